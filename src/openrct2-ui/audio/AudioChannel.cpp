@@ -31,6 +31,7 @@ namespace OpenRCT2 { namespace Audio
     private:
         ISDLAudioSource * _source = nullptr;
         SpeexResamplerState * _resampler = nullptr;
+        SDL_AudioCVT * _converter = nullptr;
 
         sint32 _group = MIXER_GROUP_SOUND;
         double _rate = 0;
@@ -65,6 +66,7 @@ namespace OpenRCT2 { namespace Audio
                 speex_resampler_destroy(_resampler);
                 _resampler = nullptr;
             }
+            delete _converter;
             if (_deletesourceondone)
             {
                 delete _source;
@@ -86,6 +88,17 @@ namespace OpenRCT2 { namespace Audio
             _resampler = value;
         }
 
+        SDL_AudioCVT * GetConverter() const override
+        {
+            return _converter;
+        }
+
+        void SetConverter(SDL_AudioCVT * value) override
+        {
+            delete _converter;
+            _converter = value;
+        }
+
         sint32 GetGroup() const override
         {
             return _group;
@@ -233,6 +246,8 @@ namespace OpenRCT2 { namespace Audio
         void Play(IAudioSource * source, sint32 loop) override
         {
             _source = static_cast<ISDLAudioSource *>(source);
+            // The new source may be in a different format
+            SetConverter(nullptr);
             _loop = loop;
             _offset = 0;
             _done = false;
@@ -50,6 +50,11 @@ namespace OpenRCT2 { namespace Audio
         virtual AudioFormat GetFormat() const abstract;
         virtual SpeexResamplerState * GetResampler() const abstract;
         virtual void SetResampler(SpeexResamplerState * value) abstract;
+        /**
+         * The converter from the format of the channel to the format of the mixer, built on first use.
+         */
+        virtual SDL_AudioCVT * GetConverter() const abstract;
+        virtual void SetConverter(SDL_AudioCVT * value) abstract;
     };
 
     namespace AudioSource
@@ -25,6 +25,7 @@
 #include <openrct2/core/Util.hpp>
 #include <openrct2/audio/audio.h>
 #include <openrct2/audio/AudioChannel.h>
+#include <openrct2/audio/AudioMixBus.h>
 #include <openrct2/audio/AudioMixer.h>
 #include <openrct2/audio/AudioSource.h>
 #include "AudioContext.h"
@@ -89,6 +90,7 @@ namespace OpenRCT2 { namespace Audio
         Buffer _channelBuffer;
         Buffer _convertBuffer;
         Buffer _effectBuffer;
+        AudioMixBus _bus;
 
     public:
         AudioMixerImpl()
@@ -254,7 +256,9 @@ namespace OpenRCT2 { namespace Audio
             // Zero the output buffer
             Memory::Set(dst, 0, length);
 
-            // Mix channels onto output buffer
+            // Mix channels onto the bus
+            size_t numFrames = length / _format.GetByteRate();
+            _bus.Clear(numFrames, _format.channels);
             auto it = _channels.begin();
             while (it != _channels.end())
             {
@@ -262,7 +266,7 @@ namespace OpenRCT2 { namespace Audio
                 sint32 group = channel->GetGroup();
                 if (group != MIXER_GROUP_SOUND || gConfigSound.sound_enabled)
                 {
-                    MixChannel(channel, dst, length);
+                    MixChannel(channel, numFrames);
                 }
                 if ((channel->IsDone() && channel->DeleteOnDone()) || channel->IsStopping())
                 {
@@ -274,6 +278,16 @@ namespace OpenRCT2 { namespace Audio
                     it++;
                 }
             }
+
+            // Convert the bus to the output buffer, only clipping once all channels have been added
+            switch (_format.format) {
+            case AUDIO_S16SYS:
+                _bus.ReadS16((sint16 *)dst);
+                break;
+            case AUDIO_U8:
+                _bus.ReadU8(dst);
+                break;
+            }
         }
 
         void UpdateAdjustedSound()
@@ -291,45 +305,53 @@ namespace OpenRCT2 { namespace Audio
             }
         }
 
-        void MixChannel(ISDLAudioChannel * channel, uint8 * data, size_t length)
+        void MixChannel(ISDLAudioChannel * channel, size_t numFrames)
         {
             sint32 byteRate = _format.GetByteRate();
-            sint32 numSamples = (sint32)(length / byteRate);
+            sint32 numSamples = (sint32)numFrames;
+            size_t length = numFrames * byteRate;
             double rate = 1;
             if (_format.format == AUDIO_S16SYS)
             {
                 rate = channel->GetRate();
             }
 
-            bool mustConvert = false;
-            SDL_AudioCVT cvt;
-            cvt.len_ratio = 1;
+            // Converters are built once per channel rather than on every callback
+            SDL_AudioCVT * cvt = nullptr;
+            double lenRatio = 1;
             AudioFormat streamformat = channel->GetFormat();
             if (streamformat != _format)
             {
-                if (SDL_BuildAudioCVT(&cvt, streamformat.format, streamformat.channels, streamformat.freq, _format.format, _format.channels, _format.freq) == -1)
+                cvt = channel->GetConverter();
+                if (cvt == nullptr)
                 {
-                    // Unable to convert channel data
-                    return;
+                    cvt = new SDL_AudioCVT();
+                    if (SDL_BuildAudioCVT(cvt, streamformat.format, streamformat.channels, streamformat.freq, _format.format, _format.channels, _format.freq) == -1)
+                    {
+                        // Unable to convert channel data
+                        delete cvt;
+                        return;
+                    }
+                    channel->SetConverter(cvt);
                 }
-                mustConvert = true;
+                lenRatio = cvt->len_ratio;
             }
 
             // Read raw PCM from channel
             sint32 readSamples = (sint32)(numSamples * rate);
-            size_t readLength = (size_t)(readSamples / cvt.len_ratio) * byteRate;
+            size_t readLength = (size_t)(readSamples / lenRatio) * byteRate;
             _channelBuffer.EnsureCapacity(readLength);
             size_t bytesRead = channel->Read(_channelBuffer.GetData(), readLength);
 
             // Convert data to required format if necessary
             void * buffer = nullptr;
             size_t bufferLen = 0;
-            if (mustConvert)
+            if (cvt != nullptr)
             {
-                if (Convert(&cvt, _channelBuffer.GetData(), bytesRead))
+                if (Convert(cvt, _channelBuffer.GetData(), bytesRead))
                 {
-                    buffer = cvt.buf;
-                    bufferLen = cvt.len_cvt;
+                    buffer = cvt->buf;
+                    bufferLen = cvt->len_cvt;
                 }
                 else
                 {
@@ -357,13 +379,17 @@ namespace OpenRCT2 { namespace Audio
                 buffer = _effectBuffer.GetData();
             }
 
-            // Apply panning and volume
-            ApplyPan(channel, buffer, bufferLen, byteRate);
-            sint32 mixVolume = ApplyVolume(channel, buffer, bufferLen);
-
-            // Finally mix on to destination buffer
-            size_t dstLength = Math::Min(length, bufferLen);
-            SDL_MixAudioFormat(data, (const uint8 *)buffer, _format.format, (uint32)dstLength, mixVolume);
+            // Finally add on to the bus with panning and volume applied
+            AudioMixGain gain = GetGain(channel);
+            size_t mixFrames = Math::Min(numFrames, bufferLen / byteRate);
+            switch (_format.format) {
+            case AUDIO_S16SYS:
+                _bus.MixS16((const sint16 *)buffer, mixFrames, gain);
+                break;
+            case AUDIO_U8:
+                _bus.MixU8((const uint8 *)buffer, mixFrames, gain);
+                break;
+            }
 
             channel->UpdateOldVolume();
         }
@@ -397,22 +423,7 @@ namespace OpenRCT2 { namespace Audio
             return outLen * byteRate;
         }
 
-        void ApplyPan(const IAudioChannel * channel, void * buffer, size_t len, size_t sampleSize)
-        {
-            if (channel->GetPan() != 0.5f && _format.channels == 2)
-            {
-                switch (_format.format) {
-                case AUDIO_S16SYS:
-                    EffectPanS16(channel, (sint16 *)buffer, (sint32)(len / sampleSize));
-                    break;
-                case AUDIO_U8:
-                    EffectPanU8(channel, (uint8 *)buffer, (sint32)(len / sampleSize));
-                    break;
-                }
-            }
-        }
-
-        sint32 ApplyVolume(const IAudioChannel * channel, void * buffer, size_t len)
+        AudioMixGain GetGain(const IAudioChannel * channel)
         {
             float volumeAdjust = _volume;
             volumeAdjust *= (gConfigSound.master_volume / 100.0f);
@@ -438,82 +449,18 @@ namespace OpenRCT2 { namespace Audio
                 endVolume = 0;
             }
 
-            sint32 mixVolume = (sint32)(channel->GetVolume() * volumeAdjust);
-            if (startVolume != endVolume)
-            {
-                // Set to max since we are adjusting the volume ourselves
-                mixVolume = MIXER_VOLUME_MAX;
-
-                // Fade between volume levels to smooth out sound and minimize clicks from sudden volume changes
-                sint32 fadeLength = (sint32)len / _format.BytesPerSample();
-                switch (_format.format) {
-                case AUDIO_S16SYS:
-                    EffectFadeS16((sint16 *)buffer, fadeLength, startVolume, endVolume);
-                    break;
-                case AUDIO_U8:
-                    EffectFadeU8((uint8 *)buffer, fadeLength, startVolume, endVolume);
-                    break;
-                }
-            }
-            return mixVolume;
-        }
-
-        static void EffectPanS16(const IAudioChannel * channel, sint16 * data, sint32 length)
-        {
-            const float dt = 1.0f / (length * 2);
-            float volumeL = channel->GetOldVolumeL();
-            float volumeR = channel->GetOldVolumeR();
-            const float d_left = dt * (channel->GetVolumeL() - channel->GetOldVolumeL());
-            const float d_right = dt * (channel->GetVolumeR() - channel->GetOldVolumeR());
-
-            for (sint32 i = 0; i < length * 2; i += 2)
-            {
-                data[i] = (sint16)(data[i] * volumeL);
-                data[i + 1] = (sint16)(data[i + 1] * volumeR);
-                volumeL += d_left;
-                volumeR += d_right;
-            }
-        }
-
-        static void EffectPanU8(const IAudioChannel * channel, uint8 * data, sint32 length)
-        {
-            float volumeL = channel->GetVolumeL();
-            float volumeR = channel->GetVolumeR();
-            float oldVolumeL = channel->GetOldVolumeL();
-            float oldVolumeR = channel->GetOldVolumeR();
-
-            for (sint32 i = 0; i < length * 2; i += 2)
-            {
-                float t = (float)i / (length * 2);
-                data[i] = (uint8)(data[i] * ((1.0 - t) * oldVolumeL + t * volumeL));
-                data[i + 1] = (uint8)(data[i + 1] * ((1.0 - t) * oldVolumeR + t * volumeR));
-            }
-        }
-
-        static void EffectFadeS16(sint16 * data, sint32 length, sint32 startvolume, sint32 endvolume)
-        {
-            static_assert(SDL_MIX_MAXVOLUME == MIXER_VOLUME_MAX, "Max volume differs between OpenRCT2 and SDL2");
-
-            float startvolume_f = (float)startvolume / SDL_MIX_MAXVOLUME;
-            float endvolume_f = (float)endvolume / SDL_MIX_MAXVOLUME;
-            for (sint32 i = 0; i < length; i++)
-            {
-                float t = (float)i / length;
-                data[i] = (sint16)(data[i] * ((1 - t) * startvolume_f + t * endvolume_f));
-            }
-        }
-
-        static void EffectFadeU8(uint8* data, sint32 length, sint32 startvolume, sint32 endvolume)
-        {
-            static_assert(SDL_MIX_MAXVOLUME == MIXER_VOLUME_MAX, "Max volume differs between OpenRCT2 and SDL2");
-
-            float startvolume_f = (float)startvolume / SDL_MIX_MAXVOLUME;
-            float endvolume_f = (float)endvolume / SDL_MIX_MAXVOLUME;
-            for (sint32 i = 0; i < length; i++)
+            // Fade between volume and pan levels to smooth out sound and minimize clicks from sudden changes
+            AudioMixGain gain;
+            gain.VolumeStart = (float)startVolume / MIXER_VOLUME_MAX;
+            gain.VolumeEnd = (float)endVolume / MIXER_VOLUME_MAX;
+            if (_format.channels == 2)
             {
-                float t = (float)i / length;
-                data[i] = (uint8)(data[i] * ((1 - t) * startvolume_f + t * endvolume_f));
+                gain.LeftStart = channel->GetOldVolumeL();
+                gain.LeftEnd = channel->GetVolumeL();
+                gain.RightStart = channel->GetOldVolumeR();
+                gain.RightEnd = channel->GetVolumeR();
             }
+            return gain;
         }
 
         bool Convert(SDL_AudioCVT * cvt, const void * src, size_t len)
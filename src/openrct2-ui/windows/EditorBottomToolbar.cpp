@@ -310,7 +310,7 @@ static void window_editor_bottom_toolbar_mouseup(rct_window *w, rct_widgetindex
 {
     if (widgetIndex == WIDX_PREVIOUS_STEP_BUTTON) {
         if ((gScreenFlags & SCREEN_FLAGS_TRACK_DESIGNER) ||
-            (gSpriteListCount[SPRITE_LIST_NULL] == MAX_SPRITES && !(gParkFlags & PARK_FLAGS_SPRITES_INITIALISED))
+            (gSpriteListCount[SPRITE_LIST_NULL] == gSpriteCapacity && !(gParkFlags & PARK_FLAGS_SPRITES_INITIALISED))
         ) {
             previous_button_mouseup_events[gS6Info.editor_step]();
         }
@@ -357,7 +357,7 @@ void window_editor_bottom_toolbar_invalidate(rct_window *w)
         } else if (gS6Info.editor_step == EDITOR_STEP_ROLLERCOASTER_DESIGNER) {
             hide_next_step_button();
         } else if (!(gScreenFlags & SCREEN_FLAGS_TRACK_DESIGNER)) {
-            if (gSpriteListCount[SPRITE_LIST_NULL] != MAX_SPRITES || gParkFlags & PARK_FLAGS_SPRITES_INITIALISED) {
+            if (gSpriteListCount[SPRITE_LIST_NULL] != gSpriteCapacity || gParkFlags & PARK_FLAGS_SPRITES_INITIALISED) {
                 hide_previous_step_button();
             }
         }
@@ -379,7 +379,7 @@ void window_editor_bottom_toolbar_paint(rct_window *w, rct_drawpixelinfo *dpi)
     else if (gScreenFlags & SCREEN_FLAGS_TRACK_DESIGNER) {
         drawPreviousButton = true;
     }
-    else if (gSpriteListCount[SPRITE_LIST_NULL] != MAX_SPRITES) {
+    else if (gSpriteListCount[SPRITE_LIST_NULL] != gSpriteCapacity) {
         drawNextButton = true;
     }
     else if (gParkFlags & PARK_FLAGS_SPRITES_INITIALISED) {
@@ -14,6 +14,9 @@
  *****************************************************************************/
 #pragma endregion
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 #include <openrct2/config/Config.h>
 #include <openrct2-ui/windows/Window.h>
 
@@ -23,6 +26,7 @@
 #include <openrct2/sprites.h>
 #include <openrct2-ui/interface/Dropdown.h>
 #include <openrct2/Context.h>
+#include <openrct2/OpenRCT2.h>
 #include <openrct2/util/Util.h>
 
 enum {
@@ -155,16 +159,45 @@ static uint16 _window_guest_list_groups_num_guests[240];
 static uint32 _window_guest_list_groups_argument_1[240];
 static uint32 _window_guest_list_groups_argument_2[240];
 static uint8 _window_guest_list_groups_guest_faces[240 * 58];
-static uint8 _window_guest_list_group_index[240];
 
 static char _window_guest_list_filter_name[32];
 
+// The guests on the individual page are only collected again once the game has ticked or the filters have changed,
+// rather than by every scroll, click and paint event.
+struct guest_list_filter_state
+{
+    uint32 tick;
+    uint32 draw_count;
+    sint32 selected_filter;
+    uint16 filter_arguments[4];
+    bool tracking_only;
+    char filter_name[32];
+};
+static guest_list_filter_state _window_guest_list_filtered_state;
+
+static bool guest_list_filter_state_equals(const guest_list_filter_state &a, const guest_list_filter_state &b)
+{
+    return a.tick == b.tick &&
+        a.draw_count == b.draw_count &&
+        a.selected_filter == b.selected_filter &&
+        memcmp(a.filter_arguments, b.filter_arguments, sizeof(a.filter_arguments)) == 0 &&
+        a.tracking_only == b.tracking_only &&
+        strcmp(a.filter_name, b.filter_name) == 0;
+}
+static bool _window_guest_list_filtered_valid;
+// In park guests that match the selected filter, which are flashed on the map
+static std::vector<uint16> _window_guest_list_filtered_guests;
+// The filtered guests that are also shown in the list
+static std::vector<uint16> _window_guest_list_visible_guests;
+
 static sint32 window_guest_list_is_peep_in_filter(rct_peep* peep);
 static void window_guest_list_find_groups();
 
 static void get_arguments_from_peep(rct_peep *peep, uint32 *argument_1, uint32* argument_2);
 
 static bool guest_should_be_visible(rct_peep *peep);
+static void window_guest_list_update_visible_guests();
+static rct_peep * window_guest_list_get_guest(uint16 spriteIndex);
 
 void window_guest_list_init_vars()
 {
@@ -226,6 +259,7 @@ rct_window * window_guest_list_open()
 
 void window_guest_list_refresh_list()
 {
+    _window_guest_list_filtered_valid = false;
     _window_guest_list_last_find_groups_wait = 0;
     _window_guest_list_last_find_groups_tick = 0;
     window_guest_list_find_groups();
@@ -488,24 +522,13 @@ static void window_guest_list_update(rct_window *w)
  */
 static void window_guest_list_scrollgetsize(rct_window *w, sint32 scrollIndex, sint32 *width, sint32 *height)
 {
-    sint32 i, y, numGuests, spriteIndex;
-    rct_peep *peep;
+    sint32 i, y, numGuests;
 
     switch (_window_guest_list_selected_tab) {
     case PAGE_INDIVIDUAL:
         // Count the number of guests
-        numGuests = 0;
-
-        FOR_ALL_GUESTS(spriteIndex, peep) {
-            if (peep->outside_of_park != 0)
-                continue;
-            if (_window_guest_list_selected_filter != -1)
-                if (window_guest_list_is_peep_in_filter(peep))
-                    continue;
-            if (!guest_should_be_visible(peep))
-                continue;
-            numGuests++;
-        }
+        window_guest_list_update_visible_guests();
+        numGuests = (sint32)_window_guest_list_visible_guests.size();
         w->var_492 = numGuests;
         y = numGuests * SCROLLABLE_ROW_HEIGHT;
         _window_guest_list_num_pages = (sint32) ceilf((float)numGuests / 3173);
@@ -555,30 +578,19 @@ static void window_guest_list_scrollgetsize(rct_window *w, sint32 scrollIndex, s
  */
 static void window_guest_list_scrollmousedown(rct_window *w, sint32 scrollIndex, sint32 x, sint32 y)
 {
-    sint32 i, spriteIndex;
+    sint32 i;
     rct_peep *peep;
 
     switch (_window_guest_list_selected_tab) {
     case PAGE_INDIVIDUAL:
         i = y / SCROLLABLE_ROW_HEIGHT;
         i += _window_guest_list_selected_page * 3173;
-        FOR_ALL_GUESTS(spriteIndex, peep) {
-            if (peep->outside_of_park != 0)
-                continue;
-            if (_window_guest_list_selected_filter != -1)
-                if (window_guest_list_is_peep_in_filter(peep))
-                    continue;
-            if (!guest_should_be_visible(peep))
-                continue;
-
-            if (i == 0) {
-                // Open guest window
+        window_guest_list_update_visible_guests();
+        if (i >= 0 && i < (sint32)_window_guest_list_visible_guests.size()) {
+            // Open guest window
+            peep = window_guest_list_get_guest(_window_guest_list_visible_guests[i]);
+            if (peep != nullptr)
                 window_guest_open(peep);
-
-                break;
-            } else {
-                i--;
-            }
         }
         break;
     case PAGE_SUMMARISED:
@@ -740,22 +752,27 @@ static void window_guest_list_scrollpaint(rct_window *w, rct_drawpixelinfo *dpi,
         i = 0;
         y = _window_guest_list_selected_page * -0x7BF2;
 
-        // For each guest
+        window_guest_list_update_visible_guests();
         FOR_ALL_GUESTS(spriteIndex, peep) {
             sprite_set_flashing((rct_sprite*)peep, false);
-            if (peep->outside_of_park != 0)
-                continue;
-            if (_window_guest_list_selected_filter != -1) {
-                if (window_guest_list_is_peep_in_filter(peep))
+        }
+        if (_window_guest_list_selected_filter != -1) {
+            for (uint16 guestSpriteIndex : _window_guest_list_filtered_guests) {
+                peep = window_guest_list_get_guest(guestSpriteIndex);
+                if (peep == nullptr)
                     continue;
                 gWindowMapFlashingFlags |= (1 << 0);
                 sprite_set_flashing((rct_sprite*)peep, true);
             }
-            if (!guest_should_be_visible(peep))
-                continue;
+        }
+
+        // For each guest
+        for (uint16 guestSpriteIndex : _window_guest_list_visible_guests) {
+            peep = window_guest_list_get_guest(guestSpriteIndex);
 
             // Check if y is beyond the scroll control
-            if (y + SCROLLABLE_ROW_HEIGHT + 1 >= -0x7FFF &&
+            if (peep != nullptr &&
+                y + SCROLLABLE_ROW_HEIGHT + 1 >= -0x7FFF &&
                 y + SCROLLABLE_ROW_HEIGHT + 1 > dpi->y &&
                 y < 0x7FFF &&
                 y < dpi->y + dpi->height) {
@@ -929,8 +946,8 @@ static void get_arguments_from_peep(rct_peep *peep, uint32 *argument_1, uint32*
  */
 static void window_guest_list_find_groups()
 {
-    sint32 spriteIndex, spriteIndex2, groupIndex, faceIndex;
-    rct_peep *peep, *peep2;
+    sint32 spriteIndex;
+    rct_peep *peep;
 
     uint32 tick256 = floor2(gScenarioTicks, 256);
     if (_window_guest_list_selected_view == _window_guest_list_last_find_groups_selected_view) {
@@ -944,107 +961,136 @@ static void window_guest_list_find_groups()
     _window_guest_list_last_find_groups_tick = tick256;
     _window_guest_list_last_find_groups_selected_view = _window_guest_list_selected_view;
     _window_guest_list_last_find_groups_wait = 320;
-    _window_guest_list_num_groups = 0;
 
-    // Set all guests to unassigned
-    FOR_ALL_GUESTS(spriteIndex, peep)
-        if (peep->outside_of_park == 0)
-            peep->flags |= SPRITE_FLAGS_PEEP_VISIBLE;
+    // Groups are kept in the order their first guest appears, each guest is matched to its group by the argument
+    // pair in a single pass. Groups without any text are still collected so their guests are not regrouped.
+    struct guest_group
+    {
+        uint32 argument_1;
+        uint32 argument_2;
+        uint16 num_guests;
+        uint8 num_faces;
+        uint8 faces[56];
+    };
+    std::vector<guest_group> groups;
+    std::unordered_map<uint64, size_t> groupsByArguments;
+    sint32 numVisibleGroups = 0;
+    bool groupLimitReached = false;
 
-    // For each guest / group
     FOR_ALL_GUESTS(spriteIndex, peep) {
-        if (peep->outside_of_park != 0 || !(peep->flags & SPRITE_FLAGS_PEEP_VISIBLE))
+        if (peep->outside_of_park != 0)
             continue;
+        peep->flags |= SPRITE_FLAGS_PEEP_VISIBLE;
 
-        // New group, cap at 240 though
-        groupIndex = _window_guest_list_num_groups;
-        if (groupIndex >= 240)
-            break;
-
-        _window_guest_list_num_groups++;
-        _window_guest_list_groups_num_guests[groupIndex] = 1;
-        peep->flags &= ~(SPRITE_FLAGS_PEEP_VISIBLE);
+        uint32 argument1, argument2;
+        get_arguments_from_peep(peep, &argument1, &argument2);
+        uint64 key = ((uint64)argument1 << 32) | argument2;
+        uint8 face = get_peep_face_sprite_small(peep) - SPR_PEEP_SMALL_FACE_VERY_VERY_UNHAPPY;
 
-        get_arguments_from_peep( peep, &_window_guest_list_groups_argument_1[groupIndex], &_window_guest_list_groups_argument_2[groupIndex]);
-        memcpy(_window_guest_list_filter_arguments + 0, &_window_guest_list_groups_argument_1[groupIndex], 4);
-        memcpy(_window_guest_list_filter_arguments + 2, &_window_guest_list_groups_argument_2[groupIndex], 4);
-
-        _window_guest_list_group_index[groupIndex] = groupIndex;
-        faceIndex = groupIndex * 56;
-        _window_guest_list_groups_guest_faces[faceIndex++] = get_peep_face_sprite_small(peep) - SPR_PEEP_SMALL_FACE_VERY_VERY_UNHAPPY;
-
-        // Find more peeps that belong to same group
-        FOR_ALL_GUESTS(spriteIndex2, peep2) {
-            if (peep2->outside_of_park != 0 || !(peep2->flags & SPRITE_FLAGS_PEEP_VISIBLE))
-                continue;
-
-            uint32 argument1, argument2;
-            // Get and check if in same group
-            get_arguments_from_peep(peep2, &argument1, &argument2);
-            if (argument1 != _window_guest_list_groups_argument_1[groupIndex] || argument2 != _window_guest_list_groups_argument_2[groupIndex] )
-                continue;
-
-            // Assign guest
-            _window_guest_list_groups_num_guests[groupIndex]++;
-            peep2->flags &= ~(SPRITE_FLAGS_PEEP_VISIBLE);
+        auto it = groupsByArguments.find(key);
+        if (it != groupsByArguments.end()) {
+            guest_group &group = groups[it->second];
+            group.num_guests++;
+            peep->flags &= ~(SPRITE_FLAGS_PEEP_VISIBLE);
 
             // Add face sprite, cap at 56 though
-            if (_window_guest_list_groups_num_guests[groupIndex] >= 56)
-                continue;
-            _window_guest_list_groups_guest_faces[faceIndex++] = get_peep_face_sprite_small(peep2) - SPR_PEEP_SMALL_FACE_VERY_VERY_UNHAPPY;
-        }
-
-        if (_window_guest_list_filter_arguments[0] == 0) {
-            _window_guest_list_num_groups--;
+            if (group.num_guests < 56)
+                group.faces[group.num_faces++] = face;
             continue;
         }
 
-        sint32 curr_num_guests = _window_guest_list_groups_num_guests[groupIndex];
-        sint32 swap_position = 0;
-        //This section places the groups in size order.
-        bool gotoNextPeep = false;
-        while (1) {
-            if (swap_position >= groupIndex) {
-                gotoNextPeep = true;
-                break;
-            }
-            if (curr_num_guests > _window_guest_list_groups_num_guests[swap_position])
-                break;
-            swap_position++;
-        }
-        if (gotoNextPeep) {
+        // New group, cap at 240 though. Guests of later new groups are left unassigned.
+        if (groupLimitReached || numVisibleGroups >= 240) {
+            groupLimitReached = true;
             continue;
         }
 
-        sint32 argument_1 = _window_guest_list_groups_argument_1[groupIndex];
-        sint32 argument_2 = _window_guest_list_groups_argument_2[groupIndex];
-        sint32 bl = _window_guest_list_group_index[groupIndex];
+        guest_group group;
+        group.argument_1 = argument1;
+        group.argument_2 = argument2;
+        group.num_guests = 1;
+        group.num_faces = 1;
+        group.faces[0] = face;
+        groupsByArguments[key] = groups.size();
+        groups.push_back(group);
+        peep->flags &= ~(SPRITE_FLAGS_PEEP_VISIBLE);
 
-        do {
-            sint32 temp = curr_num_guests;
-            curr_num_guests = _window_guest_list_groups_num_guests[swap_position];
-            _window_guest_list_groups_num_guests[swap_position] = temp;
+        memcpy(_window_guest_list_filter_arguments + 0, &argument1, 4);
+        memcpy(_window_guest_list_filter_arguments + 2, &argument2, 4);
+        if (_window_guest_list_filter_arguments[0] != 0)
+            numVisibleGroups++;
+    }
 
-            temp = argument_1;
-            argument_1 = _window_guest_list_groups_argument_1[swap_position];
-            _window_guest_list_groups_argument_1[swap_position] = temp;
+    // Place the groups in size order, groups of the same size stay in the order they were found
+    _window_guest_list_num_groups = 0;
+    std::vector<size_t> order;
+    for (size_t i = 0; i < groups.size(); i++) {
+        if ((groups[i].argument_1 & 0xFFFF) != 0)
+            order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&groups](size_t a, size_t b) -> bool
+    {
+        return groups[a].num_guests > groups[b].num_guests;
+    });
+    for (size_t groupIndex : order) {
+        const guest_group &group = groups[groupIndex];
+        sint32 i = _window_guest_list_num_groups++;
+        _window_guest_list_groups_num_guests[i] = group.num_guests;
+        _window_guest_list_groups_argument_1[i] = group.argument_1;
+        _window_guest_list_groups_argument_2[i] = group.argument_2;
+        memcpy(&_window_guest_list_groups_guest_faces[i * 56], group.faces, group.num_faces);
+    }
+}
 
-            temp = argument_2;
-            argument_2 = _window_guest_list_groups_argument_2[swap_position];
-            _window_guest_list_groups_argument_2[swap_position] = temp;
+/**
+ * Collects the guests shown on the individual page, unless nothing they depend on has changed since the last time.
+ * While the game is paused guests can still be renamed or tracked, so the guests are then collected once per frame.
+ */
+static void window_guest_list_update_visible_guests()
+{
+    guest_list_filter_state state = {};
+    state.tick = gCurrentTicks;
+    state.draw_count = game_is_paused() ? gCurrentDrawCount : 0;
+    state.selected_filter = _window_guest_list_selected_filter;
+    memcpy(state.filter_arguments, _window_guest_list_filter_arguments, sizeof(state.filter_arguments));
+    state.tracking_only = _window_guest_list_tracking_only;
+    safe_strcpy(state.filter_name, _window_guest_list_filter_name, sizeof(state.filter_name));
+    if (_window_guest_list_filtered_valid && guest_list_filter_state_equals(state, _window_guest_list_filtered_state))
+        return;
 
-            uint8 temp_faces[56];
-            memcpy(temp_faces, &(_window_guest_list_groups_guest_faces[groupIndex*56]), 56);
-            memcpy(&(_window_guest_list_groups_guest_faces[groupIndex * 56]), &(_window_guest_list_groups_guest_faces[swap_position * 56]), 56);
-            memcpy(&(_window_guest_list_groups_guest_faces[swap_position * 56]), temp_faces, 56);
+    _window_guest_list_filtered_state = state;
+    _window_guest_list_filtered_valid = true;
+    _window_guest_list_filtered_guests.clear();
+    _window_guest_list_visible_guests.clear();
 
-            temp = _window_guest_list_group_index[swap_position];
-            _window_guest_list_group_index[swap_position] = bl;
-            bl = temp;
-        } while (++swap_position <= groupIndex);
+    sint32 spriteIndex;
+    rct_peep *peep;
+    FOR_ALL_GUESTS(spriteIndex, peep) {
+        if (peep->outside_of_park != 0)
+            continue;
+        if (_window_guest_list_selected_filter != -1) {
+            if (window_guest_list_is_peep_in_filter(peep))
+                continue;
+            _window_guest_list_filtered_guests.push_back((uint16)spriteIndex);
+        }
+        if (!guest_should_be_visible(peep))
+            continue;
+        _window_guest_list_visible_guests.push_back((uint16)spriteIndex);
     }
 }
 
+/**
+ * Guests can be removed between ticks, for example by cheats, so the sprites in the cached lists are checked
+ * before they are used. Returns nullptr if the sprite is no longer a guest.
+ */
+static rct_peep * window_guest_list_get_guest(uint16 spriteIndex)
+{
+    rct_sprite * sprite = get_sprite(spriteIndex);
+    if (sprite->unknown.sprite_identifier != SPRITE_IDENTIFIER_PEEP || sprite->peep.type != PEEP_TYPE_GUEST)
+        return nullptr;
+    return &sprite->peep;
+}
+
 static bool guest_should_be_visible(rct_peep *peep)
 {
     if (_window_guest_list_tracking_only && !(peep->peep_flags & PEEP_FLAGS_TRACKING))
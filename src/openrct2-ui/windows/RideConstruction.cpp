@@ -2243,12 +2243,9 @@ static void sub_6CBCE2(
 ) {
     Ride *ride;
     const rct_preview_track *trackBlock;
-    sint32 preserve_current_viewport_flags;
     sint32 offsetX, offsetY;
 
-    paint_session * session = paint_session_alloc(dpi);
-    preserve_current_viewport_flags = gCurrentViewportFlags;
-    gCurrentViewportFlags = 0;
+    paint_session * session = paint_session_alloc(dpi, 0);
     trackDirection &= 3;
 
     ride = get_ride(rideIndex);
@@ -2358,10 +2355,8 @@ static void sub_6CBCE2(
     gMapSizeMaxXY = preserveMapSizeMaxXY;
 
     paint_struct ps = paint_session_arrange(session);
-    paint_draw_structs(dpi, &ps, gCurrentViewportFlags);
+    paint_draw_structs(dpi, &ps, session->ViewFlags);
     paint_session_free(session);
-
-    gCurrentViewportFlags = preserve_current_viewport_flags;
 }
 
 /**
@@ -121,6 +121,7 @@ namespace OpenRCT2
 
         ~Context() override
         {
+            scenario_save_wait();
             window_close_all();
             network_close();
             http_dispose();
@@ -130,9 +131,6 @@ namespace OpenRCT2
             gfx_unload_g2();
             gfx_unload_g1();
             config_release();
-#ifndef DISABLE_NETWORK
-            EVP_MD_CTX_destroy(gHashCTX);
-#endif // DISABLE_NETWORK
 
             delete _titleScreen;
 
@@ -268,11 +266,6 @@ namespace OpenRCT2
             }
             _initialised = true;
 
-#ifndef DISABLE_NETWORK
-            gHashCTX = EVP_MD_CTX_create();
-            Guard::Assert(gHashCTX != nullptr, "EVP_MD_CTX_create failed");
-#endif // DISABLE_NETWORK
-
             crash_init();
 
             if (gConfigGeneral.last_run_version != nullptr && String::Equals(gConfigGeneral.last_run_version, OPENRCT2_VERSION))
@@ -318,7 +318,7 @@ namespace Editor
         ride_init_all();
 
         //
-        for (sint32 i = 0; i < MAX_SPRITES; i++)
+        for (sint32 i = 0; i < gSpriteCapacity; i++)
         {
             rct_sprite * sprite = get_sprite(i);
             user_string_free(sprite->unknown.name_string_idx);
@@ -14,6 +14,7 @@
  *****************************************************************************/
 #pragma endregion
 
+#include <chrono>
 #include "audio/audio.h"
 #include "Cheats.h"
 #include "config/Config.h"
@@ -77,6 +78,8 @@ char   gCurrentLoadedPath[MAX_PATH];
 
 bool gLoadKeepWindowsOpen = false;
 
+uint64 * gGameLogicPhaseTimings = nullptr;
+
 uint8 gUnk13CA740;
 uint8 gUnk141F568;
 
@@ -441,12 +444,33 @@ void game_update()
     gInUpdateCode         = false;
 }
 
+static std::chrono::high_resolution_clock::time_point _gameLogicPhaseStartTime;
+
+static void game_logic_begin_phases()
+{
+    if (gGameLogicPhaseTimings != nullptr)
+    {
+        _gameLogicPhaseStartTime = std::chrono::high_resolution_clock::now();
+    }
+}
+
+static void game_logic_end_phase(GAME_LOGIC_PHASE phase)
+{
+    if (gGameLogicPhaseTimings != nullptr)
+    {
+        auto now = std::chrono::high_resolution_clock::now();
+        gGameLogicPhaseTimings[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - _gameLogicPhaseStartTime).count();
+        _gameLogicPhaseStartTime = now;
+    }
+}
+
 void game_logic_update()
 {
     gScreenAge++;
     if (gScreenAge == 0)
         gScreenAge--;
 
+    game_logic_begin_phases();
     network_update();
 
     if (network_get_mode() == NETWORK_MODE_CLIENT && network_get_status() == NETWORK_STATUS_CONNECTED && network_get_authstatus() == NETWORK_AUTH_OK)
@@ -469,29 +493,44 @@ void game_logic_update()
         // Check desync.
         network_check_desynchronization();
     }
+    game_logic_end_phase(GAME_LOGIC_PHASE_NETWORK);
 
-    sub_68B089();
     scenario_update();
+    game_logic_end_phase(GAME_LOGIC_PHASE_SCENARIO);
     climate_update();
+    game_logic_end_phase(GAME_LOGIC_PHASE_CLIMATE);
     map_update_tiles();
+    game_logic_end_phase(GAME_LOGIC_PHASE_MAP_TILES);
     // Temporarily remove provisional paths to prevent peep from interacting with them
     map_remove_provisional_elements();
     map_update_path_wide_flags();
+    game_logic_end_phase(GAME_LOGIC_PHASE_PATHS);
     peep_update_all();
+    game_logic_end_phase(GAME_LOGIC_PHASE_PEEPS);
     map_restore_provisional_elements();
+    game_logic_end_phase(GAME_LOGIC_PHASE_PATHS);
     vehicle_update_all();
+    game_logic_end_phase(GAME_LOGIC_PHASE_VEHICLES);
     sprite_misc_update_all();
+    game_logic_end_phase(GAME_LOGIC_PHASE_MISC_SPRITES);
     ride_update_all();
+    game_logic_end_phase(GAME_LOGIC_PHASE_RIDES);
     park_update();
+    game_logic_end_phase(GAME_LOGIC_PHASE_PARK);
     research_update();
+    game_logic_end_phase(GAME_LOGIC_PHASE_RESEARCH);
     ride_ratings_update_all();
+    game_logic_end_phase(GAME_LOGIC_PHASE_RIDE_RATINGS);
     ride_measurements_update();
+    game_logic_end_phase(GAME_LOGIC_PHASE_RIDE_MEASUREMENTS);
     news_item_update_current();
+    game_logic_end_phase(GAME_LOGIC_PHASE_NEWS);
 
     map_animation_invalidate_all();
     vehicle_sounds_update();
     peep_update_crowd_noise();
     climate_update_sound();
+    game_logic_end_phase(GAME_LOGIC_PHASE_ANIMATIONS_AND_SOUNDS);
     editor_open_windows_for_current_step();
 
     // Update windows
@@ -516,12 +555,18 @@ void game_logic_update()
     {
         gLastAutoSaveUpdate = platform_get_ticks();
     }
+    game_logic_end_phase(GAME_LOGIC_PHASE_INTERFACE);
 
     // Separated out processing commands in network_update which could call scenario_rand where gInUpdateCode is false.
     // All commands that are received are first queued and then executed where gInUpdateCode is set to true.
     network_process_game_commands();
+    // Recalculate the rides the commands changed now, as the queue is not part of the saved game. This is the only
+    // place the queue is drained, so the recalculation happens at the same point of the tick on every peer.
+    ride_ratings_update_pending();
+    game_logic_end_phase(GAME_LOGIC_PHASE_GAME_COMMANDS);
 
     network_flush();
+    game_logic_end_phase(GAME_LOGIC_PHASE_NETWORK);
 
     gCurrentTicks++;
     gScenarioTicks++;
@@ -670,7 +715,14 @@ sint32 game_do_command_p(uint32 command, sint32 * eax, sint32 * ebx, sint32 * ec
             }
 
             // Second call to actually perform the operation
+            bool trackMapChanges = gRideRatingsTrackMapChanges;
+            if (gGameCommandNestLevel == 1)
+            {
+                gRideRatingsTrackMapChanges = !(flags & GAME_COMMAND_FLAG_GHOST);
+            }
             new_game_command_table[command](eax, ebx, ecx, edx, esi, edi, ebp);
+            gRideRatingsTrackMapChanges = trackMapChanges;
+            peep_pathfind_invalidate_cache();
 
             // Do the callback (required for multiplayer to work correctly), but only for top level commands
             if (gGameCommandNestLevel == 1)
@@ -1219,7 +1271,11 @@ void game_fix_save_vars()
             if (tileElement == nullptr)
             {
                 log_error("Null map element at x = %d and y = %d. Fixing...", x, y);
-                tileElement = tile_element_insert(x, y, 14, 0);
+                tileElement = nullptr;
+                if (map_check_free_elements_and_reorganise(1))
+                {
+                    tileElement = tile_element_insert(x, y, 14, 0);
+                }
                 if (tileElement == nullptr)
                 {
                     log_error("Unable to fix: Map element limit reached.");
@@ -1409,7 +1465,7 @@ void game_load_init()
  */
 void reset_all_sprite_quadrant_placements()
 {
-    for (size_t i = 0; i < MAX_SPRITES; i++)
+    for (size_t i = 0; i < gSpriteCapacity; i++)
     {
         rct_sprite * spr = get_sprite(i);
         if (spr->unknown.sprite_identifier != SPRITE_IDENTIFIER_NULL)
@@ -1571,6 +1627,8 @@ void game_autosave()
              currentDate.year, currentDate.month, currentDate.day, currentTime.hour,
              currentTime.minute, currentTime.second, fileExtension);
 
+    // The previous autosave has to be complete before it can be counted or backed up
+    scenario_save_wait();
     limit_autosave_count(NUMBER_OF_AUTOSAVES_TO_KEEP, (gScreenFlags & SCREEN_FLAGS_EDITOR));
 
     utf8 path[MAX_PATH];
@@ -1589,7 +1647,7 @@ void game_autosave()
         platform_file_copy(path, backupPath, true);
     }
 
-    scenario_save(path, saveFlags);
+    scenario_save_in_background(path, saveFlags);
 }
 
 static void game_load_or_quit_no_save_prompt_callback(sint32 result, const utf8 * path)
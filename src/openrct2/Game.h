@@ -122,6 +122,29 @@ enum
     ERROR_TYPE_FILE_LOAD = 255
 };
 
+// Subsystems updated by game_logic_update, in order, used for profiling the simulation
+enum GAME_LOGIC_PHASE
+{
+    GAME_LOGIC_PHASE_NETWORK,
+    GAME_LOGIC_PHASE_SCENARIO,
+    GAME_LOGIC_PHASE_CLIMATE,
+    GAME_LOGIC_PHASE_MAP_TILES,
+    GAME_LOGIC_PHASE_PATHS,
+    GAME_LOGIC_PHASE_PEEPS,
+    GAME_LOGIC_PHASE_VEHICLES,
+    GAME_LOGIC_PHASE_MISC_SPRITES,
+    GAME_LOGIC_PHASE_RIDES,
+    GAME_LOGIC_PHASE_PARK,
+    GAME_LOGIC_PHASE_RESEARCH,
+    GAME_LOGIC_PHASE_RIDE_RATINGS,
+    GAME_LOGIC_PHASE_RIDE_MEASUREMENTS,
+    GAME_LOGIC_PHASE_NEWS,
+    GAME_LOGIC_PHASE_ANIMATIONS_AND_SOUNDS,
+    GAME_LOGIC_PHASE_INTERFACE,
+    GAME_LOGIC_PHASE_GAME_COMMANDS,
+    GAME_LOGIC_PHASE_COUNT
+};
+
 typedef void (GAME_COMMAND_POINTER)(sint32 * eax, sint32 * ebx, sint32 * ecx, sint32 * edx, sint32 * esi, sint32 * edi, sint32 * ebp);
 
 typedef void (GAME_COMMAND_CALLBACK_POINTER)(sint32 eax, sint32 ebx, sint32 ecx, sint32 edx, sint32 esi, sint32 edi, sint32 ebp);
@@ -144,6 +167,9 @@ extern GAME_COMMAND_POINTER * new_game_command_table[GAME_COMMAND_COUNT];
 
 extern uint32 gCurrentTicks;
 
+// When set, the time spent in each GAME_LOGIC_PHASE is added to this array (in nanoseconds)
+extern uint64 * gGameLogicPhaseTimings;
+
 extern uint16 gTicksSinceLastUpdate;
 extern uint8  gGamePaused;
 extern sint32 gGameSpeed;
@@ -0,0 +1,241 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#include "core/Memory.hpp"
+#include "core/String.hpp"
+#include "core/Util.hpp"
+#include "GameStateChecksum.h"
+#include "scenario/scenario.h"
+#include "world/footpath.h"
+#include "world/Park.h"
+
+namespace
+{
+    void HashSprites(GameStateHasher * hashers)
+    {
+        for (size_t i = 0; i < gSpriteCapacity; i++)
+        {
+            const rct_sprite * sprite = get_sprite(i);
+            sint32 subsystem = game_state_get_sprite_subsystem(sprite);
+            if (subsystem != -1)
+            {
+                rct_sprite copy = *sprite;
+                game_state_mask_sprite(&copy);
+                hashers[subsystem].Write(copy);
+            }
+        }
+    }
+
+    void HashTileElements(GameStateHasher * hashers)
+    {
+        // Ghost elements are placed locally by each player while constructing, so they are skipped. Their
+        // presence also moves the last-for-tile flag, so that is replaced by the number of elements per tile.
+        for (sint32 y = 0; y < MAXIMUM_MAP_SIZE_TECHNICAL; y++)
+        {
+            for (sint32 x = 0; x < MAXIMUM_MAP_SIZE_TECHNICAL; x++)
+            {
+                GameStateHasher &hasher = hashers[game_state_get_tile_subsystem(x, y)];
+                const rct_tile_element * tileElement = map_get_first_element_at(x, y);
+                uint32 numElements = 0;
+                do
+                {
+                    if (!(tileElement->flags & TILE_ELEMENT_FLAG_GHOST))
+                    {
+                        rct_tile_element copy = *tileElement;
+                        game_state_mask_tile_element(&copy);
+                        hasher.Write(copy);
+                        numElements++;
+                    }
+                }
+                while (!tile_element_is_last_for_tile(tileElement++));
+                hasher.Write(numElements);
+            }
+        }
+    }
+
+    void HashRides(GameStateHasher &hasher)
+    {
+        sint32 rideIndex;
+        Ride * ride;
+        FOR_ALL_RIDES(rideIndex, ride)
+        {
+            Ride copy = *ride;
+            game_state_mask_ride(&copy);
+            hasher.Write(rideIndex);
+            hasher.Write(copy);
+        }
+    }
+}
+
+extern "C"
+{
+    uint64 game_state_checksum()
+    {
+        uint64 checksums[GAME_STATE_SUBSYSTEM_COUNT];
+        game_state_checksum_subsystems(checksums);
+        return game_state_checksum_combine(checksums);
+    }
+
+    uint64 game_state_checksum_combine(const uint64 checksums[GAME_STATE_SUBSYSTEM_COUNT])
+    {
+        GameStateHasher hasher;
+        hasher.Write(checksums, GAME_STATE_SUBSYSTEM_COUNT * sizeof(uint64));
+        return hasher.GetHash();
+    }
+
+    void game_state_checksum_subsystems(uint64 checksums[GAME_STATE_SUBSYSTEM_COUNT])
+    {
+        GameStateHasher hashers[GAME_STATE_SUBSYSTEM_COUNT];
+
+        game_state_rng rng;
+        game_state_get_rng(&rng);
+        hashers[GAME_STATE_SUBSYSTEM_RNG].Write(rng);
+
+        game_state_finances finances;
+        game_state_get_finances(&finances);
+        hashers[GAME_STATE_SUBSYSTEM_FINANCES].Write(finances);
+
+        HashRides(hashers[GAME_STATE_SUBSYSTEM_RIDES]);
+        HashSprites(hashers);
+        HashTileElements(hashers);
+
+        for (sint32 i = 0; i < GAME_STATE_SUBSYSTEM_COUNT; i++)
+        {
+            checksums[i] = hashers[i].GetHash();
+        }
+    }
+
+    void game_state_get_rng(game_state_rng * rng)
+    {
+        rng->srand0 = gScenarioSrand0;
+        rng->srand1 = gScenarioSrand1;
+    }
+
+    void game_state_get_finances(game_state_finances * finances)
+    {
+        finances->cash = gCash;
+        finances->bank_loan = gBankLoan;
+        finances->bank_loan_interest_rate = gBankLoanInterestRate;
+        finances->max_bank_loan = gMaxBankLoan;
+        finances->current_expenditure = gCurrentExpenditure;
+        finances->current_profit = gCurrentProfit;
+        finances->historical_profit = gHistoricalProfit;
+        finances->weekly_profit_average_dividend = gWeeklyProfitAverageDividend;
+        finances->weekly_profit_average_divisor = gWeeklyProfitAverageDivisor;
+        finances->park_value = gParkValue;
+        finances->company_value = gCompanyValue;
+        Memory::CopyArray(finances->cash_history, gCashHistory, Util::CountOf(gCashHistory));
+        Memory::CopyArray(finances->weekly_profit_history, gWeeklyProfitHistory, Util::CountOf(gWeeklyProfitHistory));
+        Memory::CopyArray(finances->park_value_history, gParkValueHistory, Util::CountOf(gParkValueHistory));
+        std::memcpy(finances->expenditure_table, gExpenditureTable, sizeof(gExpenditureTable));
+    }
+
+    void game_state_get_subsystem_name(sint32 subsystem, utf8 * buffer, size_t bufferSize)
+    {
+        switch (subsystem) {
+        case GAME_STATE_SUBSYSTEM_RNG:
+            String::Set(buffer, bufferSize, "scenario RNG");
+            break;
+        case GAME_STATE_SUBSYSTEM_FINANCES:
+            String::Set(buffer, bufferSize, "park finances");
+            break;
+        case GAME_STATE_SUBSYSTEM_RIDES:
+            String::Set(buffer, bufferSize, "rides");
+            break;
+        case GAME_STATE_SUBSYSTEM_SPRITES_TRAIN:
+            String::Set(buffer, bufferSize, "sprites (train list)");
+            break;
+        case GAME_STATE_SUBSYSTEM_SPRITES_PEEP:
+            String::Set(buffer, bufferSize, "sprites (peep list)");
+            break;
+        case GAME_STATE_SUBSYSTEM_SPRITES_LITTER:
+            String::Set(buffer, bufferSize, "sprites (litter list)");
+            break;
+        default:
+        {
+            sint32 region = subsystem - GAME_STATE_SUBSYSTEM_TILE_REGION_FIRST;
+            sint32 left = (region % GAME_STATE_TILE_REGIONS_PER_AXIS) * GAME_STATE_TILE_REGION_SIZE;
+            sint32 top = (region / GAME_STATE_TILE_REGIONS_PER_AXIS) * GAME_STATE_TILE_REGION_SIZE;
+            snprintf(buffer, bufferSize, "tile elements (x %d-%d, y %d-%d)",
+                     left, left + GAME_STATE_TILE_REGION_SIZE - 1,
+                     top, top + GAME_STATE_TILE_REGION_SIZE - 1);
+            break;
+        }
+        }
+    }
+
+    sint32 game_state_get_sprite_subsystem(const rct_sprite * sprite)
+    {
+        switch (sprite->unknown.sprite_identifier) {
+        case SPRITE_IDENTIFIER_VEHICLE:
+            return GAME_STATE_SUBSYSTEM_SPRITES_TRAIN;
+        case SPRITE_IDENTIFIER_PEEP:
+            return GAME_STATE_SUBSYSTEM_SPRITES_PEEP;
+        case SPRITE_IDENTIFIER_LITTER:
+            return GAME_STATE_SUBSYSTEM_SPRITES_LITTER;
+        default:
+            // Misc sprites (particles, money effects etc.) are not synchronised
+            return -1;
+        }
+    }
+
+    sint32 game_state_get_tile_subsystem(sint32 x, sint32 y)
+    {
+        sint32 regionX = x / GAME_STATE_TILE_REGION_SIZE;
+        sint32 regionY = y / GAME_STATE_TILE_REGION_SIZE;
+        return GAME_STATE_SUBSYSTEM_TILE_REGION_FIRST + (regionY * GAME_STATE_TILE_REGIONS_PER_AXIS) + regionX;
+    }
+
+    void game_state_mask_sprite(rct_sprite * sprite)
+    {
+        sprite->unknown.sprite_left = sprite->unknown.sprite_right = sprite->unknown.sprite_top = sprite->unknown.sprite_bottom = 0;
+        if (sprite->unknown.sprite_identifier == SPRITE_IDENTIFIER_PEEP)
+        {
+            // Selecting a guest clears its invalidation flags on that client only
+            sprite->peep.window_invalidate_flags = 0;
+        }
+    }
+
+    void game_state_mask_tile_element(rct_tile_element * tileElement)
+    {
+        tileElement->flags &= ~TILE_ELEMENT_FLAG_LAST_TILE;
+
+        if (tile_element_get_type(tileElement) == TILE_ELEMENT_TYPE_PATH)
+        {
+            // A path addition being previewed is placed on the real path element, but only by that player
+            if (footpath_element_path_scenery_is_ghost(tileElement))
+            {
+                footpath_element_set_path_scenery(tileElement, 0);
+                footpath_scenery_set_is_ghost(tileElement, false);
+            }
+            // The status is only used by additions, and previewing a bin overwrites it
+            if (!footpath_element_is_queue(tileElement) && !footpath_element_has_path_scenery(tileElement))
+            {
+                tileElement->properties.path.addition_status = 0;
+            }
+        }
+    }
+
+    void game_state_mask_ride(Ride * ride)
+    {
+        // Updated by the UI and by the ride music, which depends on the local view
+        ride->window_invalidate_flags = 0;
+        // Only assigned when a player opens the ride's graphs
+        ride->measurement_index = 0;
+        ride->music_tune_id = 0;
+        ride->music_position = 0;
+    }
+}
@@ -0,0 +1,178 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#ifndef _GAME_STATE_CHECKSUM_H_
+#define _GAME_STATE_CHECKSUM_H_
+
+#ifdef __cplusplus
+    #include <cstring>
+#endif
+#include "common.h"
+#include "management/Finance.h"
+#include "ride/Ride.h"
+#include "world/map.h"
+#include "world/sprite.h"
+
+// The map is split into square regions of this many tiles, each with its own checksum
+#define GAME_STATE_TILE_REGION_SIZE 32
+#define GAME_STATE_TILE_REGIONS_PER_AXIS (MAXIMUM_MAP_SIZE_TECHNICAL / GAME_STATE_TILE_REGION_SIZE)
+#define GAME_STATE_TILE_REGION_COUNT (GAME_STATE_TILE_REGIONS_PER_AXIS * GAME_STATE_TILE_REGIONS_PER_AXIS)
+
+enum GAME_STATE_SUBSYSTEM
+{
+    GAME_STATE_SUBSYSTEM_RNG,
+    GAME_STATE_SUBSYSTEM_FINANCES,
+    GAME_STATE_SUBSYSTEM_RIDES,
+    GAME_STATE_SUBSYSTEM_SPRITES_TRAIN,
+    GAME_STATE_SUBSYSTEM_SPRITES_PEEP,
+    GAME_STATE_SUBSYSTEM_SPRITES_LITTER,
+    GAME_STATE_SUBSYSTEM_TILE_REGION_FIRST,
+    GAME_STATE_SUBSYSTEM_COUNT = GAME_STATE_SUBSYSTEM_TILE_REGION_FIRST + GAME_STATE_TILE_REGION_COUNT
+};
+
+#pragma pack(push, 1)
+typedef struct game_state_rng
+{
+    uint32 srand0;
+    uint32 srand1;
+} game_state_rng;
+
+typedef struct game_state_finances
+{
+    money32 cash;
+    money32 bank_loan;
+    uint8 bank_loan_interest_rate;
+    money32 max_bank_loan;
+    money32 current_expenditure;
+    money32 current_profit;
+    money32 historical_profit;
+    money32 weekly_profit_average_dividend;
+    uint16 weekly_profit_average_divisor;
+    money32 park_value;
+    money32 company_value;
+    money32 cash_history[FINANCE_GRAPH_SIZE];
+    money32 weekly_profit_history[FINANCE_GRAPH_SIZE];
+    money32 park_value_history[FINANCE_GRAPH_SIZE];
+    money32 expenditure_table[EXPENDITURE_TABLE_MONTH_COUNT][RCT_EXPENDITURE_TYPE_COUNT];
+} game_state_finances;
+#pragma pack(pop)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Calculates a 64-bit checksum of the synchronised game state: all sprites (except misc sprites), every
+ * non-ghost tile element, all rides, the park finances and the scenario RNG. Fields that are only modified
+ * by the user interface or audio are excluded so that clients viewing different parts of the park still
+ * produce the same value as the server. The hash is not cryptographic, it is only used to detect
+ * desynchronisation.
+ */
+uint64 game_state_checksum();
+
+/**
+ * Calculates a separate checksum for each GAME_STATE_SUBSYSTEM so that a desync can be narrowed down to
+ * a sprite list, map region, the rides, finances or RNG. game_state_checksum is derived from these.
+ */
+void game_state_checksum_subsystems(uint64 checksums[GAME_STATE_SUBSYSTEM_COUNT]);
+uint64 game_state_checksum_combine(const uint64 checksums[GAME_STATE_SUBSYSTEM_COUNT]);
+
+void game_state_get_rng(game_state_rng * rng);
+void game_state_get_finances(game_state_finances * finances);
+void game_state_get_subsystem_name(sint32 subsystem, utf8 * buffer, size_t bufferSize);
+sint32 game_state_get_sprite_subsystem(const rct_sprite * sprite);
+sint32 game_state_get_tile_subsystem(sint32 x, sint32 y);
+
+/**
+ * Clears the fields of a sprite, tile element or ride copy that are not part of the synchronised state.
+ */
+void game_state_mask_sprite(rct_sprite * sprite);
+void game_state_mask_tile_element(rct_tile_element * tileElement);
+void game_state_mask_ride(Ride * ride);
+
+#ifdef __cplusplus
+}
+
+/**
+ * Word at a time 64-bit hash using the xxHash64 round and finaliser.
+ */
+class GameStateHasher final
+{
+private:
+    static constexpr uint64 Prime1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64 Prime2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64 Prime3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64 Prime4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr uint64 Prime5 = 0x27D4EB2F165667C5ULL;
+
+    uint64 _hash = Prime5;
+
+public:
+    void Write(const void * data, size_t length)
+    {
+        auto src = static_cast<const uint8 *>(data);
+        while (length >= sizeof(uint64))
+        {
+            uint64 word;
+            std::memcpy(&word, src, sizeof(word));
+            Mix(word);
+            src += sizeof(uint64);
+            length -= sizeof(uint64);
+        }
+        if (length > 0)
+        {
+            uint64 word = 0;
+            std::memcpy(&word, src, length);
+            Mix(word ^ ((uint64)length << 56));
+        }
+    }
+
+    template<typename T>
+    void Write(const T &value)
+    {
+        Write(&value, sizeof(T));
+    }
+
+    uint64 GetHash() const
+    {
+        uint64 hash = _hash;
+        hash ^= hash >> 33;
+        hash *= Prime2;
+        hash ^= hash >> 29;
+        hash *= Prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+private:
+    static uint64 RotateLeft(uint64 value, sint32 shift)
+    {
+        return (value << shift) | (value >> (64 - shift));
+    }
+
+    void Mix(uint64 word)
+    {
+        word *= Prime2;
+        word = RotateLeft(word, 31);
+        word *= Prime1;
+        _hash ^= word;
+        _hash = RotateLeft(_hash, 27) * Prime1 + Prime4;
+    }
+};
+
+#endif
+
+#endif
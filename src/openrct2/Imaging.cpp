@@ -16,6 +16,7 @@
 
 #pragma warning(disable : 4611) // interaction between '_setjmp' and C++ object destruction is non-portable
 
+#include <memory>
 #include <png.h>
 #include "core/Exception.hpp"
 #include "core/FileStream.hpp"
@@ -273,6 +274,162 @@ namespace Imaging
         return result;
     }
 
+    struct PngStreamWriter::State
+    {
+        png_structp                 png_ptr = nullptr;
+        png_infop                   info_ptr = nullptr;
+        png_colorp                  png_palette = nullptr;
+        std::unique_ptr<FileStream> fs;
+        sint32                      width = 0;
+        sint32                      rowsRemaining = 0;
+        bool                        failed = false;
+
+        ~State()
+        {
+            if (png_ptr != nullptr)
+            {
+                png_free(png_ptr, png_palette);
+                png_destroy_write_struct(&png_ptr, &info_ptr);
+            }
+        }
+    };
+
+    PngStreamWriter::~PngStreamWriter()
+    {
+        delete _state;
+    }
+
+    bool PngStreamWriter::Begin(const utf8 * path, sint32 width, sint32 height, const rct_palette * palette)
+    {
+        Guard::Assert(_state == nullptr, "PNG stream already started");
+
+        _state = new State();
+        _state->width = width;
+        _state->rowsRemaining = height;
+
+        _state->png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, PngError, PngWarning);
+        if (_state->png_ptr == nullptr)
+        {
+            _state->failed = true;
+            return false;
+        }
+        png_structp png_ptr = _state->png_ptr;
+
+        _state->info_ptr = png_create_info_struct(png_ptr);
+        if (_state->info_ptr == nullptr)
+        {
+            _state->failed = true;
+            return false;
+        }
+        png_infop info_ptr = _state->info_ptr;
+
+        _state->png_palette = (png_colorp)png_malloc(png_ptr, PNG_MAX_PALETTE_LENGTH * sizeof(png_color));
+        for (int i = 0; i < 256; i++)
+        {
+            const rct_palette_entry *entry = &palette->entries[i];
+            _state->png_palette[i].blue = entry->blue;
+            _state->png_palette[i].green = entry->green;
+            _state->png_palette[i].red = entry->red;
+        }
+
+        try
+        {
+            // Open file for writing
+            _state->fs = std::unique_ptr<FileStream>(new FileStream(path, FILE_MODE_WRITE));
+            png_set_write_fn(png_ptr, _state->fs.get(), PngWriteData, PngFlush);
+
+            // Set error handler
+            if (setjmp(png_jmpbuf(png_ptr)))
+            {
+                throw Exception("PNG ERROR");
+            }
+
+            // Write header
+            png_set_PLTE(png_ptr, info_ptr, _state->png_palette, PNG_MAX_PALETTE_LENGTH);
+            png_set_IHDR(
+                png_ptr, info_ptr, width, height, 8,
+                PNG_COLOR_TYPE_PALETTE, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT
+            );
+            png_byte transparentIndex = 0;
+            png_set_tRNS(png_ptr, info_ptr, &transparentIndex, 1, nullptr);
+            png_write_info(png_ptr, info_ptr);
+            return true;
+        }
+        catch (const std::exception &)
+        {
+            _state->failed = true;
+            return false;
+        }
+    }
+
+    bool PngStreamWriter::WriteRows(const uint8 * bits, sint32 stride, sint32 numRows)
+    {
+        if (_state == nullptr || _state->failed)
+        {
+            return false;
+        }
+        if (numRows > _state->rowsRemaining)
+        {
+            log_error("PNG stream written past its height");
+            _state->failed = true;
+            return false;
+        }
+
+        png_structp png_ptr = _state->png_ptr;
+        try
+        {
+            // The jump buffer belongs to the calling frame, so it is set again for every band
+            if (setjmp(png_jmpbuf(png_ptr)))
+            {
+                throw Exception("PNG ERROR");
+            }
+
+            for (sint32 y = 0; y < numRows; y++)
+            {
+                png_write_row(png_ptr, (png_const_bytep)bits);
+                bits += stride;
+            }
+            _state->rowsRemaining -= numRows;
+            return true;
+        }
+        catch (const std::exception &)
+        {
+            _state->failed = true;
+            return false;
+        }
+    }
+
+    bool PngStreamWriter::End()
+    {
+        if (_state == nullptr || _state->failed)
+        {
+            return false;
+        }
+        if (_state->rowsRemaining != 0)
+        {
+            log_error("PNG stream ended with %d rows missing", _state->rowsRemaining);
+            _state->failed = true;
+            return false;
+        }
+
+        png_structp png_ptr = _state->png_ptr;
+        try
+        {
+            if (setjmp(png_jmpbuf(png_ptr)))
+            {
+                throw Exception("PNG ERROR");
+            }
+            png_write_end(png_ptr, nullptr);
+            _state->fs = nullptr;
+            return true;
+        }
+        catch (const std::exception &)
+        {
+            _state->failed = true;
+            return false;
+        }
+    }
+
     static void PngReadData(png_structp png_ptr, png_bytep data, png_size_t length)
     {
         auto * fs = static_cast<FileStream *>(png_get_io_ptr(png_ptr));
@@ -27,6 +27,27 @@ namespace Imaging
     bool PngRead(uint8 * * pixels, uint32 * width, uint32 * height, bool expand, const utf8 * path, sint32 * bitDepth);
     bool PngWrite(const rct_drawpixelinfo * dpi, const rct_palette * palette, const utf8 * path);
     bool PngWrite32bpp(sint32 width, sint32 height, const void * pixels, const utf8 * path);
+
+    /**
+     * Writes a palette PNG a band of rows at a time, so that large images never need to be held in memory as
+     * a whole. Rows must be written in order and the total must match the height passed to Begin.
+     */
+    class PngStreamWriter final
+    {
+    private:
+        struct State;
+        State * _state = nullptr;
+
+    public:
+        PngStreamWriter() = default;
+        PngStreamWriter(const PngStreamWriter &) = delete;
+        PngStreamWriter & operator=(const PngStreamWriter &) = delete;
+        ~PngStreamWriter();
+
+        bool Begin(const utf8 * path, sint32 width, sint32 height, const rct_palette * palette);
+        bool WriteRows(const uint8 * bits, sint32 stride, sint32 numRows);
+        bool End();
+    };
 }
 
 #endif // __cplusplus
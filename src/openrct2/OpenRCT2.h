@@ -19,11 +19,6 @@
 #include "common.h"
 #include "core/Guard.hpp"
 
-
-#ifndef DISABLE_NETWORK
-    #include <openssl/evp.h>
-#endif // DISABLE_NETWORK
-
 enum STARTUP_ACTION
 {
     STARTUP_ACTION_INTRO,
@@ -64,10 +59,6 @@ extern "C"
     extern bool gOpenRCT2ShowChangelog;
     extern bool gOpenRCT2SilentBreakpad;
 
-#ifndef DISABLE_NETWORK
-    extern EVP_MD_CTX * gHashCTX;
-#endif // DISABLE_NETWORK
-
 #ifndef DISABLE_NETWORK
     extern sint32 gNetworkStart;
     extern char gNetworkStartHost[128];
@@ -181,6 +181,7 @@ const char * PlatformEnvironment::DirectoryNamesRCT2[] =
     "Landscapes",           // LANDSCAPE
     nullptr,                // LANGUAGE
     nullptr,                // LOG_CHAT
+    nullptr,                // LOG_DESYNCS
     nullptr,                // LOG_SERVER
     nullptr,                // NETWORK_KEY
     "ObjData",              // OBJECT
@@ -199,6 +200,7 @@ const char * PlatformEnvironment::DirectoryNamesOpenRCT2[] =
     "landscape",            // LANDSCAPE
     "language",             // LANGUAGE
     "chatlogs",             // LOG_CHAT
+    "desyncs",              // LOG_DESYNCS
     "serverlogs",           // LOG_SERVER
     "keys",                 // NETWORK_KEY
     "object",               // OBJECT
@@ -41,6 +41,7 @@ namespace OpenRCT2
         LANDSCAPE,          // Contains scenario editor landscapes (SC6).
         LANGUAGE,           // Contains language packs.
         LOG_CHAT,           // Contains chat logs.
+        LOG_DESYNCS,        // Contains desync reports.
         LOG_SERVER,         // Contains server logs.
         NETWORK_KEY,        // Contains the user's public and private keys.
         OBJECT,             // Contains objects.
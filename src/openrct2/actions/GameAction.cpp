@@ -24,6 +24,8 @@
 
 #include "../platform/platform.h"
 #include "../localisation/localisation.h"
+#include "../peep/Peep.h"
+#include "../ride/ride_ratings.h"
 #include "../world/Park.h"
 
 GameActionResult::GameActionResult()
@@ -174,7 +176,11 @@ namespace GameActions
             log_verbose("[%s] GameAction::Execute\n", "sv");
 
             // Execute the action, changing the game state
+            bool trackMapChanges = gRideRatingsTrackMapChanges;
+            gRideRatingsTrackMapChanges = !(flags & GAME_COMMAND_FLAG_GHOST);
             result = action->Execute();
+            gRideRatingsTrackMapChanges = trackMapChanges;
+            peep_pathfind_invalidate_cache();
 
             // Update money balance
             if (!(gParkFlags & PARK_FLAGS_NO_MONEY) && result->Cost != 0)
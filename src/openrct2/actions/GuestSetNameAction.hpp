@@ -54,7 +54,7 @@ public:
     GameActionResult::Ptr Query() const override
     {
         
-        if (_spriteIndex >= MAX_SPRITES)
+        if (_spriteIndex >= gSpriteCapacity)
         {
             return std::make_unique<GameActionResult>(GA_ERROR::INVALID_PARAMETERS, STR_CANT_NAME_GUEST, STR_NONE);
         }
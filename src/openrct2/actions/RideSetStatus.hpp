@@ -24,6 +24,7 @@
 #include "../interface/window.h"
 #include "../world/Park.h"
 #include "../ride/Ride.h"
+#include "../ride/RideCandidates.h"
 
 static rct_string_id _StatusErrorTitles[] =
 {
@@ -135,6 +136,7 @@ public:
             }
 
             ride->status = RIDE_STATUS_CLOSED;
+            ride_candidates_invalidate_visible();
             ride->lifecycle_flags &= ~RIDE_LIFECYCLE_PASS_STATION_NO_STOPPING;
             ride->race_winner = SPRITE_INDEX_NULL;
             ride->window_invalidate_flags |= RIDE_INVALIDATE_RIDE_MAIN | RIDE_INVALIDATE_RIDE_LIST;
@@ -174,6 +176,7 @@ public:
 
                 ride->race_winner = SPRITE_INDEX_NULL;
                 ride->status = _status;
+                ride_candidates_invalidate_visible();
                 ride_get_measurement(_rideIndex, nullptr);
                 ride->window_invalidate_flags |= RIDE_INVALIDATE_RIDE_MAIN | RIDE_INVALIDATE_RIDE_LIST;
                 window_invalidate_by_number(WC_RIDE, _rideIndex);
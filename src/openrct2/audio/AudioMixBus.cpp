@@ -0,0 +1,175 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+
+#include <algorithm>
+#include <cmath>
+#include "AudioMixBus.h"
+
+#ifdef PLATFORM_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace OpenRCT2 { namespace Audio
+{
+    constexpr float MIX_BUS_SAMPLE_MIN = -32768.0f;
+    constexpr float MIX_BUS_SAMPLE_MAX = 32767.0f;
+
+    // The gains at frame 0 and how much they change each frame
+    struct GainRamp
+    {
+        float Volume;
+        float VolumeStep;
+        float Left;
+        float LeftStep;
+        float Right;
+        float RightStep;
+
+        GainRamp(const AudioMixGain &gain, size_t numFrames)
+        {
+            float frames = (float)std::max<size_t>(numFrames, 1);
+            Volume = gain.VolumeStart;
+            VolumeStep = (gain.VolumeEnd - gain.VolumeStart) / frames;
+            Left = gain.LeftStart;
+            LeftStep = (gain.LeftEnd - gain.LeftStart) / frames;
+            Right = gain.RightStart;
+            RightStep = (gain.RightEnd - gain.RightStart) / frames;
+        }
+    };
+
+    static float SampleToFloat(sint16 sample)
+    {
+        return (float)sample;
+    }
+
+    static float SampleToFloat(uint8 sample)
+    {
+        // Scaled to the range of a 16-bit sample so that both formats share the bus
+        return (float)((sint32)sample - 128) * 256.0f;
+    }
+
+    template<typename T>
+    static void MixFrames(float * bus, const T * src, size_t firstFrame, size_t numFrames, sint32 numChannels, const GainRamp &ramp)
+    {
+        for (size_t i = firstFrame; i < numFrames; i++)
+        {
+            float frame = (float)i;
+            float volume = ramp.Volume + frame * ramp.VolumeStep;
+            if (numChannels == 2)
+            {
+                bus[i * 2] += SampleToFloat(src[i * 2]) * (volume * (ramp.Left + frame * ramp.LeftStep));
+                bus[i * 2 + 1] += SampleToFloat(src[i * 2 + 1]) * (volume * (ramp.Right + frame * ramp.RightStep));
+            }
+            else
+            {
+                for (sint32 c = 0; c < numChannels; c++)
+                {
+                    bus[i * numChannels + c] += SampleToFloat(src[i * numChannels + c]) * volume;
+                }
+            }
+        }
+    }
+
+    void AudioMixBus::Clear(size_t numFrames, sint32 numChannels)
+    {
+        _numChannels = numChannels;
+        _samples.assign(numFrames * numChannels, 0.0f);
+    }
+
+    void AudioMixBus::MixS16(const sint16 * src, size_t numFrames, const AudioMixGain &gain)
+    {
+        numFrames = std::min(numFrames, GetNumFrames());
+        GainRamp ramp(gain, numFrames);
+        float * bus = _samples.data();
+        size_t i = 0;
+#ifdef PLATFORM_SSE2
+        if (_numChannels == 2)
+        {
+            // Four stereo frames at a time, each half of a vector holding two frames of left and right samples
+            const __m128 volume = _mm_set1_ps(ramp.Volume);
+            const __m128 volumeStep = _mm_set1_ps(ramp.VolumeStep);
+            const __m128 pan = _mm_setr_ps(ramp.Left, ramp.Right, ramp.Left, ramp.Right);
+            const __m128 panStep = _mm_setr_ps(ramp.LeftStep, ramp.RightStep, ramp.LeftStep, ramp.RightStep);
+            const __m128 frameIncrement = _mm_set1_ps(4.0f);
+            __m128 framesLo = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+            __m128 framesHi = _mm_setr_ps(2.0f, 2.0f, 3.0f, 3.0f);
+            for (; i + 4 <= numFrames; i += 4)
+            {
+                __m128 gainLo = _mm_mul_ps(
+                    _mm_add_ps(volume, _mm_mul_ps(framesLo, volumeStep)),
+                    _mm_add_ps(pan, _mm_mul_ps(framesLo, panStep)));
+                __m128 gainHi = _mm_mul_ps(
+                    _mm_add_ps(volume, _mm_mul_ps(framesHi, volumeStep)),
+                    _mm_add_ps(pan, _mm_mul_ps(framesHi, panStep)));
+
+                // Sign extend the 16-bit samples by unpacking them into the top half of each 32-bit lane
+                __m128i samples = _mm_loadu_si128((const __m128i *)&src[i * 2]);
+                __m128 samplesLo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+                __m128 samplesHi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+
+                float * dst = &bus[i * 2];
+                _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_mul_ps(samplesLo, gainLo)));
+                _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), _mm_mul_ps(samplesHi, gainHi)));
+
+                framesLo = _mm_add_ps(framesLo, frameIncrement);
+                framesHi = _mm_add_ps(framesHi, frameIncrement);
+            }
+        }
+#endif
+        MixFrames(bus, src, i, numFrames, _numChannels, ramp);
+    }
+
+    void AudioMixBus::MixU8(const uint8 * src, size_t numFrames, const AudioMixGain &gain)
+    {
+        numFrames = std::min(numFrames, GetNumFrames());
+        MixFrames(_samples.data(), src, 0, numFrames, _numChannels, GainRamp(gain, numFrames));
+    }
+
+    void AudioMixBus::ReadS16(sint16 * dst) const
+    {
+        const float * src = _samples.data();
+        size_t numSamples = _samples.size();
+        size_t i = 0;
+#ifdef PLATFORM_SSE2
+        // Clamped before converting as out of range floats convert to INT32_MIN, the pack then saturates
+        const __m128 sampleMin = _mm_set1_ps(MIX_BUS_SAMPLE_MIN);
+        const __m128 sampleMax = _mm_set1_ps(MIX_BUS_SAMPLE_MAX);
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            __m128 lo = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&src[i]), sampleMin), sampleMax);
+            __m128 hi = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&src[i + 4]), sampleMin), sampleMax);
+            __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi));
+            _mm_storeu_si128((__m128i *)&dst[i], packed);
+        }
+#endif
+        for (; i < numSamples; i++)
+        {
+            float sample = std::min(std::max(src[i], MIX_BUS_SAMPLE_MIN), MIX_BUS_SAMPLE_MAX);
+            dst[i] = (sint16)std::lrint(sample);
+        }
+    }
+
+    void AudioMixBus::ReadU8(uint8 * dst) const
+    {
+        const float * src = _samples.data();
+        for (size_t i = 0; i < _samples.size(); i++)
+        {
+            float sample = std::min(std::max(src[i], MIX_BUS_SAMPLE_MIN), MIX_BUS_SAMPLE_MAX);
+            sint32 value = (sint32)std::lrint(sample / 256.0f) + 128;
+            dst[i] = (uint8)std::min(value, 255);
+        }
+    }
+} }
@@ -0,0 +1,72 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+
+#pragma once
+
+#include <vector>
+#include "../common.h"
+
+namespace OpenRCT2 { namespace Audio
+{
+    /**
+     * The gain applied to a channel over one block. Each gain ramps linearly from its start value on the first
+     * frame to its end value on the last, which smooths out volume and pan changes. The left and right gains
+     * are only used for stereo, multiplied by the volume.
+     */
+    struct AudioMixGain
+    {
+        float VolumeStart = 1.0f;
+        float VolumeEnd = 1.0f;
+        float LeftStart = 1.0f;
+        float LeftEnd = 1.0f;
+        float RightStart = 1.0f;
+        float RightEnd = 1.0f;
+    };
+
+    /**
+     * Accumulates audio channels as 32-bit floats in the range of a 16-bit sample, so that mixing many loud
+     * channels does not clip until the single saturating conversion to the output format.
+     */
+    class AudioMixBus final
+    {
+    private:
+        std::vector<float>  _samples;
+        sint32              _numChannels = 0;
+
+    public:
+        /**
+         * Empties the bus and sizes it for a block of interleaved frames.
+         */
+        void Clear(size_t numFrames, sint32 numChannels);
+
+        size_t GetNumFrames() const { return _numChannels == 0 ? 0 : _samples.size() / _numChannels; }
+        const float * GetSamples() const { return _samples.data(); }
+
+        /**
+         * Adds interleaved samples with the same number of channels as the bus. numFrames may be less than the
+         * size of the bus, the ramps in gain then end early.
+         */
+        void MixS16(const sint16 * src, size_t numFrames, const AudioMixGain &gain);
+        void MixU8(const uint8 * src, size_t numFrames, const AudioMixGain &gain);
+
+        /**
+         * Converts the bus to the output format, clamping samples that are out of range.
+         */
+        void ReadS16(sint16 * dst) const;
+        void ReadU8(uint8 * dst) const;
+    };
+} }
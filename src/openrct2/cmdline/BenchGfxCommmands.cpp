@@ -17,12 +17,22 @@
 #include "../interface/Screenshot.h"
 #include "CommandLine.hpp"
 
+static BenchGfxOptions options;
+
+static const CommandLineOptionDefinition BenchGfxOptionsDef[]
+{
+    { CMDLINE_TYPE_STRING,  &options.json_path,     NAC, "json",      "write the results to a JSON file" },
+    { CMDLINE_TYPE_STRING,  &options.baseline_path, NAC, "baseline",  "fail if slower than the results in a JSON file written by --json" },
+    { CMDLINE_TYPE_INTEGER, &options.tolerance,     NAC, "tolerance", "percentage a frame may be slower than the baseline (default 10)" },
+    OptionTableEnd
+};
+
 static exitcode_t HandleBenchGfx(CommandLineArgEnumerator *argEnumerator);
 
 const CommandLineCommand CommandLine::BenchGfxCommands[]
 {
     // Main commands
-    DefineCommand("", "<file> [iterations count]", nullptr, HandleBenchGfx),
+    DefineCommand("", "<file> [iterations per zoom level and rotation]", BenchGfxOptionsDef, HandleBenchGfx),
     CommandTableEnd
 };
 
@@ -30,7 +40,7 @@ static exitcode_t HandleBenchGfx(CommandLineArgEnumerator *argEnumerator)
 {
     const char * * argv = (const char * *)argEnumerator->GetArguments() + argEnumerator->GetIndex();
     sint32 argc = argEnumerator->GetCount() - argEnumerator->GetIndex();
-    sint32 result = cmdline_for_gfxbench(argv, argc);
+    sint32 result = cmdline_for_gfxbench(argv, argc, &options);
     if (result < 0) {
         return EXITCODE_FAIL;
     }
@@ -0,0 +1,136 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#include <chrono>
+#include "../Context.h"
+#include "../core/Console.hpp"
+#include "../core/Util.hpp"
+#include "../Game.h"
+#include "../Intro.h"
+#include "../OpenRCT2.h"
+#include "../peep/Peep.h"
+#include "../ride/Ride.h"
+#include "../world/sprite.h"
+#include "CommandLine.hpp"
+
+using namespace OpenRCT2;
+
+static exitcode_t HandleBenchSim(CommandLineArgEnumerator *argEnumerator);
+
+const CommandLineCommand CommandLine::BenchSimCommands[]
+{
+    // Main commands
+    DefineCommand("", "<file> [ticks]", nullptr, HandleBenchSim),
+    CommandTableEnd
+};
+
+static const char * const GameLogicPhaseNames[] =
+{
+    "network",
+    "scenario_update",
+    "climate_update",
+    "map_update_tiles",
+    "map_update_path_wide_flags",
+    "peep_update_all",
+    "vehicle_update_all",
+    "sprite_misc_update_all",
+    "ride_update_all",
+    "park_update",
+    "research_update",
+    "ride_ratings_update_all",
+    "ride_measurements_update",
+    "news_item_update_current",
+    "animations and sounds",
+    "interface",
+    "game commands",
+};
+static_assert(Util::CountOf(GameLogicPhaseNames) == GAME_LOGIC_PHASE_COUNT, "Missing game logic phase name");
+
+static exitcode_t HandleBenchSim(CommandLineArgEnumerator *argEnumerator)
+{
+    const char * inputPath;
+    if (!argEnumerator->TryPopString(&inputPath))
+    {
+        Console::Error::WriteLine("Usage: openrct2 benchsim <file> [ticks]");
+        return EXITCODE_FAIL;
+    }
+
+    sint32 tickCount = 10000;
+    if (argEnumerator->TryPopInteger(&tickCount) && tickCount <= 0)
+    {
+        Console::Error::WriteLine("Tick count must be greater than zero.");
+        return EXITCODE_FAIL;
+    }
+
+    gOpenRCT2Headless = true;
+    auto context = CreateContext();
+    if (!context->Initialise() || !context->LoadParkFromFile(inputPath))
+    {
+        delete context;
+        return EXITCODE_FAIL;
+    }
+
+    gIntroState = INTRO_STATE_NONE;
+    gScreenFlags = SCREEN_FLAGS_PLAYING;
+
+    uint32 numRides = 0;
+    sint32 rideIndex;
+    Ride * ride;
+    FOR_ALL_RIDES(rideIndex, ride)
+    {
+        numRides++;
+    }
+    Console::WriteLine("Simulating %d ticks of a park with %u peeps (%u guests in park) and %u rides.",
+                       tickCount,
+                       gSpriteListCount[SPRITE_LIST_PEEP],
+                       gNumGuestsInPark,
+                       numRides);
+
+    uint64 phaseTimings[GAME_LOGIC_PHASE_COUNT] = { 0 };
+    gGameLogicPhaseTimings = phaseTimings;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (sint32 i = 0; i < tickCount; i++)
+    {
+        game_logic_update();
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    gGameLogicPhaseTimings = nullptr;
+
+    std::chrono::duration<double> duration = endTime - startTime;
+    Console::WriteLine("Simulating %d ticks took %.2f seconds (%.1f ticks per second).",
+                       tickCount,
+                       duration.count(),
+                       tickCount / duration.count());
+
+    uint64 totalPhaseTime = 0;
+    for (auto phaseTime : phaseTimings)
+    {
+        totalPhaseTime += phaseTime;
+    }
+    Console::WriteLine();
+    Console::WriteLine("%-28s %12s %12s %8s", "Phase", "Total (ms)", "Tick (us)", "Share");
+    for (sint32 phase = 0; phase < GAME_LOGIC_PHASE_COUNT; phase++)
+    {
+        double totalMs = phaseTimings[phase] / 1000000.0;
+        double tickUs = (phaseTimings[phase] / 1000.0) / tickCount;
+        double share = totalPhaseTime == 0 ? 0 : (phaseTimings[phase] * 100.0) / totalPhaseTime;
+        Console::WriteLine("%-28s %12.2f %12.2f %7.1f%%", GameLogicPhaseNames[phase], totalMs, tickUs, share);
+    }
+
+    delete context;
+    return EXITCODE_OK;
+}
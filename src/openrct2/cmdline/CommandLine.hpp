@@ -102,6 +102,7 @@ namespace CommandLine
     extern const CommandLineCommand ScreenshotCommands[];
     extern const CommandLineCommand SpriteCommands[];
     extern const CommandLineCommand BenchGfxCommands[];
+    extern const CommandLineCommand BenchSimCommands[];
 
     extern const CommandLineExample RootExamples[];
 
@@ -213,6 +213,11 @@ typedef uint16 rct_string_id;
     #define PLATFORM_32BIT
 #endif
 
+// SSE2 is part of the x86-64 baseline, 32-bit x86 builds only have it when the compiler targets it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define PLATFORM_SSE2
+#endif
+
 // C99's restrict keywords guarantees the pointer in question, for the whole of its lifetime,
 // will be the only way to access a given memory region. In other words: there is no other pointer
 // aliasing the same memory area. Using it lets compiler generate better code. If your compiler
@@ -208,6 +208,7 @@ namespace Config
             model->render_weather_effects = reader->GetBoolean("render_weather_effects", true);
             model->render_weather_gloom = reader->GetBoolean("render_weather_gloom", true);
             model->show_guest_purchases = reader->GetBoolean("show_guest_purchases", false);
+            model->multithreading = reader->GetBoolean("multithreading", false);
             model->show_real_names_of_guests = reader->GetBoolean("show_real_names_of_guests", true);
         }
     }
@@ -277,6 +278,7 @@ namespace Config
         writer->WriteBoolean("render_weather_effects", model->render_weather_effects);
         writer->WriteBoolean("render_weather_gloom", model->render_weather_gloom);
         writer->WriteBoolean("show_guest_purchases", model->show_guest_purchases);
+        writer->WriteBoolean("multithreading", model->multithreading);
         writer->WriteBoolean("show_real_names_of_guests", model->show_real_names_of_guests);
     }
 
@@ -381,6 +383,7 @@ namespace Config
             model->log_chat = reader->GetBoolean("log_chat", false);
             model->log_server_actions = reader->GetBoolean("log_server_actions", false);
             model->pause_server_if_no_clients = reader->GetBoolean("pause_server_if_no_clients", false);
+            model->desync_debugging = reader->GetBoolean("desync_debugging", false);
         }
     }
 
@@ -406,6 +409,7 @@ namespace Config
         writer->WriteBoolean("log_chat", model->log_chat);
         writer->WriteBoolean("log_server_actions", model->log_server_actions);
         writer->WriteBoolean("pause_server_if_no_clients", model->pause_server_if_no_clients);
+        writer->WriteBoolean("desync_debugging", model->desync_debugging);
     }
 
     static void ReadNotifications(IIniReader * reader)
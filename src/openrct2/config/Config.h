@@ -49,6 +49,7 @@ typedef struct GeneralConfiguration
     bool        render_weather_gloom;
     bool        disable_lightning_effect;
     bool        show_guest_purchases;
+    bool        multithreading;
 
     // Localisation
     sint32      language;
@@ -153,6 +154,7 @@ typedef struct NetworkConfiguration
     bool        log_chat;
     bool        log_server_actions;
     bool        pause_server_if_no_clients;
+    bool        desync_debugging;
 } NetworkConfiguration;
 
 typedef struct NotificationConfiguration
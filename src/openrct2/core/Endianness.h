@@ -53,6 +53,16 @@ struct ByteSwapT<4>
     }
 };
 
+template <>
+struct ByteSwapT<8>
+{
+    static uint64 SwapBE(uint64 value)
+    {
+        return ((uint64)ByteSwapT<4>::SwapBE((uint32)value) << 32) |
+                         ByteSwapT<4>::SwapBE((uint32)(value >> 32));
+    }
+};
+
 template <typename T>
 static T ByteSwapBE(const T& value)
 {
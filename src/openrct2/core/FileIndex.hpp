@@ -16,40 +16,53 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <mutex>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 #include "../common.h"
+#include "Console.hpp"
 #include "File.h"
 #include "FileScanner.h"
 #include "FileStream.hpp"
+#include "JobPool.hpp"
+#include "MemoryStream.h"
 #include "Path.hpp"
 
 template<typename TItem>
 class FileIndex
 {
 private:
-    struct DirectoryStats
+    struct IndexedFile
     {
-        uint32 TotalFiles = 0;
-        uint64 TotalFileSize = 0;
-        uint32 FileDateModifiedChecksum = 0;
-        uint32 PathChecksum = 0;
+        std::string Path;
+        uint64 Size = 0;
+        uint64 LastModified = 0;
     };
 
     struct ScanResult
     {
-        DirectoryStats const Stats;
-        std::vector<std::string> const Files;
+        std::vector<IndexedFile> const Files;
 
-        ScanResult(DirectoryStats stats, std::vector<std::string> files)
-            : Stats(stats),
-              Files(files)
+        explicit ScanResult(std::vector<IndexedFile> files)
+            : Files(files)
         {
         }
     };
 
+    // An item read from the index, for the file at the same position in the scan result. Files that
+    // could not be indexed are remembered as failed so they are not loaded again until they change.
+    struct CachedItem
+    {
+        bool    Valid = false;
+        bool    Failed = false;
+        TItem   Item;
+    };
+
     struct FileIndexHeader
     {
         uint32          HeaderSize = sizeof(FileIndexHeader);
@@ -57,12 +70,15 @@ private:
         uint8           VersionA = 0;
         uint8           VersionB = 0;
         uint16          LanguageId = 0;
-        DirectoryStats  Stats;
         uint32          NumItems = 0;
+        uint32          NumFailedFiles = 0;
     };
 
     // Index file format version which when incremented forces a rebuild
-    static constexpr uint8 FILE_INDEX_VERSION = 4;
+    static constexpr uint8 FILE_INDEX_VERSION = 6;
+
+    // Number of files each job creates items for when building the index
+    static constexpr size_t BUILD_BATCH_SIZE = 64;
 
     std::string const _name;
     uint32 const _magicNumber;
@@ -101,37 +117,30 @@ public:
     virtual ~FileIndex() = default;
 
     /**
-     * Queries and directories and loads the index header. If the index is up to date,
-     * the items are loaded from the index and returned, otherwise the index is rebuilt.
+     * Queries and directories and loads the index. Items for files that have the same size and
+     * modification time as when they were indexed are loaded from the index, the remaining files
+     * are loaded to create their items and the index is rewritten. Files that failed to index are
+     * only loaded again once their size or modification time changes.
      */
     std::vector<TItem> LoadOrBuild() const
     {
-        std::vector<TItem> items;
         auto scanResult = Scan();
-        auto readIndexResult = ReadIndexFile(scanResult.Stats);
-        if (std::get<0>(readIndexResult))
-        {
-            // Index was loaded
-            items = std::get<1>(readIndexResult);
-        }
-        else
-        {
-            // Index was not loaded
-            items = Build(scanResult);
-        }
-        return items;
+        auto readIndexResult = ReadIndexFile(scanResult);
+        return Build(scanResult, std::get<1>(readIndexResult), std::get<0>(readIndexResult));
     }
 
     std::vector<TItem> Rebuild() const
     {
         auto scanResult = Scan();
-        auto items = Build(scanResult);
+        std::vector<CachedItem> cachedItems(scanResult.Files.size());
+        auto items = Build(scanResult, cachedItems, false);
         return items;
     }
 
 protected:
     /**
      * Loads the given file and creates the item representing the data to store in the index.
+     * This is called from multiple threads at once when building the index.
      * TODO Use std::optional when C++17 is available.
      */
     virtual std::tuple<bool, TItem> Create(const std::string &path) const abstract;
@@ -149,9 +158,8 @@ protected:
 private:
     ScanResult Scan() const
     {
-        DirectoryStats stats {};
-        std::vector<std::string> files;
-        for (const auto directory : SearchPaths)
+        std::vector<IndexedFile> files;
+        for (const auto &directory : SearchPaths)
         {
             log_verbose("FileIndex:Scanning for %s in '%s'", _pattern.c_str(), directory.c_str());
 
@@ -160,80 +168,187 @@ private:
             while (scanner->Next())
             {
                 auto fileInfo = scanner->GetFileInfo();
-                auto path = std::string(scanner->GetPath());
-
-                files.push_back(path);
 
-                stats.TotalFiles++;
-                stats.TotalFileSize += fileInfo->Size;
-                stats.FileDateModifiedChecksum ^=
-                    (uint32)(fileInfo->LastModified >> 32) ^
-                    (uint32)(fileInfo->LastModified & 0xFFFFFFFF);
-                stats.FileDateModifiedChecksum = ror32(stats.FileDateModifiedChecksum, 5);
-                stats.PathChecksum += GetPathChecksum(path);
+                IndexedFile file;
+                file.Path = std::string(scanner->GetPath());
+                file.Size = fileInfo->Size;
+                file.LastModified = fileInfo->LastModified;
+                files.push_back(file);
             }
             delete scanner;
         }
-        return ScanResult(stats, files);
+        return ScanResult(files);
     }
 
-    std::vector<TItem> Build(const ScanResult &scanResult) const
+    /**
+     * Creates the items for the files that were not found in the index, spreading the files over a
+     * job pool, then writes the index if it changed.
+     */
+    std::vector<TItem> Build(const ScanResult &scanResult, std::vector<CachedItem> &cachedItems, bool indexUpToDate) const
     {
-        std::vector<TItem> items;
-        Console::WriteLine("Building %s (%zu items)", _name.c_str(), scanResult.Files.size());
+        std::vector<size_t> pendingFiles;
+        for (size_t i = 0; i < scanResult.Files.size(); i++)
+        {
+            if (!cachedItems[i].Valid && !cachedItems[i].Failed)
+            {
+                pendingFiles.push_back(i);
+            }
+        }
 
-        auto startTime = std::chrono::high_resolution_clock::now();
-        // Start at 1, so that we can reach 100% completion status
-        size_t i = 1;
-        for (auto filePath : scanResult.Files)
+        if (!pendingFiles.empty())
         {
-            Console::WriteFormat("File %5d of %d, done %3d%%\r", i, scanResult.Files.size(), i * 100 / scanResult.Files.size());
-            i++;
-            log_verbose("FileIndex:Indexing '%s'", filePath.c_str());
-            auto item = Create(filePath);
-            if (std::get<0>(item))
+            Console::WriteLine("Building %s (%zu of %zu items)", _name.c_str(), pendingFiles.size(), scanResult.Files.size());
+            auto startTime = std::chrono::high_resolution_clock::now();
+
+            JobPool jobPool;
+            std::atomic<size_t> numProcessed { 0 };
+            std::mutex consoleMutex;
+            for (size_t batchStart = 0; batchStart < pendingFiles.size(); batchStart += BUILD_BATCH_SIZE)
             {
-                items.push_back(std::get<1>(item));
+                size_t batchEnd = std::min(batchStart + BUILD_BATCH_SIZE, pendingFiles.size());
+                jobPool.AddTask([&, batchStart, batchEnd]() -> void
+                {
+                    for (size_t i = batchStart; i < batchEnd; i++)
+                    {
+                        size_t fileIndex = pendingFiles[i];
+                        CreateItem(scanResult.Files[fileIndex].Path, &cachedItems[fileIndex]);
+
+                        // Start at 1, so that we can reach 100% completion status
+                        size_t processed = ++numProcessed;
+                        std::lock_guard<std::mutex> lock(consoleMutex);
+                        Console::WriteFormat("File %5zu of %zu, done %3zu%%\r", processed, pendingFiles.size(), processed * 100 / pendingFiles.size());
+                    }
+                });
             }
+            jobPool.Join();
+            Console::WriteLine();
+
+            auto endTime = std::chrono::high_resolution_clock::now();
+            auto duration = (std::chrono::duration<float>)(endTime - startTime);
+            Console::WriteLine("Finished building %s in %.2f seconds.", _name.c_str(), duration.count());
         }
-        Console::WriteLine();
 
-        WriteIndexFile(scanResult.Stats, items);
+        // Items are kept in the order the files were scanned in, regardless of which thread created them
+        std::vector<const IndexedFile *> indexedFiles;
+        std::vector<const IndexedFile *> failedFiles;
+        std::vector<TItem> items;
+        for (size_t i = 0; i < scanResult.Files.size(); i++)
+        {
+            if (cachedItems[i].Valid)
+            {
+                indexedFiles.push_back(&scanResult.Files[i]);
+                items.push_back(cachedItems[i].Item);
+            }
+            else
+            {
+                failedFiles.push_back(&scanResult.Files[i]);
+            }
+        }
 
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = (std::chrono::duration<float>)(endTime - startTime);
-        Console::WriteLine("Finished building %s in %.2f seconds.", _name.c_str(), duration.count());
+        if (!pendingFiles.empty() || !indexUpToDate)
+        {
+            WriteIndexFile(indexedFiles, items, failedFiles);
+        }
         return items;
     }
 
-    std::tuple<bool, std::vector<TItem>> ReadIndexFile(const DirectoryStats &stats) const
+    void CreateItem(const std::string &path, CachedItem * outItem) const
     {
-        bool loadedItems = false;
-        std::vector<TItem> items;
+        log_verbose("FileIndex:Indexing '%s'", path.c_str());
+        try
+        {
+            auto item = Create(path);
+            if (std::get<0>(item))
+            {
+                outItem->Valid = true;
+                outItem->Item = std::get<1>(item);
+                return;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            log_error("Unable to index '%s': %s", path.c_str(), e.what());
+        }
+        outItem->Failed = true;
+    }
+
+    /**
+     * Reads the items from the index whose file is still present with the same size and modification
+     * time. Items for other files are skipped without being deserialised. Failed files that are
+     * unchanged are marked as failed again.
+     * @return whether the index matched the scanned files exactly, and the items in the same order
+     *         as the scanned files.
+     */
+    std::tuple<bool, std::vector<CachedItem>> ReadIndexFile(const ScanResult &scanResult) const
+    {
+        bool upToDate = false;
+        std::vector<CachedItem> cachedItems(scanResult.Files.size());
         try
         {
             log_verbose("FileIndex:Loading index: '%s'", _indexPath.c_str());
             auto fs = FileStream(_indexPath, FILE_MODE_OPEN);
 
-            // Read header, check if we need to re-scan
+            // Read header, check if the items can be used at all
             auto header = fs.ReadValue<FileIndexHeader>();
             if (header.HeaderSize == sizeof(FileIndexHeader) &&
                 header.MagicNumber == _magicNumber &&
                 header.VersionA == FILE_INDEX_VERSION &&
                 header.VersionB == _version &&
-                header.LanguageId == gCurrentLanguage &&
-                header.Stats.TotalFiles == stats.TotalFiles &&
-                header.Stats.TotalFileSize == stats.TotalFileSize &&
-                header.Stats.FileDateModifiedChecksum == stats.FileDateModifiedChecksum &&
-                header.Stats.PathChecksum == stats.PathChecksum)
+                header.LanguageId == gCurrentLanguage)
             {
-                // Directory is the same, just read the saved items
+                std::unordered_map<std::string, size_t> fileIndices;
+                for (size_t i = 0; i < scanResult.Files.size(); i++)
+                {
+                    fileIndices[scanResult.Files[i].Path] = i;
+                }
+
+                size_t numOutOfDate = 0;
                 for (uint32 i = 0; i < header.NumItems; i++)
                 {
-                    auto item = Deserialise(&fs);
-                    items.push_back(item);
+                    auto path = fs.ReadStdString();
+                    auto size = fs.ReadValue<uint64>();
+                    auto lastModified = fs.ReadValue<uint64>();
+                    auto itemLength = fs.ReadValue<uint32>();
+
+                    auto it = fileIndices.find(path);
+                    if (it != fileIndices.end() &&
+                        scanResult.Files[it->second].Size == size &&
+                        scanResult.Files[it->second].LastModified == lastModified &&
+                        !cachedItems[it->second].Valid)
+                    {
+                        cachedItems[it->second].Valid = true;
+                        cachedItems[it->second].Item = Deserialise(&fs);
+                    }
+                    else
+                    {
+                        fs.Seek(itemLength, STREAM_SEEK_CURRENT);
+                        numOutOfDate++;
+                    }
+                }
+                for (uint32 i = 0; i < header.NumFailedFiles; i++)
+                {
+                    auto path = fs.ReadStdString();
+                    auto size = fs.ReadValue<uint64>();
+                    auto lastModified = fs.ReadValue<uint64>();
+
+                    auto it = fileIndices.find(path);
+                    if (it != fileIndices.end() &&
+                        scanResult.Files[it->second].Size == size &&
+                        scanResult.Files[it->second].LastModified == lastModified &&
+                        !cachedItems[it->second].Valid)
+                    {
+                        cachedItems[it->second].Failed = true;
+                    }
+                    else
+                    {
+                        numOutOfDate++;
+                    }
+                }
+                upToDate = numOutOfDate == 0;
+                if (numOutOfDate > 0)
+                {
+                    Console::WriteLine("%s has %zu out of date items", _name.c_str(), numOutOfDate);
                 }
-                loadedItems = true;
             }
             else
             {
@@ -244,32 +359,51 @@ private:
         {
             Console::Error::WriteLine("Unable to load index: '%s'.", _indexPath.c_str());
             Console::Error::WriteLine("%s", e.what());
+            upToDate = false;
+            cachedItems = std::vector<CachedItem>(scanResult.Files.size());
         }
-        return std::make_tuple(loadedItems, items);
+        return std::make_tuple(upToDate, std::move(cachedItems));
     }
 
-    void WriteIndexFile(const DirectoryStats &stats, const std::vector<TItem> &items) const
+    void WriteIndexFile(const std::vector<const IndexedFile *> &files, const std::vector<TItem> &items,
+        const std::vector<const IndexedFile *> &failedFiles) const
     {
         try
         {
             log_verbose("FileIndex:Writing index: '%s'", _indexPath.c_str());
             Path::CreateDirectory(Path::GetDirectory(_indexPath));
             auto fs = FileStream(_indexPath, FILE_MODE_WRITE);
-    
+
             // Write header
             FileIndexHeader header;
             header.MagicNumber = _magicNumber;
             header.VersionA = FILE_INDEX_VERSION;
             header.VersionB = _version;
             header.LanguageId = gCurrentLanguage;
-            header.Stats = stats;
             header.NumItems = (uint32)items.size();
+            header.NumFailedFiles = (uint32)failedFiles.size();
             fs.WriteValue(header);
-    
-            // Write items
-            for (const auto item : items)
+
+            // Write items, each preceded by the file it was created from and its length so that
+            // out of date items can be skipped when reading
+            for (size_t i = 0; i < items.size(); i++)
             {
-                Serialise(&fs, item);
+                MemoryStream itemStream;
+                Serialise(&itemStream, items[i]);
+
+                fs.WriteString(files[i]->Path);
+                fs.WriteValue<uint64>(files[i]->Size);
+                fs.WriteValue<uint64>(files[i]->LastModified);
+                fs.WriteValue<uint32>((uint32)itemStream.GetLength());
+                fs.Write(itemStream.GetData(), itemStream.GetLength());
+            }
+
+            // Write the files that could not be indexed, so they are skipped until they change
+            for (const auto file : failedFiles)
+            {
+                fs.WriteString(file->Path);
+                fs.WriteValue<uint64>(file->Size);
+                fs.WriteValue<uint64>(file->LastModified);
             }
         }
         catch (const std::exception &e)
@@ -278,19 +412,4 @@ private:
             Console::Error::WriteLine("%s", e.what());
         }
     }
-
-    static uint32 GetPathChecksum(const std::string &path)
-    {
-        uint32 hash = 0xD8430DED;
-        for (const utf8 * ch = path.c_str(); *ch != '\0'; ch++)
-        {
-            hash += (*ch);
-            hash += (hash << 10);
-            hash ^= (hash >> 6);
-        }
-        hash += (hash << 3);
-        hash ^= (hash >> 11);
-        hash += (hash << 15);
-        return hash;
-    }
 };
@@ -0,0 +1,129 @@
+#pragma region Copyright (c) 2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../common.h"
+
+/**
+ * A fixed set of worker threads that run queued tasks. Tasks are added with AddTask and
+ * Join blocks the calling thread until every queued task has finished.
+ */
+class JobPool
+{
+private:
+    std::vector<std::thread>            _threads;
+    std::deque<std::function<void()>>   _pending;
+    size_t                              _processing = 0;
+    bool                                _shouldStop = false;
+
+    std::mutex                          _mutex;
+    std::condition_variable             _condPending;
+    std::condition_variable             _condComplete;
+
+public:
+    /**
+     * Creates a new JobPool.
+     * @param maxThreads The number of worker threads, 0 to use one per hardware thread.
+     */
+    explicit JobPool(size_t maxThreads = 0)
+    {
+        if (maxThreads == 0)
+        {
+            maxThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        for (size_t n = 0; n < maxThreads; n++)
+        {
+            _threads.emplace_back(&JobPool::ProcessQueue, this);
+        }
+    }
+
+    ~JobPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _shouldStop = true;
+            _condPending.notify_all();
+        }
+        for (auto &th : _threads)
+        {
+            th.join();
+        }
+    }
+
+    JobPool(const JobPool &) = delete;
+    JobPool & operator=(const JobPool &) = delete;
+
+    size_t CountThreads() const
+    {
+        return _threads.size();
+    }
+
+    void AddTask(std::function<void()> workFn)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _pending.push_back(std::move(workFn));
+        _condPending.notify_one();
+    }
+
+    void Join()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condComplete.wait(lock, [this]() -> bool
+        {
+            return _pending.empty() && _processing == 0;
+        });
+    }
+
+private:
+    void ProcessQueue()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;)
+        {
+            _condPending.wait(lock, [this]() -> bool
+            {
+                return _shouldStop || !_pending.empty();
+            });
+            if (_pending.empty())
+            {
+                // Only reachable when stopping
+                break;
+            }
+
+            auto workFn = std::move(_pending.front());
+            _pending.pop_front();
+            _processing++;
+
+            lock.unlock();
+            workFn();
+            lock.lock();
+
+            _processing--;
+            if (_pending.empty() && _processing == 0)
+            {
+                _condComplete.notify_all();
+            }
+        }
+    }
+};
@@ -0,0 +1,111 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include "../common.h"
+
+/**
+ * An unbounded queue for passing items from one producer thread to one consumer thread without locking.
+ * Items are stored in blocks, so memory is only allocated once per BlockSize pushes.
+ */
+template<typename T, size_t BlockSize = 64>
+class SpscQueue
+{
+private:
+    struct Block
+    {
+        T                       Items[BlockSize];
+        // Number of items the producer has published to the consumer
+        std::atomic<size_t>     Count { 0 };
+        std::atomic<Block *>    Next { nullptr };
+    };
+
+    // Only accessed by the consumer
+    Block *     _head;
+    size_t      _headIndex = 0;
+    // Only accessed by the producer
+    Block *     _tail;
+
+public:
+    SpscQueue()
+    {
+        _head = _tail = new Block();
+    }
+
+    ~SpscQueue()
+    {
+        while (_head != nullptr)
+        {
+            Block * next = _head->Next.load(std::memory_order_relaxed);
+            delete _head;
+            _head = next;
+        }
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue & operator=(const SpscQueue &) = delete;
+
+    /**
+     * Adds an item to the back of the queue. Must only be called from the producer thread.
+     */
+    void Push(T item)
+    {
+        size_t count = _tail->Count.load(std::memory_order_relaxed);
+        if (count == BlockSize)
+        {
+            auto block = new Block();
+            block->Items[0] = std::move(item);
+            block->Count.store(1, std::memory_order_relaxed);
+            _tail->Next.store(block, std::memory_order_release);
+            _tail = block;
+        }
+        else
+        {
+            _tail->Items[count] = std::move(item);
+            _tail->Count.store(count + 1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Removes the item at the front of the queue. Must only be called from the consumer thread.
+     * @returns false if the queue is empty.
+     */
+    bool TryPop(T * outItem)
+    {
+        if (_headIndex == BlockSize)
+        {
+            // The producer has finished with a full block once it links the next one
+            Block * next = _head->Next.load(std::memory_order_acquire);
+            if (next == nullptr)
+            {
+                return false;
+            }
+            delete _head;
+            _head = next;
+            _headIndex = 0;
+        }
+        if (_headIndex < _head->Count.load(std::memory_order_acquire))
+        {
+            *outItem = std::move(_head->Items[_headIndex]);
+            _headIndex++;
+            return true;
+        }
+        return false;
+    }
+};
@@ -31,6 +31,28 @@ static constexpr size_t CountOf(T const (&)[N]) noexcept
     return N;
 }
 
+/**
+ * Hints that the given memory will be read soon, so that it can be fetched into the cache in advance.
+ */
+static inline void Prefetch(const void * address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+template <typename T>
+static inline void PrefetchObject(const T * object)
+{
+    const char * address = reinterpret_cast<const char *>(object);
+    for (size_t offset = 0; offset < sizeof(T); offset += 64)
+    {
+        Prefetch(address + offset);
+    }
+}
+
 } // namespace Util
 
 #endif // _UTIL_HPP_
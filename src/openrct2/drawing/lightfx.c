@@ -293,12 +293,11 @@ void lightfx_prepare_light_list()
                     dpi->zoom_level = _viewportDpi1.zoom;
                     dpi->height = 1;
                     dpi->width = 1;
-                    gPaintSession.EndOfPaintStructArray = 0xF1A4CC;
-                    gPaintSession.Unk140E9A8 = dpi;
-                    painter_setup();
-                    viewport_paint_setup();
-                    paint_session_arrange(gPaintSession);
+                    paint_session * session = paint_session_alloc(dpi, 0);
+                    paint_session_generate(session);
+                    paint_session_arrange(session);
                     sub_68862C();
+                    paint_session_free(session);
 
                 //  log_warning("[%i, %i]", dpi->x, dpi->y);
 
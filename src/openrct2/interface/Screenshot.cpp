@@ -14,13 +14,20 @@
  *****************************************************************************/
 #pragma endregion
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
+#include <vector>
 #include "../audio/audio.h"
 #include "../Context.h"
 #include "../core/Console.hpp"
+#include "../core/Json.hpp"
+#include "../core/JobPool.hpp"
+#include "../core/Math.hpp"
 #include "../Imaging.h"
 #include "../OpenRCT2.h"
+#include "../paint/Paint.h"
 #include "Screenshot.h"
 
 #include "../drawing/drawing.h"
@@ -172,6 +179,104 @@ sint32 screenshot_dump_png_32bpp(sint32 width, sint32 height, const void *pixels
     }
 }
 
+/**
+ * Gets the view coordinates of the centre of the map for the given rotation.
+ */
+static void screenshot_get_map_centre_view(sint32 rotation, sint32 * outX, sint32 * outY)
+{
+    sint32 centreX = (gMapSize / 2) * 32 + 16;
+    sint32 centreY = (gMapSize / 2) * 32 + 16;
+
+    sint32 x = 0, y = 0;
+    sint32 z = tile_element_height(centreX, centreY) & 0xFFFF;
+    switch (rotation) {
+    case 0:
+        x = centreY - centreX;
+        y = ((centreX + centreY) / 2) - z;
+        break;
+    case 1:
+        x = -centreY - centreX;
+        y = ((-centreX + centreY) / 2) - z;
+        break;
+    case 2:
+        x = -centreY + centreX;
+        y = ((-centreX - centreY) / 2) - z;
+        break;
+    case 3:
+        x = centreY + centreX;
+        y = ((centreX - centreY) / 2) - z;
+        break;
+    }
+    *outX = x;
+    *outY = y;
+}
+
+// Number of rows rendered at a time when writing large screenshots
+#define SCREENSHOT_BAND_HEIGHT 256
+
+/**
+ * Renders a viewport into a PNG one band of rows at a time, so only two bands are held in memory rather than
+ * the whole image. Each band's paint structs are generated in parallel by viewport_paint, while drawing stays
+ * on this thread as it is not thread-safe. Compressing a band is handed to a writer thread so it overlaps with
+ * painting the next one.
+ */
+static bool screenshot_render_viewport_png(const rct_viewport * viewport, const rct_palette * palette, const utf8 * path)
+{
+    Imaging::PngStreamWriter writer;
+    if (!writer.Begin(path, viewport->width, viewport->height, palette))
+    {
+        return false;
+    }
+
+    sint32 bandHeight = Math::Min<sint32>(SCREENSHOT_BAND_HEIGHT, viewport->height);
+    std::vector<uint8> bands[2];
+    bands[0].resize(viewport->width * bandHeight);
+    bands[1].resize(viewport->width * bandHeight);
+
+    JobPool writerJobs(1);
+    std::atomic<bool> writeFailed { false };
+    for (sint32 top = 0, index = 0; top < viewport->height; top += bandHeight, index++)
+    {
+        sint32 numRows = Math::Min<sint32>(bandHeight, viewport->height - top);
+
+        // The band last used this buffer two iterations ago, its write was joined before the previous band was queued
+        uint8 * bits = bands[index & 1].data();
+        std::fill_n(bits, viewport->width * numRows, 0);
+
+        rct_viewport bandViewport = *viewport;
+        bandViewport.height = numRows;
+        bandViewport.view_height = numRows;
+        bandViewport.view_y = viewport->view_y + (top << viewport->zoom);
+
+        rct_drawpixelinfo dpi;
+        dpi.x = 0;
+        dpi.y = 0;
+        dpi.width = viewport->width;
+        dpi.height = numRows;
+        dpi.pitch = 0;
+        dpi.zoom_level = 0;
+        dpi.bits = bits;
+        viewport_render(&dpi, &bandViewport, 0, 0, bandViewport.width, bandViewport.height);
+
+        writerJobs.Join();
+        if (writeFailed)
+        {
+            break;
+        }
+        sint32 stride = viewport->width;
+        writerJobs.AddTask([&writer, &writeFailed, bits, stride, numRows]() -> void
+        {
+            if (!writer.WriteRows(bits, stride, numRows))
+            {
+                writeFailed = true;
+            }
+        });
+    }
+    writerJobs.Join();
+
+    return !writeFailed && writer.End();
+}
+
 void screenshot_giant()
 {
     sint32 originalRotation = get_current_rotation();
@@ -200,29 +305,8 @@ void screenshot_giant()
     viewport.var_11 = 0;
     viewport.flags = 0;
 
-    sint32 centreX = (mapSize / 2) * 32 + 16;
-    sint32 centreY = (mapSize / 2) * 32 + 16;
-
-    sint32 x = 0, y = 0;
-    sint32 z = tile_element_height(centreX, centreY) & 0xFFFF;
-    switch (rotation) {
-    case 0:
-        x = centreY - centreX;
-        y = ((centreX + centreY) / 2) - z;
-        break;
-    case 1:
-        x = -centreY - centreX;
-        y = ((-centreX + centreY) / 2) - z;
-        break;
-    case 2:
-        x = -centreY + centreX;
-        y = ((-centreX - centreY) / 2) - z;
-        break;
-    case 3:
-        x = centreY + centreX;
-        y = ((centreX - centreY) / 2) - z;
-        break;
-    }
+    sint32 x, y;
+    screenshot_get_map_centre_view(rotation, &x, &y);
 
     viewport.view_x = x - ((viewport.view_width << zoom) / 2);
     viewport.view_y = y - ((viewport.view_height << zoom) / 2);
@@ -232,17 +316,6 @@ void screenshot_giant()
     // Ensure sprites appear regardless of rotation
     reset_all_sprite_quadrant_placements();
 
-    rct_drawpixelinfo dpi;
-    dpi.x = 0;
-    dpi.y = 0;
-    dpi.width = resolutionWidth;
-    dpi.height = resolutionHeight;
-    dpi.pitch = 0;
-    dpi.zoom_level = 0;
-    dpi.bits = (uint8 *)malloc(dpi.width * dpi.height);
-
-    viewport_render(&dpi, &viewport, 0, 0, viewport.width, viewport.height);
-
     // Get a free screenshot path
     char path[MAX_PATH];
     if (screenshot_get_next_path(path, MAX_PATH) == -1) {
@@ -254,9 +327,11 @@ void screenshot_giant()
     rct_palette renderedPalette;
     screenshot_get_rendered_palette(&renderedPalette);
 
-    image_io_png_write(&dpi, &renderedPalette, path);
-
-    free(dpi.bits);
+    if (!screenshot_render_viewport_png(&viewport, &renderedPalette, path)) {
+        log_error("Giant screenshot failed, unable to write %s.", path);
+        context_show_error(STR_SCREENSHOT_FAILED, STR_NONE);
+        return;
+    }
 
     // Show user that screenshot saved successfully
     set_format_arg(0, rct_string_id, STR_STRING);
@@ -264,23 +339,178 @@ void screenshot_giant()
     context_show_error(STR_SCREENSHOT_SAVED_AS, STR_NONE);
 }
 
-sint32 cmdline_for_gfxbench(const char **argv, sint32 argc)
+struct BenchGfxResult
+{
+    sint32          zoom = 0;
+    sint32          rotation = 0;
+    double          frame_time = 0;
+    double          generate_time = 0;
+    double          arrange_time = 0;
+    double          draw_time = 0;
+    uint64          paint_structs = 0;
+    uint32          max_session_paint_structs = 0;
+    uint32          full_sessions = 0;
+};
+
+/**
+ * Renders the whole map the given number of times and returns the averages per frame. Times are in milliseconds.
+ */
+static BenchGfxResult benchgfx_run(rct_drawpixelinfo * dpi, sint32 zoom, sint32 rotation, sint32 iterationCount)
+{
+    sint32 mapSize = gMapSize;
+    rct_viewport viewport;
+    viewport.x = 0;
+    viewport.y = 0;
+    viewport.width = ((mapSize * 32 * 2) >> zoom) + 8;
+    viewport.height = ((mapSize * 32 * 1) >> zoom) + 128;
+    viewport.view_width = viewport.width;
+    viewport.view_height = viewport.height;
+    viewport.var_11 = 0;
+    viewport.flags = 0;
+
+    sint32 x, y;
+    screenshot_get_map_centre_view(rotation, &x, &y);
+    viewport.view_x = x - ((viewport.view_width << zoom) / 2);
+    viewport.view_y = y - ((viewport.view_height << zoom) / 2);
+    viewport.zoom = zoom;
+    gCurrentRotation = rotation;
+
+    dpi->width = viewport.width;
+    dpi->height = viewport.height;
+
+    paint_profile_reset();
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (sint32 i = 0; i < iterationCount; i++)
+    {
+        viewport_render(dpi, &viewport, 0, 0, viewport.width, viewport.height);
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    paint_profile profile;
+    paint_profile_get(&profile);
+
+    BenchGfxResult result;
+    result.zoom = zoom;
+    result.rotation = rotation;
+    result.frame_time = std::chrono::duration<double, std::milli>(endTime - startTime).count() / iterationCount;
+    result.generate_time = profile.generate_time / 1000000.0 / iterationCount;
+    result.arrange_time = profile.arrange_time / 1000000.0 / iterationCount;
+    result.draw_time = profile.draw_time / 1000000.0 / iterationCount;
+    result.paint_structs = profile.paint_struct_count / iterationCount;
+    result.max_session_paint_structs = profile.max_session_paint_structs;
+    result.full_sessions = profile.full_session_count / iterationCount;
+    return result;
+}
+
+static json_t * benchgfx_results_to_json(const utf8 * park, const utf8 * engine, sint32 iterationCount, const std::vector<BenchGfxResult> &results)
+{
+    json_t * jsonResults = json_array();
+    for (const auto &result : results)
+    {
+        json_t * jsonResult = json_object();
+        json_object_set_new(jsonResult, "zoom", json_integer(result.zoom));
+        json_object_set_new(jsonResult, "rotation", json_integer(result.rotation));
+        json_object_set_new(jsonResult, "frame_ms", json_real(result.frame_time));
+        json_object_set_new(jsonResult, "generate_ms", json_real(result.generate_time));
+        json_object_set_new(jsonResult, "arrange_ms", json_real(result.arrange_time));
+        json_object_set_new(jsonResult, "draw_ms", json_real(result.draw_time));
+        json_object_set_new(jsonResult, "paint_structs", json_integer(result.paint_structs));
+        json_object_set_new(jsonResult, "max_session_paint_structs", json_integer(result.max_session_paint_structs));
+        json_object_set_new(jsonResult, "full_sessions", json_integer(result.full_sessions));
+        json_array_append_new(jsonResults, jsonResult);
+    }
+
+    json_t * json = json_object();
+    json_object_set_new(json, "park", json_string(park));
+    json_object_set_new(json, "engine", json_string(engine));
+    json_object_set_new(json, "iterations", json_integer(iterationCount));
+    json_object_set_new(json, "multithreading", json_boolean(paint_is_multithreaded()));
+    json_object_set_new(json, "results", jsonResults);
+    return json;
+}
+
+/**
+ * Compares the results against a previous run written with --json. Returns false if any frame became slower than
+ * the tolerance allows. A different number of paint structs means the park no longer renders the same, so the
+ * times are not comparable and it is reported as a failure as well.
+ */
+static bool benchgfx_compare_baseline(const utf8 * path, const std::vector<BenchGfxResult> &results, sint32 tolerance)
+{
+    json_t * json;
+    try
+    {
+        json = Json::ReadFromFile(path);
+    }
+    catch (const std::exception &e)
+    {
+        Console::Error::WriteLine("Unable to read baseline '%s': %s", path, e.what());
+        return false;
+    }
+
+    bool passed = true;
+    json_t * jsonResults = json_object_get(json, "results");
+    for (const auto &result : results)
+    {
+        json_t * jsonBaseline = nullptr;
+        size_t index;
+        json_t * jsonResult;
+        json_array_foreach(jsonResults, index, jsonResult)
+        {
+            if (json_integer_value(json_object_get(jsonResult, "zoom")) == result.zoom &&
+                json_integer_value(json_object_get(jsonResult, "rotation")) == result.rotation)
+            {
+                jsonBaseline = jsonResult;
+                break;
+            }
+        }
+        if (jsonBaseline == nullptr)
+        {
+            Console::WriteLine("zoom %d, rotation %d: not in baseline", result.zoom, result.rotation);
+            continue;
+        }
+
+        double baselineTime = json_number_value(json_object_get(jsonBaseline, "frame_ms"));
+        uint64 baselinePaintStructs = (uint64)json_integer_value(json_object_get(jsonBaseline, "paint_structs"));
+        double change = baselineTime > 0 ? ((result.frame_time / baselineTime) - 1) * 100 : 0;
+        if (result.paint_structs != baselinePaintStructs)
+        {
+            Console::WriteLine("zoom %d, rotation %d: paint structs changed from %llu to %llu",
+                               result.zoom, result.rotation,
+                               (unsigned long long)baselinePaintStructs, (unsigned long long)result.paint_structs);
+            passed = false;
+        }
+        else if (change > tolerance)
+        {
+            Console::WriteLine("zoom %d, rotation %d: %.2f ms per frame is %.1f%% slower than the baseline %.2f ms",
+                               result.zoom, result.rotation, result.frame_time, change, baselineTime);
+            passed = false;
+        }
+    }
+    json_decref(json);
+    return passed;
+}
+
+sint32 cmdline_for_gfxbench(const char **argv, sint32 argc, BenchGfxOptions * options)
 {
     if (argc != 1 && argc != 2) {
         printf("Usage: openrct2 benchgfx <file> [<iteration_count>]\n");
         return -1;
     }
 
-    sint32 iteration_count = 40;
+    sint32 iteration_count = 10;
     if (argc == 2)
     {
         iteration_count = atoi(argv[1]);
     }
-
-    sint32 resolutionWidth, resolutionHeight, customX = 0, customY = 0;
+    if (iteration_count <= 0)
+    {
+        Console::Error::WriteLine("Iteration count must be greater than 0.");
+        return -1;
+    }
 
     const char *inputPath = argv[0];
 
+    sint32 result = 1;
     gOpenRCT2Headless = true;
     auto context = CreateContext();
     if (context->Initialise())
@@ -291,68 +521,77 @@ sint32 cmdline_for_gfxbench(const char **argv, sint32 argc)
         gIntroState = INTRO_STATE_NONE;
         gScreenFlags = SCREEN_FLAGS_PLAYING;
 
-        sint32 mapSize = gMapSize;
-        resolutionWidth = (mapSize * 32 * 2);
-        resolutionHeight = (mapSize * 32 * 1);
-
-        resolutionWidth += 8;
-        resolutionHeight += 128;
-
-        rct_viewport viewport;
-        viewport.x = 0;
-        viewport.y = 0;
-        viewport.width = resolutionWidth;
-        viewport.height = resolutionHeight;
-        viewport.view_width = viewport.width;
-        viewport.view_height = viewport.height;
-        viewport.var_11 = 0;
-        viewport.flags = 0;
-
-        customX = (mapSize / 2) * 32 + 16;
-        customY = (mapSize / 2) * 32 + 16;
-
-        sint32 x = 0, y = 0;
-        sint32 z = tile_element_height(customX, customY) & 0xFFFF;
-        x = customY - customX;
-        y = ((customX + customY) / 2) - z;
-
-        viewport.view_x = x - ((viewport.view_width) / 2);
-        viewport.view_y = y - ((viewport.view_height) / 2);
-        viewport.zoom = 0;
-        gCurrentRotation = 0;
-
         // Ensure sprites appear regardless of rotation
         reset_all_sprite_quadrant_placements();
 
+        // Sized for zoom level 0, the other levels use the top left of the buffer
+        sint32 mapSize = gMapSize;
         rct_drawpixelinfo dpi;
         dpi.x = 0;
         dpi.y = 0;
-        dpi.width = resolutionWidth;
-        dpi.height = resolutionHeight;
+        dpi.width = (mapSize * 32 * 2) + 8;
+        dpi.height = (mapSize * 32 * 1) + 128;
         dpi.pitch = 0;
+        dpi.zoom_level = 0;
         dpi.bits = (uint8 *)malloc(dpi.width * dpi.height);
 
-        auto startTime = std::chrono::high_resolution_clock::now();
-        for (sint32 i = 0; i < iteration_count; i++)
-        {
-            // Render at various zoom levels
-            dpi.zoom_level = i & 3;
-            viewport_render(&dpi, &viewport, 0, 0, viewport.width, viewport.height);
-        }
-        auto endTime = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> duration = endTime - startTime;
         char engine_name[128];
         rct_string_id engine_id = DrawingEngineStringIds[drawing_engine_get_type()];
         format_string(engine_name, sizeof(engine_name), engine_id, nullptr);
-        Console::WriteLine("Rendering %d times with drawing engine %s took %.2f seconds.",
-                           iteration_count, engine_name,
-                           duration.count());
+        Console::WriteLine("Rendering each zoom level and rotation %d times with drawing engine %s.", iteration_count, engine_name);
+        Console::WriteLine("Times are milliseconds per frame, paint phases are summed over all paint threads.");
+        Console::WriteLine("Zoom  Rotation     Frame  Generate   Arrange      Draw  Paint structs  Max/session  Full sessions");
+
+        std::vector<BenchGfxResult> results;
+        paint_profile_set_enabled(true);
+        for (sint32 zoom = 0; zoom < 4; zoom++)
+        {
+            for (sint32 rotation = 0; rotation < 4; rotation++)
+            {
+                auto benchResult = benchgfx_run(&dpi, zoom, rotation, iteration_count);
+                Console::WriteLine("%4d  %8d  %8.2f  %8.2f  %8.2f  %8.2f  %13llu  %11u  %13u",
+                                   zoom, rotation,
+                                   benchResult.frame_time, benchResult.generate_time,
+                                   benchResult.arrange_time, benchResult.draw_time,
+                                   (unsigned long long)benchResult.paint_structs,
+                                   benchResult.max_session_paint_structs, benchResult.full_sessions);
+                results.push_back(benchResult);
+            }
+        }
+        paint_profile_set_enabled(false);
+
+        if (options->json_path != nullptr)
+        {
+            json_t * json = benchgfx_results_to_json(inputPath, engine_name, iteration_count, results);
+            try
+            {
+                Json::WriteToFile(options->json_path, json, JSON_INDENT(4));
+            }
+            catch (const std::exception &e)
+            {
+                Console::Error::WriteLine("Unable to write results to '%s': %s", options->json_path, e.what());
+                result = -1;
+            }
+            json_decref(json);
+        }
+
+        if (options->baseline_path != nullptr)
+        {
+            if (benchgfx_compare_baseline(options->baseline_path, results, options->tolerance))
+            {
+                Console::WriteLine("All results are within %d%% of the baseline.", options->tolerance);
+            }
+            else
+            {
+                result = -1;
+            }
+        }
 
         free(dpi.bits);
         drawing_engine_dispose();
     }
     delete context;
-    return 1;
+    return result;
 }
 
 sint32 cmdline_for_screenshot(const char * * argv, sint32 argc, ScreenshotOptions * options)
@@ -513,15 +752,6 @@ sint32 cmdline_for_screenshot(const char * * argv, sint32 argc, ScreenshotOption
         // Ensure sprites appear regardless of rotation
         reset_all_sprite_quadrant_placements();
 
-        rct_drawpixelinfo dpi;
-        dpi.x = 0;
-        dpi.y = 0;
-        dpi.width = resolutionWidth;
-        dpi.height = resolutionHeight;
-        dpi.pitch = 0;
-        dpi.zoom_level = 0;
-        dpi.bits = (uint8 *)malloc(dpi.width * dpi.height);
-
         if (options->hide_guests)
         {
             viewport.flags |= VIEWPORT_FLAG_INVISIBLE_PEEPS;
@@ -557,14 +787,14 @@ sint32 cmdline_for_screenshot(const char * * argv, sint32 argc, ScreenshotOption
             game_do_command(0, GAME_COMMAND_FLAG_APPLY, CHEAT_REMOVELITTER, 0, GAME_COMMAND_CHEAT, 0, 0);
         }
 
-        viewport_render(&dpi, &viewport, 0, 0, viewport.width, viewport.height);
-
         rct_palette renderedPalette;
         screenshot_get_rendered_palette(&renderedPalette);
 
-        image_io_png_write(&dpi, &renderedPalette, outputPath);
+        if (!screenshot_render_viewport_png(&viewport, &renderedPalette, outputPath))
+        {
+            Console::Error::WriteLine("Unable to write screenshot to '%s'.", outputPath);
+        }
 
-        free(dpi.bits);
         drawing_engine_dispose();
     }
     delete context;
@@ -39,6 +39,13 @@ extern "C"
         bool tidy_up_park  = false;
     };
 
+    struct BenchGfxOptions
+    {
+        utf8 * json_path     = nullptr;
+        utf8 * baseline_path = nullptr;
+        sint32 tolerance     = 10;
+    };
+
     void screenshot_check();
     sint32 screenshot_dump();
     sint32 screenshot_dump_png(rct_drawpixelinfo *dpi);
@@ -46,7 +53,7 @@ extern "C"
 
     void screenshot_giant();
     sint32 cmdline_for_screenshot(const char * * argv, sint32 argc, ScreenshotOptions * options);
-    sint32 cmdline_for_gfxbench(const char **argv, sint32 argc);
+    sint32 cmdline_for_gfxbench(const char **argv, sint32 argc, BenchGfxOptions * options);
 #ifdef __cplusplus
 }
 #endif
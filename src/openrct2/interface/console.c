@@ -1307,8 +1307,8 @@ static sint32 cc_show_limits(const utf8 ** argv, sint32 argc)
         }
     }
 
-    console_printf("Sprites: %d/%d", spriteCount, MAX_SPRITES);
-    console_printf("Map Elements: %d/%d", tileElementCount, MAX_TILE_ELEMENTS);
+    console_printf("Sprites: %d/%d", spriteCount, gSpriteCapacity);
+    console_printf("Map Elements: %d/%d", tileElementCount, gTileElementCapacity);
     console_printf("Banners: %d/%d", bannerCount, MAX_BANNERS);
     console_printf("Rides: %d/%d", rideCount, MAX_RIDES);
     console_printf("Staff: %d/%d", staffCount, STAFF_MAX_COUNT);
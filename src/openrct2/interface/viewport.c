@@ -38,6 +38,9 @@
 #include "window.h"
 
 //#define DEBUG_SHOW_DIRTY_BOX
+
+// Maximum number of columns generated together when rendering with multiple threads
+#define VIEWPORT_PAINT_COLUMN_BATCH_SIZE 32
 uint8 gShowGridLinesRefCount;
 uint8 gShowLandRightsRefCount;
 uint8 gShowConstuctionRightsRefCount;
@@ -54,7 +57,6 @@ uint8 gSavedViewRotation;
 
 paint_entry *gNextFreePaintStruct;
 uint8 gCurrentRotation;
-uint32 gCurrentViewportFlags = 0;
 
 static uint32 _currentImageType;
 
@@ -65,7 +67,8 @@ static sint16 _interactionMapX;
 static sint16 _interactionMapY;
 static uint16 _unk9AC154;
 
-static void viewport_paint_column(rct_drawpixelinfo * dpi, uint32 viewFlags);
+static void viewport_paint_columns(paint_session ** sessions, size_t count);
+static void viewport_paint_column(paint_session * session);
 static void viewport_paint_weather_gloom(rct_drawpixelinfo * dpi);
 
 /**
@@ -854,7 +857,11 @@ void viewport_paint(rct_viewport* viewport, rct_drawpixelinfo* dpi, sint16 left,
     // this as well as the [x += 32] in the loop causes signed integer overflow -> undefined behaviour.
     sint16 rightBorder = dpi1.x + dpi1.width;
 
-    // Splits the area into 32 pixel columns and renders them
+    // Splits the area into 32 pixel columns and renders them. Each column has its own paint
+    // session so they are generated in batches which may be spread across multiple threads.
+    paint_session * sessions[VIEWPORT_PAINT_COLUMN_BATCH_SIZE];
+    size_t batchSize = paint_is_multithreaded() ? VIEWPORT_PAINT_COLUMN_BATCH_SIZE : 1;
+    size_t sessionCount = 0;
     for (x = floor2(dpi1.x, 32); x < rightBorder; x += 32) {
         rct_drawpixelinfo dpi2 = dpi1;
         if (x >= dpi2.x) {
@@ -873,13 +880,28 @@ void viewport_paint(rct_viewport* viewport, rct_drawpixelinfo* dpi, sint16 left,
         }
         dpi2.width = paintRight - dpi2.x;
 
-        viewport_paint_column(&dpi2, viewFlags);
+        sessions[sessionCount++] = paint_session_alloc(&dpi2, viewFlags);
+        if (sessionCount == batchSize) {
+            viewport_paint_columns(sessions, sessionCount);
+            sessionCount = 0;
+        }
+    }
+    viewport_paint_columns(sessions, sessionCount);
+}
+
+static void viewport_paint_columns(paint_session ** sessions, size_t count)
+{
+    paint_sessions_generate_and_arrange(sessions, count);
+    for (size_t i = 0; i < count; i++) {
+        viewport_paint_column(sessions[i]);
+        paint_session_free(sessions[i]);
     }
 }
 
-static void viewport_paint_column(rct_drawpixelinfo * dpi, uint32 viewFlags)
+static void viewport_paint_column(paint_session * session)
 {
-    gCurrentViewportFlags = viewFlags;
+    rct_drawpixelinfo * dpi = session->Unk140E9A8;
+    uint32 viewFlags = session->ViewFlags;
 
     if (viewFlags & (VIEWPORT_FLAG_HIDE_VERTICAL | VIEWPORT_FLAG_HIDE_BASE | VIEWPORT_FLAG_UNDERGROUND_INSIDE | VIEWPORT_FLAG_PAINT_CLIP_TO_HEIGHT)) {
         uint8 colour = 10;
@@ -889,11 +911,7 @@ static void viewport_paint_column(rct_drawpixelinfo * dpi, uint32 viewFlags)
         gfx_clear(dpi, colour);
     }
 
-    paint_session * session = paint_session_alloc(dpi);
-    paint_session_generate(session);
-    paint_struct ps = paint_session_arrange(session);
-    paint_draw_structs(dpi, &ps, viewFlags);
-    paint_session_free(session);
+    paint_draw_structs(dpi, &session->PaintHead, viewFlags);
 
     if (gConfigGeneral.render_weather_gloom &&
         !gTrackDesignSaveMode &&
@@ -1535,7 +1553,7 @@ void get_map_coordinates_from_pos_window(rct_window * window, sint32 screenX, si
             dpi->x = _viewportDpi1.x;
             dpi->width = 1;
 
-            paint_session * session = paint_session_alloc(dpi);
+            paint_session * session = paint_session_alloc(dpi, myviewport->flags);
             paint_session_generate(session);
             paint_struct ps = paint_session_arrange(session);
             sub_68862C(dpi, &ps);
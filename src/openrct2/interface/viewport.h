@@ -112,7 +112,6 @@ extern uint8 gSavedViewRotation;
 
 extern paint_entry *gNextFreePaintStruct;
 extern uint8 gCurrentRotation;
-extern uint32 gCurrentViewportFlags;
 
 void viewport_init_all();
 void centre_2d_coordinates(sint32 x, sint32 y, sint32 z, sint32 * out_x, sint32 * out_y, rct_viewport * viewport);
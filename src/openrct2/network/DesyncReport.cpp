@@ -0,0 +1,702 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include "../core/String.hpp"
+#include "../peep/Peep.h"
+#include "../platform/platform.h"
+#include "../ride/Vehicle.h"
+#include "../Version.h"
+#include "DesyncReport.h"
+
+struct GameStateField
+{
+    const char *    Name;
+    size_t          Offset;
+    size_t          Size;
+};
+
+#define STATE_FIELD(type, field) { #field, offsetof(type, field), sizeof(((type *)nullptr)->field) }
+
+static const GameStateField RngFields[] =
+{
+    STATE_FIELD(game_state_rng, srand0),
+    STATE_FIELD(game_state_rng, srand1),
+};
+
+static const GameStateField FinanceFields[] =
+{
+    STATE_FIELD(game_state_finances, cash),
+    STATE_FIELD(game_state_finances, bank_loan),
+    STATE_FIELD(game_state_finances, bank_loan_interest_rate),
+    STATE_FIELD(game_state_finances, max_bank_loan),
+    STATE_FIELD(game_state_finances, current_expenditure),
+    STATE_FIELD(game_state_finances, current_profit),
+    STATE_FIELD(game_state_finances, historical_profit),
+    STATE_FIELD(game_state_finances, weekly_profit_average_dividend),
+    STATE_FIELD(game_state_finances, weekly_profit_average_divisor),
+    STATE_FIELD(game_state_finances, park_value),
+    STATE_FIELD(game_state_finances, company_value),
+    STATE_FIELD(game_state_finances, cash_history),
+    STATE_FIELD(game_state_finances, weekly_profit_history),
+    STATE_FIELD(game_state_finances, park_value_history),
+    STATE_FIELD(game_state_finances, expenditure_table),
+};
+
+static const GameStateField TileElementFields[] =
+{
+    STATE_FIELD(rct_tile_element, type),
+    STATE_FIELD(rct_tile_element, flags),
+    STATE_FIELD(rct_tile_element, base_height),
+    STATE_FIELD(rct_tile_element, clearance_height),
+    STATE_FIELD(rct_tile_element, properties),
+};
+
+static const GameStateField PeepFields[] =
+{
+    STATE_FIELD(rct_peep, sprite_identifier),
+    STATE_FIELD(rct_peep, var_01),
+    STATE_FIELD(rct_peep, next_in_quadrant),
+    STATE_FIELD(rct_peep, next),
+    STATE_FIELD(rct_peep, previous),
+    STATE_FIELD(rct_peep, linked_list_type_offset),
+    STATE_FIELD(rct_peep, sprite_height_negative),
+    STATE_FIELD(rct_peep, sprite_index),
+    STATE_FIELD(rct_peep, flags),
+    STATE_FIELD(rct_peep, x),
+    STATE_FIELD(rct_peep, y),
+    STATE_FIELD(rct_peep, z),
+    STATE_FIELD(rct_peep, sprite_width),
+    STATE_FIELD(rct_peep, sprite_height_positive),
+    STATE_FIELD(rct_peep, sprite_left),
+    STATE_FIELD(rct_peep, sprite_top),
+    STATE_FIELD(rct_peep, sprite_right),
+    STATE_FIELD(rct_peep, sprite_bottom),
+    STATE_FIELD(rct_peep, sprite_direction),
+    STATE_FIELD(rct_peep, pad_1F),
+    STATE_FIELD(rct_peep, name_string_idx),
+    STATE_FIELD(rct_peep, next_x),
+    STATE_FIELD(rct_peep, next_y),
+    STATE_FIELD(rct_peep, next_z),
+    STATE_FIELD(rct_peep, next_var_29),
+    STATE_FIELD(rct_peep, outside_of_park),
+    STATE_FIELD(rct_peep, state),
+    STATE_FIELD(rct_peep, sub_state),
+    STATE_FIELD(rct_peep, sprite_type),
+    STATE_FIELD(rct_peep, type),
+    STATE_FIELD(rct_peep, staff_type),
+    STATE_FIELD(rct_peep, tshirt_colour),
+    STATE_FIELD(rct_peep, trousers_colour),
+    STATE_FIELD(rct_peep, destination_x),
+    STATE_FIELD(rct_peep, destination_y),
+    STATE_FIELD(rct_peep, destination_tolerance),
+    STATE_FIELD(rct_peep, var_37),
+    STATE_FIELD(rct_peep, energy),
+    STATE_FIELD(rct_peep, energy_target),
+    STATE_FIELD(rct_peep, happiness),
+    STATE_FIELD(rct_peep, happiness_target),
+    STATE_FIELD(rct_peep, nausea),
+    STATE_FIELD(rct_peep, nausea_target),
+    STATE_FIELD(rct_peep, hunger),
+    STATE_FIELD(rct_peep, thirst),
+    STATE_FIELD(rct_peep, bathroom),
+    STATE_FIELD(rct_peep, var_41),
+    STATE_FIELD(rct_peep, var_42),
+    STATE_FIELD(rct_peep, intensity),
+    STATE_FIELD(rct_peep, nausea_tolerance),
+    STATE_FIELD(rct_peep, window_invalidate_flags),
+    STATE_FIELD(rct_peep, paid_on_drink),
+    STATE_FIELD(rct_peep, ride_types_been_on),
+    STATE_FIELD(rct_peep, item_extra_flags),
+    STATE_FIELD(rct_peep, photo2_ride_ref),
+    STATE_FIELD(rct_peep, photo3_ride_ref),
+    STATE_FIELD(rct_peep, photo4_ride_ref),
+    STATE_FIELD(rct_peep, pad_5F),
+    STATE_FIELD(rct_peep, current_ride),
+    STATE_FIELD(rct_peep, current_ride_station),
+    STATE_FIELD(rct_peep, current_train),
+    STATE_FIELD(rct_peep, current_car),
+    STATE_FIELD(rct_peep, current_seat),
+    STATE_FIELD(rct_peep, special_sprite),
+    STATE_FIELD(rct_peep, action_sprite_type),
+    STATE_FIELD(rct_peep, next_action_sprite_type),
+    STATE_FIELD(rct_peep, action_sprite_image_offset),
+    STATE_FIELD(rct_peep, action),
+    STATE_FIELD(rct_peep, action_frame),
+    STATE_FIELD(rct_peep, var_73),
+    STATE_FIELD(rct_peep, var_74),
+    STATE_FIELD(rct_peep, var_76),
+    STATE_FIELD(rct_peep, pad_77),
+    STATE_FIELD(rct_peep, maze_last_edge),
+    STATE_FIELD(rct_peep, interaction_ride_index),
+    STATE_FIELD(rct_peep, time_in_queue),
+    STATE_FIELD(rct_peep, rides_been_on),
+    STATE_FIELD(rct_peep, id),
+    STATE_FIELD(rct_peep, cash_in_pocket),
+    STATE_FIELD(rct_peep, cash_spent),
+    STATE_FIELD(rct_peep, time_in_park),
+    STATE_FIELD(rct_peep, var_AC),
+    STATE_FIELD(rct_peep, previous_ride),
+    STATE_FIELD(rct_peep, previous_ride_time_out),
+    STATE_FIELD(rct_peep, thoughts),
+    STATE_FIELD(rct_peep, var_C4),
+    STATE_FIELD(rct_peep, staff_id),
+    STATE_FIELD(rct_peep, staff_orders),
+    STATE_FIELD(rct_peep, photo1_ride_ref),
+    STATE_FIELD(rct_peep, peep_flags),
+    STATE_FIELD(rct_peep, pathfind_goal),
+    STATE_FIELD(rct_peep, pathfind_history),
+    STATE_FIELD(rct_peep, no_action_frame_no),
+    STATE_FIELD(rct_peep, litter_count),
+    STATE_FIELD(rct_peep, time_on_ride),
+    STATE_FIELD(rct_peep, disgusting_count),
+    STATE_FIELD(rct_peep, paid_to_enter),
+    STATE_FIELD(rct_peep, paid_on_rides),
+    STATE_FIELD(rct_peep, paid_on_food),
+    STATE_FIELD(rct_peep, paid_on_souvenirs),
+    STATE_FIELD(rct_peep, no_of_food),
+    STATE_FIELD(rct_peep, no_of_drinks),
+    STATE_FIELD(rct_peep, no_of_souvenirs),
+    STATE_FIELD(rct_peep, var_EF),
+    STATE_FIELD(rct_peep, voucher_type),
+    STATE_FIELD(rct_peep, voucher_arguments),
+    STATE_FIELD(rct_peep, var_F2),
+    STATE_FIELD(rct_peep, angriness),
+    STATE_FIELD(rct_peep, var_F4),
+    STATE_FIELD(rct_peep, days_in_queue),
+    STATE_FIELD(rct_peep, balloon_colour),
+    STATE_FIELD(rct_peep, umbrella_colour),
+    STATE_FIELD(rct_peep, hat_colour),
+    STATE_FIELD(rct_peep, favourite_ride),
+    STATE_FIELD(rct_peep, favourite_ride_rating),
+    STATE_FIELD(rct_peep, pad_FB),
+    STATE_FIELD(rct_peep, item_standard_flags),
+};
+
+static const GameStateField VehicleFields[] =
+{
+    STATE_FIELD(rct_vehicle, sprite_identifier),
+    STATE_FIELD(rct_vehicle, is_child),
+    STATE_FIELD(rct_vehicle, next_in_quadrant),
+    STATE_FIELD(rct_vehicle, next),
+    STATE_FIELD(rct_vehicle, previous),
+    STATE_FIELD(rct_vehicle, linked_list_type_offset),
+    STATE_FIELD(rct_vehicle, sprite_height_negative),
+    STATE_FIELD(rct_vehicle, sprite_index),
+    STATE_FIELD(rct_vehicle, flags),
+    STATE_FIELD(rct_vehicle, x),
+    STATE_FIELD(rct_vehicle, y),
+    STATE_FIELD(rct_vehicle, z),
+    STATE_FIELD(rct_vehicle, sprite_width),
+    STATE_FIELD(rct_vehicle, sprite_height_positive),
+    STATE_FIELD(rct_vehicle, sprite_left),
+    STATE_FIELD(rct_vehicle, sprite_top),
+    STATE_FIELD(rct_vehicle, sprite_right),
+    STATE_FIELD(rct_vehicle, sprite_bottom),
+    STATE_FIELD(rct_vehicle, sprite_direction),
+    STATE_FIELD(rct_vehicle, vehicle_sprite_type),
+    STATE_FIELD(rct_vehicle, bank_rotation),
+    STATE_FIELD(rct_vehicle, pad_21),
+    STATE_FIELD(rct_vehicle, remaining_distance),
+    STATE_FIELD(rct_vehicle, velocity),
+    STATE_FIELD(rct_vehicle, acceleration),
+    STATE_FIELD(rct_vehicle, ride),
+    STATE_FIELD(rct_vehicle, vehicle_type),
+    STATE_FIELD(rct_vehicle, colours),
+    STATE_FIELD(rct_vehicle, track_progress),
+    STATE_FIELD(rct_vehicle, track_direction),
+    STATE_FIELD(rct_vehicle, track_x),
+    STATE_FIELD(rct_vehicle, track_y),
+    STATE_FIELD(rct_vehicle, track_z),
+    STATE_FIELD(rct_vehicle, next_vehicle_on_train),
+    STATE_FIELD(rct_vehicle, prev_vehicle_on_ride),
+    STATE_FIELD(rct_vehicle, next_vehicle_on_ride),
+    STATE_FIELD(rct_vehicle, var_44),
+    STATE_FIELD(rct_vehicle, mass),
+    STATE_FIELD(rct_vehicle, update_flags),
+    STATE_FIELD(rct_vehicle, var_4A),
+    STATE_FIELD(rct_vehicle, current_station),
+    STATE_FIELD(rct_vehicle, swinging_car_var_0),
+    STATE_FIELD(rct_vehicle, var_4E),
+    STATE_FIELD(rct_vehicle, status),
+    STATE_FIELD(rct_vehicle, sub_state),
+    STATE_FIELD(rct_vehicle, peep),
+    STATE_FIELD(rct_vehicle, peep_tshirt_colours),
+    STATE_FIELD(rct_vehicle, num_seats),
+    STATE_FIELD(rct_vehicle, num_peeps),
+    STATE_FIELD(rct_vehicle, next_free_seat),
+    STATE_FIELD(rct_vehicle, restraints_position),
+    STATE_FIELD(rct_vehicle, var_B6),
+    STATE_FIELD(rct_vehicle, var_B8),
+    STATE_FIELD(rct_vehicle, var_BA),
+    STATE_FIELD(rct_vehicle, sound1_id),
+    STATE_FIELD(rct_vehicle, sound1_volume),
+    STATE_FIELD(rct_vehicle, sound2_id),
+    STATE_FIELD(rct_vehicle, sound2_volume),
+    STATE_FIELD(rct_vehicle, var_BF),
+    STATE_FIELD(rct_vehicle, var_C0),
+    STATE_FIELD(rct_vehicle, speed),
+    STATE_FIELD(rct_vehicle, powered_acceleration),
+    STATE_FIELD(rct_vehicle, var_C4),
+    STATE_FIELD(rct_vehicle, var_C5),
+    STATE_FIELD(rct_vehicle, pad_C6),
+    STATE_FIELD(rct_vehicle, var_C8),
+    STATE_FIELD(rct_vehicle, var_CA),
+    STATE_FIELD(rct_vehicle, scream_sound_id),
+    STATE_FIELD(rct_vehicle, var_CD),
+    STATE_FIELD(rct_vehicle, var_CE),
+    STATE_FIELD(rct_vehicle, var_CF),
+    STATE_FIELD(rct_vehicle, lost_time_out),
+    STATE_FIELD(rct_vehicle, vertical_drop_countdown),
+    STATE_FIELD(rct_vehicle, var_D3),
+    STATE_FIELD(rct_vehicle, mini_golf_current_animation),
+    STATE_FIELD(rct_vehicle, mini_golf_flags),
+    STATE_FIELD(rct_vehicle, ride_subtype),
+    STATE_FIELD(rct_vehicle, colours_extended),
+    STATE_FIELD(rct_vehicle, seat_rotation),
+    STATE_FIELD(rct_vehicle, target_seat_rotation),
+};
+
+static const GameStateField RideFields[] =
+{
+    STATE_FIELD(Ride, type),
+    STATE_FIELD(Ride, subtype),
+    STATE_FIELD(Ride, pad_002),
+    STATE_FIELD(Ride, mode),
+    STATE_FIELD(Ride, colour_scheme_type),
+    STATE_FIELD(Ride, vehicle_colours),
+    STATE_FIELD(Ride, pad_046),
+    STATE_FIELD(Ride, status),
+    STATE_FIELD(Ride, name),
+    STATE_FIELD(Ride, name_arguments),
+    STATE_FIELD(Ride, overall_view),
+    STATE_FIELD(Ride, station_starts),
+    STATE_FIELD(Ride, station_heights),
+    STATE_FIELD(Ride, station_length),
+    STATE_FIELD(Ride, station_depart),
+    STATE_FIELD(Ride, train_at_station),
+    STATE_FIELD(Ride, entrances),
+    STATE_FIELD(Ride, exits),
+    STATE_FIELD(Ride, last_peep_in_queue),
+    STATE_FIELD(Ride, pad_082),
+    STATE_FIELD(Ride, vehicles),
+    STATE_FIELD(Ride, depart_flags),
+    STATE_FIELD(Ride, num_stations),
+    STATE_FIELD(Ride, num_vehicles),
+    STATE_FIELD(Ride, num_cars_per_train),
+    STATE_FIELD(Ride, proposed_num_vehicles),
+    STATE_FIELD(Ride, proposed_num_cars_per_train),
+    STATE_FIELD(Ride, max_trains),
+    STATE_FIELD(Ride, min_max_cars_per_train),
+    STATE_FIELD(Ride, min_waiting_time),
+    STATE_FIELD(Ride, max_waiting_time),
+    STATE_FIELD(Ride, operation_option),
+    STATE_FIELD(Ride, boat_hire_return_direction),
+    STATE_FIELD(Ride, boat_hire_return_position),
+    STATE_FIELD(Ride, measurement_index),
+    STATE_FIELD(Ride, special_track_elements),
+    STATE_FIELD(Ride, pad_0D6),
+    STATE_FIELD(Ride, max_speed),
+    STATE_FIELD(Ride, average_speed),
+    STATE_FIELD(Ride, current_test_segment),
+    STATE_FIELD(Ride, average_speed_test_timeout),
+    STATE_FIELD(Ride, pad_0E2),
+    STATE_FIELD(Ride, length),
+    STATE_FIELD(Ride, time),
+    STATE_FIELD(Ride, max_positive_vertical_g),
+    STATE_FIELD(Ride, max_negative_vertical_g),
+    STATE_FIELD(Ride, max_lateral_g),
+    STATE_FIELD(Ride, previous_vertical_g),
+    STATE_FIELD(Ride, previous_lateral_g),
+    STATE_FIELD(Ride, pad_106),
+    STATE_FIELD(Ride, testing_flags),
+    STATE_FIELD(Ride, cur_test_track_location),
+    STATE_FIELD(Ride, turn_count_default),
+    STATE_FIELD(Ride, turn_count_banked),
+    STATE_FIELD(Ride, turn_count_sloped),
+    STATE_FIELD(Ride, inversions),
+    STATE_FIELD(Ride, drops),
+    STATE_FIELD(Ride, start_drop_height),
+    STATE_FIELD(Ride, highest_drop_height),
+    STATE_FIELD(Ride, sheltered_length),
+    STATE_FIELD(Ride, var_11C),
+    STATE_FIELD(Ride, num_sheltered_sections),
+    STATE_FIELD(Ride, cur_test_track_z),
+    STATE_FIELD(Ride, cur_num_customers),
+    STATE_FIELD(Ride, num_customers_timeout),
+    STATE_FIELD(Ride, num_customers),
+    STATE_FIELD(Ride, price),
+    STATE_FIELD(Ride, chairlift_bullwheel_location),
+    STATE_FIELD(Ride, chairlift_bullwheel_z),
+    STATE_FIELD(Ride, ratings),
+    STATE_FIELD(Ride, value),
+    STATE_FIELD(Ride, chairlift_bullwheel_rotation),
+    STATE_FIELD(Ride, satisfaction),
+    STATE_FIELD(Ride, satisfaction_time_out),
+    STATE_FIELD(Ride, satisfaction_next),
+    STATE_FIELD(Ride, window_invalidate_flags),
+    STATE_FIELD(Ride, pad_14E),
+    STATE_FIELD(Ride, total_customers),
+    STATE_FIELD(Ride, total_profit),
+    STATE_FIELD(Ride, popularity),
+    STATE_FIELD(Ride, popularity_time_out),
+    STATE_FIELD(Ride, popularity_next),
+    STATE_FIELD(Ride, num_riders),
+    STATE_FIELD(Ride, music_tune_id),
+    STATE_FIELD(Ride, slide_in_use),
+    STATE_FIELD(Ride, slide_peep),
+    STATE_FIELD(Ride, pad_160),
+    STATE_FIELD(Ride, slide_peep_t_shirt_colour),
+    STATE_FIELD(Ride, pad_16F),
+    STATE_FIELD(Ride, spiral_slide_progress),
+    STATE_FIELD(Ride, pad_177),
+    STATE_FIELD(Ride, build_date),
+    STATE_FIELD(Ride, upkeep_cost),
+    STATE_FIELD(Ride, race_winner),
+    STATE_FIELD(Ride, pad_186),
+    STATE_FIELD(Ride, music_position),
+    STATE_FIELD(Ride, breakdown_reason_pending),
+    STATE_FIELD(Ride, mechanic_status),
+    STATE_FIELD(Ride, mechanic),
+    STATE_FIELD(Ride, inspection_station),
+    STATE_FIELD(Ride, broken_vehicle),
+    STATE_FIELD(Ride, broken_car),
+    STATE_FIELD(Ride, breakdown_reason),
+    STATE_FIELD(Ride, price_secondary),
+    STATE_FIELD(Ride, reliability_subvalue),
+    STATE_FIELD(Ride, reliability_percentage),
+    STATE_FIELD(Ride, unreliability_factor),
+    STATE_FIELD(Ride, downtime),
+    STATE_FIELD(Ride, inspection_interval),
+    STATE_FIELD(Ride, last_inspection),
+    STATE_FIELD(Ride, downtime_history),
+    STATE_FIELD(Ride, no_primary_items_sold),
+    STATE_FIELD(Ride, no_secondary_items_sold),
+    STATE_FIELD(Ride, breakdown_sound_modifier),
+    STATE_FIELD(Ride, not_fixed_timeout),
+    STATE_FIELD(Ride, last_crash_type),
+    STATE_FIELD(Ride, connected_message_throttle),
+    STATE_FIELD(Ride, income_per_hour),
+    STATE_FIELD(Ride, profit),
+    STATE_FIELD(Ride, queue_time),
+    STATE_FIELD(Ride, track_colour_main),
+    STATE_FIELD(Ride, track_colour_additional),
+    STATE_FIELD(Ride, track_colour_supports),
+    STATE_FIELD(Ride, music),
+    STATE_FIELD(Ride, entrance_style),
+    STATE_FIELD(Ride, vehicle_change_timeout),
+    STATE_FIELD(Ride, num_block_brakes),
+    STATE_FIELD(Ride, lift_hill_speed),
+    STATE_FIELD(Ride, guests_favourite),
+    STATE_FIELD(Ride, lifecycle_flags),
+    STATE_FIELD(Ride, vehicle_colours_extended),
+    STATE_FIELD(Ride, total_air_time),
+    STATE_FIELD(Ride, current_test_station),
+    STATE_FIELD(Ride, num_circuits),
+    STATE_FIELD(Ride, cable_lift_x),
+    STATE_FIELD(Ride, cable_lift_y),
+    STATE_FIELD(Ride, cable_lift_z),
+    STATE_FIELD(Ride, pad_1FD),
+    STATE_FIELD(Ride, cable_lift),
+    STATE_FIELD(Ride, queue_length),
+    STATE_FIELD(Ride, pad_208),
+};
+
+static const GameStateField SpriteFields[] =
+{
+    STATE_FIELD(rct_unk_sprite, sprite_identifier),
+    STATE_FIELD(rct_unk_sprite, misc_identifier),
+    STATE_FIELD(rct_unk_sprite, next_in_quadrant),
+    STATE_FIELD(rct_unk_sprite, next),
+    STATE_FIELD(rct_unk_sprite, previous),
+    STATE_FIELD(rct_unk_sprite, linked_list_type_offset),
+    STATE_FIELD(rct_unk_sprite, sprite_height_negative),
+    STATE_FIELD(rct_unk_sprite, sprite_index),
+    STATE_FIELD(rct_unk_sprite, flags),
+    STATE_FIELD(rct_unk_sprite, x),
+    STATE_FIELD(rct_unk_sprite, y),
+    STATE_FIELD(rct_unk_sprite, z),
+    STATE_FIELD(rct_unk_sprite, sprite_width),
+    STATE_FIELD(rct_unk_sprite, sprite_height_positive),
+    STATE_FIELD(rct_unk_sprite, sprite_left),
+    STATE_FIELD(rct_unk_sprite, sprite_top),
+    STATE_FIELD(rct_unk_sprite, sprite_right),
+    STATE_FIELD(rct_unk_sprite, sprite_bottom),
+    STATE_FIELD(rct_unk_sprite, sprite_direction),
+    STATE_FIELD(rct_unk_sprite, pad_1F),
+    STATE_FIELD(rct_unk_sprite, name_string_idx),
+    STATE_FIELD(rct_unk_sprite, pad_24),
+    STATE_FIELD(rct_unk_sprite, frame),
+};
+
+
+struct DescribedField
+{
+    std::string Name;
+    size_t      Offset;
+    size_t      Size;
+};
+
+template<size_t TCount>
+static void AddFields(std::vector<DescribedField> &result, const GameStateField (&fields)[TCount], size_t baseOffset = 0, const std::string &prefix = std::string())
+{
+    for (const auto &field : fields)
+    {
+        result.push_back({ prefix + field.Name, baseOffset + field.Offset, field.Size });
+    }
+}
+
+static std::vector<DescribedField> DescribeEntity(sint32 subsystem, size_t dataSize, uint8 spriteIdentifier)
+{
+    std::vector<DescribedField> result;
+    switch (subsystem) {
+    case GAME_STATE_SUBSYSTEM_RNG:
+        AddFields(result, RngFields);
+        break;
+    case GAME_STATE_SUBSYSTEM_FINANCES:
+        AddFields(result, FinanceFields);
+        break;
+    case GAME_STATE_SUBSYSTEM_RIDES:
+        AddFields(result, RideFields);
+        break;
+    case GAME_STATE_SUBSYSTEM_SPRITES_TRAIN:
+    case GAME_STATE_SUBSYSTEM_SPRITES_PEEP:
+    case GAME_STATE_SUBSYSTEM_SPRITES_LITTER:
+        switch (spriteIdentifier) {
+        case SPRITE_IDENTIFIER_VEHICLE:
+            AddFields(result, VehicleFields);
+            break;
+        case SPRITE_IDENTIFIER_PEEP:
+            AddFields(result, PeepFields);
+            break;
+        default:
+            AddFields(result, SpriteFields);
+            break;
+        }
+        break;
+    default:
+        for (size_t i = 0; i < dataSize / sizeof(rct_tile_element); i++)
+        {
+            AddFields(result, TileElementFields, i * sizeof(rct_tile_element), String::StdFormat("element[%u].", (uint32)i));
+        }
+        break;
+    }
+
+    // Cover any bytes the tables above do not describe, e.g. the type specific part of litter sprites
+    size_t end = result.empty() ? 0 : result.back().Offset + result.back().Size;
+    if (end < dataSize)
+    {
+        result.push_back({ "(remaining bytes)", end, dataSize - end });
+    }
+    return result;
+}
+
+static bool FieldDiffers(const DescribedField &field, const std::vector<uint8> &a, const std::vector<uint8> &b)
+{
+    bool inA = field.Offset + field.Size <= a.size();
+    bool inB = field.Offset + field.Size <= b.size();
+    if (inA != inB)
+    {
+        return true;
+    }
+    return inA && std::memcmp(a.data() + field.Offset, b.data() + field.Offset, field.Size) != 0;
+}
+
+static std::string FormatFieldValue(const DescribedField &field, const std::vector<uint8> &data)
+{
+    if (field.Offset + field.Size > data.size())
+    {
+        return "-";
+    }
+
+    const uint8 * src = data.data() + field.Offset;
+    if (field.Size == 1 || field.Size == 2 || field.Size == 4)
+    {
+        uint32 value = 0;
+        for (size_t i = 0; i < field.Size; i++)
+        {
+            value |= (uint32)src[i] << (i * 8);
+        }
+        return String::StdFormat("%u", value);
+    }
+
+    // Show larger fields as hex, limited so that each field stays on one line
+    constexpr size_t MaxBytes = 16;
+    std::string result;
+    for (size_t i = 0; i < field.Size && i < MaxBytes; i++)
+    {
+        result += String::StdFormat("%02X", src[i]);
+    }
+    if (field.Size > MaxBytes)
+    {
+        result += "...";
+    }
+    return result;
+}
+
+static std::string FormatChecksum(uint64 checksum)
+{
+    return String::StdFormat("%08X%08X", (uint32)(checksum >> 32), (uint32)checksum);
+}
+
+DesyncReport::DesyncReport(uint32 tick, const std::vector<uint64> &clientChecksums, const std::vector<uint64> &serverChecksums)
+    : _tick(tick),
+      _clientChecksums(clientChecksums),
+      _serverChecksums(serverChecksums)
+{
+    size_t count = std::min(_clientChecksums.size(), _serverChecksums.size());
+    for (size_t i = 0; i < count; i++)
+    {
+        if (_clientChecksums[i] != _serverChecksums[i])
+        {
+            _subsystem = (sint32)i;
+            break;
+        }
+    }
+
+    if (_subsystem != -1)
+    {
+        GameStateSnapshot snapshot;
+        snapshot.Capture(tick);
+        _clientEntities = snapshot.GetEntities(_subsystem);
+    }
+}
+
+void DesyncReport::AddServerEntity(uint32 id, bool present, std::vector<uint8> data)
+{
+    ServerEntity serverEntity;
+    serverEntity.Present = present;
+    serverEntity.Entity.Id = id;
+    serverEntity.Entity.Data = std::move(data);
+    _serverEntities[id] = std::move(serverEntity);
+}
+
+void DesyncReport::SetServerStateUnavailable()
+{
+    _serverStateAvailable = false;
+}
+
+std::string DesyncReport::ToString() const
+{
+    std::string report;
+    auto appendLine = [&report](const std::string &line)
+    {
+        report += line;
+        report += PLATFORM_NEWLINE;
+    };
+
+    appendLine(String::StdFormat("OpenRCT2 desync report, %s", gVersionInfoFull));
+    appendLine(String::StdFormat("Tick: %u", _tick));
+    appendLine("");
+
+    utf8 subsystemName[64];
+    appendLine("Diverging subsystems (client / server checksum):");
+    for (size_t i = 0; i < _clientChecksums.size() && i < _serverChecksums.size(); i++)
+    {
+        if (_clientChecksums[i] != _serverChecksums[i])
+        {
+            game_state_get_subsystem_name((sint32)i, subsystemName, sizeof(subsystemName));
+            appendLine(String::StdFormat("    %-40s %s / %s", subsystemName,
+                                         FormatChecksum(_clientChecksums[i]).c_str(),
+                                         FormatChecksum(_serverChecksums[i]).c_str()));
+        }
+    }
+    appendLine("");
+
+    if (_subsystem == -1)
+    {
+        appendLine("All subsystem checksums match, the desync was only detected by the scenario RNG seed.");
+        return report;
+    }
+
+    game_state_get_subsystem_name(_subsystem, subsystemName, sizeof(subsystemName));
+    appendLine(String::StdFormat("First diverging subsystem: %s", subsystemName));
+
+    if (!_serverStateAvailable)
+    {
+        appendLine("The server no longer has a snapshot of this tick, no entity level comparison is available.");
+        return report;
+    }
+    if (_serverEntities.empty())
+    {
+        appendLine("The server did not report any diverging entity.");
+        return report;
+    }
+
+    // The server only returns entities whose hash differs, so the lowest ID is the first diverging one
+    const ServerEntity &serverEntity = _serverEntities.begin()->second;
+    uint32 entityId = serverEntity.Entity.Id;
+    const GameStateEntity * clientEntity = nullptr;
+    for (const auto &entity : _clientEntities)
+    {
+        if (entity.Id == entityId)
+        {
+            clientEntity = &entity;
+            break;
+        }
+    }
+
+    const GameStateEntity &namedEntity = clientEntity != nullptr ? *clientEntity : serverEntity.Entity;
+    appendLine(String::StdFormat("First diverging entity: %s", GameStateSnapshot::GetEntityName(_subsystem, namedEntity).c_str()));
+    if (clientEntity == nullptr)
+    {
+        appendLine("The entity only exists on the server.");
+    }
+    if (!serverEntity.Present)
+    {
+        appendLine("The entity only exists on the client.");
+    }
+
+    static const std::vector<uint8> Empty;
+    const std::vector<uint8> &clientData = clientEntity != nullptr ? clientEntity->Data : Empty;
+    const std::vector<uint8> &serverData = serverEntity.Present ? serverEntity.Entity.Data : Empty;
+    const std::vector<uint8> &largerData = clientData.size() >= serverData.size() ? clientData : serverData;
+    auto fields = DescribeEntity(_subsystem, largerData.size(), largerData.empty() ? SPRITE_IDENTIFIER_NULL : largerData[0]);
+
+    for (const auto &field : fields)
+    {
+        if (FieldDiffers(field, clientData, serverData))
+        {
+            appendLine(String::StdFormat("First diverging field: %s (offset 0x%X)", field.Name.c_str(), (uint32)field.Offset));
+            break;
+        }
+    }
+    appendLine("");
+
+    appendLine(String::StdFormat("%-40s %-36s %-36s", "Field", "Client", "Server"));
+    for (const auto &field : fields)
+    {
+        appendLine(String::StdFormat("%-40s %-36s %-36s%s",
+                                     field.Name.c_str(),
+                                     FormatFieldValue(field, clientData).c_str(),
+                                     FormatFieldValue(field, serverData).c_str(),
+                                     FieldDiffers(field, clientData, serverData) ? " *" : ""));
+    }
+
+    if (_serverEntities.size() > 1)
+    {
+        appendLine("");
+        appendLine("Other diverging entities reported by the server:");
+        for (auto it = std::next(_serverEntities.begin()); it != _serverEntities.end(); it++)
+        {
+            appendLine("    " + GameStateSnapshot::GetEntityName(_subsystem, it->second.Entity));
+        }
+    }
+    return report;
+}
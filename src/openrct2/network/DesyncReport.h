@@ -0,0 +1,61 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "../common.h"
+#include "GameStateSnapshot.h"
+
+/**
+ * Collects the client and server state after a desync and writes a human readable report naming the first
+ * diverging subsystem, entity and field, followed by a dump of that entity on both sides.
+ */
+class DesyncReport final
+{
+private:
+    struct ServerEntity
+    {
+        bool            Present = false;
+        GameStateEntity Entity;
+    };
+
+    uint32                          _tick = 0;
+    sint32                          _subsystem = -1;
+    std::vector<uint64>             _clientChecksums;
+    std::vector<uint64>             _serverChecksums;
+    std::vector<GameStateEntity>    _clientEntities;
+    std::map<uint32, ServerEntity>  _serverEntities;
+    bool                            _serverStateAvailable = true;
+
+public:
+    DesyncReport(uint32 tick, const std::vector<uint64> &clientChecksums, const std::vector<uint64> &serverChecksums);
+
+    uint32 GetTick() const { return _tick; }
+    sint32 GetSubsystem() const { return _subsystem; }
+    const std::vector<GameStateEntity> & GetClientEntities() const { return _clientEntities; }
+
+    /**
+     * Adds an entity the server found to differ from the client's hash. Present is false if the entity does
+     * not exist on the server.
+     */
+    void AddServerEntity(uint32 id, bool present, std::vector<uint8> data);
+    void SetServerStateUnavailable();
+
+    std::string ToString() const;
+};
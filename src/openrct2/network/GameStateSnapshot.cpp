@@ -0,0 +1,160 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#include <string>
+#include "../core/String.hpp"
+#include "GameStateSnapshot.h"
+
+template<typename T>
+static GameStateEntity CreateEntity(uint32 id, const T * items, size_t count)
+{
+    GameStateEntity entity;
+    entity.Id = id;
+    auto bytes = reinterpret_cast<const uint8 *>(items);
+    entity.Data.assign(bytes, bytes + (count * sizeof(T)));
+    return entity;
+}
+
+uint32 GameStateEntity::GetHash() const
+{
+    GameStateHasher hasher;
+    hasher.Write(Data.data(), Data.size());
+    return (uint32)hasher.GetHash();
+}
+
+void GameStateSnapshot::Capture(uint32 tick)
+{
+    _tick = tick;
+    game_state_get_rng(&_rng);
+    game_state_get_finances(&_finances);
+
+    _rides.clear();
+    _rideIndices.clear();
+    sint32 rideIndex;
+    Ride * ride;
+    FOR_ALL_RIDES(rideIndex, ride)
+    {
+        Ride copy = *ride;
+        game_state_mask_ride(&copy);
+        _rides.push_back(copy);
+        _rideIndices.push_back((uint8)rideIndex);
+    }
+
+    _sprites.clear();
+    for (size_t i = 0; i < gSpriteCapacity; i++)
+    {
+        const rct_sprite * sprite = get_sprite(i);
+        if (game_state_get_sprite_subsystem(sprite) != -1)
+        {
+            rct_sprite copy = *sprite;
+            game_state_mask_sprite(&copy);
+            _sprites.push_back(copy);
+        }
+    }
+
+    _tileElements.clear();
+    _tileOffsets.resize(MAX_TILE_TILE_ELEMENT_POINTERS + 1);
+    for (sint32 y = 0; y < MAXIMUM_MAP_SIZE_TECHNICAL; y++)
+    {
+        for (sint32 x = 0; x < MAXIMUM_MAP_SIZE_TECHNICAL; x++)
+        {
+            _tileOffsets[(y * MAXIMUM_MAP_SIZE_TECHNICAL) + x] = (uint32)_tileElements.size();
+            const rct_tile_element * tileElement = map_get_first_element_at(x, y);
+            do
+            {
+                if (!(tileElement->flags & TILE_ELEMENT_FLAG_GHOST))
+                {
+                    rct_tile_element copy = *tileElement;
+                    game_state_mask_tile_element(&copy);
+                    _tileElements.push_back(copy);
+                }
+            }
+            while (!tile_element_is_last_for_tile(tileElement++));
+        }
+    }
+    _tileOffsets[MAX_TILE_TILE_ELEMENT_POINTERS] = (uint32)_tileElements.size();
+}
+
+std::vector<GameStateEntity> GameStateSnapshot::GetEntities(sint32 subsystem) const
+{
+    std::vector<GameStateEntity> entities;
+    switch (subsystem) {
+    case GAME_STATE_SUBSYSTEM_RNG:
+        entities.push_back(CreateEntity(0, &_rng, 1));
+        break;
+    case GAME_STATE_SUBSYSTEM_FINANCES:
+        entities.push_back(CreateEntity(0, &_finances, 1));
+        break;
+    case GAME_STATE_SUBSYSTEM_RIDES:
+        for (size_t i = 0; i < _rides.size(); i++)
+        {
+            entities.push_back(CreateEntity(_rideIndices[i], &_rides[i], 1));
+        }
+        break;
+    case GAME_STATE_SUBSYSTEM_SPRITES_TRAIN:
+    case GAME_STATE_SUBSYSTEM_SPRITES_PEEP:
+    case GAME_STATE_SUBSYSTEM_SPRITES_LITTER:
+        for (const auto &sprite : _sprites)
+        {
+            if (game_state_get_sprite_subsystem(&sprite) == subsystem)
+            {
+                entities.push_back(CreateEntity(sprite.unknown.sprite_index, &sprite, 1));
+            }
+        }
+        break;
+    default:
+    {
+        sint32 region = subsystem - GAME_STATE_SUBSYSTEM_TILE_REGION_FIRST;
+        if (region < 0 || region >= GAME_STATE_TILE_REGION_COUNT || _tileOffsets.empty())
+        {
+            break;
+        }
+
+        sint32 left = (region % GAME_STATE_TILE_REGIONS_PER_AXIS) * GAME_STATE_TILE_REGION_SIZE;
+        sint32 top = (region / GAME_STATE_TILE_REGIONS_PER_AXIS) * GAME_STATE_TILE_REGION_SIZE;
+        for (sint32 y = top; y < top + GAME_STATE_TILE_REGION_SIZE; y++)
+        {
+            for (sint32 x = left; x < left + GAME_STATE_TILE_REGION_SIZE; x++)
+            {
+                uint32 tileIndex = (y * MAXIMUM_MAP_SIZE_TECHNICAL) + x;
+                uint32 first = _tileOffsets[tileIndex];
+                uint32 count = _tileOffsets[tileIndex + 1] - first;
+                entities.push_back(CreateEntity(tileIndex, _tileElements.data() + first, count));
+            }
+        }
+        break;
+    }
+    }
+    return entities;
+}
+
+std::string GameStateSnapshot::GetEntityName(sint32 subsystem, const GameStateEntity &entity)
+{
+    switch (subsystem) {
+    case GAME_STATE_SUBSYSTEM_RNG:
+        return "scenario RNG";
+    case GAME_STATE_SUBSYSTEM_FINANCES:
+        return "park finances";
+    case GAME_STATE_SUBSYSTEM_RIDES:
+        return String::StdFormat("ride %u", entity.Id);
+    case GAME_STATE_SUBSYSTEM_SPRITES_TRAIN:
+    case GAME_STATE_SUBSYSTEM_SPRITES_PEEP:
+    case GAME_STATE_SUBSYSTEM_SPRITES_LITTER:
+        return String::StdFormat("sprite %u", entity.Id);
+    default:
+        return String::StdFormat("tile (%u, %u)", entity.Id % MAXIMUM_MAP_SIZE_TECHNICAL, entity.Id / MAXIMUM_MAP_SIZE_TECHNICAL);
+    }
+}
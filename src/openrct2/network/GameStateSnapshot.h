@@ -0,0 +1,64 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../common.h"
+#include "../GameStateChecksum.h"
+
+/**
+ * A single entity of a game state subsystem: a sprite, ride, map tile, the finances or the RNG. The data is
+ * masked in the same way as for the game state checksum so it can be compared between server and client.
+ */
+struct GameStateEntity
+{
+    uint32              Id = 0;
+    std::vector<uint8>  Data;
+
+    uint32 GetHash() const;
+};
+
+/**
+ * A copy of the synchronised game state at a given tick. The server keeps a few of these around when desync
+ * debugging is enabled, so that clients can compare their own state against it after a desync.
+ */
+class GameStateSnapshot final
+{
+private:
+    uint32                          _tick = 0;
+    game_state_rng                  _rng = {};
+    game_state_finances             _finances = {};
+    std::vector<Ride>               _rides;
+    std::vector<uint8>              _rideIndices;
+    std::vector<rct_sprite>         _sprites;
+    std::vector<rct_tile_element>   _tileElements;
+    // Index into _tileElements of the first element of each tile, plus one extra entry for the end
+    std::vector<uint32>             _tileOffsets;
+
+public:
+    uint32 GetTick() const { return _tick; }
+
+    void Capture(uint32 tick);
+
+    /**
+     * Gets all entities belonging to a GAME_STATE_SUBSYSTEM, ordered by ID.
+     */
+    std::vector<GameStateEntity> GetEntities(sint32 subsystem) const;
+
+    static std::string GetEntityName(sint32 subsystem, const GameStateEntity &entity);
+};
@@ -56,10 +56,12 @@ static sint32 _pickup_peep_old_x = LOCATION_NULL;
 
 #include "../config/Config.h"
 #include "../Game.h"
+#include "../GameStateChecksum.h"
 #include "../interface/chat.h"
 #include "../interface/window.h"
 #include "../localisation/date.h"
 #include "../localisation/localisation.h"
+#include "../ride/ride_ratings.h"
 #include "../scenario/scenario.h"
 #include "../util/Util.h"
 #include "../Cheats.h"
@@ -111,6 +113,7 @@ Network::Network()
     client_command_handlers[NETWORK_COMMAND_GAMEINFO] = &Network::Client_Handle_GAMEINFO;
     client_command_handlers[NETWORK_COMMAND_TOKEN] = &Network::Client_Handle_TOKEN;
     client_command_handlers[NETWORK_COMMAND_OBJECTS] = &Network::Client_Handle_OBJECTS;
+    client_command_handlers[NETWORK_COMMAND_GAMESTATE] = &Network::Client_Handle_GAMESTATE;
     server_command_handlers.resize(NETWORK_COMMAND_MAX, nullptr);
     server_command_handlers[NETWORK_COMMAND_AUTH] = &Network::Server_Handle_AUTH;
     server_command_handlers[NETWORK_COMMAND_CHAT] = &Network::Server_Handle_CHAT;
@@ -120,6 +123,7 @@ Network::Network()
     server_command_handlers[NETWORK_COMMAND_GAMEINFO] = &Network::Server_Handle_GAMEINFO;
     server_command_handlers[NETWORK_COMMAND_TOKEN] = &Network::Server_Handle_TOKEN;
     server_command_handlers[NETWORK_COMMAND_OBJECTS] = &Network::Server_Handle_OBJECTS;
+    server_command_handlers[NETWORK_COMMAND_GAMESTATE] = &Network::Server_Handle_GAMESTATE;
     OpenSSL_add_all_algorithms();
 }
 
@@ -168,6 +172,9 @@ void Network::Close()
         return;
     }
 
+    // Stop the I/O thread before the sockets and connections it uses are deleted
+    SafeDelete(_ioThread);
+
     if (mode == NETWORK_MODE_CLIENT) {
         delete server_connection->Socket;
         server_connection->Socket = nullptr;
@@ -181,6 +188,15 @@ void Network::Close()
     CloseChatLog();
     CloseServerLog();
 
+    // Write whatever was collected if the connection closes before the server replied
+    if (_desyncReport != nullptr) {
+        WriteDesyncReport();
+    }
+    _closeAfterDesyncReport = false;
+    _gameStateSnapshots.clear();
+    _mapStreams.clear();
+    _mapDecoder = nullptr;
+
     mode = NETWORK_MODE_NONE;
     status = NETWORK_STATUS_NONE;
     _lastConnectStatus = SOCKET_STATUS_CLOSED;
@@ -308,6 +324,7 @@ bool Network::BeginServer(uint16 port, const char* address)
     try
     {
         listening_socket->Listen(address, port);
+        _ioThread = new NetworkIOThread(listening_socket);
     }
     catch (const Exception &ex)
     {
@@ -403,6 +420,9 @@ void Network::Update()
         break;
     }
 
+    // Send what the update queued, such as pings, even when the game is paused and does not flush
+    Flush();
+
     // If the Close() was called during the update, close it for real
     _closeLock = false;
     if (_requireClose) {
@@ -412,21 +432,16 @@ void Network::Update()
 
 void Network::Flush()
 {
-    if (GetMode() == NETWORK_MODE_CLIENT)
-    {
-        server_connection->SendQueuedPackets();
-    }
-    else
+    if (_ioThread != nullptr)
     {
-        for (auto& it : client_connection_list)
-        {
-            it->SendQueuedPackets();
-        }
+        _ioThread->Wake();
     }
 }
 
 void Network::UpdateServer()
 {
+    UpdateMapStreams(false);
+
     auto it = client_connection_list.begin();
     while (it != client_connection_list.end()) {
         if (!ProcessConnection(*(*it))) {
@@ -447,8 +462,8 @@ void Network::UpdateServer()
         _advertiser->Update();
     }
 
-    ITcpSocket * tcpSocket = listening_socket->Accept();
-    if (tcpSocket != nullptr) {
+    ITcpSocket * tcpSocket;
+    while (_ioThread->TryAccept(&tcpSocket)) {
         AddClient(tcpSocket);
     }
 }
@@ -501,6 +516,8 @@ void Network::UpdateClient()
         {
             status = NETWORK_STATUS_CONNECTED;
             server_connection->ResetLastPacketTime();
+            _ioThread = new NetworkIOThread();
+            _ioThread->AddConnection(server_connection);
             Client_Send_TOKEN();
             char str_authenticating[256];
             format_string(str_authenticating, 256, STR_MULTIPLAYER_AUTHENTICATING, nullptr);
@@ -551,6 +568,13 @@ void Network::UpdateClient()
             window_close_by_class(WC_MULTIPLAYER);
             Close();
         }
+        else if (_desyncReport != nullptr && platform_get_ticks() > _desyncReportDeadline) {
+            // Give up waiting for the server's part of the desync report
+            WriteDesyncReport();
+            if (_closeAfterDesyncReport) {
+                Close();
+            }
+        }
         break;
     }
     }
@@ -614,6 +638,9 @@ const char* Network::FormatChat(NetworkPlayer* fromplayer, const char* text)
 
 void Network::SendPacketToClients(NetworkPacket& packet, bool front, bool gameCmd)
 {
+    // Serialised once and shared by every connection's queue
+    NetworkPacketBuffer buffer = packet.Serialise();
+    bool requiresAuth = packet.CommandRequiresAuth();
     for (auto &client_connection : client_connection_list) {
         if (gameCmd) {
             // If marked as game command we can not send the packet to connections that are not fully connected.
@@ -623,7 +650,7 @@ void Network::SendPacketToClients(NetworkPacket& packet, bool front, bool gameCm
                 continue;
             }
         }
-        client_connection->QueuePacket(NetworkPacket::Duplicate(packet), front);
+        client_connection->QueuePacket(buffer, requiresAuth, front);
     }
 }
 
@@ -645,13 +672,13 @@ bool Network::CheckSRAND(uint32 tick, uint32 srand0)
     if (tick == server_srand0_tick)
     {
         server_srand0_tick = 0;
-        // Check that the server and client sprite hashes match
-        const char *client_sprite_hash = sprite_checksum();
-        const bool sprites_mismatch = server_sprite_hash[0] != '\0' && strcmp(client_sprite_hash, server_sprite_hash);
-        // Check PRNG values and sprite hashes, if exist
-        if ((srand0 != server_srand0) || sprites_mismatch) {
+        // Check that the server and client game state checksums match
+        const uint64 client_checksum = game_state_checksum();
+        const bool state_mismatch = server_checksum_received && client_checksum != server_checksum;
+        // Check PRNG values and game state checksums, if exist
+        if ((srand0 != server_srand0) || state_mismatch) {
 #ifdef DEBUG_DESYNC
-            dbg_report_desync(tick, srand0, server_srand0, client_sprite_hash, server_sprite_hash);
+            dbg_report_desync(tick, srand0, server_srand0, client_checksum, server_checksum, server_checksum_received);
 #endif
             return false;
         }
@@ -673,8 +700,17 @@ void Network::CheckDesynchronizaton()
         intent.putExtra(INTENT_EXTRA_MESSAGE, std::string { str_desync });
         context_open_intent(&intent);
 
+        if (!server_subsystem_checksums.empty()) {
+            BeginDesyncReport(gCurrentTicks);
+        }
+
         if (!gConfigNetwork.stay_connected) {
-            Close();
+            if (_desyncReport != nullptr) {
+                // Stay connected until the server has sent its state for the report
+                _closeAfterDesyncReport = true;
+            } else {
+                Close();
+            }
         }
     }
 }
@@ -688,7 +724,7 @@ void Network::KickPlayer(sint32 playerId)
             char str_disconnect_msg[256];
             format_string(str_disconnect_msg, 256, STR_MULTIPLAYER_KICKED_REASON, nullptr);
             Server_Send_SETDISCONNECTMSG(*client_connection, str_disconnect_msg);
-            client_connection->Socket->Disconnect();
+            client_connection->Disconnect();
             break;
         }
     }
@@ -702,7 +738,7 @@ void Network::SetPassword(const char* password)
 void Network::ShutdownClient()
 {
     if (GetMode() == NETWORK_MODE_CLIENT) {
-        server_connection->Socket->Disconnect();
+        server_connection->Disconnect();
     }
 }
 
@@ -981,6 +1017,42 @@ void Network::CloseServerLog()
     AppendServerLog(logMessage);
 }
 
+void Network::BeginDesyncReport(uint32 tick)
+{
+    uint64 checksums[GAME_STATE_SUBSYSTEM_COUNT];
+    game_state_checksum_subsystems(checksums);
+    std::vector<uint64> clientChecksums(std::begin(checksums), std::end(checksums));
+
+    _desyncReport = std::make_unique<DesyncReport>(tick, clientChecksums, server_subsystem_checksums);
+    _desyncReportPendingReplies = 0;
+    _desyncReportDeadline = platform_get_ticks() + 10000;
+    if (_desyncReport->GetSubsystem() == -1) {
+        WriteDesyncReport();
+    } else {
+        Client_Send_GAMESTATE();
+    }
+}
+
+void Network::WriteDesyncReport()
+{
+    auto directory = _env->GetDirectoryPath(DIRBASE::USER, DIRID::LOG_DESYNCS);
+    if (platform_ensure_directory_exists(directory.c_str())) {
+        try
+        {
+            auto path = BeginLog(directory, "", _desyncReportFilenameFormat);
+            auto report = _desyncReport->ToString();
+            auto fs = FileStream(path, FILE_MODE_WRITE);
+            fs.Write(report.c_str(), report.size());
+            Console::WriteLine("Desync report written to %s", path.c_str());
+        }
+        catch (const Exception &ex)
+        {
+            log_error("Unable to write desync report: %s", ex.GetMessage());
+        }
+    }
+    _desyncReport = nullptr;
+}
+
 void Network::Client_Send_TOKEN()
 {
     log_verbose("requesting token");
@@ -1001,6 +1073,7 @@ void Network::Client_Send_AUTH(const char* name, const char* password, const cha
     assert(sigsize <= (size_t)UINT32_MAX);
     *packet << (uint32)sigsize;
     packet->Write((const uint8 *)sig, sigsize);
+    *packet << NetworkMapCodec::GetSupportedCodecs();
     server_connection->AuthStatus = NETWORK_AUTH_REQUESTED;
     server_connection->QueuePacket(std::move(packet));
 }
@@ -1039,6 +1112,51 @@ void Network::Server_Send_OBJECTS(NetworkConnection& connection, const std::vect
     connection.QueuePacket(std::move(packet));
 }
 
+void Network::Client_Send_GAMESTATE()
+{
+    // Send the hash of every entity in the diverging subsystem so the server can reply with just the entities that
+    // differ. The hashes are split over several packets when needed, each one covering a range of entity IDs.
+    const size_t maxEntitiesPerPacket = 4096;
+    const auto &entities = _desyncReport->GetClientEntities();
+    size_t index = 0;
+    do
+    {
+        size_t count = std::min(maxEntitiesPerPacket, entities.size() - index);
+        uint32 firstId = index == 0 ? 0 : entities[index].Id;
+        uint32 lastId = index + count < entities.size() ? entities[index + count].Id - 1 : UINT32_MAX;
+
+        std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
+        *packet << (uint32)NETWORK_COMMAND_GAMESTATE << _desyncReport->GetTick() << (uint16)_desyncReport->GetSubsystem();
+        *packet << firstId << lastId << (uint32)count;
+        for (size_t i = index; i < index + count; i++)
+        {
+            *packet << entities[i].Id << entities[i].GetHash();
+        }
+        server_connection->QueuePacket(std::move(packet));
+
+        _desyncReportPendingReplies++;
+        index += count;
+    }
+    while (index < entities.size());
+}
+
+void Network::Server_Send_GAMESTATE(NetworkConnection& connection, uint32 tick, sint32 subsystem, bool available, const std::map<uint32, const GameStateEntity *> &entities)
+{
+    std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
+    *packet << (uint32)NETWORK_COMMAND_GAMESTATE << tick << (uint16)subsystem << (uint8)available << (uint8)entities.size();
+    for (const auto &entity : entities)
+    {
+        // A null entity means it only exists on the client
+        *packet << entity.first << (uint8)(entity.second != nullptr);
+        if (entity.second != nullptr)
+        {
+            *packet << (uint16)entity.second->Data.size();
+            packet->Write(entity.second->Data.data(), entity.second->Data.size());
+        }
+    }
+    connection.QueuePacket(std::move(packet));
+}
+
 void Network::Server_Send_AUTH(NetworkConnection& connection)
 {
     uint8 new_playerid = 0;
@@ -1052,89 +1170,119 @@ void Network::Server_Send_AUTH(NetworkConnection& connection)
     }
     connection.QueuePacket(std::move(packet));
     if (connection.AuthStatus != NETWORK_AUTH_OK && connection.AuthStatus != NETWORK_AUTH_REQUIREPASSWORD) {
-        connection.SendQueuedPackets();
-        connection.Socket->Disconnect();
+        connection.Disconnect();
     }
 }
 
 void Network::Server_Send_MAP(NetworkConnection* connection)
 {
     std::vector<const ObjectRepositoryItem *> objects;
+    std::vector<NetworkConnection *> connections;
     if (connection) {
         objects = connection->RequestedObjects;
+        connections.push_back(connection);
     } else {
         // This will send all custom objects to connected clients
         // TODO: fix it so custom objects negotiation is performed even in this case.
         IObjectManager * objManager = GetObjectManager();
         objects = objManager->GetPackableObjects();
+        for (auto &client_connection : client_connection_list) {
+            if (client_connection->AuthStatus == NETWORK_AUTH_OK) {
+                connections.push_back(client_connection.get());
+            }
+        }
+        if (connections.empty()) {
+            return;
+        }
     }
 
-    size_t out_size;
-    uint8 * header = save_for_network(out_size, objects);
-    if (header == nullptr) {
+    // Finish any map still being streamed to these clients so that it is not overtaken by the new one
+    for (auto target : connections) {
+        if (IsStreamingMap(target)) {
+            UpdateMapStreams(true);
+            break;
+        }
+    }
+
+    NETWORK_MAP_CODEC codec = NETWORK_MAP_CODEC_ZSTD;
+    for (auto target : connections) {
+        if (!NetworkMapCodec::IsSupported(codec) || !(target->SupportedMapCodecs & (1 << codec))) {
+            codec = NETWORK_MAP_CODEC_ZLIB;
+        }
+    }
+
+    auto encoder = SaveMap(objects, codec);
+    if (encoder == nullptr) {
         if (connection) {
             connection->SetLastDisconnectReason(STR_MULTIPLAYER_CONNECTION_CLOSED);
-            connection->Socket->Disconnect();
+            connection->Disconnect();
         }
         return;
     }
-    size_t chunksize = 65000;
-    for (size_t i = 0; i < out_size; i += chunksize) {
-        size_t datasize = Math::Min(chunksize, out_size - i);
-        std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
-        *packet << (uint32)NETWORK_COMMAND_MAP << (uint32)out_size << (uint32)i;
-        packet->Write(&header[i], datasize);
-        if (connection) {
-            connection->QueuePacket(std::move(packet));
-        } else {
-            SendPacketToClients(*packet);
-        }
+
+    // Anything sent from now on depends on the state the map was captured at, so it must arrive after the map
+    for (auto target : connections) {
+        target->HoldPackets();
     }
-    free(header);
+
+    MapStream stream;
+    stream.Encoder = std::move(encoder);
+    stream.Connections = std::move(connections);
+    _mapStreams.push_back(std::move(stream));
 }
 
-uint8 * Network::save_for_network(size_t &out_size, const std::vector<const ObjectRepositoryItem *> &objects) const
+void Network::UpdateMapStreams(bool wait)
 {
-    uint8 * header = nullptr;
-    out_size = 0;
-    bool RLEState = gUseRLE;
-    gUseRLE = false;
-
-    auto ms = MemoryStream();
-    if (!SaveMap(&ms, objects)) {
-        log_warning("Failed to export map.");
-        return nullptr;
-    }
-    gUseRLE = RLEState;
+    auto it = _mapStreams.begin();
+    while (it != _mapStreams.end()) {
+        MapStream &stream = *it;
+        if (wait) {
+            stream.Encoder->Wait();
+        }
 
-    const void * data = ms.GetData();
-    sint32 size = ms.GetLength();
+        bool complete = false;
+        NetworkMapChunk chunk;
+        while (stream.Encoder->TryPopChunk(&chunk)) {
+            for (auto connection : stream.Connections) {
+                std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
+                *packet << (uint32)NETWORK_COMMAND_MAP << stream.Offset << (uint8)(chunk.Last ? NETWORK_MAP_FLAG_LAST_CHUNK : 0);
+                if (stream.Offset == 0) {
+                    packet->WriteString(NetworkMapCodec::GetTag(stream.Encoder->GetCodec()));
+                    *packet << stream.Encoder->GetUncompressedSize();
+                }
+                packet->Write(chunk.Data.data(), chunk.Data.size());
+                connection->QueueMapPacket(std::move(packet));
+            }
+            stream.Offset += (uint32)chunk.Data.size();
+            complete = chunk.Last;
+        }
 
-    uint8 *compressed = util_zlib_deflate((const uint8 *)data, size, &out_size);
-    if (compressed != nullptr)
-    {
-        header = (uint8 *)_strdup("open2_sv6_zlib");
-        size_t header_len = strlen((char *)header) + 1; // account for null terminator
-        header = (uint8 *)realloc(header, header_len + out_size);
-        if (header == nullptr) {
-            log_error("Failed to allocate %u bytes.", header_len + out_size);
-        } else {
-            memcpy(&header[header_len], compressed, out_size);
-            out_size += header_len;
-            log_verbose("Sending map of size %u bytes, compressed to %u bytes", size, out_size);
+        bool failed = stream.Encoder->HasFailed();
+        if (failed) {
+            for (auto connection : stream.Connections) {
+                connection->SetLastDisconnectReason(STR_MULTIPLAYER_CONNECTION_CLOSED);
+                connection->Disconnect();
+            }
         }
-        free(compressed);
-    } else {
-        log_warning("Failed to compress the data, falling back to non-compressed sv6.");
-        header = (uint8 *)malloc(size);
-        if (header == nullptr) {
-            log_error("Failed to allocate %u bytes.", size);
+        if (complete || failed) {
+            for (auto connection : stream.Connections) {
+                connection->ReleaseHeldPackets();
+            }
+            it = _mapStreams.erase(it);
         } else {
-            out_size = size;
-            memcpy(header, data, size);
+            it++;
         }
     }
-    return header;
+}
+
+bool Network::IsStreamingMap(const NetworkConnection * connection) const
+{
+    for (const auto &stream : _mapStreams) {
+        if (std::find(stream.Connections.begin(), stream.Connections.end(), connection) != stream.Connections.end()) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void Network::Client_Send_CHAT(const char* text)
@@ -1215,21 +1363,36 @@ void Network::Server_Send_TICK()
 
     std::unique_ptr<NetworkPacket> packet(NetworkPacket::Allocate());
     *packet << (uint32)NETWORK_COMMAND_TICK << (uint32)gCurrentTicks << (uint32)gScenarioSrand0;
-    uint32 flags = 0;
-    // Simple counter which limits how often a sprite checksum gets sent.
-    // This can get somewhat expensive, so we don't want to push it every tick in release,
-    // but debug version can check more often.
-    static sint32 checksum_counter = 0;
-    checksum_counter++;
-    if (checksum_counter >= 100) {
-        checksum_counter = 0;
-        flags |= NETWORK_TICK_FLAG_CHECKSUMS;
+    // The game state checksum is cheap enough to be sent with every tick, which lets clients
+    // detect a desync on the tick it happens rather than up to 100 ticks later.
+    uint32 flags = NETWORK_TICK_FLAG_CHECKSUMS;
+    if (gConfigNetwork.desync_debugging) {
+        flags |= NETWORK_TICK_FLAG_SUBSYSTEM_CHECKSUMS;
     }
     // Send flags always, so we can understand packet structure on the other end,
     // and allow for some expansion.
     *packet << flags;
-    if (flags & NETWORK_TICK_FLAG_CHECKSUMS) {
-        packet->WriteString(sprite_checksum());
+    if (flags & NETWORK_TICK_FLAG_SUBSYSTEM_CHECKSUMS) {
+        uint64 checksums[GAME_STATE_SUBSYSTEM_COUNT];
+        game_state_checksum_subsystems(checksums);
+        *packet << game_state_checksum_combine(checksums) << (uint16)GAME_STATE_SUBSYSTEM_COUNT;
+        for (auto checksum : checksums) {
+            *packet << checksum;
+        }
+
+        // Keep a copy of the state so that desynchronised clients can compare against it,
+        // reusing the oldest snapshot once the history is full
+        std::unique_ptr<GameStateSnapshot> snapshot;
+        if (_gameStateSnapshots.size() >= 32) {
+            snapshot = std::move(_gameStateSnapshots.front());
+            _gameStateSnapshots.pop_front();
+        } else {
+            snapshot = std::make_unique<GameStateSnapshot>();
+        }
+        snapshot->Capture(gCurrentTicks);
+        _gameStateSnapshots.push_back(std::move(snapshot));
+    } else if (flags & NETWORK_TICK_FLAG_CHECKSUMS) {
+        *packet << game_state_checksum();
     }
     SendPacketToClients(*packet);
 }
@@ -1278,7 +1441,6 @@ void Network::Server_Send_SETDISCONNECTMSG(NetworkConnection& connection, const
     *packet << (uint32)NETWORK_COMMAND_SETDISCONNECTMSG;
     packet->WriteString(msg);
     connection.QueuePacket(std::move(packet));
-    connection.SendQueuedPackets();
 }
 
 void Network::Server_Send_GAMEINFO(NetworkConnection& connection)
@@ -1347,33 +1509,21 @@ void Network::Server_Send_EVENT_PLAYER_DISCONNECTED(const char *playerName, cons
 
 bool Network::ProcessConnection(NetworkConnection& connection)
 {
+    // The I/O thread has already received and parsed the packets, so this only processes them
     sint32 packetStatus;
-    do {
-        packetStatus = connection.ReadPacket();
-        switch(packetStatus) {
-        case NETWORK_READPACKET_DISCONNECTED:
-            // closed connection or network error
-            if (!connection.GetLastDisconnectReason()) {
-                connection.SetLastDisconnectReason(STR_MULTIPLAYER_CONNECTION_CLOSED);
-            }
+    while ((packetStatus = connection.ReadPacket()) == NETWORK_READPACKET_SUCCESS) {
+        ProcessPacket(connection, connection.InboundPacket);
+        if (connection.Socket == nullptr) {
             return false;
-            break;
-        case NETWORK_READPACKET_SUCCESS:
-            // done reading in packet
-            ProcessPacket(connection, connection.InboundPacket);
-            if (connection.Socket == nullptr) {
-                return false;
-            }
-            break;
-        case NETWORK_READPACKET_MORE_DATA:
-            // more data required to be read
-            break;
-        case NETWORK_READPACKET_NO_DATA:
-            // could not read anything from socket
-            break;
         }
-    } while (packetStatus == NETWORK_READPACKET_MORE_DATA || packetStatus == NETWORK_READPACKET_SUCCESS);
-    connection.SendQueuedPackets();
+    }
+    if (packetStatus == NETWORK_READPACKET_DISCONNECTED) {
+        // closed connection or network error
+        if (!connection.GetLastDisconnectReason()) {
+            connection.SetLastDisconnectReason(STR_MULTIPLAYER_CONNECTION_CLOSED);
+        }
+        return false;
+    }
     if (!connection.ReceivedPacketRecently()) {
         if (!connection.GetLastDisconnectReason()) {
             connection.SetLastDisconnectReason(STR_MULTIPLAYER_NO_DATA);
@@ -1514,6 +1664,7 @@ void Network::AddClient(ITcpSocket * socket)
     }
     auto connection = std::make_unique<NetworkConnection>();
     connection->Socket = socket;
+    _ioThread->AddConnection(connection.get());
     char addr[128];
     snprintf(addr, sizeof(addr), "Client joined from %s", socket->GetHostName());
     AppendServerLog(addr);
@@ -1522,6 +1673,9 @@ void Network::AddClient(ITcpSocket * socket)
 
 void Network::RemoveClient(std::unique_ptr<NetworkConnection>& connection)
 {
+    if (connection->Socket != nullptr) {
+        _ioThread->RemoveConnection(connection.get());
+    }
     NetworkPlayer* connection_player = connection->Player;
     if (connection_player) {
         char text[256];
@@ -1549,6 +1703,11 @@ void Network::RemoveClient(std::unique_ptr<NetworkConnection>& connection)
     player_list.erase(std::remove_if(player_list.begin(), player_list.end(), [connection_player](std::unique_ptr<NetworkPlayer>& player){
                           return player.get() == connection_player;
                       }), player_list.end());
+    for (auto &stream : _mapStreams) {
+        auto &connections = stream.Connections;
+        connections.erase(std::remove(connections.begin(), connections.end(), connection.get()), connections.end());
+    }
+    _mapStreams.remove_if([](const MapStream &stream) { return stream.Connections.empty(); });
     client_connection_list.remove(connection);
     if (gConfigNetwork.pause_server_if_no_clients && game_is_not_paused() && client_connection_list.size() == 0)
     {
@@ -1664,7 +1823,7 @@ void Network::Client_Handle_TOKEN(NetworkConnection& connection, NetworkPacket&
     {
         log_error("Failed to load key %s", keyPath);
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_VERIFICATION_FAILURE);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         return;
     }
 
@@ -1680,7 +1839,7 @@ void Network::Client_Handle_TOKEN(NetworkConnection& connection, NetworkPacket&
     if (!ok) {
         log_error("Failed to sign server's challenge.");
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_VERIFICATION_FAILURE);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         return;
     }
     // Don't keep private key in memory. There's no need and it may get leaked
@@ -1706,37 +1865,37 @@ void Network::Client_Handle_AUTH(NetworkConnection& connection, NetworkPacket& p
         break;
     case NETWORK_AUTH_BADNAME:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_BAD_PLAYER_NAME);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     case NETWORK_AUTH_BADVERSION:
     {
         const char *version = packet.ReadString();
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_INCORRECT_SOFTWARE_VERSION, &version);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     }
     case NETWORK_AUTH_BADPASSWORD:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_BAD_PASSWORD);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     case NETWORK_AUTH_VERIFICATIONFAILURE:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_VERIFICATION_FAILURE);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     case NETWORK_AUTH_FULL:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_SERVER_FULL);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     case NETWORK_AUTH_REQUIREPASSWORD:
         context_open_window_view(WV_NETWORK_PASSWORD);
         break;
     case NETWORK_AUTH_UNKNOWN_KEY_DISALLOWED:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_UNKNOWN_KEY_DISALLOWED);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     default:
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_INCORRECT_SOFTWARE_VERSION);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         break;
     }
 }
@@ -1770,6 +1929,57 @@ void Network::Server_Handle_TOKEN(NetworkConnection& connection, NetworkPacket&
     Server_Send_TOKEN(connection);
 }
 
+void Network::Client_Handle_GAMESTATE(NetworkConnection& connection, NetworkPacket& packet)
+{
+    uint32 tick;
+    uint16 subsystem;
+    uint8 available;
+    uint8 count;
+    packet >> tick >> subsystem >> available >> count;
+    if (_desyncReport == nullptr || tick != _desyncReport->GetTick() || subsystem != _desyncReport->GetSubsystem())
+    {
+        return;
+    }
+
+    if (!available)
+    {
+        _desyncReport->SetServerStateUnavailable();
+    }
+    for (uint32 i = 0; i < count; i++)
+    {
+        uint32 id;
+        uint8 present;
+        packet >> id >> present;
+
+        std::vector<uint8> data;
+        if (present)
+        {
+            uint16 size;
+            packet >> size;
+            const uint8 * bytes = packet.Read(size);
+            if (bytes == nullptr)
+            {
+                break;
+            }
+            data.assign(bytes, bytes + size);
+        }
+        _desyncReport->AddServerEntity(id, present != 0, std::move(data));
+    }
+
+    if (_desyncReportPendingReplies > 0)
+    {
+        _desyncReportPendingReplies--;
+    }
+    if (_desyncReportPendingReplies == 0)
+    {
+        WriteDesyncReport();
+        if (_closeAfterDesyncReport)
+        {
+            Close();
+        }
+    }
+}
+
 void Network::Client_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket& packet)
 {
     IObjectRepository * repo = GetObjectRepository();
@@ -1779,7 +1989,7 @@ void Network::Client_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket
     if (size > OBJECT_ENTRY_COUNT)
     {
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_SERVER_INVALID_REQUEST);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         log_warning("Server sent invalid amount of objects");
         return;
     }
@@ -1806,6 +2016,73 @@ void Network::Client_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket
     Client_Send_OBJECTS(requested_objects);
 }
 
+void Network::Server_Handle_GAMESTATE(NetworkConnection& connection, NetworkPacket& packet)
+{
+    // The server only sends the entities that differ, limited so the reply always fits into one packet
+    const size_t maxDivergingEntities = 4;
+
+    uint32 tick;
+    uint16 subsystem;
+    uint32 firstId;
+    uint32 lastId;
+    uint32 count;
+    packet >> tick >> subsystem >> firstId >> lastId >> count;
+
+    auto snapshot = std::find_if(_gameStateSnapshots.begin(), _gameStateSnapshots.end(),
+        [tick](const std::unique_ptr<GameStateSnapshot> &s) -> bool
+        {
+            return s->GetTick() == tick;
+        });
+    if (!gConfigNetwork.desync_debugging || subsystem >= GAME_STATE_SUBSYSTEM_COUNT || snapshot == _gameStateSnapshots.end())
+    {
+        Server_Send_GAMESTATE(connection, tick, subsystem, false, {});
+        return;
+    }
+
+    // The count is sent by the client, never read more hashes than the rest of the packet holds
+    const size_t hashEntrySize = sizeof(uint32) * 2;
+    count = (uint32)std::min<size_t>(count, (packet.Size - packet.BytesRead) / hashEntrySize);
+
+    std::map<uint32, uint32> clientHashes;
+    for (uint32 i = 0; i < count; i++)
+    {
+        uint32 id;
+        uint32 hash;
+        packet >> id >> hash;
+        clientHashes[id] = hash;
+    }
+
+    auto serverEntities = (*snapshot)->GetEntities(subsystem);
+    std::map<uint32, const GameStateEntity *> divergingEntities;
+    for (const auto &entity : serverEntities)
+    {
+        if (entity.Id < firstId || entity.Id > lastId)
+        {
+            continue;
+        }
+        auto clientHash = clientHashes.find(entity.Id);
+        if (clientHash == clientHashes.end() || clientHash->second != entity.GetHash())
+        {
+            divergingEntities[entity.Id] = &entity;
+        }
+        if (clientHash != clientHashes.end())
+        {
+            clientHashes.erase(clientHash);
+        }
+    }
+    // Whatever is left only exists on the client
+    for (const auto &clientHash : clientHashes)
+    {
+        divergingEntities[clientHash.first] = nullptr;
+    }
+
+    while (divergingEntities.size() > maxDivergingEntities)
+    {
+        divergingEntities.erase(std::prev(divergingEntities.end()));
+    }
+    Server_Send_GAMESTATE(connection, tick, subsystem, true, divergingEntities);
+}
+
 void Network::Server_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket& packet)
 {
     uint32 size;
@@ -1813,7 +2090,7 @@ void Network::Server_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket
     if (size > OBJECT_ENTRY_COUNT)
     {
         connection.SetLastDisconnectReason(STR_MULTIPLAYER_CLIENT_INVALID_REQUEST);
-        connection.Socket->Disconnect();
+        connection.Disconnect();
         std::string playerName = "(unknown)";
         if (connection.Player)
         {
@@ -1866,6 +2143,7 @@ void Network::Server_Handle_AUTH(NetworkConnection& connection, NetworkPacket& p
                 {
                     throw Exception();
                 }
+                packet >> connection.SupportedMapCodecs;
 
                 auto ms = MemoryStream(pubkey, strlen(pubkey));
                 if (!connection.Key.LoadPublic(&ms))
@@ -1938,17 +2216,37 @@ void Network::Server_Handle_AUTH(NetworkConnection& connection, NetworkPacket& p
 
 void Network::Client_Handle_MAP(NetworkConnection& connection, NetworkPacket& packet)
 {
-    uint32 size, offset;
-    packet >> size >> offset;
-    sint32 chunksize = (sint32)(packet.Size - packet.BytesRead);
-    if (chunksize <= 0) {
+    uint32 offset;
+    uint8 flags;
+    packet >> offset >> flags;
+    if (offset == 0) {
+        const utf8 * tag = packet.ReadString();
+        uint32 size;
+        packet >> size;
+        NETWORK_MAP_CODEC codec;
+        if (tag == nullptr || !NetworkMapCodec::TryParseTag(tag, &codec) || !NetworkMapCodec::IsSupported(codec)) {
+            log_warning("Server sent map in an unsupported format.");
+            Close();
+            return;
+        }
+        _mapDecoder = std::make_unique<NetworkMapDecoder>(codec, size);
+    }
+    if (_mapDecoder == nullptr || offset != _mapDecoder->GetCompressedLength()) {
+        log_warning("Received map chunk out of order.");
+        Close();
         return;
     }
-    if (size > chunk_buffer.size()) {
-        chunk_buffer.resize(size);
+
+    // Decompress each chunk as it arrives rather than all at once at the end
+    size_t chunksize = packet.Size - packet.BytesRead;
+    if (!_mapDecoder->Write(packet.Read(chunksize), chunksize)) {
+        log_warning("Failed to decompress data sent from server.");
+        Close();
+        return;
     }
+
     char str_downloading_map[256];
-    uint32 downloading_map_args[2] = {(offset + chunksize) / 1024, size / 1024};
+    uint32 downloading_map_args[2] = {(uint32)_mapDecoder->GetLength() / 1024, _mapDecoder->GetUncompressedSize() / 1024};
     format_string(str_downloading_map, 256, STR_MULTIPLAYER_DOWNLOADING_MAP, downloading_map_args);
 
     auto intent = Intent(WC_NETWORK_STATUS);
@@ -1958,30 +2256,15 @@ void Network::Client_Handle_MAP(NetworkConnection& connection, NetworkPacket& pa
     });
     context_open_intent(&intent);
 
-    memcpy(&chunk_buffer[offset], (void*)packet.Read(chunksize), chunksize);
-    if (offset + chunksize == size) {
+    if (flags & NETWORK_MAP_FLAG_LAST_CHUNK) {
         context_force_close_window_by_class(WC_NETWORK_STATUS);
-        bool has_to_free = false;
-        uint8 *data = &chunk_buffer[0];
-        size_t data_size = size;
-        // zlib-compressed
-        if (strcmp("open2_sv6_zlib", (char *)&chunk_buffer[0]) == 0)
-        {
-            log_verbose("Received zlib-compressed sv6 map");
-            has_to_free = true;
-            size_t header_len = strlen("open2_sv6_zlib") + 1;
-            data = util_zlib_inflate(&chunk_buffer[header_len], size - header_len, &data_size);
-            if (data == nullptr)
-            {
-                log_warning("Failed to decompress data sent from server.");
-                Close();
-                return;
-            }
-        } else {
-            log_verbose("Assuming received map is in plain sv6 format");
+        auto decoder = std::move(_mapDecoder);
+        if (!decoder->IsComplete()) {
+            log_warning("Failed to decompress data sent from server.");
+            Close();
+            return;
         }
-
-        auto ms = MemoryStream(data, data_size);
+        auto ms = MemoryStream(decoder->GetData(), decoder->GetLength());
         if (LoadMap(&ms))
         {
             game_load_init();
@@ -2003,10 +2286,6 @@ void Network::Client_Handle_MAP(NetworkConnection& connection, NetworkPacket& pa
             //Something went wrong, game is not loaded. Return to main screen.
             game_do_command(0, GAME_COMMAND_FLAG_APPLY, 0, 0, GAME_COMMAND_LOAD_OR_QUIT, 1, 0);
         }
-        if (has_to_free)
-        {
-            free(data);
-        }
     }
 }
 
@@ -2028,6 +2307,7 @@ bool Network::LoadMap(IStream * stream)
 
         // Read other data not in normal save files
         stream->Read(gSpriteSpatialIndex, 0x10001 * sizeof(uint16));
+        rebuild_sprite_spatial_index_links();
         gGamePaused = stream->ReadValue<uint32>();
         _guestGenerationProbability = stream->ReadValue<uint32>();
         _suggestedGuestMaximum = stream->ReadValue<uint32>();
@@ -2052,6 +2332,10 @@ bool Network::LoadMap(IStream * stream)
         gCheatsDisableRideValueAging = stream->ReadValue<uint8>() != 0;
         gConfigGeneral.show_real_names_of_guests = stream->ReadValue<uint8>() != 0;
         gCheatsIgnoreResearchStatus = stream->ReadValue<uint8>() != 0;
+
+        std::vector<uint8> pendingRatings(ride_ratings_get_pending_size());
+        stream->Read(pendingRatings.data(), pendingRatings.size());
+        ride_ratings_set_pending(pendingRatings.data());
         
         gLastAutoSaveUpdate = AUTOSAVE_PAUSE;
         result = true;
@@ -2062,18 +2346,24 @@ bool Network::LoadMap(IStream * stream)
     return result;
 }
 
-bool Network::SaveMap(IStream * stream, const std::vector<const ObjectRepositoryItem *> &objects) const
+std::unique_ptr<NetworkMapEncoder> Network::SaveMap(const std::vector<const ObjectRepositoryItem *> &objects, NETWORK_MAP_CODEC codec) const
 {
-    bool result = false;
+    std::unique_ptr<NetworkMapEncoder> result;
     viewport_set_saved_view();
     try
     {
+        // The game state and packed objects are captured here, the encoder thread only writes out the exporter's
+        // own copy and compresses it. The map is compressed as a whole, which works better without RLE encoding
+        // the chunks first.
         auto s6exporter = std::make_unique<S6Exporter>();
         s6exporter->ExportObjectsList = objects;
+        s6exporter->UseRLE = false;
         s6exporter->Export();
-        s6exporter->SaveGame(stream);
+        s6exporter->PackObjects();
 
         // Write other data not in normal save files
+        auto ms = MemoryStream();
+        auto stream = &ms;
         stream->Write(gSpriteSpatialIndex, 0x10001 * sizeof(uint16));
         stream->WriteValue<uint32>(gGamePaused);
         stream->WriteValue<uint32>(_guestGenerationProbability);
@@ -2100,10 +2390,18 @@ bool Network::SaveMap(IStream * stream, const std::vector<const ObjectRepository
         stream->WriteValue<uint8>(gConfigGeneral.show_real_names_of_guests);
         stream->WriteValue<uint8>(gCheatsIgnoreResearchStatus);
 
-        result = true;
+        // Rides queued by the server's own commands since the last tick
+        std::vector<uint8> pendingRatings(ride_ratings_get_pending_size());
+        ride_ratings_get_pending(pendingRatings.data());
+        stream->Write(pendingRatings.data(), pendingRatings.size());
+
+        auto extraData = static_cast<const uint8 *>(ms.GetData());
+        result = std::make_unique<NetworkMapEncoder>(codec, std::move(s6exporter),
+                                                     std::vector<uint8>(extraData, extraData + ms.GetLength()));
     }
     catch (const Exception &)
     {
+        log_warning("Failed to export map.");
     }
     return result;
 }
@@ -2326,13 +2624,21 @@ void Network::Client_Handle_TICK(NetworkConnection& connection, NetworkPacket& p
     if (server_srand0_tick == 0) {
         server_srand0 = srand0;
         server_srand0_tick = server_tick;
-        server_sprite_hash[0] = '\0';
+        server_checksum_received = false;
+        server_subsystem_checksums.clear();
         if (flags & NETWORK_TICK_FLAG_CHECKSUMS)
         {
-            const char* text = packet.ReadString();
-            if (text != nullptr)
+            packet >> server_checksum;
+            server_checksum_received = true;
+        }
+        if (flags & NETWORK_TICK_FLAG_SUBSYSTEM_CHECKSUMS)
+        {
+            uint16 numChecksums;
+            packet >> numChecksums;
+            server_subsystem_checksums.resize(numChecksums);
+            for (auto &checksum : server_subsystem_checksums)
             {
-                safe_strcpy(server_sprite_hash, text, sizeof(server_sprite_hash));
+                packet >> checksum;
             }
         }
     }
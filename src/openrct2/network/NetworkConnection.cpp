@@ -16,6 +16,8 @@
 
 #ifndef DISABLE_NETWORK
 
+#include <algorithm>
+#include <cstring>
 #include "network.h"
 #include "NetworkConnection.h"
 #include "../core/String.hpp"
@@ -24,6 +26,12 @@
 #include "../platform/platform.h"
 
 constexpr size_t NETWORK_DISCONNECT_REASON_BUFFER_SIZE = 256;
+// Initial size of the receive buffer, it grows to fit larger packets
+constexpr size_t NETWORK_RECEIVE_BUFFER_SIZE = 16 * 1024;
+// Maximum number of queued packets gathered into a single send
+constexpr size_t NETWORK_MAX_PACKETS_PER_SEND = 32;
+// How long a connection that is being disconnected has to send its remaining packets
+constexpr uint32 NETWORK_DISCONNECT_TIMEOUT = 3000;
 
 NetworkConnection::NetworkConnection()
 {
@@ -38,104 +46,261 @@ NetworkConnection::~NetworkConnection()
 
 sint32 NetworkConnection::ReadPacket()
 {
-    if (InboundPacket.BytesTransferred < sizeof(InboundPacket.Size))
+    // Check for a closed socket first so that packets received before it closed are not lost
+    bool closed = _socketClosed.load(std::memory_order_acquire);
+
+    std::unique_ptr<NetworkPacket> packet;
+    if (_disconnecting)
     {
-        // read packet size
-        void * buffer = &((char*)&InboundPacket.Size)[InboundPacket.BytesTransferred];
-        size_t bufferLength = sizeof(InboundPacket.Size) - InboundPacket.BytesTransferred;
-        size_t readBytes;
-        NETWORK_READPACKET status = Socket->ReceiveData(buffer, bufferLength, &readBytes);
-        if (status != NETWORK_READPACKET_SUCCESS)
+        // Nothing more from the peer is processed, the connection is only kept until its queued packets are
+        // sent so that the peer still receives the reason it was disconnected
+        while (_receivedPackets.TryPop(&packet))
         {
-            return status;
         }
-
-        InboundPacket.BytesTransferred += readBytes;
-        if (InboundPacket.BytesTransferred == sizeof(InboundPacket.Size))
+        if (closed || platform_get_ticks() > _disconnectTime + NETWORK_DISCONNECT_TIMEOUT)
         {
-            InboundPacket.Size = Convert::NetworkToHost(InboundPacket.Size);
-            if (InboundPacket.Size == 0) // Can't have a size 0 packet
-            {
-                return NETWORK_READPACKET_DISCONNECTED;
-            }
-            InboundPacket.Data->resize(InboundPacket.Size);
+            return NETWORK_READPACKET_DISCONNECTED;
         }
+        return NETWORK_READPACKET_NO_DATA;
     }
-    else
+    if (_receivedPackets.TryPop(&packet))
     {
-        // read packet data
-        if (InboundPacket.Data->capacity() > 0)
-        {
-            void * buffer = &InboundPacket.GetData()[InboundPacket.BytesTransferred - sizeof(InboundPacket.Size)];
-            size_t bufferLength = sizeof(InboundPacket.Size) + InboundPacket.Size - InboundPacket.BytesTransferred;
-            size_t readBytes;
-            NETWORK_READPACKET status = Socket->ReceiveData(buffer, bufferLength, &readBytes);
-            if (status != NETWORK_READPACKET_SUCCESS)
-            {
-                return status;
-            }
+        InboundPacket = std::move(*packet);
+        _lastPacketTime = platform_get_ticks();
+        return NETWORK_READPACKET_SUCCESS;
+    }
+    return closed ? NETWORK_READPACKET_DISCONNECTED : NETWORK_READPACKET_NO_DATA;
+}
+
+void NetworkConnection::QueuePacket(std::unique_ptr<NetworkPacket> packet, bool front)
+{
+    QueuePacket(packet->Serialise(), packet->CommandRequiresAuth(), front);
+}
 
-            InboundPacket.BytesTransferred += readBytes;
+void NetworkConnection::QueuePacket(const NetworkPacketBuffer &buffer, bool requiresAuth, bool front)
+{
+    if (AuthStatus == NETWORK_AUTH_OK || !requiresAuth)
+    {
+        if (_holdPackets && !front)
+        {
+            _heldPackets.push_back(buffer);
         }
-        if (InboundPacket.BytesTransferred == sizeof(InboundPacket.Size) + InboundPacket.Size)
+        else
         {
-            _lastPacketTime = platform_get_ticks();
-            return NETWORK_READPACKET_SUCCESS;
+            _queuedPackets.Push({ buffer, front });
         }
     }
-    return NETWORK_READPACKET_MORE_DATA;
 }
 
-bool NetworkConnection::SendPacket(NetworkPacket& packet)
+void NetworkConnection::QueueMapPacket(std::unique_ptr<NetworkPacket> packet)
 {
-    uint16 sizen = Convert::HostToNetwork(packet.Size);
-    std::vector<uint8> tosend;
-    tosend.reserve(sizeof(sizen) + packet.Size);
-    tosend.insert(tosend.end(), (uint8*)&sizen, (uint8*)&sizen + sizeof(sizen));
-    tosend.insert(tosend.end(), packet.Data->begin(), packet.Data->end());
+    if (AuthStatus == NETWORK_AUTH_OK)
+    {
+        _queuedPackets.Push({ packet->Serialise(), false });
+    }
+}
 
-    const void * buffer = &tosend[packet.BytesTransferred];
-    size_t bufferSize = tosend.size() - packet.BytesTransferred;
-    size_t sent = Socket->SendData(buffer, bufferSize);
-    if (sent > 0)
+void NetworkConnection::Disconnect()
+{
+    if (!_disconnecting)
     {
-        packet.BytesTransferred += sent;
+        _disconnecting = true;
+        _disconnectTime = platform_get_ticks();
+        _queuedPackets.Push({ nullptr, false });
     }
-    return packet.BytesTransferred == tosend.size();
 }
 
-void NetworkConnection::QueuePacket(std::unique_ptr<NetworkPacket> packet, bool front)
+void NetworkConnection::HoldPackets()
+{
+    _holdPackets = true;
+}
+
+void NetworkConnection::ReleaseHeldPackets()
+{
+    _holdPackets = false;
+    for (const auto &buffer : _heldPackets)
+    {
+        _queuedPackets.Push({ buffer, false });
+    }
+    _heldPackets.clear();
+}
+
+bool NetworkConnection::ReceivePackets()
+{
+    if (_socketClosed.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    sint32 status = ReceiveIntoBuffer();
+    while (status == NETWORK_READPACKET_SUCCESS)
+    {
+        // A single read can contain several packets
+        status = TryParsePacket();
+    }
+    if (status == NETWORK_READPACKET_DISCONNECTED)
+    {
+        _socketClosed.store(true, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+sint32 NetworkConnection::ReceiveIntoBuffer()
+{
+    // Move the start of a partially received packet to the front to make room for the rest of it
+    if (_receiveOffset > 0)
+    {
+        std::memmove(_receiveBuffer.data(), _receiveBuffer.data() + _receiveOffset, _receiveLength - _receiveOffset);
+        _receiveLength -= _receiveOffset;
+        _receiveOffset = 0;
+    }
+
+    // Grow the buffer if the partial packet is larger than it
+    size_t requiredSize = NETWORK_RECEIVE_BUFFER_SIZE;
+    if (_receiveLength >= sizeof(uint16))
+    {
+        uint16 packetSize;
+        std::memcpy(&packetSize, _receiveBuffer.data(), sizeof(packetSize));
+        requiredSize = std::max(requiredSize, sizeof(uint16) + Convert::NetworkToHost(packetSize));
+    }
+    if (_receiveBuffer.size() < requiredSize)
+    {
+        _receiveBuffer.resize(requiredSize);
+    }
+
+    size_t readBytes;
+    NETWORK_READPACKET status = Socket->ReceiveData(&_receiveBuffer[_receiveLength], _receiveBuffer.size() - _receiveLength, &readBytes);
+    if (status == NETWORK_READPACKET_SUCCESS)
+    {
+        _receiveLength += readBytes;
+    }
+    return status;
+}
+
+sint32 NetworkConnection::TryParsePacket()
 {
-    if (AuthStatus == NETWORK_AUTH_OK || !packet->CommandRequiresAuth())
+    size_t available = _receiveLength - _receiveOffset;
+    if (available < sizeof(uint16))
+    {
+        return NETWORK_READPACKET_MORE_DATA;
+    }
+
+    const uint8 * data = &_receiveBuffer[_receiveOffset];
+    uint16 packetSize;
+    std::memcpy(&packetSize, data, sizeof(packetSize));
+    packetSize = Convert::NetworkToHost(packetSize);
+    if (packetSize == 0) // Can't have a size 0 packet
     {
-        packet->Size = (uint16)packet->Data->size();
-        if (front)
+        return NETWORK_READPACKET_DISCONNECTED;
+    }
+    if (available < sizeof(uint16) + packetSize)
+    {
+        return NETWORK_READPACKET_MORE_DATA;
+    }
+
+    auto packet = std::make_unique<NetworkPacket>();
+    packet->Size = packetSize;
+    packet->Data->assign(data + sizeof(uint16), data + sizeof(uint16) + packetSize);
+    packet->BytesTransferred = sizeof(uint16) + packetSize;
+    _receivedPackets.Push(std::move(packet));
+
+    _receiveOffset += sizeof(uint16) + packetSize;
+    if (_receiveOffset == _receiveLength)
+    {
+        _receiveOffset = 0;
+        _receiveLength = 0;
+    }
+    return NETWORK_READPACKET_SUCCESS;
+}
+
+void NetworkConnection::EnqueuePacket(const NetworkPacketBuffer &buffer, bool front)
+{
+    if (front)
+    {
+        // If the first packet was already partially sent add new packet to second position
+        if (!_outboundPackets.empty() && _outboundPackets.front().BytesSent > 0)
         {
-            // If the first packet was already partially sent add new packet to second position
-            if (!_outboundPackets.empty() && _outboundPackets.front()->BytesTransferred > 0)
-            {
-                auto it = _outboundPackets.begin();
-                it++; // Second position
-                _outboundPackets.insert(it, std::move(packet));
-            }
-            else
-            {
-                _outboundPackets.push_front(std::move(packet));
-            }
+            _outboundPackets.insert(_outboundPackets.begin() + 1, { buffer, 0 });
         }
         else
         {
-            _outboundPackets.push_back(std::move(packet));
+            _outboundPackets.push_front({ buffer, 0 });
         }
     }
+    else
+    {
+        _outboundPackets.push_back({ buffer, 0 });
+    }
 }
 
-void NetworkConnection::SendQueuedPackets()
+bool NetworkConnection::SendPackets()
 {
-    while (!_outboundPackets.empty() && SendPacket(*_outboundPackets.front()))
+    QueuedPacket queued;
+    while (_queuedPackets.TryPop(&queued))
     {
-        _outboundPackets.remove(_outboundPackets.front());
+        if (_sendClosed)
+        {
+            // Anything queued after the disconnect request is dropped
+        }
+        else if (queued.Buffer == nullptr)
+        {
+            // Packets queued before the request are still sent, so push a null marker after them
+            _outboundPackets.push_back({ nullptr, 0 });
+            _sendClosed = true;
+        }
+        else
+        {
+            EnqueuePacket(queued.Buffer, queued.Front);
+        }
+    }
+
+    // Packets are sent straight from their serialised buffers, gathering as many as possible into each send
+    TcpSocketBuffer buffers[NETWORK_MAX_PACKETS_PER_SEND];
+    while (!_outboundPackets.empty())
+    {
+        if (_outboundPackets.front().Buffer == nullptr)
+        {
+            _outboundPackets.clear();
+            Socket->Disconnect();
+            _socketClosed.store(true, std::memory_order_release);
+            return true;
+        }
+
+        size_t numBuffers = 0;
+        size_t totalLength = 0;
+        for (auto it = _outboundPackets.begin(); it != _outboundPackets.end() && it->Buffer != nullptr && numBuffers < NETWORK_MAX_PACKETS_PER_SEND; it++)
+        {
+            // Only the first packet can have been partially sent
+            size_t length = it->Buffer->size() - it->BytesSent;
+            buffers[numBuffers++] = { it->Buffer->data() + it->BytesSent, length };
+            totalLength += length;
+        }
+
+        size_t sent = Socket->SendData(buffers, numBuffers);
+        for (size_t remaining = sent; remaining > 0; )
+        {
+            OutboundPacket &packet = _outboundPackets.front();
+            size_t packetRemaining = packet.Buffer->size() - packet.BytesSent;
+            if (remaining >= packetRemaining)
+            {
+                remaining -= packetRemaining;
+                _outboundPackets.pop_front();
+            }
+            else
+            {
+                packet.BytesSent += remaining;
+                remaining = 0;
+            }
+        }
+
+        if (sent < totalLength)
+        {
+            // The socket would block, the I/O thread tries again shortly
+            return false;
+        }
     }
+    return true;
 }
 
 void NetworkConnection::ResetLastPacketTime()
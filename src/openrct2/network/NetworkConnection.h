@@ -19,11 +19,13 @@
 #ifdef __cplusplus
 
 #ifndef DISABLE_NETWORK
-#include <list>
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <vector>
 
 #include "../common.h"
+#include "../core/SpscQueue.hpp"
 
 #include "NetworkTypes.h"
 #include "NetworkKey.h"
@@ -33,6 +35,11 @@ interface ITcpSocket;
 class NetworkPlayer;
 struct ObjectRepositoryItem;
 
+/**
+ * A connection to a client, or on a client the connection to the server. Packets are read from and written to
+ * the socket by NetworkIOThread, the game thread only ever sees complete packets through ReadPacket and
+ * QueuePacket. Unless stated otherwise the methods are for the game thread.
+ */
 class NetworkConnection final
 {
 public:
@@ -44,13 +51,39 @@ public:
     NetworkKey                                  Key;
     std::vector<uint8>                          Challenge;
     std::vector<const ObjectRepositoryItem *>   RequestedObjects;
+    // Bit set of NETWORK_MAP_CODEC the client can decompress
+    uint8                                       SupportedMapCodecs = 0;
 
     NetworkConnection();
     ~NetworkConnection();
 
+    /**
+     * Moves the next packet received by the I/O thread into InboundPacket.
+     * @returns NETWORK_READPACKET_SUCCESS if there was one, NETWORK_READPACKET_NO_DATA if not, or
+     *          NETWORK_READPACKET_DISCONNECTED once every packet received before the socket closed has been read,
+     *          or once a connection passed to Disconnect can be removed.
+     */
     sint32  ReadPacket();
     void QueuePacket(std::unique_ptr<NetworkPacket> packet, bool front = false);
-    void SendQueuedPackets();
+    /**
+     * Queues a packet that has already been serialised, allowing the same buffer to be queued on many
+     * connections. requiresAuth should be the result of NetworkPacket::CommandRequiresAuth.
+     */
+    void QueuePacket(const NetworkPacketBuffer &buffer, bool requiresAuth, bool front = false);
+    /**
+     * Shuts down the socket once the packets already queued have been sent, or after a few seconds if the peer
+     * is not reading them. Packets received from now on are dropped.
+     */
+    void Disconnect();
+
+    /**
+     * While a map is being streamed to the client, packets queued with QueuePacket are held back until
+     * ReleaseHeldPackets so that they arrive after the map. Packets queued at the front, such as pings, and
+     * map chunks queued with QueueMapPacket are sent straight away.
+     */
+    void HoldPackets();
+    void ReleaseHeldPackets();
+    void QueueMapPacket(std::unique_ptr<NetworkPacket> packet);
     void ResetLastPacketTime();
     bool ReceivedPacketRecently();
 
@@ -58,12 +91,56 @@ public:
     void SetLastDisconnectReason(const utf8 * src);
     void SetLastDisconnectReason(const rct_string_id string_id, void * args = nullptr);
 
+    /**
+     * Called by the I/O thread to read and parse everything waiting on the socket.
+     * @returns false once the socket has closed.
+     */
+    bool ReceivePackets();
+
+    /**
+     * Called by the I/O thread to send as many queued packets as the socket will take.
+     * @returns false if some could not be sent yet.
+     */
+    bool SendPackets();
+
 private:
-    std::list<std::unique_ptr<NetworkPacket>>   _outboundPackets;
+    // A queued packet, or a request to disconnect when Buffer is null
+    struct QueuedPacket
+    {
+        NetworkPacketBuffer Buffer;
+        bool                Front = false;
+    };
+
+    struct OutboundPacket
+    {
+        NetworkPacketBuffer Buffer;
+        size_t              BytesSent;
+    };
+
+    // Game thread
+    std::deque<NetworkPacketBuffer>             _heldPackets;
+    bool                                        _holdPackets = false;
+    bool                                        _disconnecting = false;
+    uint32                                      _disconnectTime = 0;
     uint32                                      _lastPacketTime;
     utf8 *                                      _lastDisconnectReason   = nullptr;
 
-    bool SendPacket(NetworkPacket &packet);
+    // Passed between the game thread and the I/O thread
+    SpscQueue<QueuedPacket>                     _queuedPackets;
+    SpscQueue<std::unique_ptr<NetworkPacket>>   _receivedPackets;
+    std::atomic<bool>                           _socketClosed { false };
+
+    // I/O thread
+    std::deque<OutboundPacket>                  _outboundPackets;
+    bool                                        _sendClosed = false;
+    // Data received from the socket but not yet parsed into packets, starting at _receiveOffset
+    std::vector<uint8>                          _receiveBuffer;
+    size_t                                      _receiveOffset = 0;
+    size_t                                      _receiveLength = 0;
+
+    sint32 ReceiveIntoBuffer();
+    sint32 TryParsePacket();
+    void EnqueuePacket(const NetworkPacketBuffer &buffer, bool front);
 };
 
 #endif // DISABLE_NETWORK
@@ -0,0 +1,183 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+
+#ifndef DISABLE_NETWORK
+
+#include <algorithm>
+#include "../core/Console.hpp"
+#include "NetworkConnection.h"
+#include "NetworkIOThread.h"
+#include "TcpSocket.h"
+
+// How long the thread sleeps when there is nothing to do, it is woken up when packets are queued
+constexpr uint32 NETWORK_IO_IDLE_POLL_TIMEOUT = 1000;
+// How long the thread waits before retrying a send that would have blocked
+constexpr uint32 NETWORK_IO_BLOCKED_POLL_TIMEOUT = 5;
+
+NetworkIOThread::NetworkIOThread(ITcpSocket * listeningSocket)
+    : _listeningSocket(listeningSocket),
+      _poller(CreateTcpSocketPoller())
+{
+    if (_listeningSocket != nullptr)
+    {
+        _poller->Add(_listeningSocket, _listeningSocket);
+    }
+    _thread = std::thread(&NetworkIOThread::Run, this);
+}
+
+NetworkIOThread::~NetworkIOThread()
+{
+    _stopping = true;
+    _poller->Wake();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+    delete _poller;
+
+    // Clients that connected after the last call to TryAccept
+    ITcpSocket * socket;
+    while (_acceptedSockets.TryPop(&socket))
+    {
+        delete socket;
+    }
+}
+
+void NetworkIOThread::AddConnection(NetworkConnection * connection)
+{
+    Command command;
+    command.Connection = connection;
+    _commands.Push(command);
+    _poller->Wake();
+}
+
+void NetworkIOThread::RemoveConnection(NetworkConnection * connection)
+{
+    std::promise<void> removed;
+    Command command;
+    command.Connection = connection;
+    command.Removed = &removed;
+    _commands.Push(command);
+    _poller->Wake();
+    removed.get_future().wait();
+}
+
+bool NetworkIOThread::TryAccept(ITcpSocket * * outSocket)
+{
+    return _acceptedSockets.TryPop(outSocket);
+}
+
+void NetworkIOThread::Wake()
+{
+    _poller->Wake();
+}
+
+void NetworkIOThread::Run()
+{
+    bool sendBlocked = false;
+    while (!_stopping)
+    {
+        uint32 timeout = sendBlocked ? NETWORK_IO_BLOCKED_POLL_TIMEOUT : NETWORK_IO_IDLE_POLL_TIMEOUT;
+        for (void * ready : _poller->Poll(timeout))
+        {
+            if (ready == _listeningSocket)
+            {
+                Accept();
+            }
+            else
+            {
+                auto connection = static_cast<NetworkConnection *>(ready);
+                if (!connection->ReceivePackets())
+                {
+                    _closedConnections.push_back(connection);
+                }
+            }
+        }
+
+        // Stop polling closed sockets, the game thread removes their connections when it next updates
+        for (auto connection : _closedConnections)
+        {
+            _poller->Remove(connection->Socket);
+        }
+        _closedConnections.clear();
+
+        // Connections removed here may have been reported as ready above, so this must happen after
+        ProcessCommands();
+
+        sendBlocked = false;
+        for (auto connection : _connections)
+        {
+            if (!connection->SendPackets())
+            {
+                sendBlocked = true;
+            }
+        }
+    }
+
+    // Unblock the game thread if it is waiting on a connection to be removed
+    ProcessCommands();
+}
+
+void NetworkIOThread::ProcessCommands()
+{
+    Command command;
+    while (_commands.TryPop(&command))
+    {
+        if (command.Removed != nullptr)
+        {
+            auto it = std::find(_connections.begin(), _connections.end(), command.Connection);
+            if (it != _connections.end())
+            {
+                _poller->Remove(command.Connection->Socket);
+                _connections.erase(it);
+            }
+            command.Removed->set_value();
+        }
+        else
+        {
+            _connections.push_back(command.Connection);
+            try
+            {
+                _poller->Add(command.Connection->Socket, command.Connection);
+            }
+            catch (const std::exception &ex)
+            {
+                // Packets are still sent, the connection times out as nothing is received
+                Console::Error::WriteLine("Unable to poll connection: %s", ex.what());
+            }
+        }
+    }
+}
+
+void NetworkIOThread::Accept()
+{
+    try
+    {
+        // Take every waiting client rather than one per poll
+        ITcpSocket * socket;
+        while ((socket = _listeningSocket->Accept()) != nullptr)
+        {
+            _acceptedSockets.Push(socket);
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        Console::Error::WriteLine("Unable to accept client: %s", ex.what());
+    }
+}
+
+#endif // DISABLE_NETWORK
@@ -0,0 +1,88 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+
+#pragma once
+
+#ifndef DISABLE_NETWORK
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+#include "../common.h"
+#include "../core/SpscQueue.hpp"
+
+interface ITcpSocket;
+interface ITcpSocketPoller;
+class NetworkConnection;
+
+/**
+ * Performs all socket I/O for the connections added to it on a background thread. Received data is parsed
+ * into packets that the game thread reads with NetworkConnection::ReadPacket, and packets queued with
+ * NetworkConnection::QueuePacket are sent from here, so the game tick never blocks on or waits for a socket.
+ * Apart from the constructor and destructor, the public methods must only be called from the game thread.
+ */
+class NetworkIOThread final
+{
+private:
+    struct Command
+    {
+        NetworkConnection *     Connection = nullptr;
+        // Set when the connection is being removed, the game thread waits on it
+        std::promise<void> *    Removed = nullptr;
+    };
+
+    ITcpSocket *                        _listeningSocket;
+    ITcpSocketPoller *                  _poller;
+    std::thread                         _thread;
+    std::atomic<bool>                   _stopping { false };
+
+    SpscQueue<Command>                  _commands;
+    SpscQueue<ITcpSocket *>             _acceptedSockets;
+
+    // I/O thread
+    std::vector<NetworkConnection *>    _connections;
+    std::vector<NetworkConnection *>    _closedConnections;
+
+public:
+    /**
+     * Starts the thread.
+     * @param listeningSocket The socket clients connect to when running a server, otherwise nullptr.
+     */
+    explicit NetworkIOThread(ITcpSocket * listeningSocket = nullptr);
+    ~NetworkIOThread();
+
+    void AddConnection(NetworkConnection * connection);
+    /**
+     * Stops all I/O on the connection, blocking until the thread has finished with it so that it can be
+     * deleted straight afterwards.
+     */
+    void RemoveConnection(NetworkConnection * connection);
+    bool TryAccept(ITcpSocket * * outSocket);
+
+    /**
+     * Wakes the thread up to send the packets that have been queued.
+     */
+    void Wake();
+
+private:
+    void Run();
+    void ProcessCommands();
+    void Accept();
+};
+
+#endif // DISABLE_NETWORK
@@ -0,0 +1,495 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#ifndef DISABLE_NETWORK
+
+#include <zlib.h>
+#ifdef USE_ZSTD
+    #include <zstd.h>
+#endif
+
+#include "../core/Guard.hpp"
+#include "../core/Math.hpp"
+#include "../core/MemoryStream.h"
+#include "../core/String.hpp"
+#include "../rct2/S6Exporter.h"
+#include "NetworkMapStream.h"
+
+// Number of uncompressed bytes passed to the compressor between checks for cancellation
+constexpr size_t MAP_INPUT_SLICE_SIZE = 256 * 1024;
+constexpr size_t MAP_OUTPUT_BUFFER_SIZE = 64 * 1024;
+
+interface IMapCompressor
+{
+    virtual ~IMapCompressor() = default;
+
+    /**
+     * Compresses the given data and appends any output to dst. Finish must be set for the last block.
+     */
+    virtual bool Compress(const uint8 * src, size_t length, bool finish, std::vector<uint8> &dst) abstract;
+};
+
+interface IMapDecompressor
+{
+    virtual ~IMapDecompressor() = default;
+
+    virtual bool Decompress(const uint8 * src, size_t length, std::vector<uint8> &dst) abstract;
+    virtual bool IsFinished() const abstract;
+};
+
+class ZlibMapCompressor final : public IMapCompressor
+{
+private:
+    z_stream            _stream = {};
+    bool                _initialised = false;
+    std::vector<uint8>  _buffer;
+
+public:
+    ZlibMapCompressor()
+        : _buffer(MAP_OUTPUT_BUFFER_SIZE)
+    {
+        _initialised = deflateInit(&_stream, Z_DEFAULT_COMPRESSION) == Z_OK;
+    }
+
+    ~ZlibMapCompressor() override
+    {
+        if (_initialised)
+        {
+            deflateEnd(&_stream);
+        }
+    }
+
+    bool Compress(const uint8 * src, size_t length, bool finish, std::vector<uint8> &dst) override
+    {
+        if (!_initialised)
+        {
+            return false;
+        }
+
+        _stream.next_in = (Bytef *)src;
+        _stream.avail_in = (uInt)length;
+        do
+        {
+            _stream.next_out = _buffer.data();
+            _stream.avail_out = (uInt)_buffer.size();
+            if (deflate(&_stream, finish ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR)
+            {
+                return false;
+            }
+            dst.insert(dst.end(), _buffer.data(), _buffer.data() + (_buffer.size() - _stream.avail_out));
+        }
+        while (_stream.avail_out == 0);
+        return true;
+    }
+};
+
+class ZlibMapDecompressor final : public IMapDecompressor
+{
+private:
+    z_stream            _stream = {};
+    bool                _initialised = false;
+    bool                _finished = false;
+    std::vector<uint8>  _buffer;
+
+public:
+    ZlibMapDecompressor()
+        : _buffer(MAP_OUTPUT_BUFFER_SIZE)
+    {
+        _initialised = inflateInit(&_stream) == Z_OK;
+    }
+
+    ~ZlibMapDecompressor() override
+    {
+        if (_initialised)
+        {
+            inflateEnd(&_stream);
+        }
+    }
+
+    bool Decompress(const uint8 * src, size_t length, std::vector<uint8> &dst) override
+    {
+        if (!_initialised || (_finished && length > 0))
+        {
+            return false;
+        }
+
+        _stream.next_in = (Bytef *)src;
+        _stream.avail_in = (uInt)length;
+        do
+        {
+            _stream.next_out = _buffer.data();
+            _stream.avail_out = (uInt)_buffer.size();
+            sint32 ret = inflate(&_stream, Z_NO_FLUSH);
+            if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR)
+            {
+                return false;
+            }
+            dst.insert(dst.end(), _buffer.data(), _buffer.data() + (_buffer.size() - _stream.avail_out));
+            if (ret == Z_STREAM_END)
+            {
+                _finished = true;
+                break;
+            }
+        }
+        while (_stream.avail_out == 0);
+        return true;
+    }
+
+    bool IsFinished() const override
+    {
+        return _finished;
+    }
+};
+
+#ifdef USE_ZSTD
+class ZstdMapCompressor final : public IMapCompressor
+{
+private:
+    // Favour speed, the map is compressed while the server keeps running
+    static constexpr sint32 CompressionLevel = 3;
+
+    ZSTD_CStream *      _stream;
+    std::vector<uint8>  _buffer;
+
+public:
+    ZstdMapCompressor()
+        : _buffer(MAP_OUTPUT_BUFFER_SIZE)
+    {
+        _stream = ZSTD_createCStream();
+        if (_stream != nullptr && ZSTD_isError(ZSTD_initCStream(_stream, CompressionLevel)))
+        {
+            ZSTD_freeCStream(_stream);
+            _stream = nullptr;
+        }
+    }
+
+    ~ZstdMapCompressor() override
+    {
+        ZSTD_freeCStream(_stream);
+    }
+
+    bool Compress(const uint8 * src, size_t length, bool finish, std::vector<uint8> &dst) override
+    {
+        if (_stream == nullptr)
+        {
+            return false;
+        }
+
+        ZSTD_inBuffer input = { src, length, 0 };
+        while (input.pos < input.size)
+        {
+            ZSTD_outBuffer output = { _buffer.data(), _buffer.size(), 0 };
+            if (ZSTD_isError(ZSTD_compressStream(_stream, &output, &input)))
+            {
+                return false;
+            }
+            dst.insert(dst.end(), _buffer.data(), _buffer.data() + output.pos);
+        }
+        if (finish)
+        {
+            size_t remaining;
+            do
+            {
+                ZSTD_outBuffer output = { _buffer.data(), _buffer.size(), 0 };
+                remaining = ZSTD_endStream(_stream, &output);
+                if (ZSTD_isError(remaining))
+                {
+                    return false;
+                }
+                dst.insert(dst.end(), _buffer.data(), _buffer.data() + output.pos);
+            }
+            while (remaining != 0);
+        }
+        return true;
+    }
+};
+
+class ZstdMapDecompressor final : public IMapDecompressor
+{
+private:
+    ZSTD_DStream *      _stream;
+    bool                _finished = false;
+    std::vector<uint8>  _buffer;
+
+public:
+    ZstdMapDecompressor()
+        : _buffer(MAP_OUTPUT_BUFFER_SIZE)
+    {
+        _stream = ZSTD_createDStream();
+        if (_stream != nullptr && ZSTD_isError(ZSTD_initDStream(_stream)))
+        {
+            ZSTD_freeDStream(_stream);
+            _stream = nullptr;
+        }
+    }
+
+    ~ZstdMapDecompressor() override
+    {
+        ZSTD_freeDStream(_stream);
+    }
+
+    bool Decompress(const uint8 * src, size_t length, std::vector<uint8> &dst) override
+    {
+        if (_stream == nullptr || (_finished && length > 0))
+        {
+            return false;
+        }
+
+        ZSTD_inBuffer input = { src, length, 0 };
+        ZSTD_outBuffer output;
+        do
+        {
+            output = { _buffer.data(), _buffer.size(), 0 };
+            size_t ret = ZSTD_decompressStream(_stream, &output, &input);
+            if (ZSTD_isError(ret))
+            {
+                return false;
+            }
+            dst.insert(dst.end(), _buffer.data(), _buffer.data() + output.pos);
+            if (ret == 0)
+            {
+                _finished = true;
+                break;
+            }
+        }
+        while (input.pos < input.size || output.pos == output.size);
+        return true;
+    }
+
+    bool IsFinished() const override
+    {
+        return _finished;
+    }
+};
+#endif
+
+static std::unique_ptr<IMapCompressor> CreateCompressor(NETWORK_MAP_CODEC codec)
+{
+    switch (codec) {
+#ifdef USE_ZSTD
+    case NETWORK_MAP_CODEC_ZSTD:
+        return std::make_unique<ZstdMapCompressor>();
+#endif
+    case NETWORK_MAP_CODEC_ZLIB:
+        return std::make_unique<ZlibMapCompressor>();
+    default:
+        return nullptr;
+    }
+}
+
+static std::unique_ptr<IMapDecompressor> CreateDecompressor(NETWORK_MAP_CODEC codec)
+{
+    switch (codec) {
+#ifdef USE_ZSTD
+    case NETWORK_MAP_CODEC_ZSTD:
+        return std::make_unique<ZstdMapDecompressor>();
+#endif
+    case NETWORK_MAP_CODEC_ZLIB:
+        return std::make_unique<ZlibMapDecompressor>();
+    default:
+        return nullptr;
+    }
+}
+
+namespace NetworkMapCodec
+{
+    static const utf8 * Tags[NETWORK_MAP_CODEC_COUNT] =
+    {
+        "open2_sv6_zlib",
+        "open2_sv6_zstd",
+    };
+
+    const utf8 * GetTag(NETWORK_MAP_CODEC codec)
+    {
+        Guard::ArgumentInRange<sint32>(codec, 0, NETWORK_MAP_CODEC_COUNT - 1);
+        return Tags[codec];
+    }
+
+    bool TryParseTag(const utf8 * tag, NETWORK_MAP_CODEC * outCodec)
+    {
+        for (sint32 i = 0; i < NETWORK_MAP_CODEC_COUNT; i++)
+        {
+            if (String::Equals(tag, Tags[i]))
+            {
+                *outCodec = (NETWORK_MAP_CODEC)i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint8 GetSupportedCodecs()
+    {
+        uint8 codecs = 1 << NETWORK_MAP_CODEC_ZLIB;
+#ifdef USE_ZSTD
+        codecs |= 1 << NETWORK_MAP_CODEC_ZSTD;
+#endif
+        return codecs;
+    }
+
+    bool IsSupported(NETWORK_MAP_CODEC codec)
+    {
+        return (GetSupportedCodecs() & (1 << codec)) != 0;
+    }
+}
+
+NetworkMapEncoder::NetworkMapEncoder(NETWORK_MAP_CODEC codec, std::unique_ptr<S6Exporter> exporter, std::vector<uint8> extraData)
+    : _codec(codec),
+      _exporter(std::move(exporter)),
+      _extraData(std::move(extraData))
+{
+    _thread = std::thread(&NetworkMapEncoder::Encode, this);
+}
+
+NetworkMapEncoder::~NetworkMapEncoder()
+{
+    _cancelled = true;
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+uint32 NetworkMapEncoder::GetUncompressedSize()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _uncompressedSize;
+}
+
+bool NetworkMapEncoder::HasFailed()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _failed;
+}
+
+bool NetworkMapEncoder::TryPopChunk(NetworkMapChunk * outChunk)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_chunks.empty())
+    {
+        return false;
+    }
+    *outChunk = std::move(_chunks.front());
+    _chunks.pop_front();
+    return true;
+}
+
+void NetworkMapEncoder::Wait()
+{
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+void NetworkMapEncoder::Encode()
+{
+    auto compressor = CreateCompressor(_codec);
+    auto ms = MemoryStream();
+    try
+    {
+        if (compressor == nullptr)
+        {
+            throw Exception("Unsupported map codec.");
+        }
+        _exporter->SaveGame(&ms);
+        ms.Write(_extraData.data(), _extraData.size());
+    }
+    catch (const std::exception &ex)
+    {
+        log_warning("Failed to export map: %s", ex.what());
+        std::lock_guard<std::mutex> lock(_mutex);
+        _failed = true;
+        return;
+    }
+    _exporter = nullptr;
+
+    auto data = static_cast<const uint8 *>(ms.GetData());
+    size_t size = ms.GetLength();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _uncompressedSize = (uint32)size;
+    }
+
+    std::vector<uint8> pending;
+    size_t compressedSize = 0;
+    size_t offset = 0;
+    bool finish = false;
+    while (!finish)
+    {
+        if (_cancelled)
+        {
+            return;
+        }
+
+        size_t sliceLength = Math::Min(MAP_INPUT_SLICE_SIZE, size - offset);
+        finish = offset + sliceLength == size;
+        size_t pendingLength = pending.size();
+        if (!compressor->Compress(data + offset, sliceLength, finish, pending))
+        {
+            log_warning("Failed to compress map.");
+            std::lock_guard<std::mutex> lock(_mutex);
+            _failed = true;
+            return;
+        }
+        offset += sliceLength;
+        compressedSize += pending.size() - pendingLength;
+
+        while (pending.size() > NETWORK_MAP_CHUNK_SIZE)
+        {
+            PushChunk(pending, NETWORK_MAP_CHUNK_SIZE, false);
+        }
+    }
+    PushChunk(pending, pending.size(), true);
+    log_verbose("Sending map of size %u bytes, compressed to %u bytes", (uint32)size, (uint32)compressedSize);
+}
+
+void NetworkMapEncoder::PushChunk(std::vector<uint8> &pending, size_t length, bool last)
+{
+    NetworkMapChunk chunk;
+    chunk.Data.assign(pending.begin(), pending.begin() + length);
+    chunk.Last = last;
+    pending.erase(pending.begin(), pending.begin() + length);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _chunks.push_back(std::move(chunk));
+}
+
+NetworkMapDecoder::NetworkMapDecoder(NETWORK_MAP_CODEC codec, uint32 uncompressedSize)
+    : _decompressor(CreateDecompressor(codec)),
+      _uncompressedSize(uncompressedSize)
+{
+    _data.reserve(uncompressedSize);
+}
+
+NetworkMapDecoder::~NetworkMapDecoder() = default;
+
+bool NetworkMapDecoder::Write(const uint8 * data, size_t length)
+{
+    if (_decompressor == nullptr || (length > 0 && data == nullptr))
+    {
+        return false;
+    }
+    _compressedLength += length;
+    return _decompressor->Decompress(data, length, _data) && _data.size() <= _uncompressedSize;
+}
+
+bool NetworkMapDecoder::IsComplete() const
+{
+    return _decompressor != nullptr && _decompressor->IsFinished() && _data.size() == _uncompressedSize;
+}
+
+#endif // DISABLE_NETWORK
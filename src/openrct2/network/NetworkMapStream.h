@@ -0,0 +1,140 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#ifndef DISABLE_NETWORK
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../common.h"
+
+class S6Exporter;
+
+// Maximum number of compressed bytes sent in a single NETWORK_COMMAND_MAP packet
+constexpr size_t NETWORK_MAP_CHUNK_SIZE = 65000;
+
+enum NETWORK_MAP_FLAG
+{
+    NETWORK_MAP_FLAG_LAST_CHUNK = 1 << 0,
+};
+
+enum NETWORK_MAP_CODEC
+{
+    NETWORK_MAP_CODEC_ZLIB,
+    NETWORK_MAP_CODEC_ZSTD,
+    NETWORK_MAP_CODEC_COUNT
+};
+
+interface IMapDecompressor;
+
+namespace NetworkMapCodec
+{
+    /**
+     * Gets the tag that precedes the map data, identifying the codec it was compressed with.
+     */
+    const utf8 * GetTag(NETWORK_MAP_CODEC codec);
+    bool TryParseTag(const utf8 * tag, NETWORK_MAP_CODEC * outCodec);
+
+    /**
+     * Gets a bit set of the codecs this build can decompress, indexed by NETWORK_MAP_CODEC.
+     */
+    uint8 GetSupportedCodecs();
+    bool IsSupported(NETWORK_MAP_CODEC codec);
+}
+
+struct NetworkMapChunk
+{
+    std::vector<uint8>  Data;
+    bool                Last = false;
+};
+
+/**
+ * Serialises and compresses a map captured by S6Exporter::Export on a background thread. The compressed data
+ * is split into chunks as it is produced, so the first chunks can be sent while the rest is still compressing.
+ * The thread must not touch any game or object state, so the exporter's objects have to be packed beforehand.
+ */
+class NetworkMapEncoder final
+{
+private:
+    NETWORK_MAP_CODEC               _codec;
+    std::unique_ptr<S6Exporter>     _exporter;
+    std::vector<uint8>              _extraData;
+    std::thread                     _thread;
+    std::atomic<bool>               _cancelled { false };
+
+    std::mutex                      _mutex;
+    std::deque<NetworkMapChunk>     _chunks;
+    uint32                          _uncompressedSize = 0;
+    bool                            _failed = false;
+
+public:
+    /**
+     * Starts encoding the map.
+     * @param exporter An exporter that has already exported the game state and packed its objects.
+     * @param extraData Data appended to the saved game, which is not part of the normal save format.
+     */
+    NetworkMapEncoder(NETWORK_MAP_CODEC codec, std::unique_ptr<S6Exporter> exporter, std::vector<uint8> extraData);
+    ~NetworkMapEncoder();
+
+    NETWORK_MAP_CODEC GetCodec() const { return _codec; }
+
+    /**
+     * Gets the size of the map before compression. Only valid once the first chunk has been returned.
+     */
+    uint32 GetUncompressedSize();
+    bool HasFailed();
+    bool TryPopChunk(NetworkMapChunk * outChunk);
+
+    /**
+     * Blocks until every chunk has been compressed.
+     */
+    void Wait();
+
+private:
+    void Encode();
+    void PushChunk(std::vector<uint8> &pending, size_t length, bool last);
+};
+
+/**
+ * Decompresses the chunks of a map as they are received.
+ */
+class NetworkMapDecoder final
+{
+private:
+    std::unique_ptr<IMapDecompressor>   _decompressor;
+    std::vector<uint8>                  _data;
+    uint32                              _uncompressedSize = 0;
+    size_t                              _compressedLength = 0;
+
+public:
+    NetworkMapDecoder(NETWORK_MAP_CODEC codec, uint32 uncompressedSize);
+    ~NetworkMapDecoder();
+
+    size_t GetCompressedLength() const { return _compressedLength; }
+    size_t GetLength() const { return _data.size(); }
+    uint32 GetUncompressedSize() const { return _uncompressedSize; }
+    const uint8 * GetData() const { return _data.data(); }
+
+    bool Write(const uint8 * data, size_t length);
+    bool IsComplete() const;
+};
+
+#endif // DISABLE_NETWORK
@@ -16,19 +16,16 @@
 
 #ifndef DISABLE_NETWORK
 
+#include <cstring>
 #include "NetworkTypes.h"
 #include "NetworkPacket.h"
+#include "TcpSocket.h"
 
 std::unique_ptr<NetworkPacket> NetworkPacket::Allocate()
 {
     return std::unique_ptr<NetworkPacket>(new NetworkPacket); // change to make_unique in c++14
 }
 
-std::unique_ptr<NetworkPacket> NetworkPacket::Duplicate(NetworkPacket &packet)
-{
-    return std::unique_ptr<NetworkPacket>(new NetworkPacket(packet)); // change to make_unique in c++14
-}
-
 uint8 * NetworkPacket::GetData()
 {
     return &(*Data)[0];
@@ -67,6 +64,19 @@ bool NetworkPacket::CommandRequiresAuth()
     }
 }
 
+NetworkPacketBuffer NetworkPacket::Serialise()
+{
+    uint16 size = (uint16)Data->size();
+    uint16 sizeHeader = Convert::HostToNetwork(size);
+    auto buffer = std::make_shared<std::vector<uint8>>(sizeof(sizeHeader) + size);
+    std::memcpy(buffer->data(), &sizeHeader, sizeof(sizeHeader));
+    if (size > 0)
+    {
+        std::memcpy(buffer->data() + sizeof(sizeHeader), Data->data(), size);
+    }
+    return buffer;
+}
+
 void NetworkPacket::Write(const uint8 * bytes, size_t size)
 {
     Data->insert(Data->end(), bytes, bytes + size);
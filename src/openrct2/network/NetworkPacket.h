@@ -24,6 +24,12 @@
 #include "../core/DataSerialiser.h"
 #include "../common.h"
 
+/**
+ * A packet serialised for sending, its size header followed by its data. It is never modified once created,
+ * so a broadcast packet is serialised once and the same buffer queued on every connection.
+ */
+using NetworkPacketBuffer = std::shared_ptr<const std::vector<uint8>>;
+
 class NetworkPacket final
 {
 public:
@@ -33,13 +39,13 @@ public:
     size_t                              BytesRead = 0;
 
     static std::unique_ptr<NetworkPacket> Allocate();
-    static std::unique_ptr<NetworkPacket> Duplicate(NetworkPacket& packet);
 
     uint8 * GetData();
     uint32  GetCommand();
 
     void Clear();
     bool CommandRequiresAuth();
+    NetworkPacketBuffer Serialise();
 
     const uint8 * Read(size_t size);
     const utf8 *  ReadString();
@@ -16,8 +16,11 @@
 
 #ifndef DISABLE_NETWORK
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <future>
+#include <mutex>
 #include <thread>
 
 // MSVC: include <math.h> here otherwise PI gets defined twice
@@ -46,7 +49,13 @@
     #include <netinet/tcp.h>
     #include <netinet/in.h>
     #include <sys/socket.h>
+    #include <sys/uio.h>
     #include <fcntl.h>
+    #include <unistd.h>
+    #if defined(__linux__)
+        #include <sys/epoll.h>
+        #include <sys/eventfd.h>
+    #endif // defined(__linux__)
     #include "../common.h"
     typedef sint32 SOCKET;
     #define SOCKET_ERROR -1
@@ -66,6 +75,12 @@
 
 constexpr auto CONNECT_TIMEOUT = std::chrono::milliseconds(3000);
 
+// Maximum number of buffers gathered into a single send call
+constexpr size_t MAX_SEND_BUFFERS = 64;
+
+// How often a poller that cannot wait for sockets to become readable reports them all as ready
+constexpr auto ALL_READY_POLL_INTERVAL = std::chrono::milliseconds(10);
+
 #ifdef _WIN32
     static bool _wsaInitialised = false;
 #endif
@@ -375,6 +390,69 @@ public:
         return totalSent;
     }
 
+    size_t SendData(const TcpSocketBuffer * buffers, size_t count) override
+    {
+        if (_status != SOCKET_STATUS_CONNECTED)
+        {
+            throw Exception("Socket not connected.");
+        }
+
+        size_t totalSent = 0;
+        size_t bufferIndex = 0;
+        size_t bufferOffset = 0;
+        while (bufferIndex < count)
+        {
+            // Gather the unsent part of the buffers, starting part way through the first one
+#ifdef _WIN32
+            WSABUF sendBuffers[MAX_SEND_BUFFERS];
+#else
+            iovec sendBuffers[MAX_SEND_BUFFERS];
+#endif
+            size_t numSendBuffers = 0;
+            for (size_t i = bufferIndex; i < count && numSendBuffers < MAX_SEND_BUFFERS; i++)
+            {
+                size_t offset = (i == bufferIndex) ? bufferOffset : 0;
+#ifdef _WIN32
+                sendBuffers[numSendBuffers].buf = (CHAR *)buffers[i].Data + offset;
+                sendBuffers[numSendBuffers].len = (ULONG)(buffers[i].Length - offset);
+#else
+                sendBuffers[numSendBuffers].iov_base = (uint8 *)buffers[i].Data + offset;
+                sendBuffers[numSendBuffers].iov_len = buffers[i].Length - offset;
+#endif
+                numSendBuffers++;
+            }
+
+#ifdef _WIN32
+            DWORD sentBytes;
+            if (WSASend(_socket, sendBuffers, (DWORD)numSendBuffers, &sentBytes, 0, nullptr, nullptr) == SOCKET_ERROR)
+            {
+                return totalSent;
+            }
+#else
+            msghdr message = {};
+            message.msg_iov = sendBuffers;
+            message.msg_iovlen = numSendBuffers;
+            ssize_t sentBytes = sendmsg(_socket, &message, FLAG_NO_PIPE);
+            if (sentBytes == SOCKET_ERROR)
+            {
+                return totalSent;
+            }
+#endif
+            totalSent += sentBytes;
+
+            // Move past the buffers that were completely sent
+            size_t remainingSent = sentBytes;
+            while (bufferIndex < count && remainingSent >= buffers[bufferIndex].Length - bufferOffset)
+            {
+                remainingSent -= buffers[bufferIndex].Length - bufferOffset;
+                bufferIndex++;
+                bufferOffset = 0;
+            }
+            bufferOffset += remainingSent;
+        }
+        return totalSent;
+    }
+
     NETWORK_READPACKET ReceiveData(void * buffer, size_t size, size_t * sizeReceived) override
     {
         if (_status != SOCKET_STATUS_CONNECTED)
@@ -421,6 +499,11 @@ public:
         return _hostName.empty() ? nullptr : _hostName.c_str();
     }
 
+    SOCKET GetSocket() const
+    {
+        return _socket;
+    }
+
 private:
     explicit TcpSocket(SOCKET socket)
     {
@@ -487,11 +570,167 @@ private:
     }
 };
 
+#ifdef __linux__
+class EpollTcpSocketPoller final : public ITcpSocketPoller
+{
+private:
+    sint32                      _epoll          = -1;
+    sint32                      _wakeEvent      = -1;
+    size_t                      _numSockets     = 0;
+    std::vector<epoll_event>    _events;
+    std::vector<void *>         _ready;
+
+public:
+    EpollTcpSocketPoller()
+    {
+        _epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (_epoll == -1)
+        {
+            throw SocketException("Unable to create epoll instance.");
+        }
+
+        _wakeEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = this;
+        if (_wakeEvent == -1 || epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeEvent, &ev) == -1)
+        {
+            if (_wakeEvent != -1)
+            {
+                close(_wakeEvent);
+            }
+            close(_epoll);
+            throw SocketException("Unable to create epoll wake event.");
+        }
+    }
+
+    ~EpollTcpSocketPoller() override
+    {
+        close(_wakeEvent);
+        close(_epoll);
+    }
+
+    void Add(ITcpSocket * socket, void * userData) override
+    {
+        epoll_event ev = {};
+        // Level triggered, so a socket stays ready until everything waiting on it has been read
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = userData;
+        if (epoll_ctl(_epoll, EPOLL_CTL_ADD, static_cast<TcpSocket *>(socket)->GetSocket(), &ev) == -1)
+        {
+            throw SocketException("Unable to add socket to epoll instance.");
+        }
+        _numSockets++;
+    }
+
+    void Remove(ITcpSocket * socket) override
+    {
+        // Closed sockets have already been removed by the kernel
+        if (epoll_ctl(_epoll, EPOLL_CTL_DEL, static_cast<TcpSocket *>(socket)->GetSocket(), nullptr) == 0)
+        {
+            _numSockets--;
+        }
+    }
+
+    const std::vector<void *> & Poll(uint32 timeoutMs) override
+    {
+        _events.resize(_numSockets + 1);
+        sint32 numEvents = epoll_wait(_epoll, _events.data(), (sint32)_events.size(), (sint32)timeoutMs);
+        _ready.clear();
+        for (sint32 i = 0; i < numEvents; i++)
+        {
+            if (_events[i].data.ptr == this)
+            {
+                uint64 count;
+                UNUSED_ATTR ssize_t readBytes = read(_wakeEvent, &count, sizeof(count));
+            }
+            else
+            {
+                _ready.push_back(_events[i].data.ptr);
+            }
+        }
+        return _ready;
+    }
+
+    void Wake() override
+    {
+        uint64 count = 1;
+        UNUSED_ATTR ssize_t writtenBytes = write(_wakeEvent, &count, sizeof(count));
+    }
+};
+#endif
+
+/**
+ * Reports every socket as ready, for platforms without a poller implementation. As it cannot tell when data
+ * arrives it waits at most ALL_READY_POLL_INTERVAL between polls.
+ */
+class AllReadyTcpSocketPoller final : public ITcpSocketPoller
+{
+private:
+    std::vector<ITcpSocket *>   _sockets;
+    std::vector<void *>         _ready;
+
+    std::mutex                  _wakeMutex;
+    std::condition_variable     _wakeCondition;
+    bool                        _woken = false;
+
+public:
+    void Add(ITcpSocket * socket, void * userData) override
+    {
+        _sockets.push_back(socket);
+        _ready.push_back(userData);
+    }
+
+    void Remove(ITcpSocket * socket) override
+    {
+        for (size_t i = 0; i < _sockets.size(); i++)
+        {
+            if (_sockets[i] == socket)
+            {
+                _sockets.erase(_sockets.begin() + i);
+                _ready.erase(_ready.begin() + i);
+                break;
+            }
+        }
+    }
+
+    const std::vector<void *> & Poll(uint32 timeoutMs) override
+    {
+        auto timeout = std::min(std::chrono::milliseconds(timeoutMs), ALL_READY_POLL_INTERVAL);
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _wakeCondition.wait_for(lock, timeout, [this] { return _woken; });
+        _woken = false;
+        return _ready;
+    }
+
+    void Wake() override
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _woken = true;
+        _wakeCondition.notify_one();
+    }
+};
+
 ITcpSocket * CreateTcpSocket()
 {
     return new TcpSocket();
 }
 
+ITcpSocketPoller * CreateTcpSocketPoller()
+{
+#ifdef __linux__
+    try
+    {
+        return new EpollTcpSocketPoller();
+    }
+    catch (const SocketException &ex)
+    {
+        log_warning("%s Reading every socket instead.", ex.GetMessage());
+    }
+#endif
+    return new AllReadyTcpSocketPoller();
+}
+
 bool InitialiseWSA()
 {
 #ifdef _WIN32
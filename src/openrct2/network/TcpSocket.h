@@ -18,6 +18,7 @@
 
 #ifdef __cplusplus
 
+#include <vector>
 #include "../common.h"
 
 enum SOCKET_STATUS
@@ -37,6 +38,15 @@ enum NETWORK_READPACKET
     NETWORK_READPACKET_DISCONNECTED
 };
 
+/**
+ * A block of memory passed to ITcpSocket::SendData, so that several can be sent with one call.
+ */
+struct TcpSocketBuffer
+{
+    const void *    Data;
+    size_t          Length;
+};
+
 /**
  * Represents a TCP socket / connection or listener.
  */
@@ -57,14 +67,51 @@ public:
     virtual void ConnectAsync(const char * address, uint16 port) abstract;
 
     virtual size_t             SendData(const void * buffer, size_t size)                     abstract;
+    /**
+     * Sends the buffers in order as one stream, gathering them into as few calls as possible. Returns the
+     * number of bytes sent, which is less than their total length if the socket would block.
+     */
+    virtual size_t             SendData(const TcpSocketBuffer * buffers, size_t count)        abstract;
     virtual NETWORK_READPACKET ReceiveData(void * buffer, size_t size, size_t * sizeReceived) abstract;
 
     virtual void Disconnect() abstract;
     virtual void Close() abstract;
 };
 
+/**
+ * Reports which of a set of sockets have data waiting to be read, or for a listening socket, a connection
+ * waiting to be accepted.
+ */
+interface ITcpSocketPoller
+{
+public:
+    virtual ~ITcpSocketPoller() { }
+
+    /**
+     * Adds a socket to the set. userData is what Poll returns to identify the socket when it is ready.
+     */
+    virtual void Add(ITcpSocket * socket, void * userData) abstract;
+    virtual void Remove(ITcpSocket * socket) abstract;
+
+    /**
+     * Waits up to timeoutMs for any of the sockets to become ready and returns the user data of those that are.
+     */
+    virtual const std::vector<void *> & Poll(uint32 timeoutMs) abstract;
+
+    /**
+     * Makes a Poll in progress on another thread return straight away. Can be called from any thread.
+     */
+    virtual void Wake() abstract;
+};
+
 ITcpSocket * CreateTcpSocket();
 
+/**
+ * Creates an epoll based poller on Linux. Elsewhere the poller waits a short interval and then reports every
+ * socket as ready, leaving it to the reads to find which have data.
+ */
+ITcpSocketPoller * CreateTcpSocketPoller();
+
 bool InitialiseWSA();
 void DisposeWSA();
 
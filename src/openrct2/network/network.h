@@ -51,12 +51,13 @@ typedef struct GameAction GameAction;
 // This define specifies which version of network stream current build uses.
 // It is used for making sure only compatible builds get connected, even within
 // single OpenRCT2 version.
-#define NETWORK_STREAM_VERSION "24"
+#define NETWORK_STREAM_VERSION "29"
 #define NETWORK_STREAM_ID OPENRCT2_VERSION "-" NETWORK_STREAM_VERSION
 
 #ifdef __cplusplus
 
 #include <array>
+#include <deque>
 #include <list>
 #include <set>
 #include <memory>
@@ -64,14 +65,17 @@ typedef struct GameAction GameAction;
 #include <vector>
 #include <functional>
 #include <map>
-#include <openssl/evp.h>
 #include "../actions/GameAction.h"
 #include "../core/Json.hpp"
 #include "../core/Nullable.hpp"
 #include "../core/MemoryStream.h"
+#include "DesyncReport.h"
+#include "GameStateSnapshot.h"
 #include "NetworkConnection.h"
 #include "NetworkGroup.h"
+#include "NetworkIOThread.h"
 #include "NetworkKey.h"
+#include "NetworkMapStream.h"
 #include "NetworkPacket.h"
 #include "NetworkPlayer.h"
 #include "NetworkServerAdvertiser.h"
@@ -80,6 +84,7 @@ typedef struct GameAction GameAction;
 
 enum {
     NETWORK_TICK_FLAG_CHECKSUMS = 1 << 0,
+    NETWORK_TICK_FLAG_SUBSYSTEM_CHECKSUMS = 1 << 1,
 };
 
 struct ObjectRepositoryItem;
@@ -138,6 +143,9 @@ public:
     void AppendServerLog(const std::string &s);
     void CloseServerLog();
 
+    void BeginDesyncReport(uint32 tick);
+    void WriteDesyncReport();
+
     void Client_Send_TOKEN();
     void Client_Send_AUTH(const char* name, const char* password, const char *pubkey, const char *sig, size_t sigsize);
     void Server_Send_AUTH(NetworkConnection& connection);
@@ -163,6 +171,8 @@ public:
     void Client_Send_GAMEINFO();
     void Client_Send_OBJECTS(const std::vector<std::string> &objects);
     void Server_Send_OBJECTS(NetworkConnection& connection, const std::vector<const ObjectRepositoryItem *> &objects) const;
+    void Client_Send_GAMESTATE();
+    void Server_Send_GAMESTATE(NetworkConnection& connection, uint32 tick, sint32 subsystem, bool available, const std::map<uint32, const GameStateEntity *> &entities);
 
     std::vector<std::unique_ptr<NetworkPlayer>> player_list;
     std::vector<std::unique_ptr<NetworkGroup>> group_list;
@@ -191,7 +201,16 @@ private:
     void SetupDefaultGroups();
 
     bool LoadMap(IStream * stream);
-    bool SaveMap(IStream * stream, const std::vector<const ObjectRepositoryItem *> &objects) const;
+    std::unique_ptr<NetworkMapEncoder> SaveMap(const std::vector<const ObjectRepositoryItem *> &objects, NETWORK_MAP_CODEC codec) const;
+    void UpdateMapStreams(bool wait);
+    bool IsStreamingMap(const NetworkConnection * connection) const;
+
+    struct MapStream
+    {
+        std::unique_ptr<NetworkMapEncoder>  Encoder;
+        std::vector<NetworkConnection *>    Connections;
+        uint32                              Offset = 0;
+    };
 
     struct GameCommand
     {
@@ -230,6 +249,7 @@ private:
     bool _requireClose = false;
     bool wsa_initialized = false;
     ITcpSocket * listening_socket = nullptr;
+    NetworkIOThread * _ioThread = nullptr;
     uint16 listening_port = 0;
     NetworkConnection * server_connection = nullptr;
     SOCKET_STATUS _lastConnectStatus = SOCKET_STATUS_CLOSED;
@@ -238,11 +258,14 @@ private:
     uint32 server_tick = 0;
     uint32 server_srand0 = 0;
     uint32 server_srand0_tick = 0;
-    char server_sprite_hash[EVP_MAX_MD_SIZE + 1];
+    uint64 server_checksum = 0;
+    bool server_checksum_received = false;
+    std::vector<uint64> server_subsystem_checksums;
     uint8 player_id = 0;
     std::list<std::unique_ptr<NetworkConnection>> client_connection_list;
     std::multiset<GameCommand> game_command_queue;
-    std::vector<uint8> chunk_buffer;
+    std::list<MapStream> _mapStreams;
+    std::unique_ptr<NetworkMapDecoder> _mapDecoder;
     std::string _password;
     bool _desynchronised = false;
     INetworkServerAdvertiser * _advertiser = nullptr;
@@ -255,6 +278,12 @@ private:
     std::string _chatLogFilenameFormat = "%Y%m%d-%H%M%S.txt";
     std::string _serverLogPath;
     std::string _serverLogFilenameFormat = "%Y%m%d-%H%M%S.txt";
+    std::string _desyncReportFilenameFormat = "desync_%Y%m%d-%H%M%S.txt";
+    std::deque<std::unique_ptr<GameStateSnapshot>> _gameStateSnapshots;
+    std::unique_ptr<DesyncReport> _desyncReport;
+    uint32 _desyncReportPendingReplies = 0;
+    uint32 _desyncReportDeadline = 0;
+    bool _closeAfterDesyncReport = false;
     OpenRCT2::IPlatformEnvironment * _env = nullptr;
 
     void UpdateServer();
@@ -288,8 +317,8 @@ private:
     void Server_Handle_TOKEN(NetworkConnection& connection, NetworkPacket& packet);
     void Client_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket& packet);
     void Server_Handle_OBJECTS(NetworkConnection& connection, NetworkPacket& packet);
-
-    uint8 * save_for_network(size_t &out_size, const std::vector<const ObjectRepositoryItem *> &objects) const;
+    void Client_Handle_GAMESTATE(NetworkConnection& connection, NetworkPacket& packet);
+    void Server_Handle_GAMESTATE(NetworkConnection& connection, NetworkPacket& packet);
 };
 
 #endif // __cplusplus
@@ -19,17 +19,38 @@
 #include "../localisation/localisation.h"
 #include "../config/Config.h"
 #include "../interface/viewport.h"
+#include "../core/JobPool.hpp"
 #include "../core/Math.hpp"
+#include "../drawing/lightfx.h"
 #include "tile_element/TileElement.h"
 #include "sprite/Sprite.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 // Global for paint clipping height
 uint8 gClipHeight = 128; // Default to middle value
 
-paint_session gPaintSession;
-static bool _paintSessionInUse;
+// Sessions are recycled rather than freed as each one holds several hundred kilobytes of paint structs
+static std::mutex _paintSessionPoolMutex;
+static std::vector<paint_session *> _freePaintSessions;
+
+static std::unique_ptr<JobPool> _paintJobs;
+static std::mutex _paintSharedStateMutex;
+
+// Only toggled between frames, the totals are updated from every paint thread
+static bool _paintProfileEnabled = false;
+static std::atomic<uint64> _paintProfileGenerateTime;
+static std::atomic<uint64> _paintProfileArrangeTime;
+static std::atomic<uint64> _paintProfileDrawTime;
+static std::atomic<uint64> _paintProfilePaintStructCount;
+static std::atomic<uint32> _paintProfileSessionCount;
+static std::atomic<uint32> _paintProfileFullSessionCount;
+static std::atomic<uint32> _paintProfileMaxSessionPaintStructs;
 
 static const uint8 BoundBoxDebugColours[] =
 {
@@ -51,17 +72,27 @@ static const uint8 BoundBoxDebugColours[] =
 bool gShowDirtyVisuals;
 bool gPaintBoundingBoxes;
 
-static void paint_session_init(paint_session * session, rct_drawpixelinfo * dpi);
+static void paint_session_init(paint_session * session, rct_drawpixelinfo * dpi, uint32 viewFlags);
 static void paint_attached_ps(rct_drawpixelinfo * dpi, paint_struct * ps, uint32 viewFlags);
 static void paint_ps_image_with_bounding_boxes(rct_drawpixelinfo * dpi, paint_struct * ps, uint32 imageId, sint16 x, sint16 y);
 static void paint_ps_image(rct_drawpixelinfo * dpi, paint_struct * ps, uint32 imageId, sint16 x, sint16 y);
 static uint32 paint_ps_colourify_image(uint32 imageId, uint8 spriteType, uint32 viewFlags);
+static void paint_draw_struct_list(rct_drawpixelinfo * dpi, paint_struct * ps, uint32 viewFlags);
+static void paint_session_generate_and_arrange(paint_session * session);
 
-static void paint_session_init(paint_session * session, rct_drawpixelinfo * dpi)
+static void paint_session_init(paint_session * session, rct_drawpixelinfo * dpi, uint32 viewFlags)
 {
-    session->Unk140E9A8 = dpi;
-    session->EndOfPaintStructArray = &session->PaintStructs[4000 - 1];
-    session->NextFreePaintStruct = session->PaintStructs;
+    session->DPI = *dpi;
+    session->Unk140E9A8 = &session->DPI;
+    session->ViewFlags = viewFlags;
+    if (session->PaintEntryBlocks == nullptr)
+    {
+        session->PaintEntryBlocks = new paint_entry_block();
+    }
+    session->CurrentPaintEntryBlock = session->PaintEntryBlocks;
+    session->CurrentPaintEntryBlockIndex = 0;
+    session->NextFreePaintStruct = session->PaintEntryBlocks->Entries;
+    session->EndOfPaintStructArray = session->PaintEntryBlocks->Entries + PAINT_ENTRY_BLOCK_SIZE;
     session->UnkF1AD28 = nullptr;
     session->UnkF1AD2C = nullptr;
     for (auto &quadrant : session->Quadrants)
@@ -75,6 +106,44 @@ static void paint_session_init(paint_session * session, rct_drawpixelinfo * dpi)
     session->WoodenSupportsPrependTo = nullptr;
     session->CurrentlyDrawnItem = nullptr;
     session->SurfaceElement = nullptr;
+    session->PaintHead = { 0 };
+}
+
+/**
+ * Moves on to the session's next block of paint entries, allocating it the first time a frame needs it. Blocks are
+ * kept with the session afterwards so it does not allocate again once it has grown to fit the scene.
+ */
+static bool paint_session_next_entry_block(paint_session * session)
+{
+    if (session->CurrentPaintEntryBlockIndex + 1 >= PAINT_ENTRY_MAX_BLOCKS)
+    {
+        return false;
+    }
+
+    paint_entry_block * block = session->CurrentPaintEntryBlock;
+    if (block->Next == nullptr)
+    {
+        block->Next = new paint_entry_block();
+    }
+    session->CurrentPaintEntryBlock = block->Next;
+    session->CurrentPaintEntryBlockIndex++;
+    session->NextFreePaintStruct = block->Next->Entries;
+    session->EndOfPaintStructArray = block->Next->Entries + PAINT_ENTRY_BLOCK_SIZE;
+    return true;
+}
+
+/**
+ * Ensures NextFreePaintStruct points at a free entry. Returns false if the session has run out of blocks.
+ */
+static inline bool paint_session_reserve_entry(paint_session * session)
+{
+    return session->NextFreePaintStruct < session->EndOfPaintStructArray || paint_session_next_entry_block(session);
+}
+
+static uint32 paint_session_get_entry_count(const paint_session * session)
+{
+    uint32 usedInBlock = (uint32)(session->NextFreePaintStruct - session->CurrentPaintEntryBlock->Entries);
+    return (session->CurrentPaintEntryBlockIndex * PAINT_ENTRY_BLOCK_SIZE) + usedInBlock;
 }
 
 static void paint_session_add_ps_to_quadrant(paint_session * session, paint_struct * ps, sint32 positionHash)
@@ -93,7 +162,7 @@ static void paint_session_add_ps_to_quadrant(paint_session * session, paint_stru
 */
 static paint_struct * sub_9819_c(paint_session * session, uint32 image_id, LocationXYZ16 offset, LocationXYZ16 boundBoxSize, LocationXYZ16 boundBoxOffset, uint8 rotation)
 {
-    if (session->NextFreePaintStruct >= session->EndOfPaintStructArray) return nullptr;
+    if (!paint_session_reserve_entry(session)) return nullptr;
     auto g1 = gfx_get_g1_element(image_id & 0x7FFFF);
     if (g1 == nullptr)
     {
@@ -165,13 +234,13 @@ static paint_struct * sub_9819_c(paint_session * session, uint32 image_id, Locat
         break;
     }
 
-    ps->bound_box_x_end = boundBoxSize.x + boundBoxOffset.x + session->SpritePosition.x;
-    ps->bound_box_z = boundBoxOffset.z;
-    ps->bound_box_z_end = boundBoxOffset.z + boundBoxSize.z;
-    ps->bound_box_y_end = boundBoxSize.y + boundBoxOffset.y + session->SpritePosition.y;
+    ps->bounds.x_end = boundBoxSize.x + boundBoxOffset.x + session->SpritePosition.x;
+    ps->bounds.z = boundBoxOffset.z;
+    ps->bounds.z_end = boundBoxOffset.z + boundBoxSize.z;
+    ps->bounds.y_end = boundBoxSize.y + boundBoxOffset.y + session->SpritePosition.y;
     ps->flags = 0;
-    ps->bound_box_x = boundBoxOffset.x + session->SpritePosition.x;
-    ps->bound_box_y = boundBoxOffset.y + session->SpritePosition.y;
+    ps->bounds.x = boundBoxOffset.x + session->SpritePosition.x;
+    ps->bounds.y = boundBoxOffset.y + session->SpritePosition.y;
     ps->attached_ps = nullptr;
     ps->var_20 = nullptr;
     ps->sprite_type = session->InteractionType;
@@ -295,11 +364,11 @@ void paint_session_generate(paint_session * session)
     }
 }
 
-static bool is_bbox_intersecting(uint8 rotation, const paint_struct_bound_box& initialBBox,
-    const paint_struct_bound_box& currentBBox)
+template<uint8 TRotation>
+static bool is_bbox_intersecting(const paint_struct_bound_box& initialBBox, const paint_struct_bound_box& currentBBox)
 {
     bool result = false;
-    switch (rotation) {
+    switch (TRotation) {
     case 0:
         if (initialBBox.z_end >= currentBBox.z && initialBBox.y_end >= currentBBox.y && initialBBox.x_end >= currentBBox.x
             && !(initialBBox.z < currentBBox.z_end && initialBBox.y < currentBBox.y_end && initialBBox.x < currentBBox.x_end))
@@ -324,10 +393,77 @@ static bool is_bbox_intersecting(uint8 rotation, const paint_struct_bound_box& i
     return result;
 }
 
+/**
+ * The paint structs of the two quadrants being arranged, copied out of the linked list so the sort scans
+ * contiguous bounding boxes and flags rather than following next_quadrant_ps through every paint struct.
+ * Reused between calls on the same thread to avoid allocating.
+ */
+struct paint_arrange_window
+{
+    std::vector<paint_struct *>         Structs;
+    std::vector<paint_struct_bound_box> Bounds;
+    std::vector<uint8>                  Flags;
+};
+
+static thread_local paint_arrange_window _paintArrangeWindow;
+
+/**
+ * Moves the element at index from to index to (to < from), shifting the elements in between up by one. This is
+ * the array equivalent of unlinking a paint struct and inserting it further back in the list.
+ */
+template<typename T>
+static void paint_arrange_move_back(std::vector<T> &items, size_t from, size_t to)
+{
+    std::rotate(items.begin() + to, items.begin() + from, items.begin() + from + 1);
+}
+
+template<uint8 TRotation>
+static void paint_arrange_window_sort(paint_arrange_window &window)
+{
+    std::vector<paint_struct *> &structs = window.Structs;
+    std::vector<paint_struct_bound_box> &bounds = window.Bounds;
+    std::vector<uint8> &flags = window.Flags;
+    size_t count = structs.size();
+
+    // Each index is the position in the window, the paint struct before the window is position 0
+    size_t first = 1;
+    while (true)
+    {
+        size_t next = first;
+        while (next < count && !(flags[next] & PAINT_QUADRANT_FLAG_IDENTICAL))
+        {
+            next++;
+        }
+        if (next >= count)
+        {
+            return;
+        }
+
+        flags[next] &= ~PAINT_QUADRANT_FLAG_IDENTICAL;
+        size_t insertAt = next;
+        const paint_struct_bound_box initialBBox = bounds[next];
+
+        for (size_t current = next + 1; current < count; current++)
+        {
+            if (!(flags[current] & PAINT_QUADRANT_FLAG_NEXT))
+            {
+                continue;
+            }
+            if (is_bbox_intersecting<TRotation>(initialBBox, bounds[current]))
+            {
+                paint_arrange_move_back(structs, current, insertAt);
+                paint_arrange_move_back(bounds, current, insertAt);
+                paint_arrange_move_back(flags, current, insertAt);
+            }
+        }
+
+        first = insertAt;
+    }
+}
+
 paint_struct * paint_arrange_structs_helper(paint_struct * ps_next, uint16 quadrantIndex, uint8 flag)
 {
     paint_struct * ps;
-    paint_struct * ps_temp;
     do
     {
         ps = ps_next;
@@ -338,7 +474,15 @@ paint_struct * paint_arrange_structs_helper(paint_struct * ps_next, uint16 quadr
     // Cache the last visited node so we don't have to walk the whole list again
     paint_struct * ps_cache = ps;
 
-    ps_temp = ps;
+    paint_arrange_window &window = _paintArrangeWindow;
+    window.Structs.clear();
+    window.Bounds.clear();
+    window.Flags.clear();
+    window.Structs.push_back(ps_cache);
+    window.Bounds.push_back(ps_cache->bounds);
+    window.Flags.push_back(0);
+
+    // Flag the paint structs of this quadrant and the next, the sort never looks beyond a bigger quadrant
     do {
         ps = ps->next_quadrant_ps;
         if (ps == nullptr) break;
@@ -356,66 +500,41 @@ paint_struct * paint_arrange_structs_helper(paint_struct * ps_next, uint16 quadr
             ps->quadrant_flags = flag | PAINT_QUADRANT_FLAG_IDENTICAL;
         }
     } while (ps->quadrant_index <= quadrantIndex + 1);
-    ps = ps_temp;
 
-    uint8 rotation = get_current_rotation();
-    while (true)
+    paint_struct * ps_end = ps_cache->next_quadrant_ps;
+    while (ps_end != nullptr && !(ps_end->quadrant_flags & PAINT_QUADRANT_FLAG_BIGGER))
     {
-        while (true)
-        {
-            ps_next = ps->next_quadrant_ps;
-            if (ps_next == nullptr) return ps_cache;
-            if (ps_next->quadrant_flags & PAINT_QUADRANT_FLAG_BIGGER) return ps_cache;
-            if (ps_next->quadrant_flags & PAINT_QUADRANT_FLAG_IDENTICAL) break;
-            ps = ps_next;
-        }
-
-        ps_next->quadrant_flags &= ~PAINT_QUADRANT_FLAG_IDENTICAL;
-        ps_temp = ps;
-
-        const paint_struct_bound_box initialBBox =
-        {
-            ps_next->bound_box_x,
-            ps_next->bound_box_y,
-            ps_next->bound_box_z,
-            ps_next->bound_box_x_end,
-            ps_next->bound_box_y_end,
-            ps_next->bound_box_z_end
-        };
-
-
-        while (true)
-        {
-            ps = ps_next;
-            ps_next = ps_next->next_quadrant_ps;
-            if (ps_next == nullptr) break;
-            if (ps_next->quadrant_flags & PAINT_QUADRANT_FLAG_BIGGER) break;
-            if (!(ps_next->quadrant_flags & PAINT_QUADRANT_FLAG_NEXT)) continue;
-
-            const paint_struct_bound_box currentBBox =
-            {
-                ps_next->bound_box_x,
-                ps_next->bound_box_y,
-                ps_next->bound_box_z,
-                ps_next->bound_box_x_end,
-                ps_next->bound_box_y_end,
-                ps_next->bound_box_z_end
-            };
-
-            bool compareResult = is_bbox_intersecting(rotation, initialBBox, currentBBox);
+        window.Structs.push_back(ps_end);
+        window.Bounds.push_back(ps_end->bounds);
+        window.Flags.push_back(ps_end->quadrant_flags);
+        ps_end = ps_end->next_quadrant_ps;
+    }
 
-            if (compareResult)
-            {
-                ps->next_quadrant_ps = ps_next->next_quadrant_ps;
-                paint_struct *ps_temp2 = ps_temp->next_quadrant_ps;
-                ps_temp->next_quadrant_ps = ps_next;
-                ps_next->next_quadrant_ps = ps_temp2;
-                ps_next = ps;
-            }
-        }
+    switch (get_current_rotation())
+    {
+    case 0:
+        paint_arrange_window_sort<0>(window);
+        break;
+    case 1:
+        paint_arrange_window_sort<1>(window);
+        break;
+    case 2:
+        paint_arrange_window_sort<2>(window);
+        break;
+    case 3:
+        paint_arrange_window_sort<3>(window);
+        break;
+    }
 
-        ps = ps_temp;
+    // Relink the list in the sorted order
+    size_t count = window.Structs.size();
+    for (size_t i = 1; i < count; i++)
+    {
+        window.Structs[i - 1]->next_quadrant_ps = window.Structs[i];
+        window.Structs[i]->quadrant_flags = window.Flags[i];
     }
+    window.Structs[count - 1]->next_quadrant_ps = ps_end;
+    return ps_cache;
 }
 
 /**
@@ -460,6 +579,20 @@ paint_struct paint_session_arrange(paint_session * session)
 *  rct2: 0x00688485
 */
 void paint_draw_structs(rct_drawpixelinfo * dpi, paint_struct * ps, uint32 viewFlags)
+{
+    if (!_paintProfileEnabled)
+    {
+        paint_draw_struct_list(dpi, ps, viewFlags);
+        return;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    paint_draw_struct_list(dpi, ps, viewFlags);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    _paintProfileDrawTime += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+}
+
+static void paint_draw_struct_list(rct_drawpixelinfo * dpi, paint_struct * ps, uint32 viewFlags)
 {
     paint_struct* previous_ps = ps->next_quadrant_ps;
     for (ps = ps->next_quadrant_ps; ps;)
@@ -536,65 +669,65 @@ static void paint_ps_image_with_bounding_boxes(rct_drawpixelinfo * dpi, paint_st
 
     const LocationXYZ16 frontTop =
     {
-        (sint16)ps->bound_box_x_end,
-        (sint16)ps->bound_box_y_end,
-        (sint16)ps->bound_box_z_end
+        (sint16)ps->bounds.x_end,
+        (sint16)ps->bounds.y_end,
+        (sint16)ps->bounds.z_end
     };
     const LocationXY16 screenCoordFrontTop = coordinate_3d_to_2d(&frontTop, rotation);
 
     const LocationXYZ16 frontBottom =
     {
-        (sint16)ps->bound_box_x_end,
-        (sint16)ps->bound_box_y_end,
-        (sint16)ps->bound_box_z
+        (sint16)ps->bounds.x_end,
+        (sint16)ps->bounds.y_end,
+        (sint16)ps->bounds.z
     };
     const LocationXY16 screenCoordFrontBottom = coordinate_3d_to_2d(&frontBottom, rotation);
 
     const LocationXYZ16 leftTop =
     {
-        (sint16)ps->bound_box_x,
-        (sint16)ps->bound_box_y_end,
-        (sint16)ps->bound_box_z_end
+        (sint16)ps->bounds.x,
+        (sint16)ps->bounds.y_end,
+        (sint16)ps->bounds.z_end
     };
     const LocationXY16 screenCoordLeftTop = coordinate_3d_to_2d(&leftTop, rotation);
 
     const LocationXYZ16 leftBottom =
     {
-        (sint16)ps->bound_box_x,
-        (sint16)ps->bound_box_y_end,
-        (sint16)ps->bound_box_z
+        (sint16)ps->bounds.x,
+        (sint16)ps->bounds.y_end,
+        (sint16)ps->bounds.z
     };
     const LocationXY16 screenCoordLeftBottom = coordinate_3d_to_2d(&leftBottom, rotation);
 
     const LocationXYZ16 rightTop =
     {
-        (sint16)ps->bound_box_x_end,
-        (sint16)ps->bound_box_y,
-        (sint16)ps->bound_box_z_end
+        (sint16)ps->bounds.x_end,
+        (sint16)ps->bounds.y,
+        (sint16)ps->bounds.z_end
     };
     const LocationXY16 screenCoordRightTop = coordinate_3d_to_2d(&rightTop, rotation);
 
     const LocationXYZ16 rightBottom =
     {
-        (sint16)ps->bound_box_x_end,
-        (sint16)ps->bound_box_y,
-        (sint16)ps->bound_box_z
+        (sint16)ps->bounds.x_end,
+        (sint16)ps->bounds.y,
+        (sint16)ps->bounds.z
     };
     const LocationXY16 screenCoordRightBottom = coordinate_3d_to_2d(&rightBottom, rotation);
 
     const LocationXYZ16 backTop =
     {
-        (sint16)ps->bound_box_x,
-        (sint16)ps->bound_box_y,
-        (sint16)ps->bound_box_z_end
+        (sint16)ps->bounds.x,
+        (sint16)ps->bounds.y,
+        (sint16)ps->bounds.z_end
     };
     const LocationXY16 screenCoordBackTop = coordinate_3d_to_2d(&backTop, rotation);
 
     const LocationXYZ16 backBottom =
     {
-        (sint16)ps->bound_box_x,
-        (sint16)ps->bound_box_y,
-        (sint16)ps->bound_box_z
+        (sint16)ps->bounds.x,
+        (sint16)ps->bounds.y,
+        (sint16)ps->bounds.z
     };
     const LocationXY16 screenCoordBackBottom = coordinate_3d_to_2d(&backBottom, rotation);
 
@@ -690,6 +823,37 @@ static uint32 paint_ps_colourify_image(uint32 imageId, uint8 spriteType, uint32
     return imageId;
 }
 
+static void paint_session_generate_and_arrange(paint_session * session)
+{
+    if (!_paintProfileEnabled)
+    {
+        paint_session_generate(session);
+        session->PaintHead = paint_session_arrange(session);
+        return;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    paint_session_generate(session);
+    auto generatedTime = std::chrono::high_resolution_clock::now();
+    session->PaintHead = paint_session_arrange(session);
+    auto arrangedTime = std::chrono::high_resolution_clock::now();
+
+    uint32 numPaintStructs = paint_session_get_entry_count(session);
+    _paintProfileGenerateTime += std::chrono::duration_cast<std::chrono::nanoseconds>(generatedTime - startTime).count();
+    _paintProfileArrangeTime += std::chrono::duration_cast<std::chrono::nanoseconds>(arrangedTime - generatedTime).count();
+    _paintProfilePaintStructCount += numPaintStructs;
+    _paintProfileSessionCount++;
+    if (numPaintStructs >= PAINT_ENTRY_MAX_BLOCKS * PAINT_ENTRY_BLOCK_SIZE)
+    {
+        _paintProfileFullSessionCount++;
+    }
+    uint32 maxPaintStructs = _paintProfileMaxSessionPaintStructs;
+    while (numPaintStructs > maxPaintStructs &&
+           !_paintProfileMaxSessionPaintStructs.compare_exchange_weak(maxPaintStructs, numPaintStructs))
+    {
+    }
+}
+
 static void draw_pixel_info_crop_by_zoom(rct_drawpixelinfo *dpi)
 {
     sint32 zoom = dpi->zoom_level;
@@ -702,20 +866,119 @@ static void draw_pixel_info_crop_by_zoom(rct_drawpixelinfo *dpi)
 
 extern "C"
 {
-    paint_session * paint_session_alloc(rct_drawpixelinfo * dpi)
+    paint_session * paint_session_alloc(rct_drawpixelinfo * dpi, uint32 viewFlags)
     {
-        // Currently limited to just one session at a time
-        assert(!_paintSessionInUse);
-        _paintSessionInUse = true;
-        paint_session * session = &gPaintSession;
+        paint_session * session = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(_paintSessionPoolMutex);
+            if (!_freePaintSessions.empty())
+            {
+                session = _freePaintSessions.back();
+                _freePaintSessions.pop_back();
+            }
+        }
+        if (session == nullptr)
+        {
+            session = new paint_session();
+        }
 
-        paint_session_init(session, dpi);
+        paint_session_init(session, dpi, viewFlags);
         return session;
     }
 
     void paint_session_free(paint_session * session)
     {
-        _paintSessionInUse = false;
+        std::lock_guard<std::mutex> lock(_paintSessionPoolMutex);
+        _freePaintSessions.push_back(session);
+    }
+
+    bool paint_is_multithreaded()
+    {
+        if (!gConfigGeneral.multithreading)
+        {
+            return false;
+        }
+#ifdef __ENABLE_LIGHTFX__
+        // The light list is shared by every session
+        if (lightfx_is_available())
+        {
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    /**
+     * Generates and arranges the paint structs of each session, storing the result in PaintHead.
+     * Sessions are independent of each other so they are spread across the paint job pool when
+     * multithreaded rendering is enabled. Drawing is left to the caller as it is not thread safe.
+     */
+    void paint_sessions_generate_and_arrange(paint_session ** sessions, size_t count)
+    {
+        if (count > 1 && paint_is_multithreaded())
+        {
+            if (_paintJobs == nullptr)
+            {
+                _paintJobs = std::make_unique<JobPool>();
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                paint_session * session = sessions[i];
+                _paintJobs->AddTask([session]() -> void
+                {
+                    paint_session_generate_and_arrange(session);
+                });
+            }
+            _paintJobs->Join();
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                paint_session_generate_and_arrange(sessions[i]);
+            }
+        }
+    }
+
+    void paint_profile_set_enabled(bool enabled)
+    {
+        _paintProfileEnabled = enabled;
+    }
+
+    void paint_profile_reset()
+    {
+        _paintProfileGenerateTime = 0;
+        _paintProfileArrangeTime = 0;
+        _paintProfileDrawTime = 0;
+        _paintProfilePaintStructCount = 0;
+        _paintProfileSessionCount = 0;
+        _paintProfileFullSessionCount = 0;
+        _paintProfileMaxSessionPaintStructs = 0;
+    }
+
+    void paint_profile_get(paint_profile * profile)
+    {
+        profile->generate_time = _paintProfileGenerateTime;
+        profile->arrange_time = _paintProfileArrangeTime;
+        profile->draw_time = _paintProfileDrawTime;
+        profile->paint_struct_count = _paintProfilePaintStructCount;
+        profile->session_count = _paintProfileSessionCount;
+        profile->full_session_count = _paintProfileFullSessionCount;
+        profile->max_session_paint_structs = _paintProfileMaxSessionPaintStructs;
+    }
+
+    /**
+     * Guards global state written while generating paint structs that is not owned by a session,
+     * i.e. the format arguments, the current font and the scrolling text cache used by signs.
+     */
+    void paint_lock_shared_state()
+    {
+        _paintSharedStateMutex.lock();
+    }
+
+    void paint_unlock_shared_state()
+    {
+        _paintSharedStateMutex.unlock();
     }
 
     /**
@@ -745,7 +1008,7 @@ extern "C"
         session->UnkF1AD28 = nullptr;
         session->UnkF1AD2C = nullptr;
 
-        if (session->NextFreePaintStruct >= session->EndOfPaintStructArray)
+        if (!paint_session_reserve_entry(session))
         {
             return nullptr;
         }
@@ -806,12 +1069,12 @@ extern "C"
         coord_3d.x += session->SpritePosition.x;
         coord_3d.y += session->SpritePosition.y;
 
-        ps->bound_box_x_end = coord_3d.x + boundBox.x;
-        ps->bound_box_y_end = coord_3d.y + boundBox.y;
+        ps->bounds.x_end = coord_3d.x + boundBox.x;
+        ps->bounds.y_end = coord_3d.y + boundBox.y;
 
         // TODO: check whether this is right. edx is ((bound_box_length_z + z_offset) << 16 | z_offset)
-        ps->bound_box_z = coord_3d.z;
-        ps->bound_box_z_end = (boundBox.z + coord_3d.z);
+        ps->bounds.z = coord_3d.z;
+        ps->bounds.z_end = (boundBox.z + coord_3d.z);
 
         LocationXY16 map = coordinate_3d_to_2d(&coord_3d, rotation);
 
@@ -832,8 +1095,8 @@ extern "C"
         if (bottom >= (dpi->y + dpi->height)) return nullptr;
 
         ps->flags = 0;
-        ps->bound_box_x = coord_3d.x;
-        ps->bound_box_y = coord_3d.y;
+        ps->bounds.x = coord_3d.x;
+        ps->bounds.y = coord_3d.y;
         ps->attached_ps = nullptr;
         ps->var_20 = nullptr;
         ps->sprite_type = session->InteractionType;
@@ -908,8 +1171,8 @@ extern "C"
 
         LocationXY16 attach =
         {
-            (sint16)ps->bound_box_x,
-            (sint16)ps->bound_box_y
+            (sint16)ps->bounds.x,
+            (sint16)ps->bounds.y
         };
 
         rotate_map_coordinates(&attach.x, &attach.y, rotation);
@@ -1053,7 +1316,7 @@ extern "C"
             return paint_attach_to_previous_ps(session, image_id, x, y);
         }
 
-        if (session->NextFreePaintStruct >= session->EndOfPaintStructArray)
+        if (!paint_session_reserve_entry(session))
         {
             return false;
         }
@@ -1085,7 +1348,7 @@ extern "C"
     */
     bool paint_attach_to_previous_ps(paint_session * session, uint32 image_id, uint16 x, uint16 y)
     {
-        if (session->NextFreePaintStruct >= session->EndOfPaintStructArray)
+        if (!paint_session_reserve_entry(session))
         {
             return false;
         }
@@ -1126,7 +1389,7 @@ extern "C"
     */
     void paint_floating_money_effect(paint_session * session, money32 amount, rct_string_id string_id, sint16 y, sint16 z, sint8 y_offsets[], sint16 offset_x, uint32 rotation)
     {
-        if (session->NextFreePaintStruct >= session->EndOfPaintStructArray)
+        if (!paint_session_reserve_entry(session))
         {
             return;
         }
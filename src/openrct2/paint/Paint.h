@@ -51,6 +51,16 @@ enum PAINT_QUADRANT_FLAGS {
     PAINT_QUADRANT_FLAG_NEXT = (1 << 1),
 };
 
+/* size 0x0C, kept together so the sort can read it with a single copy */
+typedef struct paint_struct_bound_box {
+    uint16 x;
+    uint16 y;
+    uint16 z;
+    uint16 x_end;
+    uint16 y_end;
+    uint16 z_end;
+} paint_struct_bound_box;
+
 /* size 0x34 */
 struct paint_struct {
     uint32 image_id;        // 0x00
@@ -59,12 +69,7 @@ struct paint_struct {
         // If masked image_id is masked_id
         uint32 colour_image_id; // 0x04
     };
-    uint16 bound_box_x;     // 0x08
-    uint16 bound_box_y;     // 0x0A
-    uint16 bound_box_z; // 0x0C
-    uint16 bound_box_z_end; // 0x0E
-    uint16 bound_box_x_end; // 0x10
-    uint16 bound_box_y_end; // 0x12
+    paint_struct_bound_box bounds; // 0x08
     uint16 x;               // 0x14
     uint16 y;               // 0x16
     uint16 quadrant_index;
@@ -114,15 +119,6 @@ typedef struct sprite_bb {
     LocationXYZ16 bb_size;
 } sprite_bb;
 
-typedef struct paint_struct_bound_box {
-    uint16 x;
-    uint16 y;
-    uint16 z;
-    uint16 x_end;
-    uint16 y_end;
-    uint16 z_end;
-} paint_struct_bound_box;
-
 enum PAINT_STRUCT_FLAGS {
     PAINT_STRUCT_FLAG_IS_MASKED = (1 << 0)
 };
@@ -141,10 +137,25 @@ typedef struct tunnel_entry {
 #define MAX_PAINT_QUADRANTS 512
 #define TUNNEL_MAX_COUNT    65
 
+// Paint structs are allocated from blocks of this many entries, a session adds blocks as it needs them
+#define PAINT_ENTRY_BLOCK_SIZE 1024
+// Limits a session to 64K paint structs, beyond that further structs are dropped
+#define PAINT_ENTRY_MAX_BLOCKS 64
+
+typedef struct paint_entry_block paint_entry_block;
+struct paint_entry_block {
+    paint_entry         Entries[PAINT_ENTRY_BLOCK_SIZE];
+    paint_entry_block * Next;
+};
+
 typedef struct paint_session
 {
+    rct_drawpixelinfo       DPI;
     rct_drawpixelinfo *     Unk140E9A8;
-    paint_entry             PaintStructs[4000];
+    uint32                  ViewFlags;
+    paint_entry_block *     PaintEntryBlocks;
+    paint_entry_block *     CurrentPaintEntryBlock;
+    uint32                  CurrentPaintEntryBlockIndex;
     paint_struct *          Quadrants[MAX_PAINT_QUADRANTS];
     uint32                  QuadrantBackIndex;
     uint32                  QuadrantFrontIndex;
@@ -174,9 +185,24 @@ typedef struct paint_session
     uint8                   Unk141E9DB;
     uint16                  Unk141E9DC;
     uint32                  TrackColours[4];
+    paint_struct            PaintHead;
 } paint_session;
 
-extern paint_session gPaintSession;
+/**
+ * Totals gathered by the paint functions while profiling is enabled. Times are in nanoseconds. Generating and
+ * arranging are summed over every session, so with multithreading they measure time across all paint threads
+ * rather than elapsed time. A session is full when it ran out of paint structs and dropped the rest.
+ */
+typedef struct paint_profile
+{
+    uint64 generate_time;
+    uint64 arrange_time;
+    uint64 draw_time;
+    uint64 paint_struct_count;
+    uint32 session_count;
+    uint32 full_session_count;
+    uint32 max_session_paint_structs;
+} paint_profile;
 
 #ifdef __cplusplus
 extern "C" {
@@ -205,14 +231,22 @@ bool paint_attach_to_previous_attach(paint_session * session, uint32 image_id, u
 bool paint_attach_to_previous_ps(paint_session * session, uint32 image_id, uint16 x, uint16 y);
 void paint_floating_money_effect(paint_session * session, money32 amount, rct_string_id string_id, sint16 y, sint16 z, sint8 y_offsets[], sint16 offset_x, uint32 rotation);
 
-paint_session * paint_session_alloc(rct_drawpixelinfo * dpi);
+paint_session * paint_session_alloc(rct_drawpixelinfo * dpi, uint32 viewFlags);
 void paint_session_free(paint_session *);
 void paint_session_generate(paint_session * session);
 paint_struct paint_session_arrange(paint_session * session);
+void paint_sessions_generate_and_arrange(paint_session ** sessions, size_t count);
+bool paint_is_multithreaded();
+void paint_lock_shared_state();
+void paint_unlock_shared_state();
 paint_struct * paint_arrange_structs_helper(paint_struct * ps_next, uint16 quadrantIndex, uint8 flag);
 void paint_draw_structs(rct_drawpixelinfo * dpi, paint_struct * ps, uint32 viewFlags);
 void paint_draw_money_structs(rct_drawpixelinfo * dpi, paint_string_struct * ps);
 
+void paint_profile_set_enabled(bool enabled);
+void paint_profile_reset();
+void paint_profile_get(paint_profile * profile);
+
 // TESTING
 #ifdef __TESTPAINT__
     void testpaint_clear_ignore();
@@ -347,7 +347,7 @@ bool wooden_a_supports_paint_setup(paint_session * session, sint32 supportType,
         *underground = false;
     }
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
+    if (session->ViewFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
         return false;
     }
 
@@ -492,7 +492,7 @@ bool wooden_b_supports_paint_setup(paint_session * session, sint32 supportType,
 {
     bool _9E32B1 = false;
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
+    if (session->ViewFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
         if (underground != NULL) *underground = false; // AND
         return false;
     }
@@ -679,7 +679,7 @@ bool metal_a_supports_paint_setup(paint_session * session, uint8 supportType, ui
 {
     support_height * supportSegments = session->SupportSegments;
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
+    if (session->ViewFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
         return false;
     }
 
@@ -871,7 +871,7 @@ bool metal_b_supports_paint_setup(paint_session * session, uint8 supportType, ui
     support_height * supportSegments = session->SupportSegments;
     uint8 originalSegment = segment;
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
+    if (session->ViewFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
         return false; // AND
     }
 
@@ -1053,7 +1053,7 @@ bool path_a_supports_paint_setup(paint_session * session, sint32 supportType, si
         *underground = false; // AND
     }
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
+    if (session->ViewFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
         return false;
     }
 
@@ -1222,7 +1222,7 @@ bool path_b_supports_paint_setup(paint_session * session, sint32 segment, sint32
 {
     support_height * supportSegments = session->SupportSegments;
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
+    if (session->ViewFlags & VIEWPORT_FLAG_INVISIBLE_SUPPORTS) {
         return false; // AND
     }
 
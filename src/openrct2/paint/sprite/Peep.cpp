@@ -64,7 +64,7 @@ void peep_paint(paint_session * session, rct_peep * peep, sint32 imageDirection)
         return;
     }
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_INVISIBLE_PEEPS) {
+    if (session->ViewFlags & VIEWPORT_FLAG_INVISIBLE_PEEPS) {
         return;
     }
 
@@ -37,7 +37,7 @@ void sprite_paint_setup(paint_session * session, const uint16 eax, const uint16
 
     if (gTrackDesignSaveMode) return;
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_INVISIBLE_SPRITES) return;
+    if (session->ViewFlags & VIEWPORT_FLAG_INVISIBLE_SPRITES) return;
 
     dpi = session->Unk140E9A8;
     if (dpi->zoom_level > 2) return;
@@ -50,7 +50,7 @@ void sprite_paint_setup(paint_session * session, const uint16 eax, const uint16
         // Here converting from land/path/etc height scale to pixel height scale.
         // Note: peeps/scenery on slopes will be above the base
         // height of the slope element, and consequently clipped.
-        if ((gCurrentViewportFlags & VIEWPORT_FLAG_PAINT_CLIP_TO_HEIGHT) && (spr->unknown.z > (gClipHeight * 8) )) continue;
+        if ((session->ViewFlags & VIEWPORT_FLAG_PAINT_CLIP_TO_HEIGHT) && (spr->unknown.z > (gClipHeight * 8) )) continue;
 
         dpi = session->Unk140E9A8;
 
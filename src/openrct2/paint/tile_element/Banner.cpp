@@ -93,6 +93,7 @@ void banner_paint(paint_session * session, uint8 direction, sint32 height, rct_t
 
     scrollingMode += direction;
 
+    paint_lock_shared_state();
     set_format_arg(0, uint32, 0);
     set_format_arg(4, uint32, 0);
 
@@ -114,4 +115,5 @@ void banner_paint(paint_session * session, uint8 direction, sint32 height, rct_t
     uint16 scroll = (gCurrentTicks / 2) % string_width;
 
     sub_98199C(session, scrolling_text_setup(session, string_id, scroll, scrollingMode), 0, 0, 1, 1, 0x15, height + 22, boundBoxOffsetX, boundBoxOffsetY, boundBoxOffsetZ, get_current_rotation());
+    paint_unlock_shared_state();
 }
@@ -26,8 +26,6 @@
 #include "TileElement.h"
 #include "../../drawing/lightfx.h"
 
-static uint32 _unk9E32BC;
-
 /**
  *
  *  rct2: 0x0066508C, 0x00665540
@@ -82,12 +80,12 @@ static void ride_entrance_exit_paint(paint_session * session, uint8 direction, s
     image_id = (colour_1 << 19) | (colour_2 << 24) | IMAGE_TYPE_REMAP | IMAGE_TYPE_REMAP_2_PLUS;
 
     session->InteractionType = VIEWPORT_INTERACTION_ITEM_RIDE;
-    _unk9E32BC = 0;
+    uint32 supportsImageId = 0;
 
     if (tile_element->flags & TILE_ELEMENT_FLAG_GHOST){
         session->InteractionType = VIEWPORT_INTERACTION_ITEM_NONE;
         image_id = CONSTRUCTION_MARKER;
-        _unk9E32BC = image_id;
+        supportsImageId = image_id;
         if (transparant_image_id)
             transparant_image_id = image_id;
     }
@@ -140,6 +138,7 @@ static void ride_entrance_exit_paint(paint_session * session, uint8 direction, s
         !(tile_element->flags & TILE_ELEMENT_FLAG_GHOST) &&
         tile_element->properties.entrance.ride_index != 0xFF){
 
+        paint_lock_shared_state();
         set_format_arg(0, uint32, 0);
         set_format_arg(4, uint32, 0);
 
@@ -167,9 +166,10 @@ static void ride_entrance_exit_paint(paint_session * session, uint8 direction, s
         uint16 scroll = (gCurrentTicks / 2) % string_width;
 
         sub_98199C(session, scrolling_text_setup(session, string_id, scroll, style->scrolling_mode), 0, 0, 0x1C, 0x1C, 0x33, height + style->height, 2, 2, height + style->height, get_current_rotation());
+        paint_unlock_shared_state();
     }
 
-    image_id = _unk9E32BC;
+    image_id = supportsImageId;
     if (image_id == 0) {
         image_id = SPRITE_ID_PALETTE_COLOUR_1(COLOUR_SATURATED_BROWN);
     }
@@ -196,12 +196,10 @@ static void park_entrance_paint(paint_session * session, uint8 direction, sint32
 #endif
 
     session->InteractionType = VIEWPORT_INTERACTION_ITEM_PARK;
-    _unk9E32BC = 0;
     uint32 image_id, ghost_id = 0;
     if (tile_element->flags & TILE_ELEMENT_FLAG_GHOST){
         session->InteractionType = VIEWPORT_INTERACTION_ITEM_NONE;
         ghost_id = CONSTRUCTION_MARKER;
-        _unk9E32BC = ghost_id;
     }
 
     rct_footpath_entry* path_entry = get_footpath_entry(tile_element->properties.entrance.path_type);
@@ -233,6 +231,7 @@ static void park_entrance_paint(paint_session * session, uint8 direction, sint32
             break;
 
         {
+            paint_lock_shared_state();
             rct_string_id park_text_id = STR_BANNER_TEXT_CLOSED;
             set_format_arg(0, uint32, 0);
             set_format_arg(4, uint32, 0);
@@ -256,12 +255,12 @@ static void park_entrance_paint(paint_session * session, uint8 direction, sint32
             uint16 string_width = gfx_get_string_width(park_name);
             uint16 scroll = (gCurrentTicks / 2) % string_width;
 
-            if (entrance->scrolling_mode == 0xFF)
-                break;
-
-            sint32 stsetup = scrolling_text_setup(session, park_text_id, scroll, entrance->scrolling_mode + direction / 2);
-            sint32 text_height = height + entrance->text_height;
-            sub_98199C(session, stsetup, 0, 0, 0x1C, 0x1C, 0x2F, text_height, 2, 2, text_height, get_current_rotation());
+            if (entrance->scrolling_mode != 0xFF) {
+                sint32 stsetup = scrolling_text_setup(session, park_text_id, scroll, entrance->scrolling_mode + direction / 2);
+                sint32 text_height = height + entrance->text_height;
+                sub_98199C(session, stsetup, 0, 0, 0x1C, 0x1C, 0x2F, text_height, 2, 2, text_height, get_current_rotation());
+            }
+            paint_unlock_shared_state();
         }
         break;
     case 1:
@@ -295,7 +294,7 @@ void entrance_paint(paint_session * session, uint8 direction, sint32 height, rct
 
     rct_drawpixelinfo* dpi = session->Unk140E9A8;
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_PATH_HEIGHTS &&
+    if (session->ViewFlags & VIEWPORT_FLAG_PATH_HEIGHTS &&
         dpi->zoom_level == 0){
 
         if (entrance_get_directions(tile_element) & 0xF){
@@ -344,6 +344,7 @@ void fence_paint(paint_session * session, uint8 direction, sint32 height, rct_ti
         return;
     }
 
+    paint_lock_shared_state();
     set_format_arg(0, uint32, 0);
     set_format_arg(4, uint32, 0);
 
@@ -385,4 +386,5 @@ void fence_paint(paint_session * session, uint8 direction, sint32 height, rct_ti
     uint16 scroll = (gCurrentTicks / 2) % string_width;
 
     sub_98199C(session, scrolling_text_setup(session, stringId, scroll, scrollingMode), 0, 0, 1, 1, 13, height + 8, boundsOffset.x, boundsOffset.y, boundsOffset.z, get_current_rotation());
+    paint_unlock_shared_state();
 }
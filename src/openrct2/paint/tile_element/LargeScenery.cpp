@@ -252,6 +252,7 @@ void large_scenery_paint(paint_session * session, uint8 direction, uint16 height
         }
         // 6B8331:
         // Draw sign text:
+        paint_lock_shared_state();
         set_format_arg(0, uint32, 0);
         set_format_arg(4, uint32, 0);
         sint32 textColour = scenery_large_get_secondary_colour(tileElement);
@@ -324,6 +325,7 @@ void large_scenery_paint(paint_session * session, uint8 direction, uint16 height
                 large_scenery_sign_paint_line(session, signString, entry->large_scenery.text, entry->large_scenery.text_image, textColour, direction, y_offset);
             }
         }
+        paint_unlock_shared_state();
         return;
     }
     rct_drawpixelinfo* dpi = session->Unk140E9A8;
@@ -337,6 +339,7 @@ void large_scenery_paint(paint_session * session, uint8 direction, uint16 height
         return;
     }
     // Draw scrolling text:
+    paint_lock_shared_state();
     set_format_arg(0, uint32, 0);
     set_format_arg(4, uint32, 0);
     uint8 textColour = scenery_large_get_secondary_colour(tileElement);
@@ -370,6 +373,7 @@ void large_scenery_paint(paint_session * session, uint8 direction, uint16 height
     uint16 string_width = gfx_get_string_width(signString);
     uint16 scroll = (gCurrentTicks / 2) % string_width;
     sub_98199C(session, scrolling_text_setup(session, stringId, scroll, scrollMode), 0, 0, 1, 1, 21, height + 25, boxoffset.x, boxoffset.y, boxoffset.z, get_current_rotation());
+    paint_unlock_shared_state();
 
     large_scenery_paint_supports(session, direction, height, tileElement, dword_F4387C, tile);
 }
@@ -391,6 +391,7 @@ static void sub_6A4101(paint_session * session, rct_tile_element * tile_element,
             uint16 scrollingMode = footpathEntry->scrolling_mode;
             scrollingMode += direction;
 
+            paint_lock_shared_state();
             set_format_arg(0, uint32, 0);
             set_format_arg(4, uint32, 0);
 
@@ -413,6 +414,7 @@ static void sub_6A4101(paint_session * session, rct_tile_element * tile_element,
             uint16 scroll = (gCurrentTicks / 2) % string_width;
 
             sub_98199C(session, scrolling_text_setup(session, string_id, scroll, scrollingMode), 0, 0, 1, 1, 21, height + 7,  boundBoxOffsets.x,  boundBoxOffsets.y,  boundBoxOffsets.z, get_current_rotation());
+            paint_unlock_shared_state();
         }
 
         session->InteractionType = VIEWPORT_INTERACTION_ITEM_FOOTPATH;
@@ -749,7 +751,7 @@ void path_paint(paint_session * session, uint8 direction, uint16 height, rct_til
     }
 
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_PATH_HEIGHTS) {
+    if (session->ViewFlags & VIEWPORT_FLAG_PATH_HEIGHTS) {
         uint16 height2 = 3 + tile_element->base_height * 8;
         if (footpath_element_is_sloped(tile_element)) {
             height2 += 8;
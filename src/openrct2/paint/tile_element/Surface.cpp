@@ -609,7 +609,7 @@ static void viewport_surface_draw_tile_side_bottom(paint_session * session, enum
     }
 
     uint32 base_image_id = _terrainEdgeSpriteIds[edgeStyle][0];
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_UNDERGROUND_INSIDE)
+    if (session->ViewFlags & VIEWPORT_FLAG_UNDERGROUND_INSIDE)
     {
         base_image_id = _terrainEdgeSpriteIds[edgeStyle][1];
     }
@@ -806,7 +806,7 @@ static void viewport_surface_draw_tile_side_top(paint_session * session, enum ed
     if (isWater)
     {
         base_image_id = _terrainEdgeSpriteIds[terrain][2]; // var_08
-        if (gCurrentViewportFlags & VIEWPORT_FLAG_UNDERGROUND_INSIDE)
+        if (session->ViewFlags & VIEWPORT_FLAG_UNDERGROUND_INSIDE)
         {
             base_image_id = _terrainEdgeSpriteIds[terrain][1];  // var_04
         }
@@ -814,7 +814,7 @@ static void viewport_surface_draw_tile_side_top(paint_session * session, enum ed
     }
     else
     {
-        if (!(gCurrentViewportFlags & VIEWPORT_FLAG_UNDERGROUND_INSIDE))
+        if (!(session->ViewFlags & VIEWPORT_FLAG_UNDERGROUND_INSIDE))
         {
             const uint8 incline = (regs.cl - regs.al) + 1;
             const uint32 image_id = _terrainEdgeSpriteIds[terrain][3] + (edge == EDGE_TOPLEFT ? 3 : 0) + incline; // var_c;
@@ -962,7 +962,7 @@ void surface_paint(paint_session * session, uint8 direction, uint16 height, rct_
     }
 
 
-    if ((gCurrentViewportFlags & VIEWPORT_FLAG_LAND_HEIGHTS) && (zoomLevel == 0))
+    if ((session->ViewFlags & VIEWPORT_FLAG_LAND_HEIGHTS) && (zoomLevel == 0))
     {
         const sint16 x = session->MapPosition.x;
         const sint16 y = session->MapPosition.y;
@@ -988,7 +988,7 @@ void surface_paint(paint_session * session, uint8 direction, uint16 height, rct_
     }
     else
     {
-        const bool showGridlines = (gCurrentViewportFlags & VIEWPORT_FLAG_GRIDLINES);
+        const bool showGridlines = (session->ViewFlags & VIEWPORT_FLAG_GRIDLINES);
 
         sint32 branch = -1;
         if ((tileElement->properties.surface.terrain & 0xE0) == 0)
@@ -997,7 +997,7 @@ void surface_paint(paint_session * session, uint8 direction, uint16 height, rct_
             {
                 if (zoomLevel == 0)
                 {
-                    if ((gCurrentViewportFlags & (VIEWPORT_FLAG_HIDE_BASE | VIEWPORT_FLAG_UNDERGROUND_INSIDE)) == 0)
+                    if ((session->ViewFlags & (VIEWPORT_FLAG_HIDE_BASE | VIEWPORT_FLAG_UNDERGROUND_INSIDE)) == 0)
                     {
                         branch = tileElement->properties.surface.grass_length & 0x7;
                     }
@@ -1035,7 +1035,7 @@ void surface_paint(paint_session * session, uint8 direction, uint16 height, rct_
                 image_id = SPR_TERRAIN_TRACK_DESIGNER;
             }
 
-            if (gCurrentViewportFlags & (VIEWPORT_FLAG_UNDERGROUND_INSIDE | VIEWPORT_FLAG_HIDE_BASE))
+            if (session->ViewFlags & (VIEWPORT_FLAG_UNDERGROUND_INSIDE | VIEWPORT_FLAG_HIDE_BASE))
             {
                 image_id &= 0xDC07FFFF; // remove colour
                 image_id |= 0x41880000;
@@ -1102,7 +1102,7 @@ void surface_paint(paint_session * session, uint8 direction, uint16 height, rct_
 
     // Draw Peep Spawns
     if (((gScreenFlags & SCREEN_FLAGS_SCENARIO_EDITOR) || gCheatsSandboxMode) &&
-        gCurrentViewportFlags & VIEWPORT_FLAG_LAND_OWNERSHIP)
+        session->ViewFlags & VIEWPORT_FLAG_LAND_OWNERSHIP)
     {
         const LocationXY16& pos = session->MapPosition;
         for (auto &spawn : gPeepSpawns)
@@ -1118,7 +1118,7 @@ void surface_paint(paint_session * session, uint8 direction, uint16 height, rct_
         }
     }
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_LAND_OWNERSHIP)
+    if (session->ViewFlags & VIEWPORT_FLAG_LAND_OWNERSHIP)
     {
         // loc_660E9A:
         if (tileElement->properties.surface.ownership & OWNERSHIP_OWNED)
@@ -1136,7 +1136,7 @@ void surface_paint(paint_session * session, uint8 direction, uint16 height, rct_
         }
     }
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_CONSTRUCTION_RIGHTS &&
+    if (session->ViewFlags & VIEWPORT_FLAG_CONSTRUCTION_RIGHTS &&
         !(tileElement->properties.surface.ownership & OWNERSHIP_OWNED))
     {
         if (tileElement->properties.surface.ownership & OWNERSHIP_CONSTRUCTION_RIGHTS_OWNED)
@@ -1260,8 +1260,8 @@ void surface_paint(paint_session * session, uint8 direction, uint16 height, rct_
 
     if (zoomLevel == 0 &&
         has_surface &&
-        !(gCurrentViewportFlags & VIEWPORT_FLAG_UNDERGROUND_INSIDE) &&
-        !(gCurrentViewportFlags & VIEWPORT_FLAG_HIDE_BASE) &&
+        !(session->ViewFlags & VIEWPORT_FLAG_UNDERGROUND_INSIDE) &&
+        !(session->ViewFlags & VIEWPORT_FLAG_HIDE_BASE) &&
         gConfigGeneral.landscape_smoothing)
     {
         viewport_surface_smoothen_edge(session, EDGE_TOPLEFT, tileDescriptors[0], tileDescriptors[3]);
@@ -1271,8 +1271,8 @@ void surface_paint(paint_session * session, uint8 direction, uint16 height, rct_
     }
 
 
-    if ((gCurrentViewportFlags & VIEWPORT_FLAG_UNDERGROUND_INSIDE) &&
-        !(gCurrentViewportFlags & VIEWPORT_FLAG_HIDE_BASE) &&
+    if ((session->ViewFlags & VIEWPORT_FLAG_UNDERGROUND_INSIDE) &&
+        !(session->ViewFlags & VIEWPORT_FLAG_HIDE_BASE) &&
         !(gScreenFlags & (SCREEN_FLAGS_TRACK_DESIGNER | SCREEN_FLAGS_TRACK_MANAGER)))
     {
         const uint8 image_offset = byte_97B444[surfaceShape];
@@ -1284,7 +1284,7 @@ void surface_paint(paint_session * session, uint8 direction, uint16 height, rct_
         paint_attach_to_previous_ps(session, image_id, 0, 0);
     }
 
-    if (!(gCurrentViewportFlags & VIEWPORT_FLAG_HIDE_VERTICAL))
+    if (!(session->ViewFlags & VIEWPORT_FLAG_HIDE_VERTICAL))
     {
         // loc_66122C:
         const uint8 al_edgeStyle = tileElement->properties.surface.slope & TILE_ELEMENT_SLOPE_EDGE_STYLE_MASK;
@@ -153,7 +153,7 @@ static void sub_68B3FB(paint_session * session, sint32 x, sint32 y)
 
     /* Check if the first (lowest) tile_element is below the clip
      * height. */
-    if ((gCurrentViewportFlags & VIEWPORT_FLAG_PAINT_CLIP_TO_HEIGHT) && (tile_element->base_height > gClipHeight)) {
+    if ((session->ViewFlags & VIEWPORT_FLAG_PAINT_CLIP_TO_HEIGHT) && (tile_element->base_height > gClipHeight)) {
         blank_tiles_paint(session, x, y);
         return;
     }
@@ -234,7 +234,7 @@ static void sub_68B3FB(paint_session * session, sint32 x, sint32 y)
     sint32 previousHeight = 0;
     do {
         // Only paint tile_elements below the clip height.
-        if ((gCurrentViewportFlags & VIEWPORT_FLAG_PAINT_CLIP_TO_HEIGHT) && (tile_element->base_height > gClipHeight)) break;
+        if ((session->ViewFlags & VIEWPORT_FLAG_PAINT_CLIP_TO_HEIGHT) && (tile_element->base_height > gClipHeight)) break;
 
         sint32 direction = tile_element_get_direction_with_offset(tile_element, rotation);
         sint32 height = tile_element->base_height * 8;
@@ -341,7 +341,7 @@ static void sub_68B3FB(paint_session * session, sint32 x, sint32 y)
             }
 
             // Only draw supports below the clipping height.
-            if ((gCurrentViewportFlags & VIEWPORT_FLAG_PAINT_CLIP_TO_HEIGHT) && (segmentHeight > gClipHeight)) continue;
+            if ((session->ViewFlags & VIEWPORT_FLAG_PAINT_CLIP_TO_HEIGHT) && (segmentHeight > gClipHeight)) continue;
 
             sint32 xOffset = sy * 10;
             sint32 yOffset = -22 + sx * 10;
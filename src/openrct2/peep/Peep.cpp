@@ -15,6 +15,8 @@
 #pragma endregion
 
 #include <limits>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "../Context.h"
 #include "../OpenRCT2.h"
@@ -22,6 +24,7 @@
 #include "../audio/audio.h"
 #include "../Cheats.h"
 #include "../config/Config.h"
+#include "../core/JobPool.hpp"
 #include "../core/Math.hpp"
 #include "../core/Util.hpp"
 #include "../Game.h"
@@ -35,6 +38,7 @@
 #include "../ride/Station.h"
 #include "../ride/Track.h"
 #include "../ride/Ride.h"
+#include "../ride/RideCandidates.h"
 #include "../ride/ride_data.h"
 #include "../scenario/scenario.h"
 #include "../sprites.h"
@@ -73,28 +77,106 @@ LocationXYZ16 gPeepPathFindGoalPosition;
 bool          gPeepPathFindIgnoreForeignQueues;
 uint8         gPeepPathFindQueueRideIndex;
 // uint32 gPeepPathFindAltStationNum;
-static bool   _peepPathFindIsStaff;
-static sint8  _peepPathFindNumJunctions;
-static sint8  _peepPathFindMaxJunctions;
-static sint32 _peepPathFindTilesChecked;
-static uint8  _peepPathFindFewestNumSteps;
+// The heuristic search state is per thread so guests can be searched for in parallel
+static thread_local bool   _peepPathFindIsStaff;
+static thread_local sint8  _peepPathFindNumJunctions;
+static thread_local sint8  _peepPathFindMaxJunctions;
+static thread_local sint32 _peepPathFindTilesChecked;
+static thread_local uint8  _peepPathFindFewestNumSteps;
 
 /* A junction history for the peep pathfinding heuristic search
  * The magic number 16 is the largest value returned by
  * peep_pathfind_get_max_number_junctions() which should eventually
  * be declared properly. */
-static struct
+static thread_local struct
 {
     LocationXYZ8 location;
     uint8        direction;
 } _peepPathFindHistory[16];
 
+/* Cache of the directions chosen by the heuristic search for guests.
+ * The search only depends on the map, the goal, the search limits and the
+ * guest's pathfind_history, all of which are part of the key, so a cached
+ * direction is exactly what the search would return. The cache is cleared
+ * whenever the map may have changed, see peep_pathfind_invalidate_cache(). */
+struct PeepPathFindCacheKey
+{
+    LocationXYZ16 goal;
+    sint16        x;
+    sint16        y;
+    uint8         z;
+    uint8         edges;
+    uint8         max_junctions;
+    uint8         queue_ride_index;
+    bool          ignore_foreign_queues;
+    LocationXYZD8 history[4];
+};
+
+struct PeepPathFindCacheKeyHash
+{
+    size_t operator()(const PeepPathFindCacheKey &key) const
+    {
+        // FNV-1a
+        auto   bytes = reinterpret_cast<const uint8 *>(&key);
+        uint32 hash  = 2166136261;
+        for (size_t i = 0; i < sizeof(PeepPathFindCacheKey); i++)
+        {
+            hash = (hash ^ bytes[i]) * 16777619;
+        }
+        return hash;
+    }
+};
+
+struct PeepPathFindCacheKeyEqual
+{
+    bool operator()(const PeepPathFindCacheKey &lhs, const PeepPathFindCacheKey &rhs) const
+    {
+        return memcmp(&lhs, &rhs, sizeof(PeepPathFindCacheKey)) == 0;
+    }
+};
+
+// The cache is emptied when it reaches this many directions
+#define PEEP_PATHFIND_CACHE_MAX_ENTRIES 65536
+
+static std::unordered_map<PeepPathFindCacheKey, sint8, PeepPathFindCacheKeyHash, PeepPathFindCacheKeyEqual> _peepPathFindCache;
+static bool _peepPathFindCacheInvalid;
+
+// The goal, queue rules and junction history of the current heuristic search
+static thread_local const PeepPathFindCacheKey * _peepPathFindKey;
+
 static uint8             _unk_F1AEF0;
 static uint16            _unk_F1EE18;
 static rct_tile_element * _peepRideEntranceExitElement;
-static uint32            _peepRideConsideration[8];
+static uint32            _peepRideConsideration[RIDE_CANDIDATE_SET_WORDS];
 static uint8             _peepPotentialRides[256];
 
+// Number of peeps ahead of the one being updated whose sprites are prefetched
+#define PEEP_UPDATE_PREFETCH_DISTANCE 4
+
+/* A structure of arrays mirroring the peep fields that per-tick loops read for
+ * every peep, in update order. The sprite stays the canonical copy that is
+ * saved and synchronised. Each entry is copied from it when peep_update_all
+ * gathers the peep list and again once that peep has been updated, so loops
+ * over every peep can scan these arrays instead of following next pointers
+ * through the sprites. The id detects a sprite slot being reused by a
+ * different peep during the update loop, and the sprite index is set to
+ * SPRITE_INDEX_NULL for peeps that have since left the list. */
+static struct
+{
+    uint32 count;
+    uint16 sprite_index[MAX_SPRITES];
+    uint32 id[MAX_SPRITES];
+    uint8  type[MAX_SPRITES];
+    uint8  state[MAX_SPRITES];
+    uint8  outside_of_park[MAX_SPRITES];
+    uint8  next_var_29[MAX_SPRITES];
+    uint32 peep_flags[MAX_SPRITES];
+    sint16 sprite_left[MAX_SPRITES];
+    sint16 sprite_top[MAX_SPRITES];
+    sint16 sprite_right[MAX_SPRITES];
+    sint16 sprite_bottom[MAX_SPRITES];
+} _peepHotData;
+
 enum
 {
     PATH_SEARCH_DEAD_END,
@@ -124,6 +206,7 @@ static void * _crowdSoundChannel = NULL;
 
 static void   sub_68F41A(rct_peep * peep, sint32 index);
 static void   peep_update(rct_peep * peep);
+static void   peep_pathfind_prefill_cache(uint32 count);
 static sint32 peep_has_empty_container(rct_peep * peep);
 static sint32 peep_has_drink(rct_peep * peep);
 static sint32 peep_has_food_standard_flag(rct_peep * peep);
@@ -522,6 +605,21 @@ static const LocationXY16 SpiralSlideWalkingPath[64] = {
 };
 // clang-format on
 
+static void peep_hot_data_store(uint32 index, const rct_peep * peep)
+{
+    _peepHotData.sprite_index[index]    = peep->sprite_index;
+    _peepHotData.id[index]              = peep->id;
+    _peepHotData.type[index]            = peep->type;
+    _peepHotData.state[index]           = peep->state;
+    _peepHotData.outside_of_park[index] = peep->outside_of_park;
+    _peepHotData.next_var_29[index]     = peep->next_var_29;
+    _peepHotData.peep_flags[index]      = peep->peep_flags;
+    _peepHotData.sprite_left[index]     = peep->sprite_left;
+    _peepHotData.sprite_top[index]      = peep->sprite_top;
+    _peepHotData.sprite_right[index]    = peep->sprite_right;
+    _peepHotData.sprite_bottom[index]   = peep->sprite_bottom;
+}
+
 rct_peep * try_get_guest(uint16 spriteIndex)
 {
     rct_sprite * sprite = try_get_sprite(spriteIndex);
@@ -552,19 +650,45 @@ sint32 peep_get_staff_count()
  */
 void peep_update_all()
 {
-    sint32     i;
-    uint16     spriteIndex;
-    rct_peep * peep;
-
+    _peepHotData.count = 0;
     if (gScreenFlags & (SCREEN_FLAGS_SCENARIO_EDITOR | SCREEN_FLAGS_TRACK_DESIGNER | SCREEN_FLAGS_TRACK_MANAGER))
         return;
 
-    spriteIndex = gSpriteListHead[SPRITE_LIST_PEEP];
-    i           = 0;
-    while (spriteIndex != SPRITE_INDEX_NULL)
+    // Gather the peep list before updating so the loop can walk a dense array and prefetch the sprites ahead
+    // of it, rather than waiting on each peep's next pointer.
+    uint32 count = 0;
+    for (uint16 spriteIndex = gSpriteListHead[SPRITE_LIST_PEEP]; spriteIndex != SPRITE_INDEX_NULL;)
     {
-        peep        = &(get_sprite(spriteIndex)->peep);
+        rct_peep * peep = &(get_sprite(spriteIndex)->peep);
+        peep_hot_data_store(count, peep);
+        count++;
         spriteIndex = peep->next;
+    }
+    _peepHotData.count = count;
+
+    if (gConfigGeneral.multithreading)
+    {
+        peep_pathfind_prefill_cache(count);
+    }
+
+    sint32 i = 0;
+    for (uint32 j = 0; j < count; j++)
+    {
+        if (j + PEEP_UPDATE_PREFETCH_DISTANCE < count)
+        {
+            Util::PrefetchObject(&(get_sprite(_peepHotData.sprite_index[j + PEEP_UPDATE_PREFETCH_DISTANCE])->peep));
+        }
+
+        // A peep that left the list while an earlier peep was being updated is skipped, as it would have
+        // been unlinked from the list the loop used to walk.
+        rct_peep * peep = &(get_sprite(_peepHotData.sprite_index[j])->peep);
+        if (peep->sprite_identifier != SPRITE_IDENTIFIER_PEEP ||
+            peep->linked_list_type_offset != SPRITE_LIST_PEEP * 2 ||
+            peep->id != _peepHotData.id[j])
+        {
+            _peepHotData.sprite_index[j] = SPRITE_INDEX_NULL;
+            continue;
+        }
 
         if ((uint32)(i & 0x7F) != (gCurrentTicks & 0x7F))
         {
@@ -579,6 +703,16 @@ void peep_update_all()
             }
         }
 
+        // The sprite is still in the cache, so refresh the mirror while it is
+        if (peep->sprite_identifier == SPRITE_IDENTIFIER_PEEP && peep->linked_list_type_offset == SPRITE_LIST_PEEP * 2)
+        {
+            peep_hot_data_store(j, peep);
+        }
+        else
+        {
+            _peepHotData.sprite_index[j] = SPRITE_INDEX_NULL;
+        }
+
         i++;
     }
 }
@@ -671,14 +805,11 @@ static uint8 peep_assess_surroundings(sint16 centre_x, sint16 centre_y, sint16 c
         }
     }
 
-    rct_litter * litter;
-    for (uint16 sprite_idx = gSpriteListHead[SPRITE_LIST_LITTER]; sprite_idx != SPRITE_INDEX_NULL; sprite_idx = litter->next)
+    sprite_spatial_query query;
+    sprite_spatial_query_rect(&query, centre_x - 160, centre_y - 160, centre_x + 160, centre_y + 160);
+    for (rct_sprite * sprite; (sprite = sprite_spatial_query_next(&query)) != nullptr;)
     {
-        litter = &(get_sprite(sprite_idx)->litter);
-
-        sint16 dist_x = abs(litter->x - centre_x);
-        sint16 dist_y = abs(litter->y - centre_y);
-        if (Math::Max(dist_x, dist_y) <= 160)
+        if (sprite->unknown.linked_list_type_offset == SPRITE_LIST_LITTER * 2)
         {
             num_rubbish++;
         }
@@ -2124,7 +2255,7 @@ bool peep_pickup_place(rct_peep * peep, sint32 x, sint32 y, sint32 z, bool apply
 
 bool peep_pickup_command(uint32 peepnum, sint32 x, sint32 y, sint32 z, sint32 action, bool apply)
 {
-    if (peepnum >= MAX_SPRITES)
+    if (peepnum >= gSpriteCapacity)
     {
         log_error("Failed to pick up peep for sprite %d", peepnum);
         return false;
@@ -7701,8 +7832,6 @@ void peep_stop_crowd_noise()
 void peep_update_crowd_noise()
 {
     rct_viewport * viewport;
-    uint16         spriteIndex;
-    rct_peep *     peep;
     sint32         visiblePeeps;
 
     if (gGameSoundsOff)
@@ -7718,23 +7847,26 @@ void peep_update_crowd_noise()
     if (viewport == NULL)
         return;
 
-    // Count the number of peeps visible
+    // Count the number of peeps visible. This runs after peep_update_all, so the positions are read from the
+    // mirror as they were at the end of each guest's update rather than from every guest's sprite.
     visiblePeeps = 0;
 
-    FOR_ALL_GUESTS(spriteIndex, peep)
+    for (uint32 j = 0; j < _peepHotData.count; j++)
     {
-        if (peep->sprite_left == LOCATION_NULL)
+        if (_peepHotData.sprite_index[j] == SPRITE_INDEX_NULL || _peepHotData.type[j] != PEEP_TYPE_GUEST)
+            continue;
+        if (_peepHotData.sprite_left[j] == LOCATION_NULL)
             continue;
-        if (viewport->view_x > peep->sprite_right)
+        if (viewport->view_x > _peepHotData.sprite_right[j])
             continue;
-        if (viewport->view_x + viewport->view_width < peep->sprite_left)
+        if (viewport->view_x + viewport->view_width < _peepHotData.sprite_left[j])
             continue;
-        if (viewport->view_y > peep->sprite_bottom)
+        if (viewport->view_y > _peepHotData.sprite_bottom[j])
             continue;
-        if (viewport->view_y + viewport->view_height < peep->sprite_top)
+        if (viewport->view_y + viewport->view_height < _peepHotData.sprite_top[j])
             continue;
 
-        visiblePeeps += peep->state == PEEP_STATE_QUEUING ? 1 : 2;
+        visiblePeeps += _peepHotData.state[j] == PEEP_STATE_QUEUING ? 1 : 2;
     }
 
     // This function doesn't account for the fact that the screen might be so big that 100 peeps could potentially be very
@@ -7913,7 +8045,7 @@ static const uint8 tshirt_colours[] = {
  */
 rct_peep * peep_generate(sint32 x, sint32 y, sint32 z)
 {
-    if (gSpriteListCount[SPRITE_LIST_NULL] < 400)
+    if (sprite_get_free_count() < 400)
         return NULL;
 
     rct_peep * peep = (rct_peep *)create_sprite(1);
@@ -9939,8 +10071,8 @@ static bool path_is_thin_junction(rct_tile_element * path, sint16 x, sint16 y, u
  *     wide path. This means peeps heading for a destination will only leave
  *     thin paths if walking 1 tile onto a wide path is closer than following
  *     non-wide paths;
- *   - gPeepPathFindIgnoreForeignQueues
- *   - gPeepPathFindQueueRideIndex - the ride the peep is heading for
+ *   - _peepPathFindKey - the goal, the ride the peep is heading for, whether
+ *     to ignore foreign queues and the peep's pathfind_history;
  *   - _peepPathFindHistory - the search path telemetry consisting of the
  *     starting point and all thin junctions with directions navigated
  *     in the current search path - also used to detect path loops.
@@ -10128,9 +10260,9 @@ static void peep_pathfind_heuristic_search(sint16 x, sint16 y, uint8 z, rct_peep
             else
             { // numEdges == 2
                 if (footpath_element_is_queue(tileElement) &&
-                    tileElement->properties.path.ride_index != gPeepPathFindQueueRideIndex)
+                    tileElement->properties.path.ride_index != _peepPathFindKey->queue_ride_index)
                 {
-                    if (gPeepPathFindIgnoreForeignQueues && (tileElement->properties.path.ride_index != 0xFF))
+                    if (_peepPathFindKey->ignore_foreign_queues && (tileElement->properties.path.ride_index != 0xFF))
                     {
                         // Path is a queue we aren't interested in
                         /* The rideIndex will be useful for
@@ -10164,14 +10296,14 @@ static void peep_pathfind_heuristic_search(sint16 x, sint16 y, uint8 z, rct_peep
          * Ignore for now. */
 
         // Calculate the heuristic score of this map element.
-        uint16 x_delta = abs(gPeepPathFindGoalPosition.x - x);
-        uint16 y_delta = abs(gPeepPathFindGoalPosition.y - y);
+        uint16 x_delta = abs(_peepPathFindKey->goal.x - x);
+        uint16 y_delta = abs(_peepPathFindKey->goal.y - y);
         if (x_delta < y_delta)
             x_delta >>= 4;
         else
             y_delta >>= 4;
         uint16 new_score = x_delta + y_delta;
-        uint16 z_delta   = abs(gPeepPathFindGoalPosition.z - z);
+        uint16 z_delta   = abs(_peepPathFindKey->goal.z - z);
         z_delta <<= 1;
         new_score += z_delta;
 
@@ -10361,7 +10493,7 @@ static void peep_pathfind_heuristic_search(sint16 x, sint16 y, uint8 z, rct_peep
                 bool pathLoop = false;
                 /* Check the peep->pathfind_history to see if this junction has
                  * already been visited by the peep while heading for this goal. */
-                for (auto &pathfindHistory : peep->pathfind_history)
+                for (auto &pathfindHistory : _peepPathFindKey->history)
                 {
                     if (pathfindHistory.x == x >> 5 && pathfindHistory.y == y >> 5 &&
                         pathfindHistory.z == z)
@@ -10536,35 +10668,74 @@ static void peep_pathfind_heuristic_search(sint16 x, sint16 y, uint8 z, rct_peep
 }
 
 /**
- * Returns:
- *   -1   - no direction chosen
- *   0..3 - chosen direction
- *
- *  rct2: 0x0069A5F0
+ * Forgets the cached pathfinding directions. Must be called whenever a tile
+ * element or ride that the heuristic search looks at may have changed.
  */
-sint32 peep_pathfind_choose_direction(sint16 x, sint16 y, uint8 z, rct_peep * peep)
+void peep_pathfind_invalidate_cache()
 {
-    // The max number of thin junctions searched - a per-search-path limit.
-    _peepPathFindMaxJunctions = peep_pathfind_get_max_number_junctions(peep);
-
-    /* The max number of tiles to check - a whole-search limit.
-     * Mainly to limit the performance impact of the path finding. */
-    sint32 maxTilesChecked = (peep->type == PEEP_TYPE_STAFF) ? 50000 : 15000;
-    // Used to allow walking through no entry banners
-    _peepPathFindIsStaff = (peep->type == PEEP_TYPE_STAFF);
+    _peepPathFindCacheInvalid = true;
+}
 
-    LocationXYZ8 goal = { (uint8)(gPeepPathFindGoalPosition.x >> 5),
-                      (uint8)(gPeepPathFindGoalPosition.y >> 5),
-                      (uint8)(gPeepPathFindGoalPosition.z) };
+/**
+ * Updates the junctions remembered in peep->pathfind_history after the peep
+ * chose a direction at a thin junction.
+ */
+static void peep_pathfind_remember_junction(sint16 x, sint16 y, uint8 z, rct_peep * peep, uint8 permitted_edges,
+                                            sint32 chosen_edge)
+{
+    for (sint32 i = 0; i < 4; ++i)
+    {
+        if (peep->pathfind_history[i].x == x >> 5 && peep->pathfind_history[i].y == y >> 5 &&
+            peep->pathfind_history[i].z == z)
+        {
+            /* Peep remembers this junction, so remove the
+             * chosen_edge from those left to try. */
+            peep->pathfind_history[i].direction &= ~(1 << chosen_edge);
+            /* Also remove the edge through which the peep
+             * entered the junction from those left to try. */
+            peep->pathfind_history[i].direction &= ~(1 << (peep->direction ^ 2));
+#if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+            if (gPathFindDebug)
+            {
+                log_verbose(
+                    "Updating existing pf_history (in index: %d) for %d,%d,%d without entry edge %d & exit edge %d.", i,
+                    x >> 5, y >> 5, z, peep->direction ^ 2, chosen_edge);
+            }
+#endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+            return;
+        }
+    }
 
+    /* Peep does not remember this junction, so forget a junction
+     * and remember this junction. */
+    sint32 i = peep->pathfind_goal.direction++;
+    peep->pathfind_goal.direction &= 3;
+    peep->pathfind_history[i].x         = x >> 5;
+    peep->pathfind_history[i].y         = y >> 5;
+    peep->pathfind_history[i].z         = z;
+    peep->pathfind_history[i].direction = permitted_edges;
+    /* Remove the chosen_edge from those left to try. */
+    peep->pathfind_history[i].direction &= ~(1 << chosen_edge);
+    /* Also remove the edge through which the peep
+     * entered the junction from those left to try. */
+    peep->pathfind_history[i].direction &= ~(1 << (peep->direction ^ 2));
 #if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
     if (gPathFindDebug)
     {
-        log_verbose("Choose direction for %s for goal %d,%d,%d from %d,%d,%d", gPathFindDebugPeepName, goal.x, goal.y, goal.z,
-                    x >> 5, y >> 5, z);
+        log_verbose("Storing new pf_history (in index: %d) for %d,%d,%d without entry edge %d & exit edge %d.", i, x >> 5,
+                    y >> 5, z, peep->direction ^ 2, chosen_edge);
     }
 #endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+}
 
+/**
+ * Gets the path at x,y,z that a peep is choosing a direction from, the edges
+ * permitted by all of the paths there and whether it is a thin junction.
+ * @return false if there is no path at that location.
+ */
+static bool peep_pathfind_get_junction(sint16 x, sint16 y, uint8 z, rct_tile_element ** outFirstTileElement,
+                                       uint8 * outPermittedEdges, bool * outIsThin)
+{
     // Get the path element at this location
     rct_tile_element * dest_tile_element = map_get_first_element_at(x / 32, y / 32);
     /* Where there are multiple matching map elements placed with zero
@@ -10610,11 +10781,29 @@ sint32 peep_pathfind_choose_direction(sint16 x, sint16 y, uint8 z, rct_peep * pe
         // Collect the permitted edges of ALL matching path elements at this location.
         permitted_edges |= path_get_permitted_edges(dest_tile_element);
     } while (!tile_element_is_last_for_tile(dest_tile_element++));
-    // Peep is not on a path.
-    if (!found)
-        return -1;
 
-    permitted_edges &= 0xF;
+    *outFirstTileElement = first_tile_element;
+    *outPermittedEdges   = permitted_edges & 0xF;
+    *outIsThin           = isThin;
+    return found;
+}
+
+static bool peep_pathfind_is_new_goal(const rct_peep * peep, LocationXYZ8 goal)
+{
+    return peep->pathfind_goal.direction > 3 || peep->pathfind_goal.x != goal.x || peep->pathfind_goal.y != goal.y ||
+        peep->pathfind_goal.z != goal.z;
+}
+
+/**
+ * Gets the edges a peep will choose from at a junction while heading for the
+ * goal, along with the pathfind_history the peep will have at that point.
+ * The peep itself is not changed.
+ */
+static uint8 peep_pathfind_get_untried_edges(const rct_peep * peep, sint16 x, sint16 y, uint8 z, LocationXYZ8 goal,
+                                             uint8 permitted_edges, bool isThin, LocationXYZD8 (&history)[4])
+{
+    memcpy(history, peep->pathfind_history, sizeof(history));
+
     uint8 edges = permitted_edges;
     if (isThin && peep->pathfind_goal.x == goal.x && peep->pathfind_goal.y == goal.y && peep->pathfind_goal.z == goal.z)
     {
@@ -10633,7 +10822,7 @@ sint32 peep_pathfind_choose_direction(sint16 x, sint16 y, uint8 z, rct_peep * pe
         /* If the peep remembers walking through this junction
          * previously while heading for its goal, retrieve the
          * directions it has not yet tried. */
-        for (auto &pathfindHistory : peep->pathfind_history)
+        for (auto &pathfindHistory : history)
         {
             if (pathfindHistory.x == x / 32 && pathfindHistory.y == y / 32 &&
                 pathfindHistory.z == z)
@@ -10683,232 +10872,316 @@ sint32 peep_pathfind_choose_direction(sint16 x, sint16 y, uint8 z, rct_peep * pe
         }
     }
 
-    /* If this is a new goal for the peep. Store it and reset the peep's
-     * pathfind_history. */
-    if (peep->pathfind_goal.direction > 3 || peep->pathfind_goal.x != goal.x || peep->pathfind_goal.y != goal.y ||
-        peep->pathfind_goal.z != goal.z)
+    // A new goal resets the pathfind_history
+    if (peep_pathfind_is_new_goal(peep, goal))
     {
-        peep->pathfind_goal.x         = goal.x;
-        peep->pathfind_goal.y         = goal.y;
-        peep->pathfind_goal.z         = goal.z;
-        peep->pathfind_goal.direction = 0;
-
-        // Clear pathfinding history
-        memset(peep->pathfind_history, 0xFF, sizeof(peep->pathfind_history));
-#if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
-        if (gPathFindDebug)
-        {
-            log_verbose("New goal; clearing pf_history.");
-        }
-#endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+        memset(history, 0xFF, sizeof(history));
     }
+    return edges;
+}
 
-    // Peep has tried all edges.
-    if (edges == 0)
-        return -1;
-
+/**
+ * Runs the heuristic search along each of the key's edges and returns the
+ * edge that gets closest to the goal, or -1 if the search failed.
+ * The search only reads the map, the key and (for staff) the peep, and its
+ * working state is per thread, so searches can run for several guests at once.
+ */
+static sint32 peep_pathfind_search_edges(const PeepPathFindCacheKey * key, rct_peep * peep,
+                                         rct_tile_element * first_tile_element)
+{
+    sint16 x           = key->x;
+    sint16 y           = key->y;
+    uint8  z           = key->z;
+    uint8  edges       = key->edges;
     sint32 chosen_edge = bitscanforward(edges);
 
-    // Peep has multiple edges still to try.
-    if (edges & ~(1 << chosen_edge))
-    {
-        uint16 best_score = 0xFFFF;
-        uint8  best_sub   = 0xFF;
+    /* The max number of tiles to check - a whole-search limit.
+     * Mainly to limit the performance impact of the path finding. */
+    sint32 maxTilesChecked = (peep->type == PEEP_TYPE_STAFF) ? 50000 : 15000;
+    // Used to allow walking through no entry banners
+    _peepPathFindIsStaff      = (peep->type == PEEP_TYPE_STAFF);
+    _peepPathFindMaxJunctions = key->max_junctions;
+    _peepPathFindKey          = key;
 
 #if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
-        uint8        bestJunctions         = 0;
-        LocationXYZ8 bestJunctionList[16]  = { 0 };
-        uint8        bestDirectionList[16] = { 0 };
-        LocationXYZ8 bestXYZ               = { 0, 0, 0 };
-
-        if (gPathFindDebug)
-        {
-            log_verbose("Pathfind start for goal %d,%d,%d from %d,%d,%d", goal.x, goal.y, goal.z, x >> 5, y >> 5, z);
-        }
+    LocationXYZ8 goal = { (uint8)(key->goal.x >> 5), (uint8)(key->goal.y >> 5), (uint8)(key->goal.z) };
 #endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
 
-        /* Call the search heuristic on each edge, keeping track of the
-         * edge that gives the best (i.e. smallest) value (best_score)
-         * or for different edges with equal value, the edge with the
-         * least steps (best_sub). */
-        sint32 numEdges = bitcount(edges);
-        for (sint32 test_edge = chosen_edge; test_edge != -1; test_edge = bitscanforward(edges))
-        {
-            edges &= ~(1 << test_edge);
-            uint8 height = z;
-
-            if (footpath_element_is_sloped(first_tile_element) &&
-                footpath_element_get_slope_direction(first_tile_element) == test_edge)
-            {
-                height += 0x2;
-            }
-
-            _peepPathFindFewestNumSteps = 255;
-            /* Divide the maxTilesChecked global search limit
-             * between the remaining edges to ensure the search
-             * covers all of the remaining edges. */
-            _peepPathFindTilesChecked = maxTilesChecked / numEdges;
-            _peepPathFindNumJunctions = _peepPathFindMaxJunctions;
-
-            // Initialise _peepPathFindHistory.
-            memset(_peepPathFindHistory, 0xFF, sizeof(_peepPathFindHistory));
-
-            /* The pathfinding will only use elements
-             * 1.._peepPathFindMaxJunctions, so the starting point
-             * is placed in element 0 */
-            _peepPathFindHistory[0].location.x = (uint8)(x >> 5);
-            _peepPathFindHistory[0].location.y = (uint8)(y >> 5);
-            _peepPathFindHistory[0].location.z = (uint8)z;
-            _peepPathFindHistory[0].direction  = 0xF;
-
-            uint16 score = 0xFFFF;
-            /* Variable endXYZ contains the end location of the
-             * search path. */
-            LocationXYZ8 endXYZ;
-            endXYZ.x = 0;
-            endXYZ.y = 0;
-            endXYZ.z = 0;
+    uint16 best_score = 0xFFFF;
+    uint8  best_sub   = 0xFF;
 
-            uint8 endSteps = 255;
+#if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+    uint8        bestJunctions         = 0;
+    LocationXYZ8 bestJunctionList[16]  = { 0 };
+    uint8        bestDirectionList[16] = { 0 };
+    LocationXYZ8 bestXYZ               = { 0, 0, 0 };
 
-            /* Variable endJunctions is the number of junctions
-             * passed through in the search path.
-             * Variables endJunctionList and endDirectionList
-             * contain the junctions and corresponding directions
-             * of the search path.
-             * In the future these could be used to visualise the
-             * pathfinding on the map. */
-            uint8        endJunctions         = 0;
-            LocationXYZ8 endJunctionList[16]  = { 0 };
-            uint8        endDirectionList[16] = { 0 };
+    if (gPathFindDebug)
+    {
+        log_verbose("Pathfind start for goal %d,%d,%d from %d,%d,%d", goal.x, goal.y, goal.z, x >> 5, y >> 5, z);
+    }
+#endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
 
-            bool inPatrolArea = false;
-            if (peep->type == PEEP_TYPE_STAFF && peep->staff_type == STAFF_TYPE_MECHANIC)
-            {
-                /* Mechanics are the only staff type that
-                 * pathfind to a destination. Determine if the
-                 * mechanic is in their patrol area. */
-                inPatrolArea = staff_is_location_in_patrol(peep, peep->next_x, peep->next_y);
-            }
+    /* Call the search heuristic on each edge, keeping track of the
+     * edge that gives the best (i.e. smallest) value (best_score)
+     * or for different edges with equal value, the edge with the
+     * least steps (best_sub). */
+    sint32 numEdges = bitcount(edges);
+    for (sint32 test_edge = chosen_edge; test_edge != -1; test_edge = bitscanforward(edges))
+    {
+        edges &= ~(1 << test_edge);
+        uint8 height = z;
+
+        if (footpath_element_is_sloped(first_tile_element) &&
+            footpath_element_get_slope_direction(first_tile_element) == test_edge)
+        {
+            height += 0x2;
+        }
+
+        _peepPathFindFewestNumSteps = 255;
+        /* Divide the maxTilesChecked global search limit
+         * between the remaining edges to ensure the search
+         * covers all of the remaining edges. */
+        _peepPathFindTilesChecked = maxTilesChecked / numEdges;
+        _peepPathFindNumJunctions = _peepPathFindMaxJunctions;
+
+        // Initialise _peepPathFindHistory.
+        memset(_peepPathFindHistory, 0xFF, sizeof(_peepPathFindHistory));
+
+        /* The pathfinding will only use elements
+         * 1.._peepPathFindMaxJunctions, so the starting point
+         * is placed in element 0 */
+        _peepPathFindHistory[0].location.x = (uint8)(x >> 5);
+        _peepPathFindHistory[0].location.y = (uint8)(y >> 5);
+        _peepPathFindHistory[0].location.z = (uint8)z;
+        _peepPathFindHistory[0].direction  = 0xF;
+
+        uint16 score = 0xFFFF;
+        /* Variable endXYZ contains the end location of the
+         * search path. */
+        LocationXYZ8 endXYZ;
+        endXYZ.x = 0;
+        endXYZ.y = 0;
+        endXYZ.z = 0;
+
+        uint8 endSteps = 255;
+
+        /* Variable endJunctions is the number of junctions
+         * passed through in the search path.
+         * Variables endJunctionList and endDirectionList
+         * contain the junctions and corresponding directions
+         * of the search path.
+         * In the future these could be used to visualise the
+         * pathfinding on the map. */
+        uint8        endJunctions         = 0;
+        LocationXYZ8 endJunctionList[16]  = { 0 };
+        uint8        endDirectionList[16] = { 0 };
+
+        bool inPatrolArea = false;
+        if (peep->type == PEEP_TYPE_STAFF && peep->staff_type == STAFF_TYPE_MECHANIC)
+        {
+            /* Mechanics are the only staff type that
+             * pathfind to a destination. Determine if the
+             * mechanic is in their patrol area. */
+            inPatrolArea = staff_is_location_in_patrol(peep, peep->next_x, peep->next_y);
+        }
 
 #if defined(DEBUG_LEVEL_2) && DEBUG_LEVEL_2
-            if (gPathFindDebug)
-            {
-                log_verbose("Pathfind searching in direction: %d from %d,%d,%d", test_edge, x >> 5, y >> 5, z);
-            }
+        if (gPathFindDebug)
+        {
+            log_verbose("Pathfind searching in direction: %d from %d,%d,%d", test_edge, x >> 5, y >> 5, z);
+        }
 #endif // defined(DEBUG_LEVEL_2) && DEBUG_LEVEL_2
 
-            peep_pathfind_heuristic_search(x, y, height, peep, first_tile_element, inPatrolArea, 0, &score, test_edge,
-                                           &endJunctions, endJunctionList, endDirectionList, &endXYZ, &endSteps);
+        peep_pathfind_heuristic_search(x, y, height, peep, first_tile_element, inPatrolArea, 0, &score, test_edge,
+                                       &endJunctions, endJunctionList, endDirectionList, &endXYZ, &endSteps);
 
 #if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
-            if (gPathFindDebug)
-            {
-                log_verbose("Pathfind test edge: %d score: %d steps: %d end: %d,%d,%d junctions: %d", test_edge, score,
-                            endSteps, endXYZ.x, endXYZ.y, endXYZ.z, endJunctions);
-                for (uint8 listIdx = 0; listIdx < endJunctions; listIdx++)
-                {
-                    log_info("Junction#%d %d,%d,%d Direction %d", listIdx + 1, endJunctionList[listIdx].x,
-                             endJunctionList[listIdx].y, endJunctionList[listIdx].z, endDirectionList[listIdx]);
-                }
-            }
-#endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
-
-            if (score < best_score || (score == best_score && endSteps < best_sub))
+        if (gPathFindDebug)
+        {
+            log_verbose("Pathfind test edge: %d score: %d steps: %d end: %d,%d,%d junctions: %d", test_edge, score,
+                        endSteps, endXYZ.x, endXYZ.y, endXYZ.z, endJunctions);
+            for (uint8 listIdx = 0; listIdx < endJunctions; listIdx++)
             {
-                chosen_edge = test_edge;
-                best_score  = score;
-                best_sub    = endSteps;
-#if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
-                bestJunctions = endJunctions;
-                for (uint8 index = 0; index < endJunctions; index++)
-                {
-                    bestJunctionList[index].x = endJunctionList[index].x;
-                    bestJunctionList[index].y = endJunctionList[index].y;
-                    bestJunctionList[index].z = endJunctionList[index].z;
-                    bestDirectionList[index]  = endDirectionList[index];
-                }
-                bestXYZ.x = endXYZ.x;
-                bestXYZ.y = endXYZ.y;
-                bestXYZ.z = endXYZ.z;
-#endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+                log_info("Junction#%d %d,%d,%d Direction %d", listIdx + 1, endJunctionList[listIdx].x,
+                         endJunctionList[listIdx].y, endJunctionList[listIdx].z, endDirectionList[listIdx]);
             }
         }
+#endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
 
-        /* Check if the heuristic search failed. e.g. all connected
-         * paths are within the search limits and none reaches the
-         * goal. */
-        if (best_score == 0xFFFF)
+        if (score < best_score || (score == best_score && endSteps < best_sub))
         {
+            chosen_edge = test_edge;
+            best_score  = score;
+            best_sub    = endSteps;
 #if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
-            if (gPathFindDebug)
+            bestJunctions = endJunctions;
+            for (uint8 index = 0; index < endJunctions; index++)
             {
-                log_verbose("Pathfind heuristic search failed.");
+                bestJunctionList[index].x = endJunctionList[index].x;
+                bestJunctionList[index].y = endJunctionList[index].y;
+                bestJunctionList[index].z = endJunctionList[index].z;
+                bestDirectionList[index]  = endDirectionList[index];
             }
+            bestXYZ.x = endXYZ.x;
+            bestXYZ.y = endXYZ.y;
+            bestXYZ.z = endXYZ.z;
 #endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
-            return -1;
         }
+    }
+
+    /* Check if the heuristic search failed. e.g. all connected
+     * paths are within the search limits and none reaches the
+     * goal. */
+    if (best_score == 0xFFFF)
+    {
 #if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
         if (gPathFindDebug)
         {
-            log_verbose("Pathfind best edge %d with score %d steps %d", chosen_edge, best_score, best_sub);
-            for (uint8 listIdx = 0; listIdx < bestJunctions; listIdx++)
-            {
-                log_verbose("Junction#%d %d,%d,%d Direction %d", listIdx + 1, bestJunctionList[listIdx].x,
-                            bestJunctionList[listIdx].y, bestJunctionList[listIdx].z, bestDirectionList[listIdx]);
-            }
-            log_verbose("End at %d,%d,%d", bestXYZ.x, bestXYZ.y, bestXYZ.z);
+            log_verbose("Pathfind heuristic search failed.");
         }
 #endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+        return -1;
     }
-
-    if (isThin)
+#if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+    if (gPathFindDebug)
     {
-        for (sint32 i = 0; i < 4; ++i)
+        log_verbose("Pathfind best edge %d with score %d steps %d", chosen_edge, best_score, best_sub);
+        for (uint8 listIdx = 0; listIdx < bestJunctions; listIdx++)
         {
-            if (peep->pathfind_history[i].x == x >> 5 && peep->pathfind_history[i].y == y >> 5 &&
-                peep->pathfind_history[i].z == z)
-            {
-                /* Peep remembers this junction, so remove the
-                 * chosen_edge from those left to try. */
-                peep->pathfind_history[i].direction &= ~(1 << chosen_edge);
-                /* Also remove the edge through which the peep
-                 * entered the junction from those left to try. */
-                peep->pathfind_history[i].direction &= ~(1 << (peep->direction ^ 2));
+            log_verbose("Junction#%d %d,%d,%d Direction %d", listIdx + 1, bestJunctionList[listIdx].x,
+                        bestJunctionList[listIdx].y, bestJunctionList[listIdx].z, bestDirectionList[listIdx]);
+        }
+        log_verbose("End at %d,%d,%d", bestXYZ.x, bestXYZ.y, bestXYZ.z);
+    }
+#endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+    return chosen_edge;
+}
+
+static void peep_pathfind_prepare_cache()
+{
+    if (_peepPathFindCacheInvalid || _peepPathFindCache.size() >= PEEP_PATHFIND_CACHE_MAX_ENTRIES)
+    {
+        _peepPathFindCache.clear();
+        _peepPathFindCacheInvalid = false;
+    }
+}
+
+/**
+ * Chooses the best of the key's edges, using the direction cached for the key
+ * when the peep is a guest.
+ */
+static sint32 peep_pathfind_find_best_edge(const PeepPathFindCacheKey * key, rct_peep * peep,
+                                           rct_tile_element * first_tile_element)
+{
+    /* Staff are left out of the cache as their search also depends on
+     * their patrol area. */
+    bool useCache = (peep->type == PEEP_TYPE_GUEST);
 #if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
-                if (gPathFindDebug)
-                {
-                    log_verbose(
-                        "Updating existing pf_history (in index: %d) for %d,%d,%d without entry edge %d & exit edge %d.", i,
-                        x >> 5, y >> 5, z, peep->direction ^ 2, chosen_edge);
-                }
+    useCache = useCache && !gPathFindDebug;
 #endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
-                return chosen_edge;
-            }
-        }
-
-        /* Peep does not remember this junction, so forget a junction
-         * and remember this junction. */
-        sint32 i = peep->pathfind_goal.direction++;
-        peep->pathfind_goal.direction &= 3;
-        peep->pathfind_history[i].x         = x >> 5;
-        peep->pathfind_history[i].y         = y >> 5;
-        peep->pathfind_history[i].z         = z;
-        peep->pathfind_history[i].direction = permitted_edges;
-        /* Remove the chosen_edge from those left to try. */
-        peep->pathfind_history[i].direction &= ~(1 << chosen_edge);
-        /* Also remove the edge through which the peep
-         * entered the junction from those left to try. */
-        peep->pathfind_history[i].direction &= ~(1 << (peep->direction ^ 2));
+    if (!useCache)
+    {
+        return peep_pathfind_search_edges(key, peep, first_tile_element);
+    }
+
+    peep_pathfind_prepare_cache();
+    auto it = _peepPathFindCache.find(*key);
+    if (it != _peepPathFindCache.end())
+    {
+        return it->second;
+    }
+
+    sint32 chosen_edge        = peep_pathfind_search_edges(key, peep, first_tile_element);
+    _peepPathFindCache[*key] = chosen_edge;
+    return chosen_edge;
+}
+
+/**
+ * Returns:
+ *   -1   - no direction chosen
+ *   0..3 - chosen direction
+ *
+ *  rct2: 0x0069A5F0
+ */
+sint32 peep_pathfind_choose_direction(sint16 x, sint16 y, uint8 z, rct_peep * peep)
+{
+    // The max number of thin junctions searched - a per-search-path limit.
+    _peepPathFindMaxJunctions = peep_pathfind_get_max_number_junctions(peep);
+
+    // Used to allow walking through no entry banners
+    _peepPathFindIsStaff = (peep->type == PEEP_TYPE_STAFF);
+
+    LocationXYZ8 goal = { (uint8)(gPeepPathFindGoalPosition.x >> 5),
+                      (uint8)(gPeepPathFindGoalPosition.y >> 5),
+                      (uint8)(gPeepPathFindGoalPosition.z) };
+
+#if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+    if (gPathFindDebug)
+    {
+        log_verbose("Choose direction for %s for goal %d,%d,%d from %d,%d,%d", gPathFindDebugPeepName, goal.x, goal.y, goal.z,
+                    x >> 5, y >> 5, z);
+    }
+#endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+
+    rct_tile_element * first_tile_element;
+    uint8             permitted_edges;
+    bool              isThin;
+    // Peep is not on a path.
+    if (!peep_pathfind_get_junction(x, y, z, &first_tile_element, &permitted_edges, &isThin))
+        return -1;
+
+    PeepPathFindCacheKey key;
+    // Zero the whole key first, as it is hashed and compared including padding
+    memset(&key, 0, sizeof(key));
+    key.goal                  = gPeepPathFindGoalPosition;
+    key.x                     = x;
+    key.y                     = y;
+    key.z                     = z;
+    key.max_junctions         = _peepPathFindMaxJunctions;
+    key.queue_ride_index      = gPeepPathFindQueueRideIndex;
+    key.ignore_foreign_queues = gPeepPathFindIgnoreForeignQueues;
+
+    uint8 edges = peep_pathfind_get_untried_edges(peep, x, y, z, goal, permitted_edges, isThin, key.history);
+    memcpy(peep->pathfind_history, key.history, sizeof(peep->pathfind_history));
+
+    /* If this is a new goal for the peep. Store it and reset the peep's
+     * pathfind_history. */
+    if (peep_pathfind_is_new_goal(peep, goal))
+    {
+        peep->pathfind_goal.x         = goal.x;
+        peep->pathfind_goal.y         = goal.y;
+        peep->pathfind_goal.z         = goal.z;
+        peep->pathfind_goal.direction = 0;
+
+        // The pathfinding history was cleared by peep_pathfind_get_untried_edges()
 #if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
         if (gPathFindDebug)
         {
-            log_verbose("Storing new pf_history (in index: %d) for %d,%d,%d without entry edge %d & exit edge %d.", i, x >> 5,
-                        y >> 5, z, peep->direction ^ 2, chosen_edge);
+            log_verbose("New goal; clearing pf_history.");
         }
 #endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
     }
 
+    // Peep has tried all edges.
+    if (edges == 0)
+        return -1;
+
+    sint32 chosen_edge = bitscanforward(edges);
+
+    // Peep has multiple edges still to try.
+    if (edges & ~(1 << chosen_edge))
+    {
+        key.edges   = edges;
+        chosen_edge = peep_pathfind_find_best_edge(&key, peep, first_tile_element);
+        if (chosen_edge == -1)
+            return -1;
+    }
+
+    if (isThin)
+    {
+        peep_pathfind_remember_junction(x, y, z, peep, permitted_edges, chosen_edge);
+    }
     return chosen_edge;
 }
 
@@ -11235,6 +11508,261 @@ static void get_ride_queue_end(sint16 * x, sint16 * y, sint16 * z)
     *z = tileElement->base_height;
 }
 
+/**
+ * Gets the end of the queue of the ride entrance station a guest heading for
+ * the ride walks to.
+ */
+static void guest_path_find_get_ride_goal(const rct_peep * peep, const Ride * ride, sint16 * outX, sint16 * outY, sint16 * outZ)
+{
+    /* Find the ride's closest entrance station to the peep.
+     * At the same time, count how many entrance stations there are and
+     * which stations are entrance stations. */
+    uint16 closestDist       = 0xFFFF;
+    uint8  closestStationNum = 0;
+
+    sint32 numEntranceStations = 0;
+    uint8  entranceStations    = 0;
+
+    for (uint8 stationNum = 0; stationNum < MAX_STATIONS; ++stationNum)
+    {
+        if (ride->entrances[stationNum].xy ==
+            RCT_XY8_UNDEFINED) // stationNum has no entrance (so presumably an exit only station).
+            continue;
+
+        numEntranceStations++;
+        entranceStations |= (1 << stationNum);
+
+        sint16 stationX = (ride->entrances[stationNum]).x * 32;
+        sint16 stationY = (ride->entrances[stationNum]).y * 32;
+        uint16 dist     = abs(stationX - peep->next_x) + abs(stationY - peep->next_y);
+
+        if (dist < closestDist)
+        {
+            closestDist       = dist;
+            closestStationNum = stationNum;
+            continue;
+        }
+    }
+
+    // Ride has no stations with an entrance, so head to station 0.
+    if (numEntranceStations == 0)
+        closestStationNum = 0;
+
+    /* If a ride has multiple entrance stations and is set to sync with
+     * adjacent stations, cycle through the entrance stations (based on
+     * number of rides the peep has been on) so the peep will try the
+     * different sections of the ride.
+     * In this case, the ride's various entrance stations will typically,
+     * though not necessarily, be adjacent to one another and consequently
+     * not too far for the peep to walk when cycling between them.
+     * Note: the same choice of station must made while the peep navigates
+     * to the station. Consequently a random station selection here is not
+     * appropriate. */
+    if (numEntranceStations > 1 && (ride->depart_flags & RIDE_DEPART_SYNCHRONISE_WITH_ADJACENT_STATIONS))
+    {
+        sint32 select = peep->no_of_rides % numEntranceStations;
+        while (select > 0)
+        {
+            closestStationNum = bitscanforward(entranceStations);
+            entranceStations &= ~(1 << closestStationNum);
+            select--;
+        }
+        closestStationNum = bitscanforward(entranceStations);
+    }
+
+    LocationXY8 entranceXY;
+    if (numEntranceStations == 0)
+        entranceXY = ride->station_starts[closestStationNum]; // closestStationNum is always 0 here.
+    else
+        entranceXY = ride->entrances[closestStationNum];
+
+    sint16 x = entranceXY.x * 32;
+    sint16 y = entranceXY.y * 32;
+    sint16 z = ride->station_heights[closestStationNum];
+
+    get_ride_queue_end(&x, &y, &z);
+
+    *outX = x;
+    *outY = y;
+    *outZ = z;
+}
+
+/**
+ * Predicts the key of the cached direction a walking guest will look up the
+ * next time it chooses a direction at a junction. Neither the guest nor the
+ * random number generator are changed, so a wrong prediction only costs the
+ * search it was used for.
+ * @return false if the guest is not expected to search for a direction.
+ */
+static bool peep_pathfind_predict_guest_key(rct_peep * peep, PeepPathFindCacheKey * key,
+                                            rct_tile_element ** outFirstTileElement)
+{
+    if (peep->type != PEEP_TYPE_GUEST || peep->state != PEEP_STATE_WALKING || peep->outside_of_park != 0)
+        return false;
+
+    // Guests off the path do not search and PEEP_FLAGS_2 makes the junction limit random
+    if ((peep->next_var_29 & 0x18) || (peep->peep_flags & PEEP_FLAGS_2))
+        return false;
+
+    sint16 x, y, z;
+    uint8  queueRideIndex;
+    if (peep->peep_flags & PEEP_FLAGS_LEAVING_PARK)
+    {
+        // See guest_path_find_park_entrance()
+        uint8 entranceNum = peep->current_ride;
+        if (!(peep->peep_flags & PEEP_FLAGS_PARK_ENTRANCE_CHOSEN) || entranceNum >= MAX_PARK_ENTRANCES ||
+            gParkEntrances[entranceNum].x == LOCATION_NULL)
+        {
+            entranceNum = get_nearest_park_entrance_index(peep->next_x, peep->next_y);
+            if (entranceNum == 0xFF)
+                return false;
+        }
+        x              = gParkEntrances[entranceNum].x;
+        y              = gParkEntrances[entranceNum].y;
+        z              = gParkEntrances[entranceNum].z >> 3;
+        queueRideIndex = 255;
+    }
+    else
+    {
+        if (peep->guest_heading_to_ride_id == 0xFF)
+            return false;
+
+        Ride * ride = get_ride(peep->guest_heading_to_ride_id);
+        if (ride->status != RIDE_STATUS_OPEN)
+            return false;
+
+        guest_path_find_get_ride_goal(peep, ride, &x, &y, &z);
+        queueRideIndex = peep->guest_heading_to_ride_id;
+    }
+
+    uint8 permitted_edges;
+    bool  isThin;
+    if (!peep_pathfind_get_junction(peep->next_x, peep->next_y, peep->next_z, outFirstTileElement, &permitted_edges, &isThin))
+        return false;
+
+    memset(key, 0, sizeof(PeepPathFindCacheKey));
+    key->goal                  = { x, y, z };
+    key->x                     = peep->next_x;
+    key->y                     = peep->next_y;
+    key->z                     = peep->next_z;
+    key->max_junctions         = peep_pathfind_get_max_number_junctions(peep);
+    key->queue_ride_index      = queueRideIndex;
+    key->ignore_foreign_queues = true;
+
+    LocationXYZ8 goal = { (uint8)(x >> 5), (uint8)(y >> 5), (uint8)z };
+    key->edges = peep_pathfind_get_untried_edges(peep, key->x, key->y, key->z, goal, permitted_edges, isThin, key->history);
+
+    // A single edge is taken without searching
+    return bitcount(key->edges) >= 2;
+}
+
+/**
+ * Checks the mirrored fields of the peep at the given index of the update
+ * order, so only the sprites of walking guests are read by the prediction.
+ */
+static bool peep_pathfind_may_search(uint32 index)
+{
+    return _peepHotData.type[index] == PEEP_TYPE_GUEST && _peepHotData.state[index] == PEEP_STATE_WALKING &&
+           _peepHotData.outside_of_park[index] == 0 && !(_peepHotData.next_var_29[index] & 0x18) &&
+           !(_peepHotData.peep_flags[index] & PEEP_FLAGS_2);
+}
+
+struct PeepPathFindPrediction
+{
+    PeepPathFindCacheKey key;
+    rct_peep *           peep;
+    rct_tile_element *   first_tile_element;
+    bool                 predicted;
+    sint8                chosen_edge;
+};
+
+// Guests are only searched for in parallel when there are at least this many
+#define PEEP_PATHFIND_PREFILL_MIN_PEEPS 256
+// Number of guests predicted or searched for by each job
+#define PEEP_PATHFIND_PREFILL_BATCH_SIZE 64
+
+static std::unique_ptr<JobPool>             _peepPathFindJobs;
+static std::vector<PeepPathFindPrediction>   _peepPathFindPredictions;
+static std::vector<PeepPathFindPrediction *> _peepPathFindPendingSearches;
+
+/**
+ * Fills the pathfinding cache with the directions the guests in the update
+ * order are expected to choose this tick, running the searches on several
+ * threads. The searches only read the map, so the peep update that follows
+ * still runs in order on the main thread and finds the same direction in the
+ * cache that it would have found by searching itself; which guests were
+ * predicted correctly only affects how much work is left for it.
+ */
+static void peep_pathfind_prefill_cache(uint32 count)
+{
+    if (count < PEEP_PATHFIND_PREFILL_MIN_PEEPS)
+        return;
+
+#if defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+    if (gPathFindDebug)
+        return;
+#endif // defined(DEBUG_LEVEL_1) && DEBUG_LEVEL_1
+
+    if (_peepPathFindJobs == nullptr)
+    {
+        _peepPathFindJobs = std::make_unique<JobPool>();
+    }
+
+    _peepPathFindPredictions.resize(count);
+    for (uint32 start = 0; start < count; start += PEEP_PATHFIND_PREFILL_BATCH_SIZE)
+    {
+        uint32 end = std::min<uint32>(count, start + PEEP_PATHFIND_PREFILL_BATCH_SIZE);
+        _peepPathFindJobs->AddTask([start, end]() -> void
+        {
+            for (uint32 j = start; j < end; j++)
+            {
+                PeepPathFindPrediction &prediction = _peepPathFindPredictions[j];
+                prediction.peep      = &(get_sprite(_peepHotData.sprite_index[j])->peep);
+                prediction.predicted = peep_pathfind_may_search(j) &&
+                                       peep_pathfind_predict_guest_key(prediction.peep, &prediction.key,
+                                                                       &prediction.first_tile_element);
+            }
+        });
+    }
+    _peepPathFindJobs->Join();
+
+    // Many guests share a goal and junction, so each distinct key is only searched for once
+    peep_pathfind_prepare_cache();
+    std::unordered_set<PeepPathFindCacheKey, PeepPathFindCacheKeyHash, PeepPathFindCacheKeyEqual> pendingKeys;
+    _peepPathFindPendingSearches.clear();
+    for (auto &prediction : _peepPathFindPredictions)
+    {
+        if (prediction.predicted && _peepPathFindCache.find(prediction.key) == _peepPathFindCache.end() &&
+            pendingKeys.insert(prediction.key).second)
+        {
+            _peepPathFindPendingSearches.push_back(&prediction);
+        }
+    }
+
+    size_t numSearches = std::min<size_t>(_peepPathFindPendingSearches.size(),
+                                          PEEP_PATHFIND_CACHE_MAX_ENTRIES - _peepPathFindCache.size());
+    for (size_t start = 0; start < numSearches; start += PEEP_PATHFIND_PREFILL_BATCH_SIZE)
+    {
+        size_t end = std::min<size_t>(numSearches, start + PEEP_PATHFIND_PREFILL_BATCH_SIZE);
+        _peepPathFindJobs->AddTask([start, end]() -> void
+        {
+            for (size_t j = start; j < end; j++)
+            {
+                PeepPathFindPrediction * prediction = _peepPathFindPendingSearches[j];
+                prediction->chosen_edge = peep_pathfind_search_edges(&prediction->key, prediction->peep,
+                                                                     prediction->first_tile_element);
+            }
+        });
+    }
+    _peepPathFindJobs->Join();
+
+    for (size_t j = 0; j < numSearches; j++)
+    {
+        const PeepPathFindPrediction * prediction = _peepPathFindPendingSearches[j];
+        _peepPathFindCache[prediction->key] = prediction->chosen_edge;
+    }
+}
+
 /**
  *
  *  rct2: 0x00694C35
@@ -11446,74 +11974,7 @@ static sint32 guest_path_finding(rct_peep * peep)
 
     // The ride is open.
     gPeepPathFindQueueRideIndex = rideIndex;
-
-    /* Find the ride's closest entrance station to the peep.
-     * At the same time, count how many entrance stations there are and
-     * which stations are entrance stations. */
-    uint16 closestDist       = 0xFFFF;
-    uint8  closestStationNum = 0;
-
-    sint32 numEntranceStations = 0;
-    uint8  entranceStations    = 0;
-
-    for (uint8 stationNum = 0; stationNum < MAX_STATIONS; ++stationNum)
-    {
-        if (ride->entrances[stationNum].xy ==
-            RCT_XY8_UNDEFINED) // stationNum has no entrance (so presumably an exit only station).
-            continue;
-
-        numEntranceStations++;
-        entranceStations |= (1 << stationNum);
-
-        sint16 stationX = (ride->entrances[stationNum]).x * 32;
-        sint16 stationY = (ride->entrances[stationNum]).y * 32;
-        uint16 dist     = abs(stationX - peep->next_x) + abs(stationY - peep->next_y);
-
-        if (dist < closestDist)
-        {
-            closestDist       = dist;
-            closestStationNum = stationNum;
-            continue;
-        }
-    }
-
-    // Ride has no stations with an entrance, so head to station 0.
-    if (numEntranceStations == 0)
-        closestStationNum = 0;
-
-    /* If a ride has multiple entrance stations and is set to sync with
-     * adjacent stations, cycle through the entrance stations (based on
-     * number of rides the peep has been on) so the peep will try the
-     * different sections of the ride.
-     * In this case, the ride's various entrance stations will typically,
-     * though not necessarily, be adjacent to one another and consequently
-     * not too far for the peep to walk when cycling between them.
-     * Note: the same choice of station must made while the peep navigates
-     * to the station. Consequently a random station selection here is not
-     * appropriate. */
-    if (numEntranceStations > 1 && (ride->depart_flags & RIDE_DEPART_SYNCHRONISE_WITH_ADJACENT_STATIONS))
-    {
-        sint32 select = peep->no_of_rides % numEntranceStations;
-        while (select > 0)
-        {
-            closestStationNum = bitscanforward(entranceStations);
-            entranceStations &= ~(1 << closestStationNum);
-            select--;
-        }
-        closestStationNum = bitscanforward(entranceStations);
-    }
-
-    LocationXY8 entranceXY;
-    if (numEntranceStations == 0)
-        entranceXY = ride->station_starts[closestStationNum]; // closestStationNum is always 0 here.
-    else
-        entranceXY = ride->entrances[closestStationNum];
-
-    x = entranceXY.x * 32;
-    y = entranceXY.y * 32;
-    z = ride->station_heights[closestStationNum];
-
-    get_ride_queue_end(&x, &y, &z);
+    guest_path_find_get_ride_goal(peep, ride, &x, &y, &z);
 
     gPeepPathFindGoalPosition        = { x, y, z };
     gPeepPathFindIgnoreForeignQueues = true;
@@ -13514,40 +13975,10 @@ static void peep_pick_ride_to_go_on(rct_peep * peep)
     else
     {
         // Take nearby rides into consideration
-        sint32 cx = floor2(peep->x, 32);
-        sint32 cy = floor2(peep->y, 32);
-        for (sint32 x = cx - 320; x <= cx + 320; x += 32)
-        {
-            for (sint32 y = cy - 320; y <= cy + 320; y += 32)
-            {
-                if (x >= 0 && y >= 0 && x < (256 * 32) && y < (256 * 32))
-                {
-                    rct_tile_element * tileElement = map_get_first_element_at(x >> 5, y >> 5);
-                    do
-                    {
-                        if (tile_element_get_type(tileElement) != TILE_ELEMENT_TYPE_TRACK)
-                            continue;
-
-                        sint32 rideIndex = track_element_get_ride_index(tileElement);
-                        _peepRideConsideration[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
-                    } while (!tile_element_is_last_for_tile(tileElement++));
-                }
-            }
-        }
+        ride_candidates_add_nearby(peep->x >> 5, peep->y >> 5, 10, _peepRideConsideration);
 
         // Always take the tall rides into consideration (realistic as you can usually see them from anywhere in the park)
-        sint32 i;
-        FOR_ALL_RIDES(i, ride)
-        {
-            if (ride->status != RIDE_STATUS_OPEN)
-                continue;
-            if (!ride_has_ratings(ride))
-                continue;
-            if (ride->highest_drop_height <= 66 && ride->excitement < RIDE_RATING(8, 00))
-                continue;
-
-            _peepRideConsideration[i >> 5] |= (1u << (i & 0x1F));
-        }
+        ride_candidates_add_visible(_peepRideConsideration);
     }
 
     // Filter the considered rides
@@ -13653,28 +14084,17 @@ static void peep_head_for_nearest_ride_type(rct_peep * peep, sint32 rideType)
     else
     {
         // Take nearby rides into consideration
-        sint32 cx = floor2(peep->x, 32);
-        sint32 cy = floor2(peep->y, 32);
-        for (sint32 x = cx - 320; x <= cx + 320; x += 32)
+        uint32 nearbyRides[RIDE_CANDIDATE_SET_WORDS] = { 0 };
+        ride_candidates_add_nearby(peep->x >> 5, peep->y >> 5, 10, nearbyRides);
+        for (sint32 rideIndex = 0; rideIndex < MAX_RIDES; rideIndex++)
         {
-            for (sint32 y = cy - 320; y <= cy + 320; y += 32)
-            {
-                if (x >= 0 && y >= 0 && x < (256 * 32) && y < (256 * 32))
-                {
-                    rct_tile_element * tileElement = map_get_first_element_at(x >> 5, y >> 5);
-                    do
-                    {
-                        if (tile_element_get_type(tileElement) != TILE_ELEMENT_TYPE_TRACK)
-                            continue;
+            if (!(nearbyRides[rideIndex >> 5] & (1u << (rideIndex & 0x1F))))
+                continue;
 
-                        sint32 rideIndex = track_element_get_ride_index(tileElement);
-                        ride             = get_ride(rideIndex);
-                        if (ride->type == rideType)
-                        {
-                            _peepRideConsideration[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
-                        }
-                    } while (!tile_element_is_last_for_tile(tileElement++));
-                }
+            ride = get_ride(rideIndex);
+            if (ride->type == rideType)
+            {
+                _peepRideConsideration[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
             }
         }
     }
@@ -13785,28 +14205,17 @@ static void peep_head_for_nearest_ride_with_flags(rct_peep * peep, sint32 rideTy
     else
     {
         // Take nearby rides into consideration
-        sint32 cx = floor2(peep->x, 32);
-        sint32 cy = floor2(peep->y, 32);
-        for (sint32 x = cx - 320; x <= cx + 320; x += 32)
+        uint32 nearbyRides[RIDE_CANDIDATE_SET_WORDS] = { 0 };
+        ride_candidates_add_nearby(peep->x >> 5, peep->y >> 5, 10, nearbyRides);
+        for (sint32 rideIndex = 0; rideIndex < MAX_RIDES; rideIndex++)
         {
-            for (sint32 y = cy - 320; y <= cy + 320; y += 32)
-            {
-                if (x >= 0 && y >= 0 && x < (256 * 32) && y < (256 * 32))
-                {
-                    rct_tile_element * tileElement = map_get_first_element_at(x >> 5, y >> 5);
-                    do
-                    {
-                        if (tile_element_get_type(tileElement) != TILE_ELEMENT_TYPE_TRACK)
-                            continue;
+            if (!(nearbyRides[rideIndex >> 5] & (1u << (rideIndex & 0x1F))))
+                continue;
 
-                        sint32 rideIndex = track_element_get_ride_index(tileElement);
-                        ride             = get_ride(rideIndex);
-                        if (ride_type_has_flag(ride->type, rideTypeFlags))
-                        {
-                            _peepRideConsideration[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
-                        }
-                    } while (!tile_element_is_last_for_tile(tileElement++));
-                }
+            ride = get_ride(rideIndex);
+            if (ride_type_has_flag(ride->type, rideTypeFlags))
+            {
+                _peepRideConsideration[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
             }
         }
     }
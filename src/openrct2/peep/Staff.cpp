@@ -202,7 +202,7 @@ static money32 staff_hire_new_staff_member(uint8 staff_type, uint8 flags, sint16
     gCommandPosition.y      = command_y;
     gCommandPosition.z      = command_z;
 
-    if (gSpriteListCount[SPRITE_LIST_NULL] < 400)
+    if (sprite_get_free_count() < 400)
     {
         gGameCommandErrorText = STR_TOO_MANY_PEOPLE_IN_GAME;
         return MONEY32_UNDEFINED;
@@ -428,7 +428,7 @@ void game_command_set_staff_order(sint32 * eax, sint32 * ebx, sint32 * ecx, sint
     gCommandExpenditureType = RCT_EXPENDITURE_TYPE_WAGES;
     uint8  order_id         = *ebx >> 8;
     uint16 sprite_id        = *edx;
-    if (sprite_id >= MAX_SPRITES)
+    if (sprite_id >= gSpriteCapacity)
     {
         log_warning("Invalid game command, sprite_id = %u", sprite_id);
         *ebx = MONEY32_UNDEFINED;
@@ -481,7 +481,7 @@ void game_command_set_staff_patrol(sint32 * eax, sint32 * ebx, sint32 * ecx, sin
         sint32 x         = *eax;
         sint32 y         = *ecx;
         uint16 sprite_id = *edx;
-        if (sprite_id >= MAX_SPRITES)
+        if (sprite_id >= gSpriteCapacity)
         {
             *ebx = MONEY32_UNDEFINED;
             log_warning("Invalid sprite id %u", sprite_id);
@@ -535,7 +535,7 @@ void game_command_fire_staff_member(sint32 * eax, sint32 * ebx, sint32 * ecx, si
     {
         window_close_by_class(WC_FIRE_PROMPT);
         uint16 sprite_id = *edx;
-        if (sprite_id >= MAX_SPRITES)
+        if (sprite_id >= gSpriteCapacity)
         {
             log_warning("Invalid game command, sprite_id = %u", sprite_id);
             *ebx = MONEY32_UNDEFINED;
@@ -905,13 +905,17 @@ static uint8 staff_handyman_direction_to_nearest_litter(rct_peep * peep)
 {
     uint16       nearestLitterDist = (uint16)-1;
     rct_litter * nearestLitter     = NULL;
-    rct_litter * litter            = NULL;
 
-    for (uint16 litterIndex = gSpriteListHead[SPRITE_LIST_LITTER]; litterIndex != 0xFFFF; litterIndex = litter->next)
+    // Litter any further away than this is ignored below, so only the tiles within reach are searched
+    sprite_spatial_query query;
+    sprite_spatial_query_rect(&query, peep->x - 0x60, peep->y - 0x60, peep->x + 0x60, peep->y + 0x60);
+    for (rct_sprite * sprite; (sprite = sprite_spatial_query_next(&query)) != nullptr;)
     {
-        litter = &get_sprite(litterIndex)->litter;
+        if (sprite->unknown.linked_list_type_offset != SPRITE_LIST_LITTER * 2)
+            continue;
 
-        uint16 distance = abs(litter->x - peep->x) + abs(litter->y - peep->y) + abs(litter->z - peep->z) * 4;
+        rct_litter * litter   = &sprite->litter;
+        uint16       distance = abs(litter->x - peep->x) + abs(litter->y - peep->y) + abs(litter->z - peep->z) * 4;
 
         if (distance < nearestLitterDist)
         {
@@ -1513,15 +1517,15 @@ static sint32 staff_path_finding_misc(rct_peep * peep)
  */
 static void staff_entertainer_update_nearby_peeps(rct_peep * peep)
 {
-    uint16     spriteIndex;
-    rct_peep * guest;
-
-    FOR_ALL_GUESTS(spriteIndex, guest)
+    sprite_spatial_query query;
+    sprite_spatial_query_rect(&query, peep->x - 96, peep->y - 96, peep->x + 96, peep->y + 96);
+    for (rct_sprite * sprite; (sprite = sprite_spatial_query_next(&query)) != nullptr;)
     {
-        if (guest->x == LOCATION_NULL)
+        if (sprite->unknown.linked_list_type_offset != SPRITE_LIST_PEEP * 2 || sprite->peep.type != PEEP_TYPE_GUEST)
             continue;
 
-        sint16 z_dist = abs(peep->z - guest->z);
+        rct_peep * guest  = &sprite->peep;
+        sint16     z_dist = abs(peep->z - guest->z);
         if (z_dist > 48)
             continue;
 
@@ -50,6 +50,7 @@
 #include "../peep/Staff.h"
 #include "../rct1.h"
 #include "../ride/ride_data.h"
+#include "../ride/ride_ratings.h"
 #include "../ride/Track.h"
 #include "../util/SawyerCoding.h"
 #include "../util/Util.h"
@@ -1298,7 +1299,7 @@ private:
                 ImportPeep(peep, srcPeep);
             }
         }
-        for (size_t i = 0; i < MAX_SPRITES; i++)
+        for (size_t i = 0; i < gSpriteCapacity; i++)
         {
             rct_sprite * sprite = get_sprite(i);
             if (sprite->unknown.sprite_identifier == SPRITE_IDENTIFIER_VEHICLE)
@@ -1903,6 +1904,7 @@ private:
         FixTerrain();
         FixEntrancePositions();
         FixTileElementEntryTypes();
+        ride_ratings_clear_pending();
     }
 
     void ImportResearch()
@@ -2291,6 +2293,7 @@ private:
         }
 
         gNextFreeTileElement = nextFreeTileElement;
+        map_reset_tile_element_allocator();
     }
 
     void FixSceneryColours()
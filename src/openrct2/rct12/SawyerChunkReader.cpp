@@ -20,9 +20,17 @@
 #include "../core/Memory.hpp"
 #include "SawyerChunkReader.h"
 
+#ifdef PLATFORM_SSE2
+    #include <emmintrin.h>
+#endif
+
 // Allow chunks to be uncompressed to a maximum of 16 MiB
 constexpr size_t MAX_UNCOMPRESSED_CHUNK_SIZE = 16 * 1024 * 1024;
 
+// An RLE run is at most 129 bytes, when both buffers have room for that rounded up to whole 16 byte blocks
+// the run is copied a block at a time
+constexpr size_t RLE_BLOCK_COPY_MARGIN = 144;
+
 constexpr const char * EXCEPTION_MSG_CORRUPT_CHUNK_SIZE = "Corrupt chunk size.";
 constexpr const char * EXCEPTION_MSG_DESTINATION_TOO_SMALL = "Chunk data larger than allocated destination capacity.";
 constexpr const char * EXCEPTION_MSG_INVALID_CHUNK_ENCODING = "Invalid chunk encoding.";
@@ -183,7 +191,21 @@ size_t SawyerChunkReader::DecodeChunkRLE(void * dst, size_t dstCapacity, const v
                 throw SawyerChunkException(EXCEPTION_MSG_DESTINATION_TOO_SMALL);
             }
 
-            Memory::Set(dst8, src8[i], count);
+#ifdef PLATFORM_SSE2
+            if ((size_t)(dstEnd - dst8) >= RLE_BLOCK_COPY_MARGIN)
+            {
+                // Bytes written past the run are overwritten by the next one or lie beyond the result length
+                __m128i value = _mm_set1_epi8((char)src8[i]);
+                for (size_t j = 0; j < count; j += 16)
+                {
+                    _mm_storeu_si128((__m128i *)(dst8 + j), value);
+                }
+            }
+            else
+#endif
+            {
+                Memory::Set(dst8, src8[i], count);
+            }
             dst8 += count;
         }
         else
@@ -197,7 +219,20 @@ size_t SawyerChunkReader::DecodeChunkRLE(void * dst, size_t dstCapacity, const v
                 throw SawyerChunkException(EXCEPTION_MSG_DESTINATION_TOO_SMALL);
             }
 
-            Memory::Copy(dst8, src8 + i + 1, rleCodeByte + 1);
+#ifdef PLATFORM_SSE2
+            if ((size_t)(dstEnd - dst8) >= RLE_BLOCK_COPY_MARGIN && srcLength - (i + 1) >= RLE_BLOCK_COPY_MARGIN)
+            {
+                for (size_t j = 0; j <= rleCodeByte; j += 16)
+                {
+                    __m128i block = _mm_loadu_si128((const __m128i *)(src8 + i + 1 + j));
+                    _mm_storeu_si128((__m128i *)(dst8 + j), block);
+                }
+            }
+            else
+#endif
+            {
+                Memory::Copy(dst8, src8 + i + 1, rleCodeByte + 1);
+            }
             dst8 += rleCodeByte + 1;
             i += rleCodeByte + 1;
         }
@@ -226,7 +261,21 @@ size_t SawyerChunkReader::DecodeChunkRepeat(void * dst, size_t dstCapacity, cons
                 throw SawyerChunkException(EXCEPTION_MSG_DESTINATION_TOO_SMALL);
             }
 
-            Memory::Copy(dst8, copySrc, count);
+            if (dst8 - copySrc >= 8 && dstEnd - dst8 >= 8)
+            {
+                // The whole 8 byte block is already decoded, so copy it in one go and only advance by count
+                uint64 block;
+                std::memcpy(&block, copySrc, sizeof(block));
+                std::memcpy(dst8, &block, sizeof(block));
+            }
+            else
+            {
+                // Overlapping repeats copy bytes that have just been written
+                for (size_t j = 0; j < count; j++)
+                {
+                    dst8[j] = copySrc[j];
+                }
+            }
             dst8 += count;
         }
     }
@@ -242,8 +291,33 @@ size_t SawyerChunkReader::DecodeChunkRotate(void * dst, size_t dstCapacity, cons
 
     auto src8 = static_cast<const uint8 *>(src);
     auto dst8 = static_cast<uint8 *>(dst);
+    size_t i = 0;
+#ifdef PLATFORM_SSE2
+    // The rotation cycles through 1, 3, 5 and 7 bits, so is the same for each 32-bit lane of a block
+    const __m128i laneMasks[] =
+    {
+        _mm_set1_epi32(0x000000FF),
+        _mm_set1_epi32(0x0000FF00),
+        _mm_set1_epi32(0x00FF0000),
+        _mm_set1_epi32((sint32)0xFF000000),
+    };
+    for (; i + 16 <= srcLength; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(src8 + i));
+        __m128i result = _mm_setzero_si128();
+        for (sint32 lane = 0; lane < 4; lane++)
+        {
+            // SSE2 has no byte shifts, so shift 16-bit lanes and mask off the bits that crossed into the other byte
+            sint32 shift = (lane * 2) + 1;
+            __m128i right = _mm_and_si128(_mm_srl_epi16(block, _mm_cvtsi32_si128(shift)), _mm_set1_epi8((char)(0xFF >> shift)));
+            __m128i left = _mm_and_si128(_mm_sll_epi16(block, _mm_cvtsi32_si128(8 - shift)), _mm_set1_epi8((char)(0xFF << (8 - shift))));
+            result = _mm_or_si128(result, _mm_and_si128(_mm_or_si128(right, left), laneMasks[lane]));
+        }
+        _mm_storeu_si128((__m128i *)(dst8 + i), result);
+    }
+#endif
     uint8 code = 1;
-    for (size_t i = 0; i < srcLength; i++)
+    for (; i < srcLength; i++)
     {
         dst8[i] = ror8(src8[i], code);
         code = (code + 2) % 8;
@@ -17,6 +17,8 @@
 #include "../core/Exception.hpp"
 #include "../core/FileStream.hpp"
 #include "../core/IStream.hpp"
+#include "../core/Math.hpp"
+#include "../core/MemoryStream.h"
 #include "../core/String.hpp"
 #include "../core/Util.hpp"
 #include "../management/Award.h"
@@ -26,6 +28,9 @@
 #include "../rct12/SawyerChunkWriter.h"
 #include "S6Exporter.h"
 #include <functional>
+#include <future>
+#include <memory>
+#include <string>
 
 #include "../config/Config.h"
 #include "../Game.h"
@@ -40,6 +45,7 @@
 #include "../object.h"
 #include "../OpenRCT2.h"
 #include "../peep/Staff.h"
+#include "../platform/platform.h"
 #include "../ride/Ride.h"
 #include "../ride/ride_ratings.h"
 #include "../ride/TrackData.h"
@@ -51,9 +57,24 @@
 #include "../world/Park.h"
 #include "../world/sprite.h"
 
+/**
+ * Writes an array as consecutive chunks, none of which are larger than S6_EXTENDED_POOL_CHUNK_SIZE.
+ */
+template<typename T>
+static void WriteChunkedArray(SawyerChunkWriter &chunkWriter, const std::vector<T> &items, SAWYER_ENCODING encoding)
+{
+    constexpr size_t itemsPerChunk = S6_EXTENDED_POOL_CHUNK_SIZE / sizeof(T);
+    for (size_t i = 0; i < items.size(); i += itemsPerChunk)
+    {
+        size_t count = Math::Min(itemsPerChunk, items.size() - i);
+        chunkWriter.WriteChunk(&items[i], count * sizeof(T), encoding);
+    }
+}
+
 S6Exporter::S6Exporter()
 {
     RemoveTracklessRides = false;
+    UseRLE = true;
     memset(&_s6, 0, sizeof(_s6));
 }
 
@@ -79,6 +100,19 @@ void S6Exporter::SaveScenario(IStream * stream)
     Save(stream, true);
 }
 
+void S6Exporter::PackObjects()
+{
+    auto ms = MemoryStream();
+    if (!ExportObjectsList.empty())
+    {
+        IObjectRepository * objRepo = GetObjectRepository();
+        objRepo->WritePackedObjects(&ms, ExportObjectsList);
+    }
+    auto data = static_cast<const uint8 *>(ms.GetData());
+    _packedObjects.assign(data, data + ms.GetLength());
+    _objectsPacked = true;
+}
+
 void S6Exporter::Save(IStream * stream, bool isScenario)
 {
     _s6.header.type               = isScenario ? S6_TYPE_SCENARIO : S6_TYPE_SAVEDGAME;
@@ -86,9 +120,15 @@ void S6Exporter::Save(IStream * stream, bool isScenario)
     _s6.header.num_packed_objects = uint16(ExportObjectsList.size());
     _s6.header.version            = S6_RCT2_VERSION;
     _s6.header.magic_number       = S6_MAGIC_NUMBER;
+    _s6.header.openrct2_flags     = 0;
+    if (!_extraTileElements.empty() || !_extraSprites.empty())
+    {
+        _s6.header.openrct2_flags |= S6_OPENRCT2_FLAG_EXTENDED_POOLS;
+    }
     _s6.game_version_number       = 201028;
 
     auto chunkWriter = SawyerChunkWriter(stream);
+    auto rleEncoding = UseRLE ? SAWYER_ENCODING::RLECOMPRESSED : SAWYER_ENCODING::NONE;
 
     // 0: Write header chunk
     chunkWriter.WriteChunk(&_s6.header, SAWYER_ENCODING::ROTATE);
@@ -100,7 +140,11 @@ void S6Exporter::Save(IStream * stream, bool isScenario)
     }
 
     // 2: Write packed objects
-    if (_s6.header.num_packed_objects > 0)
+    if (_objectsPacked)
+    {
+        stream->Write(_packedObjects.data(), _packedObjects.size());
+    }
+    else if (_s6.header.num_packed_objects > 0)
     {
         IObjectRepository * objRepo = GetObjectRepository();
         objRepo->WritePackedObjects(stream, ExportObjectsList);
@@ -110,27 +154,38 @@ void S6Exporter::Save(IStream * stream, bool isScenario)
     chunkWriter.WriteChunk(_s6.objects, sizeof(_s6.objects), SAWYER_ENCODING::ROTATE);
 
     // 4: Misc fields (data, rand...) chunk
-    chunkWriter.WriteChunk(&_s6.elapsed_months, 16, SAWYER_ENCODING::RLECOMPRESSED);
+    chunkWriter.WriteChunk(&_s6.elapsed_months, 16, rleEncoding);
 
     // 5: Map elements + sprites and other fields chunk
-    chunkWriter.WriteChunk(&_s6.tile_elements, 0x180000, SAWYER_ENCODING::RLECOMPRESSED);
+    chunkWriter.WriteChunk(&_s6.tile_elements, 0x180000, rleEncoding);
 
     if (_s6.header.type == S6_TYPE_SCENARIO)
     {
         // 6 to 13:
-        chunkWriter.WriteChunk(&_s6.next_free_tile_element_pointer_index, 0x27104C, SAWYER_ENCODING::RLECOMPRESSED);
-        chunkWriter.WriteChunk(&_s6.guests_in_park, 4, SAWYER_ENCODING::RLECOMPRESSED);
-        chunkWriter.WriteChunk(&_s6.last_guests_in_park, 8, SAWYER_ENCODING::RLECOMPRESSED);
-        chunkWriter.WriteChunk(&_s6.park_rating, 2, SAWYER_ENCODING::RLECOMPRESSED);
-        chunkWriter.WriteChunk(&_s6.active_research_types, 1082, SAWYER_ENCODING::RLECOMPRESSED);
-        chunkWriter.WriteChunk(&_s6.current_expenditure, 16, SAWYER_ENCODING::RLECOMPRESSED);
-        chunkWriter.WriteChunk(&_s6.park_value, 4, SAWYER_ENCODING::RLECOMPRESSED);
-        chunkWriter.WriteChunk(&_s6.completed_company_value, 0x761E8, SAWYER_ENCODING::RLECOMPRESSED);
+        chunkWriter.WriteChunk(&_s6.next_free_tile_element_pointer_index, 0x27104C, rleEncoding);
+        chunkWriter.WriteChunk(&_s6.guests_in_park, 4, rleEncoding);
+        chunkWriter.WriteChunk(&_s6.last_guests_in_park, 8, rleEncoding);
+        chunkWriter.WriteChunk(&_s6.park_rating, 2, rleEncoding);
+        chunkWriter.WriteChunk(&_s6.active_research_types, 1082, rleEncoding);
+        chunkWriter.WriteChunk(&_s6.current_expenditure, 16, rleEncoding);
+        chunkWriter.WriteChunk(&_s6.park_value, 4, rleEncoding);
+        chunkWriter.WriteChunk(&_s6.completed_company_value, 0x761E8, rleEncoding);
     }
     else
     {
         // 6: Everything else...
-        chunkWriter.WriteChunk(&_s6.next_free_tile_element_pointer_index, 0x2E8570, SAWYER_ENCODING::RLECOMPRESSED);
+        chunkWriter.WriteChunk(&_s6.next_free_tile_element_pointer_index, 0x2E8570, rleEncoding);
+    }
+
+    // 7: Tile elements and sprites past the RCT2 limits
+    if (_s6.header.openrct2_flags & S6_OPENRCT2_FLAG_EXTENDED_POOLS)
+    {
+        rct_s6_extended_pools pools;
+        pools.num_tile_elements = (uint32)(RCT2_MAX_TILE_ELEMENTS + _extraTileElements.size());
+        pools.num_sprites       = (uint32)(RCT2_MAX_SPRITES + _extraSprites.size());
+        chunkWriter.WriteChunk(&pools, rleEncoding);
+        WriteChunkedArray(chunkWriter, _extraTileElements, rleEncoding);
+        WriteChunkedArray(chunkWriter, _extraSprites, rleEncoding);
     }
 
     // Determine number of bytes written
@@ -183,7 +238,30 @@ void S6Exporter::Export()
     _s6.scenario_srand_0 = gScenarioSrand0;
     _s6.scenario_srand_1 = gScenarioSrand1;
 
-    memcpy(_s6.tile_elements, gTileElements, sizeof(_s6.tile_elements));
+    // Tiles are not stored in order in the pool and may have unused space between them, so each tile is
+    // written one after another as the importer expects
+    std::vector<rct_tile_element> tileElements;
+    tileElements.reserve((size_t)(gNextFreeTileElement - gTileElements));
+    for (sint32 y = 0; y < MAXIMUM_MAP_SIZE_TECHNICAL; y++)
+    {
+        for (sint32 x = 0; x < MAXIMUM_MAP_SIZE_TECHNICAL; x++)
+        {
+            const rct_tile_element * tileElement = map_get_first_element_at(x, y);
+            do
+            {
+                tileElements.push_back(*tileElement);
+            }
+            while (!tile_element_is_last_for_tile(tileElement++));
+        }
+    }
+    size_t numTileElements = Math::Min<size_t>(tileElements.size(), RCT2_MAX_TILE_ELEMENTS);
+    memcpy(_s6.tile_elements, tileElements.data(), numTileElements * sizeof(rct_tile_element));
+    memset(_s6.tile_elements + numTileElements, 0, (RCT2_MAX_TILE_ELEMENTS - numTileElements) * sizeof(rct_tile_element));
+    _extraTileElements.clear();
+    if (tileElements.size() > RCT2_MAX_TILE_ELEMENTS)
+    {
+        _extraTileElements.assign(tileElements.begin() + RCT2_MAX_TILE_ELEMENTS, tileElements.end());
+    }
 
     _s6.next_free_tile_element_pointer_index = gNextFreeTileElementPointerIndex;
     // Sprites needs to be reset before they get used.
@@ -195,6 +273,11 @@ void S6Exporter::Export()
     {
         memcpy(&_s6.sprites[i], get_sprite(i), sizeof(rct_sprite));
     }
+    _extraSprites.clear();
+    for (size_t i = RCT2_MAX_SPRITES; i < gSpriteCapacity; i++)
+    {
+        _extraSprites.push_back(*get_sprite(i));
+    }
 
     for (sint32 i = 0; i < NUM_SPRITE_LISTS; i++)
     {
@@ -652,6 +735,11 @@ void S6Exporter::ExportRide(rct2_ride * dst, const Ride * src)
     // pad_208[0x58];
 }
 
+// The autosave started by scenario_save_in_background, if it may still be writing. It yields an error message
+// if the save failed.
+static std::future<std::string> _backgroundSave;
+static std::string _backgroundSavePath;
+
 extern "C"
 {
     enum {
@@ -681,7 +769,6 @@ extern "C"
             window_close_construction_windows();
         }
 
-        map_reorganise_elements();
         viewport_set_saved_view();
 
         bool result     = false;
@@ -718,4 +805,94 @@ extern "C"
         }
         return result;
     }
+
+    /**
+     * Exports the park on the calling thread, which only copies the game state, then encodes and writes it on a
+     * background thread so the game keeps running. The file is written under a temporary name and renamed once
+     * complete, so an interrupted save never leaves a truncated file behind. Only autosaves are written this way.
+     * A save by the player reports its result and marks the park as saved, and exports read the object repository
+     * while packing objects, so those are saved immediately instead.
+     */
+    sint32 scenario_save_in_background(const utf8 * path, sint32 flags)
+    {
+        if (!(flags & S6_SAVE_FLAG_AUTOMATIC) || (flags & S6_SAVE_FLAG_EXPORT))
+        {
+            return scenario_save(path, flags);
+        }
+
+        // Only one save is written at a time
+        scenario_save_wait();
+
+        viewport_set_saved_view();
+
+        auto s6exporter = std::make_shared<S6Exporter>();
+        try
+        {
+            s6exporter->RemoveTracklessRides = true;
+            s6exporter->Export();
+        }
+        catch (const Exception &e)
+        {
+            log_error("Unable to save '%s': %s", path, e.GetMessage());
+            return 0;
+        }
+
+        gfx_invalidate_screen();
+
+        bool isScenario = (flags & S6_SAVE_FLAG_SCENARIO) != 0;
+        std::string finalPath = path;
+        _backgroundSavePath = finalPath;
+        _backgroundSave = std::async(std::launch::async, [s6exporter, isScenario, finalPath]() -> std::string
+        {
+            std::string tempPath = finalPath + ".tmp";
+            try
+            {
+                if (isScenario)
+                {
+                    s6exporter->SaveScenario(tempPath.c_str());
+                }
+                else
+                {
+                    s6exporter->SaveGame(tempPath.c_str());
+                }
+            }
+            catch (const Exception &e)
+            {
+                platform_file_delete(tempPath.c_str());
+                return e.GetMessage();
+            }
+            catch (const std::exception &e)
+            {
+                platform_file_delete(tempPath.c_str());
+                return e.what();
+            }
+
+            if (platform_file_exists(finalPath.c_str()))
+            {
+                platform_file_delete(finalPath.c_str());
+            }
+            if (!platform_file_move(tempPath.c_str(), finalPath.c_str()))
+            {
+                return "Unable to move '" + tempPath + "' into place";
+            }
+            return std::string();
+        });
+        return 1;
+    }
+
+    bool scenario_save_wait()
+    {
+        if (!_backgroundSave.valid())
+        {
+            return true;
+        }
+
+        std::string error = _backgroundSave.get();
+        if (!error.empty())
+        {
+            log_error("Autosave to '%s' failed: %s", _backgroundSavePath.c_str(), error.c_str());
+            return false;
+        }
+        return true;
+    }
 }
@@ -36,6 +36,8 @@ class S6Exporter final
 {
 public:
     bool RemoveTracklessRides;
+    // Chunks that are normally RLE encoded are written uncompressed when false
+    bool UseRLE;
     std::vector<const ObjectRepositoryItem *> ExportObjectsList;
 
     S6Exporter();
@@ -45,11 +47,21 @@ public:
     void SaveScenario(const utf8 * path);
     void SaveScenario(IStream * stream);
     void Export();
+    /**
+     * Packs the objects in ExportObjectsList into a buffer now. Saving then only writes data the exporter
+     * owns, so it can be done on another thread without reading the object repository.
+     */
+    void PackObjects();
     void ExportRides();
     void ExportRide(rct2_ride * dst, const Ride * src);
 
 private:
     rct_s6_data _s6;
+    // Tile elements and sprites past the RCT2 limits, saved after the RCT2 chunks
+    std::vector<rct_tile_element>   _extraTileElements;
+    std::vector<rct_sprite>         _extraSprites;
+    bool                            _objectsPacked = false;
+    std::vector<uint8>              _packedObjects;
 
     void Save(IStream * stream, bool isScenario);
     static uint32 GetLoanHash(money32 initialCash, money32 bankLoan, uint32 maxBankLoan);
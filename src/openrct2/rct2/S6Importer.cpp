@@ -18,6 +18,7 @@
 #include "../core/Exception.hpp"
 #include "../core/FileStream.hpp"
 #include "../core/IStream.hpp"
+#include "../core/Math.hpp"
 #include "../core/Path.hpp"
 #include "../core/String.hpp"
 #include "../management/Award.h"
@@ -70,6 +71,9 @@ private:
     rct_s6_data     _s6;
     uint8           _gameVersion = 0;
 
+    std::vector<rct_tile_element>   _extraTileElements;
+    std::vector<rct_sprite>         _extraSprites;
+
 public:
     S6Importer(IObjectRepository * objectRepository, IObjectManager * objectManager)
         : _objectRepository(objectRepository),
@@ -175,6 +179,13 @@ public:
             chunkReader.ReadChunk(&_s6.next_free_tile_element_pointer_index, 3048816);
         }
 
+        _extraTileElements.clear();
+        _extraSprites.clear();
+        if (_s6.header.openrct2_flags & S6_OPENRCT2_FLAG_EXTENDED_POOLS)
+        {
+            ReadExtendedPools(&chunkReader);
+        }
+
         auto missingObjects = _objectManager->GetInvalidObjects(_s6.objects);
 
         if (!missingObjects.empty())
@@ -186,6 +197,36 @@ public:
         return ParkLoadResult::CreateOK();
     }
 
+    void ReadExtendedPools(SawyerChunkReader * chunkReader)
+    {
+        auto pools = chunkReader->ReadChunkAs<rct_s6_extended_pools>();
+        if (pools.num_tile_elements < RCT2_MAX_TILE_ELEMENTS ||
+            pools.num_tile_elements > MAX_TILE_ELEMENTS + TILE_ELEMENT_POOL_SCRATCH ||
+            pools.num_sprites < RCT2_MAX_SPRITES ||
+            pools.num_sprites > MAX_SPRITES)
+        {
+            throw IOException("Invalid number of map elements or sprites.");
+        }
+        _extraTileElements.resize(pools.num_tile_elements - RCT2_MAX_TILE_ELEMENTS);
+        _extraSprites.resize(pools.num_sprites - RCT2_MAX_SPRITES);
+        ReadChunkedArray(chunkReader, &_extraTileElements);
+        ReadChunkedArray(chunkReader, &_extraSprites);
+    }
+
+    /**
+     * Reads an array written as consecutive chunks of at most S6_EXTENDED_POOL_CHUNK_SIZE.
+     */
+    template<typename T>
+    static void ReadChunkedArray(SawyerChunkReader * chunkReader, std::vector<T> * items)
+    {
+        constexpr size_t itemsPerChunk = S6_EXTENDED_POOL_CHUNK_SIZE / sizeof(T);
+        for (size_t i = 0; i < items->size(); i += itemsPerChunk)
+        {
+            size_t count = Math::Min(itemsPerChunk, items->size() - i);
+            chunkReader->ReadChunk(&(*items)[i], count * sizeof(T));
+        }
+    }
+
     bool GetDetails(scenario_index_entry * dst) override
     {
         Memory::Set(dst, 0, sizeof(scenario_index_entry));
@@ -205,13 +246,24 @@ public:
         gScenarioSrand0    = _s6.scenario_srand_0;
         gScenarioSrand1    = _s6.scenario_srand_1;
 
+        // The RCT2 limit includes the scratch space after the pool
+        map_set_tile_element_capacity((uint32)(RCT2_MAX_TILE_ELEMENTS - TILE_ELEMENT_POOL_SCRATCH + _extraTileElements.size()));
         memcpy(gTileElements, _s6.tile_elements, sizeof(_s6.tile_elements));
+        if (!_extraTileElements.empty())
+        {
+            memcpy(gTileElements + RCT2_MAX_TILE_ELEMENTS, _extraTileElements.data(), _extraTileElements.size() * sizeof(rct_tile_element));
+        }
 
         gNextFreeTileElementPointerIndex = _s6.next_free_tile_element_pointer_index;
+        sprite_set_capacity((uint32)(RCT2_MAX_SPRITES + _extraSprites.size()));
         for (sint32 i = 0; i < RCT2_MAX_SPRITES; i++)
         {
             memcpy(get_sprite(i), &_s6.sprites[i], sizeof(rct_sprite));
         }
+        for (size_t i = 0; i < _extraSprites.size(); i++)
+        {
+            memcpy(get_sprite(RCT2_MAX_SPRITES + i), &_extraSprites[i], sizeof(rct_sprite));
+        }
 
         for (sint32 i = 0; i < NUM_SPRITE_LISTS; i++)
         {
@@ -393,6 +445,7 @@ public:
         // pad_0138B582
 
         gRideRatingsCalcData = _s6.ride_ratings_calc_data;
+        ride_ratings_clear_pending();
         memcpy(gRideMeasurements, _s6.ride_measurements, sizeof(_s6.ride_measurements));
         gNextGuestNumber              = _s6.next_guest_index;
         gGrassSceneryTileLoopPosition = _s6.grass_and_scenery_tilepos;
@@ -451,6 +504,7 @@ public:
         // We try to fix the cycles on import, hence the 'true' parameter
         check_for_sprite_list_cycles(true);
         check_for_spatial_index_cycles(true);
+        rebuild_sprite_spatial_index_links();
         sint32 disjoint_sprites_count = fix_disjoint_sprites();
         // This one is less harmful, no need to assert for it ~janisozaur
         if (disjoint_sprites_count > 0)
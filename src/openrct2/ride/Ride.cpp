@@ -52,6 +52,7 @@
 #include "music_list.h"
 #include "Ride.h"
 #include "ride_data.h"
+#include "RideCandidates.h"
 #include "RideGroupManager.h"
 #include "Station.h"
 #include "Track.h"
@@ -4417,7 +4418,7 @@ static void ride_set_start_finish_points(sint32 rideIndex, rct_xy_element *start
 static sint32 count_free_misc_sprite_slots()
 {
     sint32 miscSpriteCount = gSpriteListCount[SPRITE_LIST_MISC];
-    sint32 remainingSpriteCount = gSpriteListCount[SPRITE_LIST_NULL];
+    sint32 remainingSpriteCount = (sint32)sprite_get_free_count();
     return Math::Max(0, miscSpriteCount + remainingSpriteCount - 300);
 }
 
@@ -6800,6 +6801,7 @@ void invalidate_test_results(sint32 rideIndex)
 
     ride_measurement_clear(ride);
     ride->excitement = RIDE_RATING_UNDEFINED;
+    ride_candidates_invalidate_visible();
     ride->lifecycle_flags &= ~RIDE_LIFECYCLE_TESTED;
     ride->lifecycle_flags &= ~RIDE_LIFECYCLE_TEST_IN_PROGRESS;
     if (ride->lifecycle_flags & RIDE_LIFECYCLE_ON_TRACK) {
@@ -0,0 +1,208 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#include <algorithm>
+#include <vector>
+#include "../Game.h"
+#include "../world/map.h"
+#include "RideCandidates.h"
+#include "Track.h"
+
+// The tiles of a region that one ride has track on, one bit per tile in row order
+struct RideCandidateTiles
+{
+    uint8   RideIndex;
+    uint64  Tiles;
+};
+
+struct RideCandidateRegion
+{
+    bool                            Invalid = true;
+    uint32                          Rides[RIDE_CANDIDATE_SET_WORDS];
+    std::vector<RideCandidateTiles> RideTiles;
+};
+
+static RideCandidateRegion _rideCandidateRegions[RIDE_CANDIDATE_REGIONS_PER_AXIS * RIDE_CANDIDATE_REGIONS_PER_AXIS];
+
+// The visible rides are also rebuilt every tick, as the ride state they depend on is changed in many places
+static bool     _visibleRideCandidatesValid = false;
+static uint32   _visibleRideCandidatesTick;
+static uint32   _visibleRideCandidates[RIDE_CANDIDATE_SET_WORDS];
+
+static void ride_candidates_update_region(RideCandidateRegion * region, sint32 regionX, sint32 regionY)
+{
+    std::fill_n(region->Rides, RIDE_CANDIDATE_SET_WORDS, 0);
+    region->RideTiles.clear();
+
+    for (sint32 tileY = 0; tileY < RIDE_CANDIDATE_REGION_SIZE; tileY++)
+    {
+        for (sint32 tileX = 0; tileX < RIDE_CANDIDATE_REGION_SIZE; tileX++)
+        {
+            sint32 x = (regionX * RIDE_CANDIDATE_REGION_SIZE) + tileX;
+            sint32 y = (regionY * RIDE_CANDIDATE_REGION_SIZE) + tileY;
+            uint64 tileBit = 1ULL << ((tileY * RIDE_CANDIDATE_REGION_SIZE) + tileX);
+
+            rct_tile_element * tileElement = map_get_first_element_at(x, y);
+            if (tileElement == nullptr)
+                continue;
+
+            do
+            {
+                if (tile_element_get_type(tileElement) != TILE_ELEMENT_TYPE_TRACK)
+                    continue;
+
+                uint8 rideIndex = track_element_get_ride_index(tileElement);
+                region->Rides[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
+
+                auto it = std::find_if(region->RideTiles.begin(), region->RideTiles.end(),
+                    [rideIndex](const RideCandidateTiles &rideTiles) -> bool
+                    {
+                        return rideTiles.RideIndex == rideIndex;
+                    });
+                if (it == region->RideTiles.end())
+                {
+                    region->RideTiles.push_back({ rideIndex, tileBit });
+                }
+                else
+                {
+                    it->Tiles |= tileBit;
+                }
+            }
+            while (!tile_element_is_last_for_tile(tileElement++));
+        }
+    }
+    region->Invalid = false;
+}
+
+/**
+ * Gets the tiles of a region that lie within [left, right] and [top, bottom], all in region tile coordinates.
+ */
+static uint64 ride_candidates_get_region_mask(sint32 left, sint32 top, sint32 right, sint32 bottom)
+{
+    uint64 rowMask = ((1ULL << (right - left + 1)) - 1) << left;
+    uint64 mask = 0;
+    for (sint32 y = top; y <= bottom; y++)
+    {
+        mask |= rowMask << (y * RIDE_CANDIDATE_REGION_SIZE);
+    }
+    return mask;
+}
+
+extern "C"
+{
+    void ride_candidates_invalidate_tile(sint32 x, sint32 y)
+    {
+        if (x < 0 || y < 0 || x >= MAXIMUM_MAP_SIZE_TECHNICAL || y >= MAXIMUM_MAP_SIZE_TECHNICAL)
+            return;
+
+        sint32 regionX = x / RIDE_CANDIDATE_REGION_SIZE;
+        sint32 regionY = y / RIDE_CANDIDATE_REGION_SIZE;
+        _rideCandidateRegions[(regionY * RIDE_CANDIDATE_REGIONS_PER_AXIS) + regionX].Invalid = true;
+    }
+
+    void ride_candidates_invalidate_map()
+    {
+        for (auto &region : _rideCandidateRegions)
+        {
+            region.Invalid = true;
+        }
+        _visibleRideCandidatesValid = false;
+    }
+
+    void ride_candidates_invalidate_visible()
+    {
+        _visibleRideCandidatesValid = false;
+    }
+
+    void ride_candidates_add_nearby(sint32 x, sint32 y, sint32 radius, uint32 rides[RIDE_CANDIDATE_SET_WORDS])
+    {
+        sint32 left = std::max(0, x - radius);
+        sint32 top = std::max(0, y - radius);
+        sint32 right = std::min(MAXIMUM_MAP_SIZE_TECHNICAL - 1, x + radius);
+        sint32 bottom = std::min(MAXIMUM_MAP_SIZE_TECHNICAL - 1, y + radius);
+        if (left > right || top > bottom)
+            return;
+
+        for (sint32 regionY = top / RIDE_CANDIDATE_REGION_SIZE; regionY <= bottom / RIDE_CANDIDATE_REGION_SIZE; regionY++)
+        {
+            for (sint32 regionX = left / RIDE_CANDIDATE_REGION_SIZE; regionX <= right / RIDE_CANDIDATE_REGION_SIZE; regionX++)
+            {
+                RideCandidateRegion * region = &_rideCandidateRegions[(regionY * RIDE_CANDIDATE_REGIONS_PER_AXIS) + regionX];
+                if (region->Invalid)
+                {
+                    ride_candidates_update_region(region, regionX, regionY);
+                }
+
+                sint32 regionLeft = regionX * RIDE_CANDIDATE_REGION_SIZE;
+                sint32 regionTop = regionY * RIDE_CANDIDATE_REGION_SIZE;
+                sint32 regionRight = regionLeft + RIDE_CANDIDATE_REGION_SIZE - 1;
+                sint32 regionBottom = regionTop + RIDE_CANDIDATE_REGION_SIZE - 1;
+                if (left <= regionLeft && top <= regionTop && right >= regionRight && bottom >= regionBottom)
+                {
+                    // The whole region is in range
+                    for (sint32 i = 0; i < RIDE_CANDIDATE_SET_WORDS; i++)
+                    {
+                        rides[i] |= region->Rides[i];
+                    }
+                }
+                else
+                {
+                    uint64 mask = ride_candidates_get_region_mask(
+                        std::max(left, regionLeft) - regionLeft,
+                        std::max(top, regionTop) - regionTop,
+                        std::min(right, regionRight) - regionLeft,
+                        std::min(bottom, regionBottom) - regionTop);
+                    for (const auto &rideTiles : region->RideTiles)
+                    {
+                        if (rideTiles.Tiles & mask)
+                        {
+                            rides[rideTiles.RideIndex >> 5] |= (1u << (rideTiles.RideIndex & 0x1F));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void ride_candidates_add_visible(uint32 rides[RIDE_CANDIDATE_SET_WORDS])
+    {
+        if (!_visibleRideCandidatesValid || _visibleRideCandidatesTick != gCurrentTicks)
+        {
+            std::fill_n(_visibleRideCandidates, RIDE_CANDIDATE_SET_WORDS, 0);
+
+            sint32 i;
+            Ride * ride;
+            FOR_ALL_RIDES(i, ride)
+            {
+                if (ride->status != RIDE_STATUS_OPEN)
+                    continue;
+                if (!ride_has_ratings(ride))
+                    continue;
+                if (ride->highest_drop_height <= 66 && ride->excitement < RIDE_RATING(8, 00))
+                    continue;
+
+                _visibleRideCandidates[i >> 5] |= (1u << (i & 0x1F));
+            }
+            _visibleRideCandidatesValid = true;
+            _visibleRideCandidatesTick = gCurrentTicks;
+        }
+
+        for (sint32 i = 0; i < RIDE_CANDIDATE_SET_WORDS; i++)
+        {
+            rides[i] |= _visibleRideCandidates[i];
+        }
+    }
+}
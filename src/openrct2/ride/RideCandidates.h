@@ -0,0 +1,59 @@
+#pragma region Copyright (c) 2014-2017 OpenRCT2 Developers
+/*****************************************************************************
+ * OpenRCT2, an open source clone of Roller Coaster Tycoon 2.
+ *
+ * OpenRCT2 is the work of many authors, a full list can be found in contributors.md
+ * For more information, visit https://github.com/OpenRCT2/OpenRCT2
+ *
+ * OpenRCT2 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * A full copy of the GNU General Public License can be found in licence.txt
+ *****************************************************************************/
+#pragma endregion
+
+#pragma once
+
+#include "../common.h"
+#include "../world/map.h"
+#include "Ride.h"
+
+// Number of words in a set of ride indices, one bit per ride
+#define RIDE_CANDIDATE_SET_WORDS ((MAX_RIDES + 31) / 32)
+
+// The map is split into square regions of this many tiles, each listing the rides with track in it
+#define RIDE_CANDIDATE_REGION_SIZE 8
+#define RIDE_CANDIDATE_REGIONS_PER_AXIS (MAXIMUM_MAP_SIZE_TECHNICAL / RIDE_CANDIDATE_REGION_SIZE)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Marks the rides with track on a tile as changed. Called whenever a tile element is inserted into or
+ * removed from the tile.
+ */
+void ride_candidates_invalidate_tile(sint32 x, sint32 y);
+void ride_candidates_invalidate_map();
+
+/**
+ * Marks the rides that can be seen from anywhere in the park as changed. Called when a ride's status or
+ * ratings change.
+ */
+void ride_candidates_invalidate_visible();
+
+/**
+ * Adds every ride with a track element within radius tiles of the given tile to the set.
+ */
+void ride_candidates_add_nearby(sint32 x, sint32 y, sint32 radius, uint32 rides[RIDE_CANDIDATE_SET_WORDS]);
+
+/**
+ * Adds the open, rated rides that are tall or exciting enough to be seen from anywhere in the park to the set.
+ */
+void ride_candidates_add_visible(uint32 rides[RIDE_CANDIDATE_SET_WORDS]);
+
+#ifdef __cplusplus
+}
+#endif
@@ -41,11 +41,14 @@
 #include "TrackData.h"
 #include "TrackDesign.h"
 
+// Tiles are stored as indices into the element pool, as the pool may be reallocated while the preview is drawn
 typedef struct map_backup
 {
-    rct_tile_element tile_elements[MAX_TILE_ELEMENTS];
-    rct_tile_element * tile_pointers[MAX_TILE_TILE_ELEMENT_POINTERS];
-    rct_tile_element * next_free_tile_element;
+    rct_tile_element * tile_elements;
+    uint32          tile_element_capacity;
+    uint32          tile_indices[MAX_TILE_TILE_ELEMENT_POINTERS];
+    uint32          next_free_tile_element;
+    tile_element_allocator allocator;
     uint16          map_size_units;
     uint16          map_size_units_minus_2;
     uint16          map_size;
@@ -2285,17 +2288,22 @@ static map_backup * track_design_preview_backup_map()
     map_backup * backup = (map_backup *) malloc(sizeof(map_backup));
     if (backup != nullptr)
     {
-        memcpy(
-            backup->tile_elements,
-            gTileElements,
-            sizeof(backup->tile_elements)
-        );
-        memcpy(
-            backup->tile_pointers,
-            gTileElementTilePointers,
-            sizeof(backup->tile_pointers)
-        );
-        backup->next_free_tile_element  = gNextFreeTileElement;
+        size_t length = gTileElementCapacity + TILE_ELEMENT_POOL_SCRATCH;
+        backup->tile_elements = (rct_tile_element *) malloc(length * sizeof(rct_tile_element));
+        if (backup->tile_elements == nullptr)
+        {
+            free(backup);
+            return nullptr;
+        }
+        memcpy(backup->tile_elements, gTileElements, length * sizeof(rct_tile_element));
+        backup->tile_element_capacity = gTileElementCapacity;
+        for (sint32 i = 0; i < MAX_TILE_TILE_ELEMENT_POINTERS; i++)
+        {
+            const rct_tile_element * tileElement = gTileElementTilePointers[i];
+            backup->tile_indices[i] = tileElement == TILE_UNDEFINED_TILE_ELEMENT ? UINT32_MAX : (uint32)(tileElement - gTileElements);
+        }
+        backup->next_free_tile_element = (uint32)(gNextFreeTileElement - gTileElements);
+        map_get_tile_element_allocator(&backup->allocator);
         backup->map_size_units         = gMapSizeUnits;
         backup->map_size_units_minus_2 = gMapSizeMinus2;
         backup->map_size               = gMapSize;
@@ -2310,22 +2318,25 @@ static map_backup * track_design_preview_backup_map()
  */
 static void track_design_preview_restore_map(map_backup * backup)
 {
+    map_set_tile_element_capacity(backup->tile_element_capacity);
     memcpy(
         gTileElements,
         backup->tile_elements,
-        sizeof(backup->tile_elements)
+        (backup->tile_element_capacity + TILE_ELEMENT_POOL_SCRATCH) * sizeof(rct_tile_element)
     );
-    memcpy(
-        gTileElementTilePointers,
-        backup->tile_pointers,
-        sizeof(backup->tile_pointers)
-    );
-    gNextFreeTileElement = backup->next_free_tile_element;
+    for (sint32 i = 0; i < MAX_TILE_TILE_ELEMENT_POINTERS; i++)
+    {
+        uint32 index = backup->tile_indices[i];
+        gTileElementTilePointers[i] = index == UINT32_MAX ? TILE_UNDEFINED_TILE_ELEMENT : gTileElements + index;
+    }
+    gNextFreeTileElement = gTileElements + backup->next_free_tile_element;
+    map_set_tile_element_allocator(&backup->allocator);
     gMapSizeUnits       = backup->map_size_units;
     gMapSizeMinus2      = backup->map_size_units_minus_2;
     gMapSize            = backup->map_size;
     gCurrentRotation    = backup->current_rotation;
 
+    free(backup->tile_elements);
     free(backup);
 }
 
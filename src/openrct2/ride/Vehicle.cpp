@@ -38,6 +38,7 @@
 #include "CableLift.h"
 #include "Ride.h"
 #include "ride_data.h"
+#include "RideCandidates.h"
 #include "Station.h"
 #include "Track.h"
 #include "TrackData.h"
@@ -1728,6 +1729,7 @@ static void vehicle_update_measurements(rct_vehicle * vehicle)
                     if (z > ride->highest_drop_height)
                     {
                         ride->highest_drop_height = (uint8)z;
+                        ride_candidates_invalidate_visible();
                     }
                 }
             }
@@ -1760,6 +1762,7 @@ static void vehicle_update_measurements(rct_vehicle * vehicle)
                     if (z > ride->highest_drop_height)
                     {
                         ride->highest_drop_height = (uint8)z;
+                        ride_candidates_invalidate_visible();
                     }
                 }
             }
@@ -3041,6 +3044,7 @@ void vehicle_update_test_finish(rct_vehicle * vehicle)
     ride->lifecycle_flags &= ~RIDE_LIFECYCLE_TEST_IN_PROGRESS;
     vehicle->update_flags &= ~VEHICLE_UPDATE_FLAG_TESTING;
     ride->lifecycle_flags |= RIDE_LIFECYCLE_TESTED;
+    ride_ratings_invalidate_ride(vehicle->ride);
 
     for (sint32 i = ride->num_stations - 1; i >= 1; i--)
     {
@@ -1129,7 +1129,7 @@ void vehicle_visual_mini_golf_player(paint_session * session, sint32 x, sint32 i
         return;
     }
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_INVISIBLE_PEEPS)
+    if (session->ViewFlags & VIEWPORT_FLAG_INVISIBLE_PEEPS)
     {
         return;
     }
@@ -1162,7 +1162,7 @@ void vehicle_visual_mini_golf_ball(paint_session * session, sint32 x, sint32 ima
         return;
     }
 
-    if (gCurrentViewportFlags & VIEWPORT_FLAG_INVISIBLE_PEEPS)
+    if (session->ViewFlags & VIEWPORT_FLAG_INVISIBLE_PEEPS)
     {
         return;
     }
@@ -21,19 +21,11 @@
 #include "../world/map.h"
 #include "Ride.h"
 #include "ride_data.h"
+#include "RideCandidates.h"
 #include "ride_ratings.h"
 #include "Station.h"
 #include "Track.h"
 
-enum {
-    RIDE_RATINGS_STATE_FIND_NEXT_RIDE,
-    RIDE_RATINGS_STATE_INITIALISE,
-    RIDE_RATINGS_STATE_2,
-    RIDE_RATINGS_STATE_CALCULATE,
-    RIDE_RATINGS_STATE_4,
-    RIDE_RATINGS_STATE_5
-};
-
 enum {
     PROXIMITY_WATER_OVER,                       // 0x0138B596
     PROXIMITY_WATER_TOUCH,                      // 0x0138B598
@@ -67,6 +59,16 @@ enum {
 typedef void (*ride_ratings_calculation)(Ride *ride);
 
 rct_ride_rating_calc_data gRideRatingsCalcData;
+bool gRideRatingsTrackMapChanges;
+
+// The furthest a ride's track or station can be from a changed tile and still have its ratings affected: the
+// scenery score counts the scenery within 5 tiles of the first station and the proximity score looks at the
+// tiles next to the track.
+#define RIDE_RATINGS_INVALIDATE_RADIUS 6
+
+static uint32 _rideRatingsPendingRides[RIDE_CANDIDATE_SET_WORDS];
+static uint32 _rideRatingsPendingRegions[(RIDE_CANDIDATE_REGIONS_PER_AXIS * RIDE_CANDIDATE_REGIONS_PER_AXIS + 31) / 32];
+static bool _rideRatingsAnyPending;
 
 static const ride_ratings_calculation ride_ratings_calculate_func_table[RIDE_TYPE_COUNT];
 
@@ -115,6 +117,100 @@ void ride_ratings_update_all()
     ride_ratings_update_state();
 }
 
+size_t ride_ratings_get_pending_size()
+{
+    return sizeof(_rideRatingsPendingRides) + sizeof(_rideRatingsPendingRegions);
+}
+
+void ride_ratings_get_pending(void * buffer)
+{
+    uint8 * dst = (uint8 *)buffer;
+    memcpy(dst, _rideRatingsPendingRides, sizeof(_rideRatingsPendingRides));
+    memcpy(dst + sizeof(_rideRatingsPendingRides), _rideRatingsPendingRegions, sizeof(_rideRatingsPendingRegions));
+}
+
+void ride_ratings_set_pending(const void * buffer)
+{
+    const uint8 * src = (const uint8 *)buffer;
+    memcpy(_rideRatingsPendingRides, src, sizeof(_rideRatingsPendingRides));
+    memcpy(_rideRatingsPendingRegions, src + sizeof(_rideRatingsPendingRides), sizeof(_rideRatingsPendingRegions));
+
+    _rideRatingsAnyPending = false;
+    for (size_t i = 0; i < countof(_rideRatingsPendingRides); i++) {
+        _rideRatingsAnyPending |= _rideRatingsPendingRides[i] != 0;
+    }
+    for (size_t i = 0; i < countof(_rideRatingsPendingRegions); i++) {
+        _rideRatingsAnyPending |= _rideRatingsPendingRegions[i] != 0;
+    }
+}
+
+void ride_ratings_invalidate_ride(sint32 rideIndex)
+{
+    _rideRatingsPendingRides[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
+    _rideRatingsAnyPending = true;
+}
+
+void ride_ratings_invalidate_tile(sint32 x, sint32 y)
+{
+    if (x < 0 || y < 0 || x >= MAXIMUM_MAP_SIZE_TECHNICAL || y >= MAXIMUM_MAP_SIZE_TECHNICAL)
+        return;
+
+    // The rides are looked up later, as the element inserted into the tile has not been filled in yet
+    sint32 region = ((y / RIDE_CANDIDATE_REGION_SIZE) * RIDE_CANDIDATE_REGIONS_PER_AXIS) + (x / RIDE_CANDIDATE_REGION_SIZE);
+    _rideRatingsPendingRegions[region >> 5] |= (1u << (region & 0x1F));
+    _rideRatingsAnyPending = true;
+}
+
+void ride_ratings_clear_pending()
+{
+    memset(_rideRatingsPendingRides, 0, sizeof(_rideRatingsPendingRides));
+    memset(_rideRatingsPendingRegions, 0, sizeof(_rideRatingsPendingRegions));
+    _rideRatingsAnyPending = false;
+}
+
+/**
+ * Recalculates the ratings of the rides queued by ride_ratings_invalidate_ride and ride_ratings_invalidate_tile
+ * from start to finish. The same calculation as the incremental update is used, so the ratings are identical
+ * to the ones the incremental update would give the ride in its current state.
+ */
+void ride_ratings_update_pending()
+{
+    if (!_rideRatingsAnyPending)
+        return;
+    if (gScreenFlags & SCREEN_FLAGS_SCENARIO_EDITOR)
+        return;
+
+    for (sint32 region = 0; region < RIDE_CANDIDATE_REGIONS_PER_AXIS * RIDE_CANDIDATE_REGIONS_PER_AXIS; region++) {
+        if (!(_rideRatingsPendingRegions[region >> 5] & (1u << (region & 0x1F))))
+            continue;
+
+        sint32 halfSize = RIDE_CANDIDATE_REGION_SIZE / 2;
+        sint32 x = ((region % RIDE_CANDIDATE_REGIONS_PER_AXIS) * RIDE_CANDIDATE_REGION_SIZE) + halfSize;
+        sint32 y = ((region / RIDE_CANDIDATE_REGIONS_PER_AXIS) * RIDE_CANDIDATE_REGION_SIZE) + halfSize;
+        ride_candidates_add_nearby(x, y, halfSize + RIDE_RATINGS_INVALIDATE_RADIUS, _rideRatingsPendingRides);
+    }
+    memset(_rideRatingsPendingRegions, 0, sizeof(_rideRatingsPendingRegions));
+    _rideRatingsAnyPending = false;
+
+    // The incremental update keeps its progress in gRideRatingsCalcData, which is also saved with the park
+    rct_ride_rating_calc_data incrementalCalcData = gRideRatingsCalcData;
+    for (sint32 rideIndex = 0; rideIndex < MAX_RIDES; rideIndex++) {
+        if (!(_rideRatingsPendingRides[rideIndex >> 5] & (1u << (rideIndex & 0x1F))))
+            continue;
+
+        ride_ratings_update_ride(rideIndex);
+    }
+    gRideRatingsCalcData = incrementalCalcData;
+
+    // A ride the incremental update is part way through starts again, as the part already done may be out of date
+    sint32 currentRide = gRideRatingsCalcData.current_ride;
+    if (gRideRatingsCalcData.state != RIDE_RATINGS_STATE_FIND_NEXT_RIDE && currentRide < MAX_RIDES &&
+        (_rideRatingsPendingRides[currentRide >> 5] & (1u << (currentRide & 0x1F)))) {
+        gRideRatingsCalcData.state = RIDE_RATINGS_STATE_INITIALISE;
+    }
+    memset(_rideRatingsPendingRides, 0, sizeof(_rideRatingsPendingRides));
+}
+
 static void ride_ratings_update_state()
 {
     switch (gRideRatingsCalcData.state) {
@@ -638,6 +734,7 @@ static void ride_ratings_calculate(Ride *ride)
         ride->ratings.nausea = max(0, ride->ratings.nausea);
     }
 #endif
+    ride_candidates_invalidate_visible();
 }
 
 static void ride_ratings_calculate_value(Ride *ride)
@@ -42,6 +42,15 @@ enum {
     RIDE_RATING_STATION_FLAG_NO_ENTRANCE = 1 << 0
 };
 
+enum {
+    RIDE_RATINGS_STATE_FIND_NEXT_RIDE,
+    RIDE_RATINGS_STATE_INITIALISE,
+    RIDE_RATINGS_STATE_2,
+    RIDE_RATINGS_STATE_CALCULATE,
+    RIDE_RATINGS_STATE_4,
+    RIDE_RATINGS_STATE_5
+};
+
 typedef struct rct_ride_rating_calc_data {
     uint16  proximity_x;
     uint16  proximity_y;
@@ -66,9 +75,43 @@ extern "C" {
 
 extern rct_ride_rating_calc_data gRideRatingsCalcData;
 
+/**
+ * Set while a non-ghost game command or action is applied. Tile elements inserted into or removed from the map
+ * in the meantime are passed to ride_ratings_invalidate_tile, so every client recalculates the same rides.
+ */
+extern bool gRideRatingsTrackMapChanges;
+
 void ride_ratings_update_ride(int rideIndex);
 void ride_ratings_update_all();
 
+/**
+ * Queues the ratings of a ride to be recalculated in full by the next ride_ratings_update_pending, rather than
+ * waiting for the ride's turn in the incremental update.
+ */
+void ride_ratings_invalidate_ride(sint32 rideIndex);
+
+/**
+ * Queues the ratings of every ride that could be affected by a change to the given tile, either through the
+ * proximity of its track or the scenery around its station.
+ */
+void ride_ratings_invalidate_tile(sint32 x, sint32 y);
+void ride_ratings_clear_pending();
+
+/**
+ * Recalculates the queued rides straight away. Called only after the game commands of a tick have run, so the
+ * queue is empty at the end of every tick. Commands run between ticks, such as those issued by a server's own
+ * player, are recalculated at the same point in the next tick as on the clients that run them.
+ */
+void ride_ratings_update_pending();
+
+/**
+ * Copies the queue to or from a buffer of ride_ratings_get_pending_size bytes. A server also queues rides when
+ * its own commands run between ticks, so the queue is sent with the map to joining clients.
+ */
+size_t ride_ratings_get_pending_size();
+void ride_ratings_get_pending(void * buffer);
+void ride_ratings_set_pending(const void * buffer);
+
 #ifdef __cplusplus
 }
 #endif
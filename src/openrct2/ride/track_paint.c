@@ -1756,7 +1756,7 @@ void track_paint(paint_session * session, uint8 direction, sint32 height, rct_ti
         sint32 trackSequence = tile_element_get_track_sequence(tileElement);
         sint32 trackColourScheme = track_element_get_colour_scheme(tileElement);
 
-        if ((gCurrentViewportFlags & VIEWPORT_FLAG_TRACK_HEIGHTS) && dpi->zoom_level == 0) {
+        if ((session->ViewFlags & VIEWPORT_FLAG_TRACK_HEIGHTS) && dpi->zoom_level == 0) {
             session->InteractionType = VIEWPORT_INTERACTION_ITEM_NONE;
             if (TrackHeightMarkerPositions[trackType] & (1 << trackSequence)) {
                 uint16 ax = RideData5[ride->type].z_offset;
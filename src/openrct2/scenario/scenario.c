@@ -520,7 +520,7 @@ uint32 dbg_scenario_rand(const char *file, const char *function, const uint32 li
 }
 
 #ifdef DEBUG_DESYNC
-void dbg_report_desync(uint32 tick, uint32 srand0, uint32 server_srand0, const char *clientHash, const char *serverHash)
+void dbg_report_desync(uint32 tick, uint32 srand0, uint32 server_srand0, uint64 clientChecksum, uint64 serverChecksum, bool hasServerChecksum)
 {
     if (fp == NULL)
     {
@@ -537,15 +537,21 @@ void dbg_report_desync(uint32 tick, uint32 srand0, uint32 server_srand0, const c
     }
     if (fp)
     {
-        const bool sprites_mismatch = serverHash[0] != '\0' && strcmp(clientHash, serverHash);
+        const bool state_mismatch = hasServerChecksum && clientChecksum != serverChecksum;
 
-        fprintf(fp, "[%s] !! DESYNC !! Tick: %d, Client Hash: %s, Server Hash: %s, Client Rand: %08X, Server Rand: %08X - %s\n", realm,
+        char serverChecksumText[32] = "<NONE:0>";
+        if (hasServerChecksum)
+        {
+            snprintf(serverChecksumText, sizeof(serverChecksumText), "%08X%08X", (uint32)(serverChecksum >> 32), (uint32)serverChecksum);
+        }
+        fprintf(fp, "[%s] !! DESYNC !! Tick: %d, Client Checksum: %08X%08X, Server Checksum: %s, Client Rand: %08X, Server Rand: %08X - %s\n", realm,
                 tick,
-                clientHash,
-                ( (serverHash[0] != '\0') ? serverHash : "<NONE:0>" ),
+                (uint32)(clientChecksum >> 32),
+                (uint32)clientChecksum,
+                serverChecksumText,
                 srand0,
                 server_srand0,
-                (sprites_mismatch ? "Sprite hash mismatch" : "scenario rand mismatch"));
+                (state_mismatch ? "game state checksum mismatch" : "scenario rand mismatch"));
     }
 }
 #endif
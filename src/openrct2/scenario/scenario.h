@@ -43,10 +43,21 @@ typedef struct rct_s6_header {
     uint16 num_packed_objects;  // 0x02
     uint32 version;             // 0x04
     uint32 magic_number;        // 0x08
-    uint8 pad_0C[0x14];
+    uint8 openrct2_flags;       // 0x0C Not used by RCT2, see S6_OPENRCT2_FLAGS
+    uint8 pad_0D[0x13];
 } rct_s6_header;
 assert_struct_size(rct_s6_header, 0x20);
 
+/**
+ * Follows the last SV6/SC6 chunk when S6_OPENRCT2_FLAG_EXTENDED_POOLS is set. It is followed by chunks
+ * holding the tile elements and then the sprites past the RCT2 limits.
+ */
+typedef struct rct_s6_extended_pools {
+    uint32 num_tile_elements;   // 0x00 Including the RCT2_MAX_TILE_ELEMENTS in SC6[5]
+    uint32 num_sprites;         // 0x04 Including the RCT2_MAX_SPRITES in SC6[6]
+} rct_s6_extended_pools;
+assert_struct_size(rct_s6_extended_pools, 8);
+
 /**
  * SC6 information chunk
  * size: 0x198
@@ -310,6 +321,14 @@ enum {
     S6_TYPE_SCENARIO
 };
 
+enum S6_OPENRCT2_FLAGS {
+    // The park has more tile elements or sprites than RCT2 can hold
+    S6_OPENRCT2_FLAG_EXTENDED_POOLS = (1 << 0),
+};
+
+// Maximum size of each chunk holding tile elements or sprites past the RCT2 limits
+#define S6_EXTENDED_POOL_CHUNK_SIZE (4 * 1024 * 1024)
+
 #define S6_RCT2_VERSION 120001
 #define S6_MAGIC_NUMBER 0x00031144
 
@@ -398,7 +417,7 @@ void scenario_update();
 uint32 dbg_scenario_rand(const char *file, const char *function, const uint32 line, const void *data);
 #define scenario_rand() dbg_scenario_rand(__FILE__, __FUNCTION__, __LINE__, NULL)
 #define scenario_rand_data(data) dbg_scenario_rand(__FILE__, __FUNCTION__, __LINE__, data)
-void dbg_report_desync(uint32 tick, uint32 srand0, uint32 server_srand0, const char *clientHash, const char *serverHash);
+void dbg_report_desync(uint32 tick, uint32 srand0, uint32 server_srand0, uint64 clientChecksum, uint64 serverChecksum, bool hasServerChecksum);
 #else
 uint32 scenario_rand();
 #endif
@@ -407,6 +426,11 @@ uint32 scenario_rand_max(uint32 max);
 
 bool scenario_prepare_for_save();
 sint32 scenario_save(const utf8 * path, sint32 flags);
+sint32 scenario_save_in_background(const utf8 * path, sint32 flags);
+/**
+ * Blocks until the save started by scenario_save_in_background has been written. Returns false if it failed.
+ */
+bool scenario_save_wait();
 void scenario_remove_trackless_rides(rct_s6_data *s6);
 void scenario_fix_ghosts(rct_s6_data *s6);
 void scenario_failure();
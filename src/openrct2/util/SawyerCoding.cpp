@@ -20,6 +20,10 @@
 #include "SawyerCoding.h"
 #include "Util.h"
 
+#ifdef PLATFORM_SSE2
+    #include <emmintrin.h>
+#endif
+
 static size_t decode_chunk_rle(const uint8* src_buffer, uint8* dst_buffer, size_t length);
 static size_t decode_chunk_rle_with_size(const uint8* src_buffer, uint8* dst_buffer, size_t length, size_t dstSize);
 
@@ -31,9 +35,20 @@ bool gUseRLE = true;
 
 uint32 sawyercoding_calculate_checksum(const uint8* buffer, size_t length)
 {
-    size_t i;
+    size_t i = 0;
     uint32 checksum = 0;
-    for (i = 0; i < length; i++)
+#ifdef PLATFORM_SSE2
+    // _mm_sad_epu8 against zero sums each half of the block into a 64-bit lane
+    __m128i zero = _mm_setzero_si128();
+    __m128i sums = zero;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(buffer + i));
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(block, zero));
+    }
+    checksum = (uint32)_mm_cvtsi128_si32(sums) + (uint32)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+#endif
+    for (; i < length; i++)
         checksum += buffer[i];
 
     return checksum;
@@ -253,6 +268,61 @@ static size_t decode_chunk_rle_with_size(const uint8* src_buffer, uint8* dst_buf
  * Ensure dst_buffer is bigger than src_buffer then resize afterwards
  * returns length of dst_buffer
  */
+/**
+ * Counts the bytes from src, up to maxLength, that are not followed by an identical byte. The final byte of
+ * the buffer has nothing following it, so it is never counted.
+ */
+static size_t encode_rle_count_literal(const uint8 *src, const uint8 *end, size_t maxLength)
+{
+    size_t available = Math::Min((size_t)(end - src - 1), maxLength);
+    size_t n = 0;
+#ifdef PLATFORM_SSE2
+    for (; n + 16 <= available; n += 16)
+    {
+        __m128i current = _mm_loadu_si128((const __m128i *)(src + n));
+        __m128i next = _mm_loadu_si128((const __m128i *)(src + n + 1));
+        sint32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(current, next));
+        if (mask != 0)
+        {
+            return n + bitscanforward(mask);
+        }
+    }
+#endif
+    for (; n < available; n++)
+    {
+        if (src[n] == src[n + 1])
+            break;
+    }
+    return n;
+}
+
+/**
+ * Counts the bytes from src, up to maxLength, that are equal to the first.
+ */
+static size_t encode_rle_count_run(const uint8 *src, const uint8 *end, size_t maxLength)
+{
+    size_t available = Math::Min((size_t)(end - src), maxLength);
+    size_t n = 0;
+#ifdef PLATFORM_SSE2
+    __m128i value = _mm_set1_epi8((char)*src);
+    for (; n + 16 <= available; n += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(src + n));
+        sint32 mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(block, value)) & 0xFFFF;
+        if (mask != 0)
+        {
+            return n + bitscanforward(mask);
+        }
+    }
+#endif
+    for (; n < available; n++)
+    {
+        if (src[n] != *src)
+            break;
+    }
+    return n;
+}
+
 static size_t encode_chunk_rle(const uint8 *src_buffer, uint8 *dst_buffer, size_t length)
 {
     const uint8* src = src_buffer;
@@ -271,9 +341,7 @@ static size_t encode_chunk_rle(const uint8 *src_buffer, uint8 *dst_buffer, size_
             count = 0;
         }
         if (*src == src[1]){
-            for (; (count < 125) && ((src + count) < end_src); count++){
-                if (*src != src[count]) break;
-            }
+            count = (uint8)encode_rle_count_run(src, end_src, 125);
             *dst++ = 257 - count;
             *dst++ = *src;
             src += count;
@@ -281,8 +349,10 @@ static size_t encode_chunk_rle(const uint8 *src_buffer, uint8 *dst_buffer, size_
             count = 0;
         }
         else{
-            count++;
-            src++;
+            // Skip ahead to the next repeated byte, at most until the literal run is full
+            size_t literalLength = encode_rle_count_literal(src, end_src, 126 - count);
+            count += (uint8)literalLength;
+            src += literalLength;
         }
     }
     if (src == end_src - 1)count++;
@@ -294,6 +364,27 @@ static size_t encode_chunk_rle(const uint8 *src_buffer, uint8 *dst_buffer, size_
     return dst - dst_buffer;
 }
 
+/**
+ * Counts how many bytes from index match those from repeatIndex, limited to 8 bytes and to not reading past
+ * index or the end of the buffer.
+ */
+static size_t encode_repeat_match_length(const uint8 *src_buffer, size_t length, size_t index, size_t repeatIndex)
+{
+    size_t repeatCount = 0;
+    size_t maxRepeatCount = Math::Min(Math::Min((size_t)7, index - 1 - repeatIndex), length - index - 1);
+    // maxRepeatCount should not exceed length
+    assert(repeatIndex + maxRepeatCount < length);
+    assert(index + maxRepeatCount < length);
+    for (size_t j = 0; j <= maxRepeatCount; j++) {
+        if (src_buffer[repeatIndex + j] == src_buffer[index + j]) {
+            repeatCount++;
+        } else {
+            break;
+        }
+    }
+    return repeatCount;
+}
+
 static size_t encode_chunk_repeat(const uint8 *src_buffer, uint8 *dst_buffer, size_t length)
 {
     if (length == 0)
@@ -313,19 +404,33 @@ static size_t encode_chunk_repeat(const uint8 *src_buffer, uint8 *dst_buffer, si
 
         size_t bestRepeatIndex = 0;
         size_t bestRepeatCount = 0;
-        for (size_t repeatIndex = searchIndex; repeatIndex <= searchEnd; repeatIndex++) {
-            size_t repeatCount = 0;
-            size_t maxRepeatCount = Math::Min(Math::Min((size_t)7, searchEnd - repeatIndex), length - i - 1);
-            // maxRepeatCount should not exceed length
-            assert(repeatIndex + maxRepeatCount < length);
-            assert(i + maxRepeatCount < length);
-            for (size_t j = 0; j <= maxRepeatCount; j++) {
-                if (src_buffer[repeatIndex + j] == src_buffer[i + j]) {
-                    repeatCount++;
-                } else {
-                    break;
+#ifdef PLATFORM_SSE2
+        if (i >= 32) {
+            // Only positions holding the same first byte can repeat, so find them all at once and test those
+            // in the same order as the scalar search to pick the same repeat
+            __m128i value = _mm_set1_epi8((char)src_buffer[i]);
+            __m128i windowLow = _mm_loadu_si128((const __m128i *)(src_buffer + searchIndex));
+            __m128i windowHigh = _mm_loadu_si128((const __m128i *)(src_buffer + searchIndex + 16));
+            uint32 candidates = (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(windowLow, value)) |
+                                ((uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(windowHigh, value)) << 16);
+            while (candidates != 0) {
+                size_t repeatIndex = searchIndex + bitscanforward((sint32)candidates);
+                candidates &= candidates - 1;
+
+                size_t repeatCount = encode_repeat_match_length(src_buffer, length, i, repeatIndex);
+                if (repeatCount > bestRepeatCount) {
+                    bestRepeatIndex = repeatIndex;
+                    bestRepeatCount = repeatCount;
+
+                    // Maximum repeat count is 8
+                    if (repeatCount == 8)
+                        break;
                 }
             }
+        } else
+#endif
+        for (size_t repeatIndex = searchIndex; repeatIndex <= searchEnd; repeatIndex++) {
+            size_t repeatCount = encode_repeat_match_length(src_buffer, length, i, repeatIndex);
             if (repeatCount > bestRepeatCount) {
                 bestRepeatIndex = repeatIndex;
                 bestRepeatCount = repeatCount;
@@ -247,6 +247,11 @@ static void mapgen_place_tree(sint32 type, sint32 x, sint32 y)
         return;
     }
 
+    if (!map_check_free_elements_and_reorganise(1))
+    {
+        return;
+    }
+
     surfaceZ    = tile_element_height(x * 32 + 16, y * 32 + 16) / 8;
     tileElement = tile_element_insert(x, y, surfaceZ, (1 | 2 | 4 | 8));
     assert(tileElement != nullptr);
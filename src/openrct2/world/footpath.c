@@ -552,6 +552,9 @@ static money32 footpath_place_from_track(sint32 type, sint32 x, sint32 y, sint32
     rct_tile_element * tileElement, * entranceElement;
     bool entrancePath = false, entranceIsSamePath = false;
 
+    if (!map_check_free_elements_and_reorganise(1))
+        return MONEY32_UNDEFINED;
+
     gCommandExpenditureType = RCT_EXPENDITURE_TYPE_LANDSCAPING;
     gCommandPosition.x = x + 16;
     gCommandPosition.y = y + 16;
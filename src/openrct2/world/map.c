@@ -26,7 +26,10 @@
 #include "../management/Finance.h"
 #include "../network/network.h"
 #include "../OpenRCT2.h"
+#include "../peep/Peep.h"
 #include "../ride/ride_data.h"
+#include "../ride/RideCandidates.h"
+#include "../ride/ride_ratings.h"
 #include "../ride/Track.h"
 #include "../ride/TrackData.h"
 #include "../scenario/scenario.h"
@@ -95,7 +98,8 @@ sint16 gMapSize;
 sint16 gMapSizeMaxXY;
 sint16 gMapBaseZ;
 
-rct_tile_element gTileElements[MAX_TILE_TILE_ELEMENT_POINTERS * 3];
+rct_tile_element *gTileElements;
+uint32 gTileElementCapacity;
 rct_tile_element *gTileElementTilePointers[MAX_TILE_TILE_ELEMENT_POINTERS];
 LocationXY16 gMapSelectionTiles[300];
 rct2_peep_spawn gPeepSpawns[MAX_PEEP_SPAWNS];
@@ -103,6 +107,10 @@ rct2_peep_spawn gPeepSpawns[MAX_PEEP_SPAWNS];
 rct_tile_element *gNextFreeTileElement;
 uint32 gNextFreeTileElementPointerIndex;
 
+static tile_element_allocator _tileElementAllocator;
+// At least the size of the biggest block any tile has, used to reserve room for a game command's elements
+static uint32 _tileElementLargestBlock;
+
 bool gLandMountainMode;
 bool gLandPaintMode;
 bool gClearSmallScenery;
@@ -119,6 +127,7 @@ bool gMapLandRightsUpdateSuccess;
 static void map_update_grass_length(sint32 x, sint32 y, rct_tile_element *tileElement);
 static void map_set_grass_length(sint32 x, sint32 y, rct_tile_element *tileElement, sint32 length);
 static void clear_elements_at(sint32 x, sint32 y);
+static uint32 map_get_path_wide_flags(sint32 x, sint32 y);
 static void translate_3d_to_2d(sint32 rotation, sint32 *x, sint32 *y);
 
 void rotate_map_coordinates(sint16 *x, sint16 *y, sint32 rotation)
@@ -392,6 +401,11 @@ void map_init(sint32 size)
     gNumMapAnimations = 0;
     gNextFreeTileElementPointerIndex = 0;
 
+    if (!map_set_tile_element_capacity(DEFAULT_TILE_ELEMENT_CAPACITY)) {
+        log_fatal("Unable to allocate memory for map elements.");
+        return;
+    }
+
     for (sint32 i = 0; i < MAX_TILE_TILE_ELEMENT_POINTERS; i++) {
         rct_tile_element *tile_element = &gTileElements[i];
         tile_element->type = (TILE_ELEMENT_TYPE_SURFACE << 2);
@@ -478,7 +492,7 @@ void map_strip_ghost_flag_from_elements()
     rct_tile_element *tileElement = gTileElements;
     do {
         tileElement->flags &= ~TILE_ELEMENT_FLAG_GHOST;
-    } while (++tileElement < gTileElements + MAX_TILE_ELEMENTS);
+    } while (++tileElement < gTileElements + gTileElementCapacity);
 }
 
 /**
@@ -503,6 +517,9 @@ void map_update_tile_pointers()
     }
 
     gNextFreeTileElement = tileElement;
+    map_reset_tile_element_allocator();
+    peep_pathfind_invalidate_cache();
+    ride_candidates_invalidate_map();
 }
 
 /**
@@ -660,55 +677,6 @@ sint32 tile_element_height(sint32 x, sint32 y)
     return height;
 }
 
-/**
- *
- *  rct2: 0x0068B089
- */
-void sub_68B089()
-{
-    sint32 i;
-    rct_tile_element *tileElementFirst, *tileElement;
-
-    if (gTrackDesignSaveMode)
-        return;
-
-    i = gNextFreeTileElementPointerIndex;
-    do {
-        i++;
-        if (i >= MAX_TILE_TILE_ELEMENT_POINTERS)
-            i = 0;
-    } while (gTileElementTilePointers[i] == TILE_UNDEFINED_TILE_ELEMENT);
-    gNextFreeTileElementPointerIndex = i;
-
-    tileElementFirst = tileElement = gTileElementTilePointers[i];
-    do {
-        tileElement--;
-        if (tileElement < gTileElements)
-            break;
-    } while (tileElement->base_height == 255);
-    tileElement++;
-
-    if (tileElement == tileElementFirst)
-        return;
-
-    //
-    gTileElementTilePointers[i] = tileElement;
-    do {
-        *tileElement = *tileElementFirst;
-        tileElementFirst->base_height = 255;
-
-        tileElementFirst++;
-    } while (!tile_element_is_last_for_tile(tileElement++));
-
-    tileElement = gNextFreeTileElement;
-    do {
-        tileElement--;
-    } while (tileElement->base_height == 255);
-    tileElement++;
-    gNextFreeTileElement = tileElement;
-}
-
-
 /**
  * Checks if the tile at coordinate at height counts as connected.
  * @return 1 if connected, 0 otherwise
@@ -757,7 +725,12 @@ void map_update_path_wide_flags()
     uint16 x = gWidePathTileLoopX;
     uint16 y = gWidePathTileLoopY;
     for (sint32 i = 0; i < 128; i++) {
+        // Pathfinding treats wide paths differently, so its cache is only kept while no flag changes
+        uint32 wideFlags = map_get_path_wide_flags(x, y);
         footpath_update_path_wide_flags(x, y);
+        if (wideFlags == UINT32_MAX || map_get_path_wide_flags(x, y) != wideFlags) {
+            peep_pathfind_invalidate_cache();
+        }
 
         // Next x, y tile
         x += 32;
@@ -773,6 +746,30 @@ void map_update_path_wide_flags()
     gWidePathTileLoopY = y;
 }
 
+/**
+ * Gets a bit per path element on the tile, set if the path is wide. Returns UINT32_MAX
+ * for tiles with too many path elements to tell apart.
+ */
+static uint32 map_get_path_wide_flags(sint32 x, sint32 y)
+{
+    if (x < 0 || y < 0 || x >= 8192 || y >= 8192)
+        return 0;
+
+    uint32 wideFlags = 0;
+    sint32 numPaths = 0;
+    rct_tile_element *tileElement = map_get_first_element_at(x / 32, y / 32);
+    do {
+        if (tile_element_get_type(tileElement) != TILE_ELEMENT_TYPE_PATH)
+            continue;
+        if (numPaths == 31)
+            return UINT32_MAX;
+        if (footpath_element_is_wide(tileElement))
+            wideFlags |= 1 << numPaths;
+        numPaths++;
+    } while (!tile_element_is_last_for_tile(tileElement++));
+    return wideFlags;
+}
+
 /**
  *
  *  rct2: 0x006A7B84
@@ -2899,12 +2896,44 @@ sint32 tile_element_get_station(const rct_tile_element * tileElement)
     return (tileElement->properties.track.sequence & MAP_ELEM_TRACK_SEQUENCE_STATION_INDEX_MASK) >> 4;
 }
 
+/**
+ * Finds the tile whose block contains the given element.
+ */
+static bool TileElementGetTileCoords(const rct_tile_element *tileElement, sint32 *outX, sint32 *outY)
+{
+    for (sint32 i = 0; i < MAX_TILE_TILE_ELEMENT_POINTERS; i++) {
+        const rct_tile_element *first = gTileElementTilePointers[i];
+        if (first != TILE_UNDEFINED_TILE_ELEMENT && tileElement >= first && tileElement < first + _tileElementAllocator.capacities[i]) {
+            *outX = i % MAXIMUM_MAP_SIZE_TECHNICAL;
+            *outY = i / MAXIMUM_MAP_SIZE_TECHNICAL;
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  *
  *  rct2: 0x0068B280
  */
 void tile_element_remove(rct_tile_element *tileElement)
 {
+    peep_pathfind_invalidate_cache();
+
+    // Only track elements are indexed by ride candidates, so the tile is not looked up for other elements unless
+    // the ride ratings need it
+    if (tile_element_get_type(tileElement) == TILE_ELEMENT_TYPE_TRACK || gRideRatingsTrackMapChanges) {
+        sint32 x, y;
+        if (TileElementGetTileCoords(tileElement, &x, &y)) {
+            ride_candidates_invalidate_tile(x, y);
+            if (gRideRatingsTrackMapChanges) {
+                ride_ratings_invalidate_tile(x, y);
+            }
+        } else {
+            ride_candidates_invalidate_map();
+        }
+    }
+
     // Replace Nth element by (N+1)th element.
     // This loop will make tileElement point to the old last element position,
     // after copy it to it's new position
@@ -2915,12 +2944,9 @@ void tile_element_remove(rct_tile_element *tileElement)
     }
 
     // Mark the latest element with the last element flag.
+    // The vacated slot stays part of the tile's block, it is reused by the next insert on this tile.
     (tileElement - 1)->flags |= TILE_ELEMENT_FLAG_LAST_TILE;
     tileElement->base_height = 0xFF;
-
-    if ((tileElement + 1) == gNextFreeTileElement){
-        gNextFreeTileElement--;
-    }
 }
 
 /**
@@ -3042,7 +3068,7 @@ void map_reorganise_elements()
 {
     context_setcurrentcursor(CURSOR_ZZZ);
 
-    rct_tile_element* new_tile_elements = malloc(3 * (MAXIMUM_MAP_SIZE_TECHNICAL * MAXIMUM_MAP_SIZE_TECHNICAL) * sizeof(rct_tile_element));
+    rct_tile_element* new_tile_elements = calloc(gTileElementCapacity + TILE_ELEMENT_POOL_SCRATCH, sizeof(rct_tile_element));
     rct_tile_element* new_elements_pointer = new_tile_elements;
 
     if (new_tile_elements == NULL) {
@@ -3064,97 +3090,262 @@ void map_reorganise_elements()
         }
     }
 
-    num_elements = (uint32)(new_elements_pointer - new_tile_elements);
-    memcpy(gTileElements, new_tile_elements, num_elements * sizeof(rct_tile_element));
-    memset(gTileElements + num_elements, 0, (3 * (MAXIMUM_MAP_SIZE_TECHNICAL * MAXIMUM_MAP_SIZE_TECHNICAL) - num_elements) * sizeof(rct_tile_element));
-
-    free(new_tile_elements);
+    free(gTileElements);
+    gTileElements = new_tile_elements;
 
     map_update_tile_pointers();
 }
 
+/**
+ * Resizes the tile element pool to hold the given number of elements, moving the elements and the tile
+ * pointers to the new allocation. Like map_reorganise_elements, this invalidates any other pointers to
+ * tile elements.
+ */
+bool map_set_tile_element_capacity(uint32 capacity)
+{
+    capacity = clamp(DEFAULT_TILE_ELEMENT_CAPACITY, capacity, MAX_TILE_ELEMENTS);
+    if (gTileElements != NULL && capacity == gTileElementCapacity) {
+        return true;
+    }
+
+    size_t oldLength = gTileElements == NULL ? 0 : gTileElementCapacity + TILE_ELEMENT_POOL_SCRATCH;
+    size_t newLength = capacity + TILE_ELEMENT_POOL_SCRATCH;
+    rct_tile_element *newTileElements = malloc(newLength * sizeof(rct_tile_element));
+    if (newTileElements == NULL) {
+        log_error("Unable to allocate memory for %u map elements.", capacity);
+        return false;
+    }
+
+    size_t copyLength = min(oldLength, newLength);
+    if (copyLength > 0) {
+        memcpy(newTileElements, gTileElements, copyLength * sizeof(rct_tile_element));
+    }
+    memset(newTileElements + copyLength, 0, (newLength - copyLength) * sizeof(rct_tile_element));
+
+    // Tiles that started past the end of a smaller pool are left undefined, the caller has to rebuild them
+    for (sint32 i = 0; i < MAX_TILE_TILE_ELEMENT_POINTERS; i++) {
+        rct_tile_element *tileElement = gTileElementTilePointers[i];
+        if (tileElement != TILE_UNDEFINED_TILE_ELEMENT) {
+            size_t index = (size_t)(tileElement - gTileElements);
+            gTileElementTilePointers[i] = index < newLength ? newTileElements + index : TILE_UNDEFINED_TILE_ELEMENT;
+        }
+    }
+    if (gNextFreeTileElement != NULL) {
+        size_t index = (size_t)(gNextFreeTileElement - gTileElements);
+        gNextFreeTileElement = newTileElements + min(index, newLength);
+    }
+
+    free(gTileElements);
+    gTileElements = newTileElements;
+    gTileElementCapacity = capacity;
+    log_verbose("Map element pool resized to %u elements", capacity);
+    return true;
+}
+
+/**
+ * Makes sure there is room for the given number of elements past gNextFreeTileElement, growing the pool by
+ * half again (or by enough for the new elements if that is more) when there is not.
+ */
+static bool TileElementPoolReserve(uint32 numElements)
+{
+    uint32 required = (uint32)(gNextFreeTileElement - gTileElements) + numElements;
+    if (required <= gTileElementCapacity)
+        return true;
+
+    uint32 capacity = max(gTileElementCapacity + gTileElementCapacity / 2, required);
+    return required <= MAX_TILE_ELEMENTS && map_set_tile_element_capacity(capacity);
+}
+
 /**
  *
  *  rct2: 0x0068B044
  *  Returns true on space available for more elements
- *  Reorganises the map elements to check for space
+ *  Grows the pool if there is not enough space left. Elements are inserted into their tile's block or a
+ *  recycled one, so the map no longer needs to be reorganised to make room.
+ *  Growing moves every element, so this is the only place the pool grows, before a game command holds
+ *  any element pointers. Each insert may move a full tile to a block of the next power of two, which is
+ *  at most twice the largest block, so that much is reserved for every element.
  */
 bool map_check_free_elements_and_reorganise(sint32 num_elements)
 {
-    if ((gNextFreeTileElement + num_elements) <= gTileElements + MAX_TILE_ELEMENTS)
+    uint32 worstCaseBlockSize = max(_tileElementLargestBlock, 1) * 2;
+    if (TileElementPoolReserve((uint32)num_elements * worstCaseBlockSize))
         return true;
 
-    for (sint32 i = 1000; i != 0; --i)
-        sub_68B089();
+    gGameCommandErrorText = STR_ERR_LANDSCAPE_DATA_AREA_FULL;
+    return false;
+}
 
-    if ((gNextFreeTileElement + num_elements) <= gTileElements + MAX_TILE_ELEMENTS)
-        return true;
+static uint32 TileElementCountForTile(const rct_tile_element *tileElement)
+{
+    uint32 numElements = 1;
+    while (!tile_element_is_last_for_tile(tileElement++)) {
+        numElements++;
+    }
+    return numElements;
+}
 
-    map_reorganise_elements();
+static sint32 TileElementGetSizeClass(uint32 size)
+{
+    sint32 sizeClass = 0;
+    while (size > 1 && sizeClass < TILE_ELEMENT_SIZE_CLASS_COUNT - 1) {
+        size >>= 1;
+        sizeClass++;
+    }
+    return sizeClass;
+}
 
-    if ((gNextFreeTileElement + num_elements) <= gTileElements + MAX_TILE_ELEMENTS)
-        return true;
-    else{
-        gGameCommandErrorText = STR_ERR_LANDSCAPE_DATA_AREA_FULL;
-        return false;
+/**
+ * Adds a block to the free list for its size. The block's first element records the size and the next free
+ * block, the size is split over the type and clearance height so flag updates over the whole pool leave it intact.
+ */
+static void TileElementFreeBlock(uint32 index, uint16 size)
+{
+    sint32 sizeClass = TileElementGetSizeClass(size);
+    rct_tile_element *block = &gTileElements[index];
+    block->type = size & 0xFF;
+    block->clearance_height = size >> 8;
+    block->base_height = 0xFF;
+    memcpy(&block->properties, &_tileElementAllocator.free_lists[sizeClass], sizeof(uint32));
+    _tileElementAllocator.free_lists[sizeClass] = index;
+}
+
+/**
+ * Takes a block of at least the given size (a power of two) from the free lists, or from the end of the pool
+ * if none is free. The pool is never grown here, map_check_free_elements_and_reorganise reserves the room.
+ * @return the index of the block or UINT32_MAX if the pool is full.
+ */
+static uint32 TileElementAllocateBlock(uint32 size, uint16 *outSize)
+{
+    // Every block in the class of a power of two is at least that size
+    for (sint32 sizeClass = TileElementGetSizeClass(size); sizeClass < TILE_ELEMENT_SIZE_CLASS_COUNT; sizeClass++) {
+        uint32 index = _tileElementAllocator.free_lists[sizeClass];
+        if (index != TILE_ELEMENT_FREE_LIST_END) {
+            const rct_tile_element *block = &gTileElements[index];
+            memcpy(&_tileElementAllocator.free_lists[sizeClass], &block->properties, sizeof(uint32));
+            *outSize = block->type | (block->clearance_height << 8);
+            return index;
+        }
     }
+
+    if ((uint32)(gNextFreeTileElement - gTileElements) + size > gTileElementCapacity)
+        return TILE_ELEMENT_FREE_LIST_END;
+
+    uint32 index = (uint32)(gNextFreeTileElement - gTileElements);
+    gNextFreeTileElement += size;
+    *outSize = (uint16)size;
+    return index;
 }
 
 /**
- *
- *  rct2: 0x0068B1F6
+ * Moves a tile's elements to a block big enough for the given number of elements and frees its old block.
  */
-rct_tile_element *tile_element_insert(sint32 x, sint32 y, sint32 z, sint32 flags)
+static bool TileElementGrowTile(sint32 tileIndex, uint32 numElements, uint32 requiredCapacity)
 {
-    rct_tile_element *originalTileElement, *newTileElement, *insertedElement;
+    uint32 size = 1;
+    while (size < requiredCapacity) {
+        size <<= 1;
+    }
+    if (size > UINT16_MAX) {
+        return false;
+    }
 
-    if (!map_check_free_elements_and_reorganise(1)) {
-        log_error("Cannot insert new element");
-        return NULL;
+    uint16 blockSize;
+    uint32 blockIndex = TileElementAllocateBlock(size, &blockSize);
+    if (blockIndex == TILE_ELEMENT_FREE_LIST_END) {
+        return false;
     }
 
-    newTileElement = gNextFreeTileElement;
-    originalTileElement = gTileElementTilePointers[y * MAXIMUM_MAP_SIZE_TECHNICAL + x];
+    rct_tile_element *oldElements = gTileElementTilePointers[tileIndex];
+    memcpy(&gTileElements[blockIndex], oldElements, numElements * sizeof(rct_tile_element));
+    if (_tileElementAllocator.capacities[tileIndex] > 0) {
+        TileElementFreeBlock((uint32)(oldElements - gTileElements), _tileElementAllocator.capacities[tileIndex]);
+    }
+    gTileElementTilePointers[tileIndex] = &gTileElements[blockIndex];
+    _tileElementAllocator.capacities[tileIndex] = blockSize;
+    _tileElementLargestBlock = max(_tileElementLargestBlock, blockSize);
+    return true;
+}
 
-    // Set tile index pointer to point to new element block
-    gTileElementTilePointers[y * MAXIMUM_MAP_SIZE_TECHNICAL + x] = newTileElement;
+/**
+ * Sizes every tile's block to the elements it holds and forgets all free blocks. Used whenever the tile
+ * pointers have been rebuilt from a contiguous pool.
+ */
+static void TileElementUpdateLargestBlock()
+{
+    _tileElementLargestBlock = 0;
+    for (sint32 i = 0; i < MAX_TILE_TILE_ELEMENT_POINTERS; i++) {
+        _tileElementLargestBlock = max(_tileElementLargestBlock, _tileElementAllocator.capacities[i]);
+    }
+}
 
-    // Copy all elements that are below the insert height
-    while (z >= originalTileElement->base_height) {
-        // Copy over map element
-        *newTileElement = *originalTileElement;
-        originalTileElement->base_height = 255;
-        originalTileElement++;
-        newTileElement++;
+void map_reset_tile_element_allocator()
+{
+    for (sint32 i = 0; i < MAX_TILE_TILE_ELEMENT_POINTERS; i++) {
+        const rct_tile_element *tileElement = gTileElementTilePointers[i];
+        _tileElementAllocator.capacities[i] = tileElement == TILE_UNDEFINED_TILE_ELEMENT ? 0 : (uint16)TileElementCountForTile(tileElement);
+    }
+    memset(_tileElementAllocator.free_lists, 0xFF, sizeof(_tileElementAllocator.free_lists));
+    TileElementUpdateLargestBlock();
+}
 
-        if ((newTileElement - 1)->flags & TILE_ELEMENT_FLAG_LAST_TILE) {
-            // No more elements above the insert element
-            (newTileElement - 1)->flags &= ~TILE_ELEMENT_FLAG_LAST_TILE;
-            flags |= TILE_ELEMENT_FLAG_LAST_TILE;
-            break;
+void map_get_tile_element_allocator(tile_element_allocator *allocator)
+{
+    *allocator = _tileElementAllocator;
+}
+
+void map_set_tile_element_allocator(const tile_element_allocator *allocator)
+{
+    _tileElementAllocator = *allocator;
+    TileElementUpdateLargestBlock();
+}
+
+/**
+ *
+ *  rct2: 0x0068B1F6
+ */
+rct_tile_element *tile_element_insert(sint32 x, sint32 y, sint32 z, sint32 flags)
+{
+    sint32 tileIndex = y * MAXIMUM_MAP_SIZE_TECHNICAL + x;
+    rct_tile_element *tileElement = gTileElementTilePointers[tileIndex];
+    uint32 numElements = TileElementCountForTile(tileElement);
+
+    // Only move the tile when its block has no slack left
+    if (numElements + 1 > _tileElementAllocator.capacities[tileIndex]) {
+        if (!TileElementGrowTile(tileIndex, numElements, numElements + 1)) {
+            gGameCommandErrorText = STR_ERR_LANDSCAPE_DATA_AREA_FULL;
+            log_error("Cannot insert new element");
+            return NULL;
         }
+        tileElement = gTileElementTilePointers[tileIndex];
     }
 
-    // Insert new map element
-    insertedElement = newTileElement;
-    newTileElement->base_height = z;
-    newTileElement->flags = flags;
-    newTileElement->clearance_height = z;
-    memset(&newTileElement->properties, 0, sizeof(newTileElement->properties));
-    newTileElement++;
-
-    // Insert rest of map elements above insert height
-    if (!(flags & TILE_ELEMENT_FLAG_LAST_TILE)) {
-        do {
-            // Copy over map element
-            *newTileElement = *originalTileElement;
-            originalTileElement->base_height = 255;
-            originalTileElement++;
-            newTileElement++;
-        } while (!((newTileElement - 1)->flags & TILE_ELEMENT_FLAG_LAST_TILE));
+    // The new element goes below the first element above the insert height
+    uint32 insertIndex = 0;
+    while (insertIndex < numElements && z >= tileElement[insertIndex].base_height) {
+        insertIndex++;
     }
 
-    gNextFreeTileElement = newTileElement;
+    if (insertIndex == numElements) {
+        // No more elements above the insert element
+        tileElement[numElements - 1].flags &= ~TILE_ELEMENT_FLAG_LAST_TILE;
+        flags |= TILE_ELEMENT_FLAG_LAST_TILE;
+    } else {
+        memmove(&tileElement[insertIndex + 1], &tileElement[insertIndex], (numElements - insertIndex) * sizeof(rct_tile_element));
+    }
+
+    // Insert new map element
+    rct_tile_element *insertedElement = &tileElement[insertIndex];
+    insertedElement->type = 0;
+    insertedElement->base_height = z;
+    insertedElement->flags = flags;
+    insertedElement->clearance_height = z;
+    memset(&insertedElement->properties, 0, sizeof(insertedElement->properties));
+    peep_pathfind_invalidate_cache();
+    ride_candidates_invalidate_tile(x, y);
+    if (gRideRatingsTrackMapChanges) {
+        ride_ratings_invalidate_tile(x, y);
+    }
     return insertedElement;
 }
 
@@ -3166,7 +3357,7 @@ rct_tile_element *tile_element_insert(sint32 x, sint32 y, sint32 z, sint32 flags
 bool tile_element_check_address(const rct_tile_element * const element)
 {
     if (element >= gTileElements
-        && element < gTileElements + MAX_TILE_ELEMENTS
+        && element < gTileElements + gTileElementCapacity
         // condition below checks alignment
         && gTileElements + (((uintptr_t)element - (uintptr_t)gTileElements) / sizeof(rct_tile_element)) == element)
     {
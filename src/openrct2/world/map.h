@@ -311,8 +311,18 @@ enum {
 
 #define MAP_MINIMUM_X_Y -MAXIMUM_MAP_SIZE_TECHNICAL
 
-#define MAX_TILE_ELEMENTS 196096 // 0x30000
+// The tile element pool starts with the number of elements RCT2 had and grows
+// when the park needs more, up to MAX_TILE_ELEMENTS.
+#define MAX_TILE_ELEMENTS 0x1000000
+#define DEFAULT_TILE_ELEMENT_CAPACITY 196096
+// Elements allocated after the end of the pool, which RCT2 counted as part of
+// the saved map but never used.
+#define TILE_ELEMENT_POOL_SCRATCH 512
 #define MAX_TILE_TILE_ELEMENT_POINTERS (MAXIMUM_MAP_SIZE_TECHNICAL * MAXIMUM_MAP_SIZE_TECHNICAL)
+// Free blocks of elements are kept in lists by size, list n holding blocks of
+// 2^n up to 2^(n+1) - 1 elements.
+#define TILE_ELEMENT_SIZE_CLASS_COUNT 16
+#define TILE_ELEMENT_FREE_LIST_END UINT32_MAX
 #define MAX_PEEP_SPAWNS 2
 #define PEEP_SPAWN_UNDEFINED 0xFFFF
 
@@ -338,6 +348,16 @@ typedef struct rct2_peep_spawn {
 assert_struct_size(rct2_peep_spawn, 6);
 #pragma pack(pop)
 
+/**
+ * Bookkeeping for the tile element pool. Each tile owns a block of elements that
+ * can be larger than the elements it holds, so inserting usually does not move the
+ * tile. When it does, the old block is put on a free list for reuse.
+ */
+typedef struct tile_element_allocator {
+    uint16 capacities[MAX_TILE_TILE_ELEMENT_POINTERS];
+    uint32 free_lists[TILE_ELEMENT_SIZE_CLASS_COUNT];
+} tile_element_allocator;
+
 enum {
     MAP_SELECT_FLAG_ENABLE              = 1 << 0,
     MAP_SELECT_FLAG_ENABLE_CONSTRUCT    = 1 << 1,
@@ -398,7 +418,8 @@ extern uint8        gMapSelectArrowDirection;
 
 extern uint8 gMapGroundFlags;
 
-extern rct_tile_element gTileElements[];
+extern rct_tile_element *gTileElements;
+extern uint32 gTileElementCapacity;
 extern rct_tile_element *gTileElementTilePointers[];
 
 extern LocationXY16 gMapSelectionTiles[300];
@@ -450,7 +471,6 @@ rct_tile_element *map_get_park_entrance_element_at(sint32 x, sint32 y, sint32 z,
 rct_tile_element * map_get_ride_entrance_element_at(sint32 x, sint32 y, sint32 z, bool ghost);
 rct_tile_element * map_get_ride_exit_element_at(sint32 x, sint32 y, sint32 z, bool ghost);
 sint32 tile_element_height(sint32 x, sint32 y);
-void sub_68B089();
 sint32 map_coord_is_connected(sint32 x, sint32 y, sint32 z, uint8 faceDirection);
 void map_remove_provisional_elements();
 void map_restore_provisional_elements();
@@ -465,7 +485,11 @@ void tile_element_remove(rct_tile_element *tileElement);
 void map_remove_all_rides();
 void map_invalidate_map_selection_tiles();
 void map_invalidate_selection_rect();
+bool map_set_tile_element_capacity(uint32 capacity);
 void map_reorganise_elements();
+void map_reset_tile_element_allocator();
+void map_get_tile_element_allocator(tile_element_allocator *allocator);
+void map_set_tile_element_allocator(const tile_element_allocator *allocator);
 bool map_check_free_elements_and_reorganise(sint32 num_elements);
 rct_tile_element *tile_element_insert(sint32 x, sint32 y, sint32 z, sint32 flags);
 bool tile_element_check_address(const rct_tile_element * const element);
@@ -27,13 +27,20 @@
 
 uint16 gSpriteListHead[6];
 uint16 gSpriteListCount[6];
-static rct_sprite _spriteList[MAX_SPRITES];
+uint16 gSpriteCapacity;
+
+// Sprites are allocated in blocks that never move, so growing the pool does not invalidate sprite pointers
+#define MAX_SPRITE_BLOCKS (MAX_SPRITES / SPRITE_BLOCK_SIZE)
+static rct_sprite * _spriteBlocks[MAX_SPRITE_BLOCKS];
 
 static bool _spriteFlashingList[MAX_SPRITES];
 
 #define SPATIAL_INDEX_LOCATION_NULL 0x10000
 
 uint16 gSpriteSpatialIndex[0x10001];
+// The sprite before each sprite in its spatial index chain, so that it can be unlinked without walking the chain.
+// This is not saved, it is rebuilt from the chains whenever those are loaded.
+static uint16 _spriteSpatialPrevious[MAX_SPRITES];
 
 const rct_string_id litterNames[12] = {
     STR_LITTER_VOMIT,
@@ -54,21 +61,25 @@ static LocationXYZ16 _spritelocations1[MAX_SPRITES];
 static LocationXYZ16 _spritelocations2[MAX_SPRITES];
 
 static size_t GetSpatialIndexOffset(sint32 x, sint32 y);
+static void SpatialIndexLink(rct_sprite * sprite, size_t index);
+static void SpatialIndexUnlink(rct_sprite * sprite, size_t index);
+static bool SpritePoolResize(size_t capacity);
+static bool SpritePoolGrow();
 
 rct_sprite *try_get_sprite(size_t spriteIndex)
 {
     rct_sprite * sprite = NULL;
-    if (spriteIndex < MAX_SPRITES)
+    if (spriteIndex < gSpriteCapacity)
     {
-        sprite = &_spriteList[spriteIndex];
+        sprite = &_spriteBlocks[spriteIndex / SPRITE_BLOCK_SIZE][spriteIndex % SPRITE_BLOCK_SIZE];
     }
     return sprite;
 }
 
 rct_sprite *get_sprite(size_t sprite_idx)
 {
-    openrct2_assert(sprite_idx < MAX_SPRITES, "Tried getting sprite %u", sprite_idx);
-    return &_spriteList[sprite_idx];
+    openrct2_assert(sprite_idx < gSpriteCapacity, "Tried getting sprite %u", sprite_idx);
+    return &_spriteBlocks[sprite_idx / SPRITE_BLOCK_SIZE][sprite_idx % SPRITE_BLOCK_SIZE];
 }
 
 uint16 sprite_get_first_in_quadrant(sint32 x, sint32 y)
@@ -131,7 +142,10 @@ void invalidate_sprite_2(rct_sprite *sprite)
 void reset_sprite_list()
 {
     gSavedAge = 0;
-    memset(_spriteList, 0, sizeof(rct_sprite) * MAX_SPRITES);
+    SpritePoolResize(DEFAULT_SPRITE_CAPACITY);
+    for (size_t i = 0; i < gSpriteCapacity / SPRITE_BLOCK_SIZE; i++) {
+        memset(_spriteBlocks[i], 0, sizeof(rct_sprite) * SPRITE_BLOCK_SIZE);
+    }
 
     for (sint32 i = 0; i < NUM_SPRITE_LISTS; i++) {
         gSpriteListHead[i] = SPRITE_INDEX_NULL;
@@ -141,7 +155,7 @@ void reset_sprite_list()
 
     rct_sprite* previous_spr = (rct_sprite*)SPRITE_INDEX_NULL;
 
-    for (sint32 i = 0; i < MAX_SPRITES; ++i){
+    for (sint32 i = 0; i < gSpriteCapacity; ++i){
         rct_sprite *spr = get_sprite(i);
         spr->unknown.sprite_identifier = SPRITE_IDENTIFIER_NULL;
         spr->unknown.sprite_index = i;
@@ -160,11 +174,85 @@ void reset_sprite_list()
         previous_spr = spr;
     }
 
-    gSpriteListCount[SPRITE_LIST_NULL] = MAX_SPRITES;
+    gSpriteListCount[SPRITE_LIST_NULL] = gSpriteCapacity;
 
     reset_sprite_spatial_index();
 }
 
+/**
+ * Allocates or frees blocks so that the pool holds the given number of sprites, rounded up to whole blocks.
+ * New sprites are zeroed and not linked into any list.
+ */
+static bool SpritePoolResize(size_t capacity)
+{
+    capacity = min(((capacity + SPRITE_BLOCK_SIZE - 1) / SPRITE_BLOCK_SIZE) * SPRITE_BLOCK_SIZE, MAX_SPRITES);
+    size_t numBlocks = capacity / SPRITE_BLOCK_SIZE;
+    for (size_t i = 0; i < MAX_SPRITE_BLOCKS; i++) {
+        if (i < numBlocks) {
+            if (_spriteBlocks[i] == NULL) {
+                _spriteBlocks[i] = calloc(SPRITE_BLOCK_SIZE, sizeof(rct_sprite));
+                if (_spriteBlocks[i] == NULL) {
+                    log_error("Unable to allocate memory for %u sprites.", (uint32)capacity);
+                    gSpriteCapacity = (uint16)(i * SPRITE_BLOCK_SIZE);
+                    return false;
+                }
+            }
+        } else if (_spriteBlocks[i] != NULL) {
+            free(_spriteBlocks[i]);
+            _spriteBlocks[i] = NULL;
+        }
+    }
+    gSpriteCapacity = (uint16)capacity;
+    return true;
+}
+
+/**
+ * Adds a block of sprites to the pool and puts them at the front of the null list, lowest index first.
+ */
+static bool SpritePoolGrow()
+{
+    uint16 firstSpriteIndex = gSpriteCapacity;
+    if (firstSpriteIndex >= MAX_SPRITES || !SpritePoolResize(firstSpriteIndex + SPRITE_BLOCK_SIZE)) {
+        return false;
+    }
+
+    for (sint32 i = gSpriteCapacity - 1; i >= firstSpriteIndex; i--) {
+        rct_unk_sprite *sprite = &get_sprite(i)->unknown;
+        sprite->sprite_identifier = SPRITE_IDENTIFIER_NULL;
+        sprite->sprite_index = i;
+        sprite->linked_list_type_offset = SPRITE_LIST_NULL * 2;
+        sprite->next_in_quadrant = SPRITE_INDEX_NULL;
+        sprite->previous = SPRITE_INDEX_NULL;
+        sprite->next = gSpriteListHead[SPRITE_LIST_NULL];
+        if (sprite->next != SPRITE_INDEX_NULL) {
+            get_sprite(sprite->next)->unknown.previous = i;
+        }
+        gSpriteListHead[SPRITE_LIST_NULL] = i;
+        gSpriteListCount[SPRITE_LIST_NULL]++;
+
+        _spriteFlashingList[i] = false;
+        _spriteSpatialPrevious[i] = SPRITE_INDEX_NULL;
+    }
+    log_verbose("Sprite pool grown to %u sprites", gSpriteCapacity);
+    return true;
+}
+
+/**
+ * Sets the number of sprites in the pool, for importers that go on to overwrite every sprite and list head.
+ */
+void sprite_set_capacity(uint32 capacity)
+{
+    SpritePoolResize(max(capacity, DEFAULT_SPRITE_CAPACITY));
+}
+
+/**
+ * Gets the number of sprites that can still be created, including those the pool can grow by.
+ */
+uint32 sprite_get_free_count()
+{
+    return gSpriteListCount[SPRITE_LIST_NULL] + (MAX_SPRITES - gSpriteCapacity);
+}
+
 /**
  *
  *  rct2: 0x0069EBE4
@@ -174,85 +262,94 @@ void reset_sprite_list()
 void reset_sprite_spatial_index()
 {
     memset(gSpriteSpatialIndex, SPRITE_INDEX_NULL, sizeof(gSpriteSpatialIndex));
-    for (size_t i = 0; i < MAX_SPRITES; i++) {
+    for (size_t i = 0; i < gSpriteCapacity; i++) {
         rct_sprite *spr = get_sprite(i);
         if (spr->unknown.sprite_identifier != SPRITE_IDENTIFIER_NULL) {
             size_t index = GetSpatialIndexOffset(spr->unknown.x, spr->unknown.y);
-            uint16 nextSpriteId = gSpriteSpatialIndex[index];
-            gSpriteSpatialIndex[index] = spr->unknown.sprite_index;
-            spr->unknown.next_in_quadrant = nextSpriteId;
+            SpatialIndexLink(spr, index);
         }
     }
 }
 
-static size_t GetSpatialIndexOffset(sint32 x, sint32 y)
+/**
+ * Rebuilds the backward links of the spatial index chains, which must be done whenever the chains are
+ * modified directly, e.g. when they are loaded from a save or received from the server.
+ */
+void rebuild_sprite_spatial_index_links()
 {
-    size_t index = SPATIAL_INDEX_LOCATION_NULL;
-    if (x != LOCATION_NULL) {
-        x = clamp(0, x, 0xFFFF);
-        y = clamp(0, y, 0xFFFF);
-
-        sint16 flooredX = floor2(x, 32);
-        uint8 tileY = y >> 5;
-        index = (flooredX << 3) | tileY;
+    memset(_spriteSpatialPrevious, 0xFF, sizeof(_spriteSpatialPrevious));
+    for (size_t i = 0; i < countof(gSpriteSpatialIndex); i++) {
+        uint16 previous = SPRITE_INDEX_NULL;
+        uint16 spriteIndex = gSpriteSpatialIndex[i];
+        // Guard against cycles in corrupt chains
+        for (size_t n = 0; spriteIndex < gSpriteCapacity && n < gSpriteCapacity; n++) {
+            _spriteSpatialPrevious[spriteIndex] = previous;
+            previous = spriteIndex;
+            spriteIndex = get_sprite(spriteIndex)->unknown.next_in_quadrant;
+        }
     }
-
-    openrct2_assert(index < sizeof(gSpriteSpatialIndex), "GetSpatialIndexOffset out of range");
-    return index;
 }
 
-#ifndef DISABLE_NETWORK
-
-static uint8 _spriteChecksum[EVP_MAX_MD_SIZE + 1];
-
-const char * sprite_checksum()
+static void SpatialIndexLink(rct_sprite * sprite, size_t index)
 {
-    if (EVP_DigestInit_ex(gHashCTX, EVP_sha1(), NULL) <= 0)
-    {
-        openrct2_assert(false, "Failed to initialise SHA1 engine");
+    uint16 spriteIndex = sprite->unknown.sprite_index;
+    uint16 nextSpriteIndex = gSpriteSpatialIndex[index];
+    sprite->unknown.next_in_quadrant = nextSpriteIndex;
+    _spriteSpatialPrevious[spriteIndex] = SPRITE_INDEX_NULL;
+    if (nextSpriteIndex != SPRITE_INDEX_NULL) {
+        _spriteSpatialPrevious[nextSpriteIndex] = spriteIndex;
     }
-    for (size_t i = 0; i < MAX_SPRITES; i++)
-    {
-        rct_sprite *sprite = get_sprite(i);
-        if (sprite->unknown.sprite_identifier != SPRITE_IDENTIFIER_NULL && sprite->unknown.sprite_identifier != SPRITE_IDENTIFIER_MISC)
-        {
-            rct_sprite copy = *sprite;
-            copy.unknown.sprite_left = copy.unknown.sprite_right = copy.unknown.sprite_top = copy.unknown.sprite_bottom = 0;
+    gSpriteSpatialIndex[index] = spriteIndex;
+}
 
-            if (copy.unknown.sprite_identifier == SPRITE_IDENTIFIER_PEEP) {
-                // We set this to 0 because as soon the client selects a guest the window will remove the
-                // invalidation flags causing the sprite checksum to be different than on server, the flag does not affect game state.
-                copy.peep.window_invalidate_flags = 0;
-            }
+static void SpatialIndexUnlink(rct_sprite * sprite, size_t index)
+{
+    uint16 spriteIndex = sprite->unknown.sprite_index;
+    uint16 previousSpriteIndex = _spriteSpatialPrevious[spriteIndex];
+    uint16 *link;
+    if (previousSpriteIndex == SPRITE_INDEX_NULL) {
+        link = &gSpriteSpatialIndex[index];
+    } else {
+        link = &get_sprite(previousSpriteIndex)->unknown.next_in_quadrant;
+    }
 
-            if (EVP_DigestUpdate(gHashCTX, &copy, sizeof(rct_sprite)) <= 0)
-            {
-                openrct2_assert(false, "Failed to update digest");
-            }
+    if (*link != spriteIndex) {
+        // The backward link is stale, find the sprite by walking the chain instead
+        log_verbose("Spatial index link of sprite %u is stale", spriteIndex);
+        previousSpriteIndex = SPRITE_INDEX_NULL;
+        link = &gSpriteSpatialIndex[index];
+        while (*link != SPRITE_INDEX_NULL && *link != spriteIndex) {
+            previousSpriteIndex = *link;
+            link = &get_sprite(*link)->unknown.next_in_quadrant;
+        }
+        if (*link == SPRITE_INDEX_NULL) {
+            return;
         }
     }
-    uint8 localhash[EVP_MAX_MD_SIZE + 1];
-    uint32 size = sizeof(localhash);
-    EVP_DigestFinal(gHashCTX, localhash, &size);
-    assert(size <= sizeof(localhash));
-    localhash[sizeof(localhash) - 1] = '\0';
-    char *x = (char *)_spriteChecksum;
-    for (uint32 i = 0; i < size; i++)
-    {
-        snprintf(x, EVP_MAX_MD_SIZE + 1, "%02x", localhash[i]);
-        x += 2;
+
+    uint16 nextSpriteIndex = sprite->unknown.next_in_quadrant;
+    *link = nextSpriteIndex;
+    if (nextSpriteIndex < gSpriteCapacity) {
+        _spriteSpatialPrevious[nextSpriteIndex] = previousSpriteIndex;
     }
-    *x = '\0';
-    return (char *)_spriteChecksum;
+    _spriteSpatialPrevious[spriteIndex] = SPRITE_INDEX_NULL;
 }
-#else
 
-const char * sprite_checksum()
+static size_t GetSpatialIndexOffset(sint32 x, sint32 y)
 {
-    return NULL;
-}
+    size_t index = SPATIAL_INDEX_LOCATION_NULL;
+    if (x != LOCATION_NULL) {
+        x = clamp(0, x, 0xFFFF);
+        y = clamp(0, y, 0xFFFF);
 
-#endif // DISABLE_NETWORK
+        sint16 flooredX = floor2(x, 32);
+        uint8 tileY = y >> 5;
+        index = (flooredX << 3) | tileY;
+    }
+
+    openrct2_assert(index < sizeof(gSpriteSpatialIndex), "GetSpatialIndexOffset out of range");
+    return index;
+}
 
 static void sprite_reset(rct_unk_sprite *sprite)
 {
@@ -312,12 +409,15 @@ rct_sprite *create_sprite(uint8 bl)
     size_t linkedListTypeOffset = SPRITE_LIST_UNKNOWN * 2;
     if ((bl & 2) != 0) {
         // 69EC96;
+        // Misc sprites are limited to 300, growing the pool only helps when there are fewer than that
         uint16 cx = 0x12C - gSpriteListCount[SPRITE_LIST_MISC];
         if (cx >= gSpriteListCount[SPRITE_LIST_NULL]) {
-            return NULL;
+            if (gSpriteListCount[SPRITE_LIST_MISC] >= 0x12C || !SpritePoolGrow()) {
+                return NULL;
+            }
         }
         linkedListTypeOffset = SPRITE_LIST_MISC * 2;
-    } else if (gSpriteListCount[SPRITE_LIST_NULL] == 0) {
+    } else if (gSpriteListCount[SPRITE_LIST_NULL] == 0 && !SpritePoolGrow()) {
         return NULL;
     }
 
@@ -339,8 +439,7 @@ rct_sprite *create_sprite(uint8 bl)
     sprite->flags = 0;
     sprite->sprite_left = LOCATION_NULL;
 
-    sprite->next_in_quadrant = gSpriteSpatialIndex[SPATIAL_INDEX_LOCATION_NULL];
-    gSpriteSpatialIndex[SPATIAL_INDEX_LOCATION_NULL] = sprite->sprite_index;
+    SpatialIndexLink((rct_sprite*)sprite, SPATIAL_INDEX_LOCATION_NULL);
 
     return (rct_sprite*)sprite;
 }
@@ -556,22 +655,8 @@ void sprite_move(sint16 x, sint16 y, sint16 z, rct_sprite *sprite)
     size_t newIndex = GetSpatialIndexOffset(x, y);
     size_t currentIndex = GetSpatialIndexOffset(sprite->unknown.x, sprite->unknown.y);
     if (newIndex != currentIndex) {
-        uint16 *spriteIndex = &gSpriteSpatialIndex[currentIndex];
-        if (*spriteIndex != SPRITE_INDEX_NULL) {
-            rct_sprite *sprite2 = get_sprite(*spriteIndex);
-            while (sprite != sprite2) {
-                spriteIndex = &sprite2->unknown.next_in_quadrant;
-                if (*spriteIndex == SPRITE_INDEX_NULL) {
-                    break;
-                }
-                sprite2 = get_sprite(*spriteIndex);
-            }
-        }
-        *spriteIndex = sprite->unknown.next_in_quadrant;
-
-        sint32 tempSpriteIndex = gSpriteSpatialIndex[newIndex];
-        gSpriteSpatialIndex[newIndex] = sprite->unknown.sprite_index;
-        sprite->unknown.next_in_quadrant = tempSpriteIndex;
+        SpatialIndexUnlink(sprite, currentIndex);
+        SpatialIndexLink(sprite, newIndex);
     }
 
     if (x == LOCATION_NULL) {
@@ -626,12 +711,7 @@ void sprite_remove(rct_sprite *sprite)
     _spriteFlashingList[sprite->unknown.sprite_index] = false;
 
     size_t quadrantIndex = GetSpatialIndexOffset(sprite->unknown.x, sprite->unknown.y);
-    uint16 *spriteIndex = &gSpriteSpatialIndex[quadrantIndex];
-    rct_sprite *quadrantSprite;
-    while ((quadrantSprite = get_sprite(*spriteIndex)) != sprite) {
-        spriteIndex = &quadrantSprite->unknown.next_in_quadrant;
-    }
-    *spriteIndex = sprite->unknown.next_in_quadrant;
+    SpatialIndexUnlink(sprite, quadrantIndex);
 }
 
 static bool litter_can_be_at(sint32 x, sint32 y, sint32 z)
@@ -731,6 +811,91 @@ void litter_remove_at(sint32 x, sint32 y, sint32 z)
     }
 }
 
+/**
+ * Starts a query for the sprites whose position lies within the given rectangle, edges included.
+ */
+void sprite_spatial_query_rect(sprite_spatial_query * query, sint32 left, sint32 top, sint32 right, sint32 bottom)
+{
+    query->left = left;
+    query->top = top;
+    query->right = right;
+    query->bottom = bottom;
+    query->centre_x = 0;
+    query->centre_y = 0;
+    query->radius_squared = -1;
+
+    sint32 tileLeft = clamp(0, left >> 5, MAXIMUM_MAP_SIZE_TECHNICAL - 1);
+    query->tile_top = clamp(0, top >> 5, MAXIMUM_MAP_SIZE_TECHNICAL - 1);
+    query->tile_right = clamp(0, right >> 5, MAXIMUM_MAP_SIZE_TECHNICAL - 1);
+    query->tile_bottom = clamp(0, bottom >> 5, MAXIMUM_MAP_SIZE_TECHNICAL - 1);
+    query->tile_x = tileLeft;
+    query->tile_y = query->tile_top;
+    if (left > right || top > bottom) {
+        // Nothing to visit, leave the query on its last tile
+        query->tile_x = query->tile_right;
+        query->tile_y = query->tile_bottom;
+        query->next_sprite_index = SPRITE_INDEX_NULL;
+    } else {
+        query->next_sprite_index = gSpriteSpatialIndex[GetSpatialIndexOffset(query->tile_x * 32, query->tile_y * 32)];
+    }
+}
+
+/**
+ * Starts a query for the sprites within the given distance of a point.
+ */
+void sprite_spatial_query_radius(sprite_spatial_query * query, sint32 x, sint32 y, sint32 radius)
+{
+    sprite_spatial_query_rect(query, x - radius, y - radius, x + radius, y + radius);
+    query->centre_x = x;
+    query->centre_y = y;
+    query->radius_squared = (sint64)radius * radius;
+}
+
+static bool sprite_spatial_query_next_tile(sprite_spatial_query * query)
+{
+    if (query->tile_y < query->tile_bottom) {
+        query->tile_y++;
+    } else if (query->tile_x < query->tile_right) {
+        query->tile_x++;
+        query->tile_y = query->tile_top;
+    } else {
+        return false;
+    }
+    query->next_sprite_index = gSpriteSpatialIndex[GetSpatialIndexOffset(query->tile_x * 32, query->tile_y * 32)];
+    return true;
+}
+
+/**
+ * Gets the next sprite of the query, or NULL once every sprite in the area has been returned.
+ */
+rct_sprite * sprite_spatial_query_next(sprite_spatial_query * query)
+{
+    for (;;) {
+        while (query->next_sprite_index == SPRITE_INDEX_NULL) {
+            if (!sprite_spatial_query_next_tile(query)) {
+                return NULL;
+            }
+        }
+
+        rct_sprite * sprite = get_sprite(query->next_sprite_index);
+        query->next_sprite_index = sprite->unknown.next_in_quadrant;
+
+        sint32 x = sprite->unknown.x;
+        sint32 y = sprite->unknown.y;
+        if (x < query->left || x > query->right || y < query->top || y > query->bottom) {
+            continue;
+        }
+        if (query->radius_squared >= 0) {
+            sint64 dx = x - query->centre_x;
+            sint64 dy = y - query->centre_y;
+            if (dx * dx + dy * dy > query->radius_squared) {
+                continue;
+            }
+        }
+        return sprite;
+    }
+}
+
 /**
  * Determines whether it's worth tweening a sprite or not when frame smoothing is on.
  */
@@ -747,10 +912,10 @@ static bool sprite_should_tween(rct_sprite *sprite)
 
 static void store_sprite_locations(LocationXYZ16 * sprite_locations)
 {
-    for (uint16 i = 0; i < MAX_SPRITES; i++) {
+    for (uint16 i = 0; i < gSpriteCapacity; i++) {
         // skip going through `get_sprite` to not get stalled on assert,
         // this can get very expensive for busy parks with uncap FPS option on
-        const rct_sprite *sprite = &_spriteList[i];
+        const rct_sprite *sprite = &_spriteBlocks[i / SPRITE_BLOCK_SIZE][i % SPRITE_BLOCK_SIZE];
         sprite_locations[i].x = sprite->unknown.x;
         sprite_locations[i].y = sprite->unknown.y;
         sprite_locations[i].z = sprite->unknown.z;
@@ -771,7 +936,7 @@ void sprite_position_tween_all(float alpha)
 {
     const float inv = (1.0f - alpha);
 
-    for (uint16 i = 0; i < MAX_SPRITES; i++) {
+    for (uint16 i = 0; i < gSpriteCapacity; i++) {
         rct_sprite * sprite = get_sprite(i);
         if (sprite_should_tween(sprite)) {
             LocationXYZ16 posA = _spritelocations1[i];
@@ -795,7 +960,7 @@ void sprite_position_tween_all(float alpha)
  */
 void sprite_position_tween_restore()
 {
-    for (uint16 i = 0; i < MAX_SPRITES; i++) {
+    for (uint16 i = 0; i < gSpriteCapacity; i++) {
         rct_sprite * sprite = get_sprite(i);
         if (sprite_should_tween(sprite)) {
             invalidate_sprite_2(sprite);
@@ -808,7 +973,7 @@ void sprite_position_tween_restore()
 
 void sprite_position_tween_reset()
 {
-    for (uint16 i = 0; i < MAX_SPRITES; i++) {
+    for (uint16 i = 0; i < gSpriteCapacity; i++) {
         rct_sprite * sprite = get_sprite(i);
         _spritelocations1[i].x =
         _spritelocations2[i].x = sprite->unknown.x;
@@ -821,13 +986,13 @@ void sprite_position_tween_reset()
 
 void sprite_set_flashing(rct_sprite *sprite, bool flashing)
 {
-    assert(sprite->unknown.sprite_index < MAX_SPRITES);
+    assert(sprite->unknown.sprite_index < gSpriteCapacity);
     _spriteFlashingList[sprite->unknown.sprite_index] = flashing;
 }
 
 bool sprite_get_flashing(rct_sprite *sprite)
 {
-    assert(sprite->unknown.sprite_index < MAX_SPRITES);
+    assert(sprite->unknown.sprite_index < gSpriteCapacity);
     return _spriteFlashingList[sprite->unknown.sprite_index];
 }
 
@@ -989,7 +1154,7 @@ sint32 fix_disjoint_sprites()
     sint32 count = 0;
 
     // Find all null sprites
-    for (sprite_idx = 0; sprite_idx < MAX_SPRITES; sprite_idx++)
+    for (sprite_idx = 0; sprite_idx < gSpriteCapacity; sprite_idx++)
     {
         rct_sprite * spr = get_sprite(sprite_idx);
         if (spr->unknown.sprite_identifier == SPRITE_IDENTIFIER_NULL)
@@ -22,7 +22,11 @@
 #include "../ride/Vehicle.h"
 
 #define SPRITE_INDEX_NULL       0xFFFF
-#define MAX_SPRITES             10000
+// The sprite pool starts with the number of sprites RCT2 had and grows in blocks
+// when more are needed, up to MAX_SPRITES.
+#define MAX_SPRITES             65000
+#define DEFAULT_SPRITE_CAPACITY 10000
+#define SPRITE_BLOCK_SIZE       1000
 #define NUM_SPRITE_LISTS        6
 
 enum SPRITE_IDENTIFIER {
@@ -385,6 +389,27 @@ enum {
     LITTER_TYPE_EMPTY_BOWL_BLUE,
 };
 
+/**
+ * Iterates over the sprites within an area by only visiting the spatial index chains of the tiles it overlaps.
+ * Removing the sprite that was last returned is safe, moving other sprites in the area during iteration is not.
+ */
+typedef struct sprite_spatial_query {
+    sint32 left;
+    sint32 top;
+    sint32 right;
+    sint32 bottom;
+    sint32 centre_x;
+    sint32 centre_y;
+    // Negative for rectangle queries
+    sint64 radius_squared;
+    sint32 tile_x;
+    sint32 tile_y;
+    sint32 tile_top;
+    sint32 tile_right;
+    sint32 tile_bottom;
+    uint16 next_sprite_index;
+} sprite_spatial_query;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -394,6 +419,7 @@ rct_sprite *get_sprite(size_t sprite_idx);
 
 extern uint16 gSpriteListHead[6];
 extern uint16 gSpriteListCount[6];
+extern uint16 gSpriteCapacity;
 extern uint16 gSpriteSpatialIndex[0x10001];
 
 
@@ -401,7 +427,10 @@ extern const rct_string_id litterNames[12];
 
 rct_sprite *create_sprite(uint8 bl);
 void reset_sprite_list();
+void sprite_set_capacity(uint32 capacity);
+uint32 sprite_get_free_count();
 void reset_sprite_spatial_index();
+void rebuild_sprite_spatial_index_links();
 void sprite_clear_all_unused();
 void move_sprite_to_list(rct_sprite *sprite, uint8 cl);
 void sprite_misc_update_all();
@@ -416,6 +445,9 @@ void litter_remove_at(sint32 x, sint32 y, sint32 z);
 void sprite_misc_explosion_cloud_create(sint32 x, sint32 y, sint32 z);
 void sprite_misc_explosion_flare_create(sint32 x, sint32 y, sint32 z);
 uint16 sprite_get_first_in_quadrant(sint32 x, sint32 y);
+void sprite_spatial_query_rect(sprite_spatial_query * query, sint32 left, sint32 top, sint32 right, sint32 bottom);
+void sprite_spatial_query_radius(sprite_spatial_query * query, sint32 x, sint32 y, sint32 radius);
+rct_sprite * sprite_spatial_query_next(sprite_spatial_query * query);
 void sprite_position_tween_store_a();
 void sprite_position_tween_store_b();
 void sprite_position_tween_all(float nudge);
@@ -454,7 +486,6 @@ void crashed_vehicle_particle_update(rct_crashed_vehicle_particle *particle);
 void crash_splash_create(sint32 x, sint32 y, sint32 z);
 void crash_splash_update(rct_crash_splash *splash);
 
-const char *sprite_checksum();
 
 void sprite_set_flashing(rct_sprite *sprite, bool flashing);
 bool sprite_get_flashing(rct_sprite *sprite);
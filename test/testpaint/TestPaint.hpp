@@ -26,6 +26,9 @@ extern "C"
     #include <openrct2/interface/colour.h>
     #include <openrct2/paint/Paint.h>
     #include <openrct2/paint/tile_element/TileElement.h>
+
+    // The paint functions under test all write to this one session
+    extern paint_session gPaintSession;
 }
 
 #include "addresses.h"
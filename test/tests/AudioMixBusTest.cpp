@@ -0,0 +1,281 @@
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <openrct2/audio/AudioMixBus.h>
+
+using namespace OpenRCT2::Audio;
+
+class AudioMixBusTest : public testing::Test
+{
+protected:
+    static std::vector<sint16> generate_samples(std::mt19937 &rng, size_t numSamples)
+    {
+        std::uniform_int_distribution<sint32> distribution(-32768, 32767);
+        std::vector<sint16> samples(numSamples);
+        for (auto &sample : samples)
+        {
+            sample = (sint16)distribution(rng);
+        }
+        return samples;
+    }
+
+    static std::vector<uint8> generate_samples_u8(std::mt19937 &rng, size_t numSamples)
+    {
+        std::uniform_int_distribution<sint32> distribution(0, 255);
+        std::vector<uint8> samples(numSamples);
+        for (auto &sample : samples)
+        {
+            sample = (uint8)distribution(rng);
+        }
+        return samples;
+    }
+
+    static AudioMixGain generate_gain(std::mt19937 &rng)
+    {
+        std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+        AudioMixGain gain;
+        gain.VolumeStart = distribution(rng);
+        gain.VolumeEnd = distribution(rng);
+        gain.LeftStart = distribution(rng);
+        gain.LeftEnd = distribution(rng);
+        gain.RightStart = distribution(rng);
+        gain.RightEnd = distribution(rng);
+        return gain;
+    }
+
+    static double reference_gain(float start, float end, size_t frame, size_t numFrames)
+    {
+        return start + (end - start) * (double)frame / numFrames;
+    }
+};
+
+TEST_F(AudioMixBusTest, mix_s16_stereo)
+{
+    std::mt19937 rng(0);
+    // Odd lengths cover the frames left over after the vectorised loop
+    for (size_t numFrames : { 1, 3, 4, 7, 64, 1023 })
+    {
+        AudioMixBus bus;
+        bus.Clear(numFrames, 2);
+        std::vector<double> expected(numFrames * 2, 0.0);
+        for (sint32 channel = 0; channel < 4; channel++)
+        {
+            auto samples = generate_samples(rng, numFrames * 2);
+            auto gain = generate_gain(rng);
+            bus.MixS16(samples.data(), numFrames, gain);
+            for (size_t i = 0; i < numFrames; i++)
+            {
+                double volume = reference_gain(gain.VolumeStart, gain.VolumeEnd, i, numFrames);
+                expected[i * 2] += samples[i * 2] * volume * reference_gain(gain.LeftStart, gain.LeftEnd, i, numFrames);
+                expected[i * 2 + 1] += samples[i * 2 + 1] * volume * reference_gain(gain.RightStart, gain.RightEnd, i, numFrames);
+            }
+        }
+
+        const float * mixed = bus.GetSamples();
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            ASSERT_NEAR(mixed[i], expected[i], 0.05) << "sample " << i << " of " << numFrames << " frames";
+        }
+    }
+}
+
+TEST_F(AudioMixBusTest, mix_s16_mono_ignores_pan)
+{
+    AudioMixBus bus;
+    bus.Clear(4, 1);
+    const sint16 samples[] = { 1000, 1000, 1000, 1000 };
+    AudioMixGain gain;
+    gain.VolumeStart = 0.5f;
+    gain.VolumeEnd = 0.5f;
+    gain.LeftStart = gain.LeftEnd = 0.0f;
+    bus.MixS16(samples, 4, gain);
+    for (size_t i = 0; i < 4; i++)
+    {
+        ASSERT_FLOAT_EQ(bus.GetSamples()[i], 500.0f);
+    }
+}
+
+TEST_F(AudioMixBusTest, mix_short_source)
+{
+    // A channel that ran out of data only adds to the start of the bus
+    AudioMixBus bus;
+    bus.Clear(16, 2);
+    std::vector<sint16> samples(10, 100);
+    bus.MixS16(samples.data(), 5, AudioMixGain());
+    for (size_t i = 0; i < 32; i++)
+    {
+        ASSERT_FLOAT_EQ(bus.GetSamples()[i], i < 10 ? 100.0f : 0.0f);
+    }
+}
+
+TEST_F(AudioMixBusTest, read_s16_saturates)
+{
+    AudioMixBus bus;
+    bus.Clear(9, 2);
+    const sint16 loud[] = { 30000, -30000 };
+    std::vector<sint16> samples;
+    for (size_t i = 0; i < 9; i++)
+    {
+        samples.insert(samples.end(), std::begin(loud), std::end(loud));
+    }
+    // Two loud channels only clip once they are converted
+    bus.MixS16(samples.data(), 9, AudioMixGain());
+    bus.MixS16(samples.data(), 9, AudioMixGain());
+    ASSERT_FLOAT_EQ(bus.GetSamples()[0], 60000.0f);
+
+    sint16 output[18];
+    bus.ReadS16(output);
+    for (size_t i = 0; i < 18; i += 2)
+    {
+        ASSERT_EQ(output[i], 32767);
+        ASSERT_EQ(output[i + 1], -32768);
+    }
+
+    uint8 output8[18];
+    bus.ReadU8(output8);
+    for (size_t i = 0; i < 18; i += 2)
+    {
+        ASSERT_EQ(output8[i], 255);
+        ASSERT_EQ(output8[i + 1], 0);
+    }
+}
+
+TEST_F(AudioMixBusTest, read_s16_rounds)
+{
+    AudioMixBus bus;
+    bus.Clear(1, 2);
+    const sint16 samples[] = { 3, -3 };
+    AudioMixGain gain;
+    gain.VolumeStart = gain.VolumeEnd = 0.5f;
+    bus.MixS16(samples, 1, gain);
+    sint16 output[2];
+    bus.ReadS16(output);
+    ASSERT_EQ(output[0], 2);
+    ASSERT_EQ(output[1], -2);
+}
+
+TEST_F(AudioMixBusTest, mix_u8_stereo)
+{
+    std::mt19937 rng(0);
+    for (size_t numFrames : { 1, 3, 4, 7, 64, 1023 })
+    {
+        AudioMixBus bus;
+        bus.Clear(numFrames, 2);
+        std::vector<double> expected(numFrames * 2, 0.0);
+        for (sint32 channel = 0; channel < 4; channel++)
+        {
+            auto samples = generate_samples_u8(rng, numFrames * 2);
+            auto gain = generate_gain(rng);
+            bus.MixU8(samples.data(), numFrames, gain);
+            for (size_t i = 0; i < numFrames; i++)
+            {
+                // 8-bit samples are unsigned around 128 and scaled up to the range of a 16-bit sample
+                double left = (samples[i * 2] - 128) * 256.0;
+                double right = (samples[i * 2 + 1] - 128) * 256.0;
+                double volume = reference_gain(gain.VolumeStart, gain.VolumeEnd, i, numFrames);
+                expected[i * 2] += left * volume * reference_gain(gain.LeftStart, gain.LeftEnd, i, numFrames);
+                expected[i * 2 + 1] += right * volume * reference_gain(gain.RightStart, gain.RightEnd, i, numFrames);
+            }
+        }
+
+        const float * mixed = bus.GetSamples();
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            ASSERT_NEAR(mixed[i], expected[i], 0.05) << "sample " << i << " of " << numFrames << " frames";
+        }
+    }
+}
+
+TEST_F(AudioMixBusTest, read_u8_round_trip)
+{
+    // Every 8-bit sample mixed at full volume reads back unchanged
+    std::vector<uint8> samples(256);
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        samples[i] = (uint8)i;
+    }
+    AudioMixBus bus;
+    bus.Clear(samples.size(), 1);
+    bus.MixU8(samples.data(), samples.size(), AudioMixGain());
+
+    std::vector<uint8> output(samples.size());
+    bus.ReadU8(output.data());
+    ASSERT_EQ(output, samples);
+}
+
+TEST_F(AudioMixBusTest, read_u8_saturates)
+{
+    AudioMixBus bus;
+    bus.Clear(9, 2);
+    const uint8 loud[] = { 250, 6 };
+    std::vector<uint8> samples;
+    for (size_t i = 0; i < 9; i++)
+    {
+        samples.insert(samples.end(), std::begin(loud), std::end(loud));
+    }
+    // Two loud channels only clip once they are converted
+    bus.MixU8(samples.data(), 9, AudioMixGain());
+    bus.MixU8(samples.data(), 9, AudioMixGain());
+    ASSERT_FLOAT_EQ(bus.GetSamples()[0], 122.0f * 256.0f * 2);
+    ASSERT_FLOAT_EQ(bus.GetSamples()[1], -122.0f * 256.0f * 2);
+
+    uint8 output[18];
+    bus.ReadU8(output);
+    for (size_t i = 0; i < 18; i += 2)
+    {
+        ASSERT_EQ(output[i], 255);
+        ASSERT_EQ(output[i + 1], 0);
+    }
+}
+
+TEST_F(AudioMixBusTest, read_u8_rounds)
+{
+    AudioMixBus bus;
+    bus.Clear(1, 2);
+    const sint16 samples[] = { 383, -383 };
+    bus.MixS16(samples, 1, AudioMixGain());
+    uint8 output[2];
+    bus.ReadU8(output);
+    // 383 / 256 is just under 1.5
+    ASSERT_EQ(output[0], 129);
+    ASSERT_EQ(output[1], 127);
+}
+
+// Mixes many synthetic channels the way the SDL audio callback does and prints how long each callback takes.
+// This is a benchmark rather than a test, run it with --gtest_also_run_disabled_tests.
+TEST_F(AudioMixBusTest, DISABLED_throughput)
+{
+    constexpr size_t numFrames = 1024;
+    constexpr sint32 numChannels = 64;
+    constexpr sint32 iterations = 200;
+
+    std::mt19937 rng(0);
+    std::vector<std::vector<sint16>> channels;
+    std::vector<AudioMixGain> gains;
+    for (sint32 i = 0; i < numChannels; i++)
+    {
+        channels.push_back(generate_samples(rng, numFrames * 2));
+        gains.push_back(generate_gain(rng));
+    }
+
+    AudioMixBus bus;
+    std::vector<sint16> output(numFrames * 2);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (sint32 i = 0; i < iterations; i++)
+    {
+        bus.Clear(numFrames, 2);
+        for (sint32 j = 0; j < numChannels; j++)
+        {
+            bus.MixS16(channels[j].data(), numFrames, gains[j]);
+        }
+        bus.ReadS16(output.data());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    ASSERT_EQ(bus.GetNumFrames(), numFrames);
+
+    double microseconds = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+    // 1024 frames last 23 ms at 44.1 kHz
+    printf("%d channels, %u frames: %.1f us per callback\n", numChannels, (uint32)numFrames, microseconds);
+}
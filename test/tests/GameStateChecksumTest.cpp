@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <openrct2/GameStateChecksum.h>
+#include <openrct2/world/footpath.h>
+
+class GameStateChecksumTest : public testing::Test
+{
+protected:
+    static rct_tile_element CreatePath()
+    {
+        rct_tile_element tileElement = {};
+        tileElement.type = TILE_ELEMENT_TYPE_PATH;
+        tileElement.flags = TILE_ELEMENT_FLAG_LAST_TILE;
+        tileElement.base_height = 14;
+        tileElement.clearance_height = 18;
+        tileElement.properties.path.edges = 0x0F;
+        tileElement.properties.path.addition_status = 255;
+        return tileElement;
+    }
+
+    static uint64 HashTileElement(const rct_tile_element &tileElement)
+    {
+        rct_tile_element copy = tileElement;
+        game_state_mask_tile_element(&copy);
+        GameStateHasher hasher;
+        hasher.Write(copy);
+        return hasher.GetHash();
+    }
+
+    static uint64 HashRide(const Ride &ride)
+    {
+        Ride copy = ride;
+        game_state_mask_ride(&copy);
+        GameStateHasher hasher;
+        hasher.Write(copy);
+        return hasher.GetHash();
+    }
+};
+
+TEST_F(GameStateChecksumTest, ghost_path_addition_ignored)
+{
+    rct_tile_element path = CreatePath();
+
+    rct_tile_element ghostAddition = path;
+    footpath_element_set_path_scenery(&ghostAddition, 3);
+    footpath_scenery_set_is_ghost(&ghostAddition, true);
+    ASSERT_EQ(HashTileElement(ghostAddition), HashTileElement(path));
+
+    // Once placed for real the addition is part of the synchronised state
+    rct_tile_element addition = path;
+    footpath_element_set_path_scenery(&addition, 3);
+    ASSERT_NE(HashTileElement(addition), HashTileElement(path));
+}
+
+TEST_F(GameStateChecksumTest, queue_keeps_ride_index)
+{
+    rct_tile_element queue = CreatePath();
+    queue.type |= FOOTPATH_ELEMENT_TYPE_FLAG_IS_QUEUE;
+    queue.properties.path.ride_index = 7;
+
+    rct_tile_element ghostAddition = queue;
+    footpath_element_set_path_scenery(&ghostAddition, 3);
+    footpath_scenery_set_is_ghost(&ghostAddition, true);
+    ASSERT_EQ(HashTileElement(ghostAddition), HashTileElement(queue));
+
+    rct_tile_element otherRide = ghostAddition;
+    otherRide.properties.path.ride_index = 8;
+    ASSERT_NE(HashTileElement(otherRide), HashTileElement(queue));
+}
+
+TEST_F(GameStateChecksumTest, ride_measurement_ignored)
+{
+    Ride ride = {};
+    ride.type = RIDE_TYPE_WOODEN_ROLLER_COASTER;
+    ride.status = RIDE_STATUS_OPEN;
+    ride.measurement_index = 255;
+
+    // Viewing the ride's graphs assigns a measurement on that client only
+    Ride measured = ride;
+    measured.measurement_index = 2;
+    ASSERT_EQ(HashRide(measured), HashRide(ride));
+
+    Ride closed = ride;
+    closed.status = RIDE_STATUS_CLOSED;
+    ASSERT_NE(HashRide(closed), HashRide(ride));
+}
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <openrct2/interface/viewport.h>
+#include <openrct2/paint/Paint.h>
+
+class PaintArrangeTest : public testing::Test
+{
+protected:
+    static constexpr uint16 QuadrantBackIndex = 10;
+    static constexpr uint16 QuadrantFrontIndex = 30;
+
+    /**
+     * The arrange pass as it was before the quadrants were copied into arrays, walking and relinking the
+     * linked list directly.
+     */
+    static bool reference_is_bbox_intersecting(uint8 rotation, const paint_struct_bound_box &initialBBox,
+        const paint_struct_bound_box &currentBBox)
+    {
+        bool result = false;
+        switch (rotation) {
+        case 0:
+            if (initialBBox.z_end >= currentBBox.z && initialBBox.y_end >= currentBBox.y && initialBBox.x_end >= currentBBox.x
+                && !(initialBBox.z < currentBBox.z_end && initialBBox.y < currentBBox.y_end && initialBBox.x < currentBBox.x_end))
+                result = true;
+            break;
+        case 1:
+            if (initialBBox.z_end >= currentBBox.z && initialBBox.y_end >= currentBBox.y && initialBBox.x_end < currentBBox.x
+                && !(initialBBox.z < currentBBox.z_end && initialBBox.y < currentBBox.y_end && initialBBox.x >= currentBBox.x_end))
+                result = true;
+            break;
+        case 2:
+            if (initialBBox.z_end >= currentBBox.z && initialBBox.y_end < currentBBox.y && initialBBox.x_end < currentBBox.x
+                && !(initialBBox.z < currentBBox.z_end && initialBBox.y >= currentBBox.y_end && initialBBox.x >= currentBBox.x_end))
+                result = true;
+            break;
+        case 3:
+            if (initialBBox.z_end >= currentBBox.z && initialBBox.y_end < currentBBox.y && initialBBox.x_end >= currentBBox.x
+                && !(initialBBox.z < currentBBox.z_end && initialBBox.y >= currentBBox.y_end && initialBBox.x < currentBBox.x_end))
+                result = true;
+            break;
+        }
+        return result;
+    }
+
+    static paint_struct * reference_arrange_structs_helper(paint_struct * ps_next, uint16 quadrantIndex, uint8 flag)
+    {
+        paint_struct * ps;
+        paint_struct * ps_temp;
+        do
+        {
+            ps = ps_next;
+            ps_next = ps_next->next_quadrant_ps;
+            if (ps_next == nullptr) return ps;
+        } while (quadrantIndex > ps_next->quadrant_index);
+
+        paint_struct * ps_cache = ps;
+
+        ps_temp = ps;
+        do {
+            ps = ps->next_quadrant_ps;
+            if (ps == nullptr) break;
+
+            if (ps->quadrant_index > quadrantIndex + 1)
+            {
+                ps->quadrant_flags = PAINT_QUADRANT_FLAG_BIGGER;
+            }
+            else if (ps->quadrant_index == quadrantIndex + 1)
+            {
+                ps->quadrant_flags = PAINT_QUADRANT_FLAG_NEXT | PAINT_QUADRANT_FLAG_IDENTICAL;
+            }
+            else if (ps->quadrant_index == quadrantIndex)
+            {
+                ps->quadrant_flags = flag | PAINT_QUADRANT_FLAG_IDENTICAL;
+            }
+        } while (ps->quadrant_index <= quadrantIndex + 1);
+        ps = ps_temp;
+
+        uint8 rotation = get_current_rotation();
+        while (true)
+        {
+            while (true)
+            {
+                ps_next = ps->next_quadrant_ps;
+                if (ps_next == nullptr) return ps_cache;
+                if (ps_next->quadrant_flags & PAINT_QUADRANT_FLAG_BIGGER) return ps_cache;
+                if (ps_next->quadrant_flags & PAINT_QUADRANT_FLAG_IDENTICAL) break;
+                ps = ps_next;
+            }
+
+            ps_next->quadrant_flags &= ~PAINT_QUADRANT_FLAG_IDENTICAL;
+            ps_temp = ps;
+
+            const paint_struct_bound_box initialBBox = ps_next->bounds;
+            while (true)
+            {
+                ps = ps_next;
+                ps_next = ps_next->next_quadrant_ps;
+                if (ps_next == nullptr) break;
+                if (ps_next->quadrant_flags & PAINT_QUADRANT_FLAG_BIGGER) break;
+                if (!(ps_next->quadrant_flags & PAINT_QUADRANT_FLAG_NEXT)) continue;
+
+                if (reference_is_bbox_intersecting(rotation, initialBBox, ps_next->bounds))
+                {
+                    ps->next_quadrant_ps = ps_next->next_quadrant_ps;
+                    paint_struct * ps_temp2 = ps_temp->next_quadrant_ps;
+                    ps_temp->next_quadrant_ps = ps_next;
+                    ps_next->next_quadrant_ps = ps_temp2;
+                    ps_next = ps;
+                }
+            }
+
+            ps = ps_temp;
+        }
+    }
+
+    /**
+     * Generates paint structs sorted by quadrant, with small bounding boxes so many of them intersect.
+     */
+    static std::vector<paint_struct> generate_structs(std::mt19937 &rng, size_t count)
+    {
+        std::uniform_int_distribution<sint32> quadrantDistribution(QuadrantBackIndex, QuadrantFrontIndex);
+        std::uniform_int_distribution<sint32> positionDistribution(0, 48);
+        std::uniform_int_distribution<sint32> sizeDistribution(0, 16);
+
+        std::vector<uint16> quadrants(count);
+        for (auto &quadrant : quadrants)
+        {
+            quadrant = (uint16)quadrantDistribution(rng);
+        }
+        std::sort(quadrants.begin(), quadrants.end());
+
+        std::vector<paint_struct> structs(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            paint_struct &ps = structs[i];
+            ps = {};
+            ps.quadrant_index = quadrants[i];
+            ps.bounds.x = (uint16)positionDistribution(rng);
+            ps.bounds.y = (uint16)positionDistribution(rng);
+            ps.bounds.z = (uint16)positionDistribution(rng);
+            ps.bounds.x_end = ps.bounds.x + (uint16)sizeDistribution(rng);
+            ps.bounds.y_end = ps.bounds.y + (uint16)sizeDistribution(rng);
+            ps.bounds.z_end = ps.bounds.z + (uint16)sizeDistribution(rng);
+        }
+        return structs;
+    }
+
+    /**
+     * Links the structs behind a head paint struct and arranges them the same way paint_session_arrange does,
+     * returning the resulting order as indices along with the final quadrant flags.
+     */
+    template<typename TArrangeFunc>
+    static std::vector<size_t> arrange(std::vector<paint_struct> structs, TArrangeFunc arrangeFunc,
+        std::vector<uint8> &outFlags)
+    {
+        paint_struct psHead = {};
+        paint_struct * ps = &psHead;
+        for (auto &item : structs)
+        {
+            ps->next_quadrant_ps = &item;
+            ps = &item;
+        }
+        ps->next_quadrant_ps = nullptr;
+
+        paint_struct * ps_cache = arrangeFunc(&psHead, QuadrantBackIndex, PAINT_QUADRANT_FLAG_NEXT);
+        for (uint16 quadrantIndex = QuadrantBackIndex + 1; quadrantIndex < QuadrantFrontIndex; quadrantIndex++)
+        {
+            ps_cache = arrangeFunc(ps_cache, quadrantIndex, 0);
+        }
+
+        std::vector<size_t> order;
+        outFlags.clear();
+        for (ps = psHead.next_quadrant_ps; ps != nullptr; ps = ps->next_quadrant_ps)
+        {
+            order.push_back(ps - structs.data());
+            outFlags.push_back(ps->quadrant_flags);
+        }
+        return order;
+    }
+};
+
+TEST_F(PaintArrangeTest, matches_reference)
+{
+    std::mt19937 rng(5489);
+    std::uniform_int_distribution<sint32> countDistribution(1, 300);
+    for (sint32 iteration = 0; iteration < 200; iteration++)
+    {
+        std::vector<paint_struct> structs = generate_structs(rng, countDistribution(rng));
+        for (uint8 rotation = 0; rotation < 4; rotation++)
+        {
+            gCurrentRotation = rotation;
+
+            std::vector<uint8> expectedFlags;
+            std::vector<uint8> actualFlags;
+            std::vector<size_t> expected = arrange(structs, reference_arrange_structs_helper, expectedFlags);
+            std::vector<size_t> actual = arrange(structs, paint_arrange_structs_helper, actualFlags);
+            ASSERT_EQ(expected.size(), structs.size());
+            ASSERT_EQ(actual, expected) << "iteration " << iteration << ", rotation " << (sint32)rotation;
+            ASSERT_EQ(actualFlags, expectedFlags) << "iteration " << iteration << ", rotation " << (sint32)rotation;
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
 #include <openrct2/audio/AudioContext.h>
 #include <openrct2/Context.h>
@@ -16,6 +17,53 @@ using namespace OpenRCT2;
 class RideRatings : public testing::Test
 {
 protected:
+    IContext * _context = nullptr;
+
+    void TearDown() override
+    {
+        delete _context;
+        _context = nullptr;
+    }
+
+    void LoadPark()
+    {
+        std::string path = TestData::GetParkPath("bpb.sv6");
+
+        gOpenRCT2Headless = true;
+
+        core_init();
+        _context = CreateContext();
+        bool initialised = _context->Initialise();
+        ASSERT_TRUE(initialised);
+
+        load_from_sv6(path.c_str());
+
+        // Check ride count to check load was successful
+        ASSERT_EQ(gRideCount, 134);
+    }
+
+    void CheckRatings()
+    {
+        // Load expected ratings
+        auto expectedDataPath = Path::Combine(TestData::GetBasePath(), "ratings", "bpb.sv6.txt");
+        auto expectedRatings = File::ReadAllLines(expectedDataPath);
+
+        // Check ride ratings
+        int expI = 0;
+        for (int rideId = 0; rideId < MAX_RIDES; rideId++)
+        {
+            Ride * ride = get_ride(rideId);
+            if (ride->type != RIDE_TYPE_NULL)
+            {
+                std::string actual = FormatRatings(ride);
+                std::string expected = expectedRatings[expI];
+                ASSERT_STREQ(actual.c_str(), expected.c_str());
+
+                expI++;
+            }
+        }
+    }
+
     void CalculateRatingsForAllRides()
     {
         for (int rideId = 0; rideId < MAX_RIDES; rideId++)
@@ -28,6 +76,61 @@ protected:
         }
     }
 
+    void CalculateRatingsIncrementally()
+    {
+        // Run the incremental update from the first ride until it has been through every ride once
+        gRideRatingsCalcData.current_ride = MAX_RIDES - 1;
+        gRideRatingsCalcData.state = RIDE_RATINGS_STATE_FIND_NEXT_RIDE;
+        do
+        {
+            ride_ratings_update_all();
+        }
+        while (gRideRatingsCalcData.state != RIDE_RATINGS_STATE_FIND_NEXT_RIDE ||
+            gRideRatingsCalcData.current_ride != MAX_RIDES - 1);
+    }
+
+    void CalculateRatingsOnInvalidate()
+    {
+        for (int rideId = 0; rideId < MAX_RIDES; rideId++)
+        {
+            Ride * ride = get_ride(rideId);
+            if (ride->type != RIDE_TYPE_NULL)
+            {
+                ride_ratings_invalidate_ride(rideId);
+            }
+        }
+        ride_ratings_update_pending();
+    }
+
+    void ClearRatings()
+    {
+        // Closed rides are never recalculated and keep the ratings they were saved with
+        for (int rideId = 0; rideId < MAX_RIDES; rideId++)
+        {
+            Ride * ride = get_ride(rideId);
+            if (ride->type != RIDE_TYPE_NULL && ride->status != RIDE_STATUS_CLOSED)
+            {
+                ride->ratings.excitement = RIDE_RATING_UNDEFINED;
+                ride->ratings.intensity = RIDE_RATING_UNDEFINED;
+                ride->ratings.nausea = RIDE_RATING_UNDEFINED;
+            }
+        }
+    }
+
+    std::vector<std::string> GetRatings()
+    {
+        std::vector<std::string> ratings;
+        for (int rideId = 0; rideId < MAX_RIDES; rideId++)
+        {
+            Ride * ride = get_ride(rideId);
+            if (ride->type != RIDE_TYPE_NULL)
+            {
+                ratings.push_back(FormatRatings(ride));
+            }
+        }
+        return ratings;
+    }
+
     void DumpRatings()
     {
         for (int rideId = 0; rideId < MAX_RIDES; rideId++)
@@ -92,3 +195,47 @@ TEST_F(RideRatings, all)
 
     delete context;
 }
+
+TEST_F(RideRatings, invalidated)
+{
+    ASSERT_NO_FATAL_FAILURE(LoadPark());
+    ClearRatings();
+    CalculateRatingsIncrementally();
+    std::vector<std::string> incremental = GetRatings();
+
+    // A full recalculation of the invalidated rides must match the incremental update
+    load_from_sv6(TestData::GetParkPath("bpb.sv6").c_str());
+    ClearRatings();
+    CalculateRatingsOnInvalidate();
+    std::vector<std::string> invalidated = GetRatings();
+
+    ASSERT_EQ(invalidated.size(), incremental.size());
+    for (size_t i = 0; i < incremental.size(); i++)
+    {
+        ASSERT_STREQ(invalidated[i].c_str(), incremental[i].c_str());
+    }
+}
+
+TEST_F(RideRatings, pending_restored_after_load)
+{
+    ASSERT_NO_FATAL_FAILURE(LoadPark());
+
+    // Queue every ride and save the queue, as a server does when it sends the map
+    for (int rideId = 0; rideId < MAX_RIDES; rideId++)
+    {
+        Ride * ride = get_ride(rideId);
+        if (ride->type != RIDE_TYPE_NULL)
+        {
+            ride_ratings_invalidate_ride(rideId);
+        }
+    }
+    std::vector<uint8> pending(ride_ratings_get_pending_size());
+    ride_ratings_get_pending(pending.data());
+
+    // Loading the park clears the queue, so the ratings are only recalculated if it is restored
+    load_from_sv6(TestData::GetParkPath("bpb.sv6").c_str());
+    ClearRatings();
+    ride_ratings_set_pending(pending.data());
+    ride_ratings_update_pending();
+    ASSERT_NO_FATAL_FAILURE(CheckRatings());
+}
@@ -1,7 +1,13 @@
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
 #include <gtest/gtest.h>
 #include <openrct2/core/MemoryStream.h>
 #include <openrct2/rct12/SawyerChunkReader.h>
 #include <openrct2/util/SawyerCoding.h>
+#include "TestData.h"
 
 constexpr size_t BUFFER_SIZE = 0x600000;
 
@@ -50,6 +56,58 @@ protected:
         auto result = memcmp(chunk->GetData(), randomdata, sizeof(randomdata));
         ASSERT_EQ(result, 0);
     }
+
+    void test_encode_decode(uint8 encoding_type, const std::vector<uint8> &data)
+    {
+        sawyercoding_chunk_header chdr_in;
+        chdr_in.encoding = encoding_type;
+        chdr_in.length   = (uint32)data.size();
+        // The repeat encoding doubles the size of data without repeats in the worst case
+        std::vector<uint8> encodedData(sizeof(sawyercoding_chunk_header) + (data.size() * 3));
+        size_t encodedDataSize = sawyercoding_write_chunk_buffer(encodedData.data(), data.data(), chdr_in);
+
+        MemoryStream ms(encodedData.data(), encodedDataSize);
+        SawyerChunkReader reader(&ms);
+        auto chunk = reader.ReadChunk();
+        ASSERT_EQ(chunk->GetLength(), data.size());
+        auto result = memcmp(chunk->GetData(), data.data(), data.size());
+        ASSERT_EQ(result, 0);
+    }
+
+    /**
+     * Generates data mixing random bytes, runs of one byte and short repeats of earlier bytes, in proportions
+     * that differ between calls so that every path through the encoders is exercised.
+     */
+    static std::vector<uint8> generate_fuzz_data(std::mt19937 &rng, size_t length)
+    {
+        uint32 alphabetSize = 1 + (rng() % 256);
+        uint32 runChance = rng() % 100;
+        uint32 repeatChance = rng() % 100;
+
+        std::vector<uint8> data(length);
+        for (size_t i = 0; i < length; i++)
+        {
+            if (i > 0 && (rng() % 100) < runChance)
+            {
+                data[i] = data[i - 1];
+            }
+            else if (i >= 32 && (rng() % 100) < repeatChance)
+            {
+                data[i] = data[i - 1 - (rng() % 32)];
+            }
+            else
+            {
+                data[i] = (uint8)(rng() % alphabetSize);
+            }
+        }
+        return data;
+    }
+
+    static std::vector<uint8> read_park(const std::string &name)
+    {
+        std::ifstream fs(TestData::GetParkPath(name), std::ios::binary);
+        return std::vector<uint8>(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+    }
 };
 
 TEST_F(SawyerCodingTest, write_read_chunk_none)
@@ -72,6 +130,91 @@ TEST_F(SawyerCodingTest, write_read_chunk_rotate)
     test_encode_decode(CHUNK_ENCODING_ROTATE);
 }
 
+TEST_F(SawyerCodingTest, write_read_chunk_fuzz)
+{
+    std::mt19937 rng(20180102);
+    for (sint32 i = 0; i < 200; i++)
+    {
+        // Mostly short chunks so that the tails of each kernel are hit, with some long enough for many blocks
+        size_t length = 1 + (rng() % ((i % 4 == 0) ? 65536 : 300));
+        auto data = generate_fuzz_data(rng, length);
+        for (uint8 encoding : { CHUNK_ENCODING_NONE, CHUNK_ENCODING_RLE, CHUNK_ENCODING_RLECOMPRESSED, CHUNK_ENCODING_ROTATE })
+        {
+            SCOPED_TRACE(testing::Message() << "iteration " << i << ", encoding " << (sint32)encoding);
+            test_encode_decode(encoding, data);
+        }
+    }
+}
+
+TEST_F(SawyerCodingTest, checksum_fuzz)
+{
+    std::mt19937 rng(20180102);
+    for (sint32 i = 0; i < 100; i++)
+    {
+        auto data = generate_fuzz_data(rng, rng() % 1000);
+        uint32 expected = 0;
+        for (uint8 b : data)
+        {
+            expected += b;
+        }
+        ASSERT_EQ(sawyercoding_calculate_checksum(data.data(), data.size()), expected);
+    }
+}
+
+// Prints the decode and encode throughput of each chunk in a real saved game. Only fails if a chunk does not
+// survive being encoded again. This is a benchmark rather than a test, run it with --gtest_also_run_disabled_tests.
+TEST_F(SawyerCodingTest, DISABLED_throughput_sv6)
+{
+    auto park = read_park("bpb.sv6");
+    if (park.empty())
+    {
+        printf("%s not found, skipping throughput test.\n", TestData::GetParkPath("bpb.sv6").c_str());
+        return;
+    }
+
+    constexpr sint32 iterations = 10;
+    MemoryStream ms(park.data(), park.size());
+    SawyerChunkReader reader(&ms);
+    // The last four bytes are the file checksum
+    while (ms.GetPosition() + 4 < ms.GetLength())
+    {
+        uint64 chunkPosition = ms.GetPosition();
+        auto startDecode = std::chrono::high_resolution_clock::now();
+        std::shared_ptr<SawyerChunk> chunk;
+        for (sint32 i = 0; i < iterations; i++)
+        {
+            ms.SetPosition(chunkPosition);
+            chunk = reader.ReadChunk();
+        }
+        auto endDecode = std::chrono::high_resolution_clock::now();
+
+        sawyercoding_chunk_header header;
+        header.encoding = (uint8)chunk->GetEncoding();
+        header.length = (uint32)chunk->GetLength();
+        std::vector<uint8> encodedData(BUFFER_SIZE);
+        size_t encodedDataSize = 0;
+        auto startEncode = std::chrono::high_resolution_clock::now();
+        for (sint32 i = 0; i < iterations; i++)
+        {
+            encodedDataSize = sawyercoding_write_chunk_buffer(encodedData.data(), (const uint8 *)chunk->GetData(), header);
+        }
+        auto endEncode = std::chrono::high_resolution_clock::now();
+
+        MemoryStream encodedStream(encodedData.data(), encodedDataSize);
+        SawyerChunkReader encodedReader(&encodedStream);
+        auto roundTripChunk = encodedReader.ReadChunk();
+        ASSERT_EQ(roundTripChunk->GetLength(), chunk->GetLength());
+        ASSERT_EQ(memcmp(roundTripChunk->GetData(), chunk->GetData(), chunk->GetLength()), 0);
+
+        double megabytes = (double)chunk->GetLength() * iterations / (1024 * 1024);
+        double decodeSeconds = std::chrono::duration<double>(endDecode - startDecode).count();
+        double encodeSeconds = std::chrono::duration<double>(endEncode - startEncode).count();
+        printf("chunk at %8u, encoding %d, %8u bytes: decode %8.1f MiB/s, encode %8.1f MiB/s\n",
+            (uint32)chunkPosition, (sint32)header.encoding, header.length,
+            megabytes / decodeSeconds, megabytes / encodeSeconds);
+    }
+}
+
 // Note we only check if provided data decompresses to the same data, not if it compresses the same.
 // The reason for that is we may improve encoding at some point, but the test won't be affected,
 // as we already do a decode test and rountrip (encode + decode), which validates all uses.